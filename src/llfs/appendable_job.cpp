@@ -37,11 +37,8 @@ StatusOr<AppendableJob> make_appendable_job(std::unique_ptr<PageCacheJob>&& job,
 //
 PrepareJob prepare(const AppendableJob& appendable)
 {
-  return PrepareJob{
-      .new_page_ids = appendable.job.new_page_ids(),
-      .deleted_page_ids = appendable.job.deleted_page_ids(),
-      .user_data = appendable.user_data,
-  };
+  return make_prepare_job(appendable.job.new_page_ids(), appendable.job.deleted_page_ids(),
+                          appendable.user_data);
 }
 
 }  // namespace llfs
@@ -27,9 +27,12 @@
 #include <boost/operators.hpp>
 #include <boost/smart_ptr/intrusive_ref_counter.hpp>
 
+#include <array>
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace llfs {
 
@@ -37,6 +40,56 @@ using CacheLRUHook = boost::intrusive::list_base_hook<boost::intrusive::tag<stru
 
 using LogicalTimeStamp = u64;
 
+// Eviction priority class of a Cache slot.  Unpinned slots of a lower class are always evicted
+// before those of a higher class; within a class, slots are evicted in LRU order.
+//
+enum struct CachePriority : u8 {
+  kLow = 0,
+  kNormal = 1,
+  kHigh = 2,
+};
+
+constexpr usize kNumCachePriorities = 3;
+
+// Identifies the tenant (e.g., a Volume) on whose behalf a Cache slot was filled.
+//
+using CacheOwnerId = u64;
+
+// The owner of all slots filled without specifying one.
+//
+constexpr CacheOwnerId kDefaultCacheOwner = 0;
+
+struct CacheOwnerMetrics {
+  CountMetric<u64> slot_count{0};
+  CountMetric<u64> hit_count{0};
+  CountMetric<u64> miss_count{0};
+};
+
+// Per-owner accounting state for a Cache.  All fields other than `metrics` are protected by the
+// Cache's index mutex.
+//
+struct CacheOwner {
+  explicit CacheOwner(CacheOwnerId id) noexcept : id{id}
+  {
+  }
+
+  const CacheOwnerId id;
+
+  // Slots above this count may be evicted to make room for other owners.
+  //
+  usize min_slots = 0;
+
+  // Once this owner holds this many slots, it can only replace its own.
+  //
+  usize max_slots = ~usize{0};
+
+  // The number of slots currently filled on behalf of this owner.
+  //
+  usize slot_count = 0;
+
+  CacheOwnerMetrics metrics;
+};
+
 template <typename K, typename V>
 class CacheSlot;
 
@@ -63,11 +116,24 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
     CountMetric<u64> insert_count{0};
     CountMetric<u64> erase_count{0};
     CountMetric<u64> full_count{0};
+    CountMetric<u64> retired_slots{0};
   };
 
   using Slot = AttachedCacheSlot<K, V>;
   using PinnedSlot = PinnedCacheSlot<K, V>;
 
+  // The most slots a cache miss will retire (or try to) while the cache is over capacity.
+  //
+  static constexpr usize kMaxSlotsToShrinkPerInsert = 2;
+
+  // The number of slots `shrink_to_capacity` looks at each time it locks the index.
+  //
+  static constexpr usize kShrinkBatchSize = 64;
+
+  // Observes values evicted to make room for a new key; see `set_evict_fn`.
+  //
+  using EvictFn = std::function<void(const K& key, const std::shared_ptr<V>& value)>;
+
   static boost::intrusive_ptr<Cache> make_new(usize n_slots, const std::string& name)
   {
     return boost::intrusive_ptr<Cache>{new Cache{n_slots, name}};
@@ -75,19 +141,16 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
 
  private:
   explicit Cache(usize n_slots, const std::string& name) noexcept
-      : n_slots_{n_slots}
-      , name_{name}
-      , slots_{new batt::CpuCacheLineIsolated<Slot>[n_slots]}
+      : name_{name}
+      , capacity_{n_slots}
   {
     initialize_status_codes();
 
     LLFS_VLOG(1) << "Cache(n_slots=" << n_slots << ")";
-    auto locked = this->free_pool_.lock();
-    for (auto& isolated_slot : as_slice(this->slots_.get(), this->n_slots_)) {
-      isolated_slot->set_cache_ptr(this);
-      locked->push_back(*isolated_slot.get());
+    {
+      auto locked_pool = this->free_pool_.lock();
+      this->allocate_slots(locked_pool, n_slots);
     }
-
     this->metrics_.max_slots.set(n_slots);
 
     const auto metric_name = [this](std::string_view property) {
@@ -106,6 +169,7 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
     ADD_METRIC_(insert_count);
     ADD_METRIC_(erase_count);
     ADD_METRIC_(full_count);
+    ADD_METRIC_(retired_slots);
 
 #undef ADD_METRIC_
   }
@@ -113,6 +177,13 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
  public:
   ~Cache() noexcept
   {
+    for (const auto& entry : this->owners_) {
+      global_metric_registry()
+          .remove(entry.second->metrics.slot_count)
+          .remove(entry.second->metrics.hit_count)
+          .remove(entry.second->metrics.miss_count);
+    }
+
     global_metric_registry()
         .remove(this->metrics_.max_slots)
         .remove(this->metrics_.indexed_slots)
@@ -123,7 +194,8 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
         .remove(this->metrics_.evict_count)
         .remove(this->metrics_.insert_count)
         .remove(this->metrics_.erase_count)
-        .remove(this->metrics_.full_count);
+        .remove(this->metrics_.full_count)
+        .remove(this->metrics_.retired_slots);
 
     LLFS_VLOG(1) << "Cache::~Cache()";
   }
@@ -133,6 +205,125 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
     return this->metrics_;
   }
 
+  // Returns the current target number of slots (see `set_capacity`).
+  //
+  usize capacity() const
+  {
+    return this->capacity_.load();
+  }
+
+  // Returns the number of slots currently available to hold values; this may exceed `capacity()`
+  // for a while after the cache is shrunk.
+  //
+  usize slot_count() const
+  {
+    return this->slot_count_.load();
+  }
+
+  // Changes the number of slots in the cache at runtime.
+  //
+  // Growing takes effect immediately.  Shrinking retires free slots and unpinned slots (in LRU
+  // order) right away, via `shrink_to_capacity`; pinned slots are never disturbed, but are retired
+  // by later calls to `shrink_to_capacity` or `find_or_insert` once they have been unpinned.
+  // Retired slots drop their values (releasing the memory they hold) and are reused if the cache
+  // grows again.
+  //
+  void set_capacity(usize n_slots)
+  {
+    {
+      auto locked_index = this->index_.lock();
+
+      this->capacity_.store(n_slots);
+      this->metrics_.max_slots.set(n_slots);
+
+      auto locked_pool = this->free_pool_.lock();
+
+      // Bring back retired slots first, then allocate new ones.
+      //
+      auto locked_retired = this->retired_.lock();
+      while (this->slot_count_.load() < n_slots && !locked_retired->empty()) {
+        Slot& slot = locked_retired->front();
+        locked_retired->pop_front();
+
+        // Slots retired from the LRU lists are left in the cleared state; make them invalid again
+        // so they can be filled.  Slots retired from the free pool are still invalid, since free
+        // slots are never filled.
+        //
+        if (slot.is_valid()) {
+          BATT_CHECK(slot.evict());
+        }
+        locked_pool->push_back(slot);
+        this->slot_count_.fetch_add(1);
+      }
+      this->metrics_.retired_slots.set(locked_retired->size());
+
+      if (this->slot_count_.load() < n_slots) {
+        this->allocate_slots(locked_pool, n_slots - this->slot_count_.load());
+      }
+    }
+
+    this->shrink_to_capacity();
+  }
+
+  // Retires as many slots as possible (without disturbing pinned slots) until the slot count is
+  // down to `capacity()`.  Returns true iff this succeeded.
+  //
+  // This looks at up to every slot in the cache once, but in batches of `kShrinkBatchSize`,
+  // releasing the index lock in between so that lookups are not held up for the whole scan.
+  //
+  bool shrink_to_capacity()
+  {
+    const usize max_slots = this->slot_count_.load();
+
+    for (usize n_visited = 0;; n_visited += kShrinkBatchSize) {
+      auto locked_index = this->index_.lock();
+
+      if (this->shrink_locked(locked_index, kShrinkBatchSize) || n_visited >= max_slots) {
+        return this->slot_count_.load() <= this->capacity_.load();
+      }
+    }
+  }
+
+  // Reserves `min_slots` slots for `owner` and limits it to at most `max_slots`.
+  //
+  // Slots filled on behalf of an owner that holds no more than its reservation are only evicted to
+  // make room for that same owner; an owner that holds `max_slots` or more can only replace its own
+  // slots.  It is up to the caller to keep the sum of all reservations below the capacity of the
+  // cache; otherwise some inserts will fail with StatusCode::kCacheSlotsFull.
+  //
+  void set_owner_quota(CacheOwnerId owner_id, usize min_slots, usize max_slots)
+  {
+    BATT_CHECK_LE(min_slots, max_slots);
+
+    auto locked_index = this->index_.lock();
+
+    CacheOwner& owner = this->get_owner_locked(locked_index, owner_id);
+    owner.min_slots = min_slots;
+    owner.max_slots = max_slots;
+
+    this->quotas_enabled_ = true;
+  }
+
+  // Returns the slot count and hit/miss metrics for the given owner.
+  //
+  const CacheOwnerMetrics& owner_metrics(CacheOwnerId owner_id)
+  {
+    auto locked_index = this->index_.lock();
+
+    return this->get_owner_locked(locked_index, owner_id).metrics;
+  }
+
+  // Sets a function to be called with the key and value of each slot that `find_or_insert` evicts
+  // to make room for a new key (e.g., to move the value to a second-level cache).  It is called on
+  // the thread that called `find_or_insert`, with the index lock held, so that it is ordered with
+  // respect to `erase`; it must therefore be quick, and MUST NOT invoke any methods of this Cache
+  // object.  Must be set before the cache is used by more than one thread.
+  //
+  void set_evict_fn(EvictFn&& evict_fn)
+  {
+    this->evict_fn_ = std::move(evict_fn);
+  }
+
   // Attempt to locate `key` in the cache.  If not found, attempt to allocate a slot (either from
   // the free pool or by evicting an unpinned slot in LRU order) and fill it with the value returned
   // by `factory`.  If the key is not found and a slot could not be allocated/evicted, return an
@@ -143,18 +334,34 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
   //
   batt::StatusOr<PinnedSlot> find_or_insert(const K& key,
                                             std::function<std::shared_ptr<V>()>&& factory)
+  {
+    return this->find_or_insert(key, kDefaultCacheOwner, std::move(factory));
+  }
+
+  // Same as above, but counts the lookup against `owner_id` and, if a new slot is filled, charges
+  // it to that owner's quota (see `set_owner_quota`).
+  //
+  batt::StatusOr<PinnedSlot> find_or_insert(const K& key, CacheOwnerId owner_id,
+                                            std::function<std::shared_ptr<V>()>&& factory)
   {
     this->metrics_.query_count.fetch_add(1);
 
+    // Declared before `locked_index` so that an evicted value is released after the lock.
+    //
+    std::shared_ptr<V> evicted_value;
+
     auto locked_index = this->index_.lock();
 
+    CacheOwner& owner = this->get_owner_locked(locked_index, owner_id);
+
     auto iter = locked_index->find(key);
     if (iter != locked_index->end()) {
-      Slot* slot = this->slots_[iter->second].get();
+      Slot* slot = iter->second;
 
       PinnedSlot pinned = slot->acquire_pin(key);
       if (pinned) {
         this->metrics_.hit_count.fetch_add(1);
+        owner.metrics.hit_count.fetch_add(1);
         return pinned;
       }
       this->metrics_.stale_count.fetch_add(1);
@@ -166,21 +373,50 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
       this->metrics_.indexed_slots.set(locked_index->size());
     }
 
-    // Not found in the index.  Try grabbing a slot from the free pool.
+    owner.metrics.miss_count.fetch_add(1);
+
+    // Not found in the index.  If the cache was shrunk and still has too many slots, retire a few
+    // now so that inserts don't keep taking slots that should go away.  This is bounded so that a
+    // miss never pays for the whole shrink; `shrink_to_capacity` does the rest.
     //
-    {
+    if (this->slot_count_.load() > this->capacity_.load()) {
+      this->shrink_locked(locked_index, kMaxSlotsToShrinkPerInsert);
+    }
+
+    // An owner at its maximum share can only replace one of its own slots.
+    //
+    const bool owner_at_max = this->quotas_enabled_ && owner.slot_count >= owner.max_slots;
+
+    // Try grabbing a slot from the free pool.
+    //
+    if (!owner_at_max) {
       auto locked_pool = this->free_pool_.lock();
       if (!locked_pool->empty()) {
         this->metrics_.alloc_count.fetch_add(1);
         Slot& free_slot = locked_pool->front();
         locked_pool->pop_front();
-        return this->fill_slot_and_insert(locked_index, free_slot, key, std::move(factory));
+        return this->fill_slot_and_insert(locked_index, free_slot, key, owner, std::move(factory));
       }
     }
 
-    // No free slots; we must try to evict the least recently used one.
+    // No free slots; we must try to evict the least recently used one (that we are allowed to).
     //
-    Slot* lru_slot = this->evict_lru();
+    Slot* lru_slot = nullptr;
+    if (!this->quotas_enabled_) {
+      lru_slot = this->evict_lru([](const Slot&) {
+        return true;
+      });
+    } else if (owner_at_max) {
+      lru_slot = this->evict_lru([&owner](const Slot& slot) {
+        return slot.get_owner() == &owner;
+      });
+    } else {
+      lru_slot = this->evict_lru([&owner](const Slot& slot) {
+        const CacheOwner* slot_owner = slot.get_owner();
+        return slot_owner == nullptr || slot_owner == &owner ||
+               slot_owner->slot_count > slot_owner->min_slots;
+      });
+    }
     if (!lru_slot) {
       this->metrics_.full_count.fetch_add(1);
 
@@ -196,7 +432,14 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
     //
     locked_index->erase(lru_slot->key());
 
-    return this->fill_slot_and_insert(locked_index, *lru_slot, key, std::move(factory));
+    if (this->evict_fn_) {
+      if (const K* key = lru_slot->key_or_null()) {
+        evicted_value = lru_slot->release_value();
+        this->evict_fn_(*key, evicted_value);
+      }
+    }
+
+    return this->fill_slot_and_insert(locked_index, *lru_slot, key, owner, std::move(factory));
   }
 
   // Forcibly remove the given key from the cache, if present.  Returns true if the key was found,
@@ -215,9 +458,11 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
 
     // Make a best-effort attempt to clear out the slot; it's ok if this fails, since erasing the
     // key from the index will prevent any new pins from being added, and eventually the slot's pin
-    // count will drain to 0, allowing it to be evicted organically.
+    // count will drain to 0, allowing it to be evicted organically.  Holders of long-lived pins can
+    // tell that the slot was erased by `is_erased()` (which is reset if the slot is cleared).
     //
-    Slot* slot = this->slots_[iter->second].get();
+    Slot* slot = iter->second;
+    slot->set_erased();
     this->evict_and_clear_slot(slot);
 
     locked_index->erase(iter);
@@ -229,27 +474,173 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
  private:
   using LRUList = boost::intrusive::list<Slot, boost::intrusive::base_hook<CacheLRUHook>>;
 
-  // Iterate through slots in LRU order, trying to evict one.  The worst case number of times
-  // through this loop is the number of threads actively pinning a slot right now.
+  // One LRU list per CachePriority; see `lru_`.
+  //
+  using LRULists = std::array<LRUList, kNumCachePriorities>;
+
+  // Removes `slot` from whichever of `lists` it is in, if any.
   //
-  Slot* evict_lru()
+  static void unlink_lru(LRULists& lists, Slot& slot)
+  {
+    if (slot.CacheLRUHook::is_linked()) {
+      LRUList& list = lists[slot.get_lru_class()];
+      list.erase(list.iterator_to(slot));
+    }
+  }
+
+  // Allocates `n_slots` new slots and adds them to the free pool.  Slots are never freed (or moved)
+  // until the Cache is destroyed, since refs to them may outlive their use.
+  //
+  void allocate_slots(typename batt::Mutex<LRUList>::Lock& locked_pool, usize n_slots)
+  {
+    if (n_slots == 0) {
+      return;
+    }
+
+    auto& chunk = this->slot_chunks_.emplace_back(new batt::CpuCacheLineIsolated<Slot>[n_slots]);
+    for (auto& isolated_slot : as_slice(chunk.get(), n_slots)) {
+      isolated_slot->set_cache_ptr(this);
+      locked_pool->push_back(*isolated_slot.get());
+    }
+    this->slot_count_.fetch_add(n_slots);
+  }
+
+  // If there are more slots than the current capacity, atomically removes one from the count and
+  // returns true; the caller must then retire a slot (or add the count back).
+  //
+  bool claim_excess_slot()
+  {
+    usize observed_count = this->slot_count_.load();
+    while (observed_count > this->capacity_.load()) {
+      if (this->slot_count_.compare_exchange_weak(observed_count, observed_count - 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Retires free slots, then unpinned slots in LRU order, while there are more slots than the
+  // current capacity, looking at no more than `max_slots` slots.  Returns true iff the slot count
+  // is no longer over capacity.
+  //
+  bool shrink_locked(typename batt::Mutex<std::unordered_map<K, Slot*>>::Lock& locked_index,
+                     usize max_slots)
+  {
+    usize n_visited = 0;
+    {
+      auto locked_pool = this->free_pool_.lock();
+      while (n_visited < max_slots && !locked_pool->empty() && this->claim_excess_slot()) {
+        Slot& slot = locked_pool->front();
+        locked_pool->pop_front();
+        this->retire_slot(slot);
+        n_visited += 1;
+      }
+    }
+
+    auto locked_lru = this->lru_.lock();
+    for (LRUList& lru_list : *locked_lru) {
+      for (auto iter = lru_list.begin(); iter != lru_list.end();) {
+        Slot& slot = *iter;
+        ++iter;
+
+        if (n_visited >= max_slots || !this->claim_excess_slot()) {
+          break;
+        }
+        n_visited += 1;
+
+        if (!slot.evict()) {
+          this->slot_count_.fetch_add(1);
+          continue;
+        }
+        lru_list.erase(lru_list.iterator_to(slot));
+        this->release_owner(slot);
+
+        // Only drop the index entry if it still refers to this slot (it may be stale).
+        //
+        if (const K* key = slot.key_or_null()) {
+          auto index_iter = locked_index->find(*key);
+          if (index_iter != locked_index->end() && index_iter->second == &slot) {
+            locked_index->erase(index_iter);
+          }
+        }
+        slot.clear();
+        this->retire_slot(slot);
+      }
+    }
+    this->metrics_.indexed_slots.set(locked_index->size());
+
+    return this->slot_count_.load() <= this->capacity_.load();
+  }
+
+  // Moves a slot that is in no other list out of circulation.
+  //
+  void retire_slot(Slot& slot)
+  {
+    BATT_CHECK(!slot.CacheLRUHook::is_linked());
+
+    auto locked_retired = this->retired_.lock();
+    locked_retired->push_back(slot);
+    this->metrics_.retired_slots.set(locked_retired->size());
+  }
+
+  // Iterate through slots in priority, then LRU order, trying to evict one for which `pred` returns
+  // true.  Unless `pred` rules out some slots, the worst case number of times through this loop is
+  // the number of threads actively pinning a slot right now.  Must be called with the index mutex
+  // held.
+  //
+  template <typename PredFn>
+  Slot* evict_lru(PredFn&& pred)
   {
     auto locked_lru = this->lru_.lock();
 
-    for (Slot& lru_slot : *locked_lru) {
-      if (lru_slot.evict()) {
-        if (lru_slot.CacheLRUHook::is_linked()) {
-          locked_lru->erase(locked_lru->iterator_to(lru_slot));
-          BATT_CHECK(!lru_slot.CacheLRUHook::is_linked());
+    for (LRUList& lru_list : *locked_lru) {
+      for (Slot& lru_slot : lru_list) {
+        if (pred(lru_slot) && lru_slot.evict()) {
+          if (lru_slot.CacheLRUHook::is_linked()) {
+            lru_list.erase(lru_list.iterator_to(lru_slot));
+            BATT_CHECK(!lru_slot.CacheLRUHook::is_linked());
+          }
+          this->release_owner(lru_slot);
+          return &lru_slot;
         }
-        return &lru_slot;
       }
     }
     return nullptr;
   }
 
+  // Returns the accounting state for `owner_id`, creating it if necessary.
+  //
+  CacheOwner& get_owner_locked(typename batt::Mutex<std::unordered_map<K, Slot*>>::Lock&,
+                               CacheOwnerId owner_id)
+  {
+    std::unique_ptr<CacheOwner>& owner = this->owners_[owner_id];
+    if (!owner) {
+      owner = std::make_unique<CacheOwner>(owner_id);
+
+      const auto metric_name = [this, owner_id](std::string_view property) {
+        return batt::to_string("Cache_", this->name_, "_owner_", owner_id, "_", property);
+      };
+      global_metric_registry().add(metric_name("slot_count"), owner->metrics.slot_count);
+      global_metric_registry().add(metric_name("hit_count"), owner->metrics.hit_count);
+      global_metric_registry().add(metric_name("miss_count"), owner->metrics.miss_count);
+    }
+    return *owner;
+  }
+
+  // Removes an evicted slot from its owner's slot count.  Must be called with the index mutex held.
+  //
+  void release_owner(Slot& slot)
+  {
+    CacheOwner* const owner = slot.get_owner();
+    if (owner) {
+      owner->slot_count -= 1;
+      owner->metrics.slot_count.set(owner->slot_count);
+      slot.set_owner(nullptr);
+    }
+  }
+
   // Attempt to evict a specific slot; if this succeeds, clear the slot and move it to the LRU-end
-  // of the LRU list (to allow it to be filled next).
+  // of the lowest priority LRU list (to allow it to be filled next).
   //
   bool evict_and_clear_slot(Slot* slot)
   {
@@ -260,18 +651,18 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
     }
     this->metrics_.evict_count.fetch_add(1);
 
-    if (slot->CacheLRUHook::is_linked()) {
-      locked_lru->erase(locked_lru->iterator_to(*slot));
-    }
-    locked_lru->push_front(*slot);
+    unlink_lru(*locked_lru, *slot);
+    slot->set_lru_class(0);
+    (*locked_lru)[0].push_front(*slot);
     slot->clear();
+    this->release_owner(*slot);
 
     return true;
   }
 
   PinnedSlot fill_slot_and_insert(
-      typename batt::Mutex<std::unordered_map<K, usize>>::Lock& locked_index, Slot& dst_slot,
-      const K& key, std::function<std::shared_ptr<V>()>&& factory)
+      typename batt::Mutex<std::unordered_map<K, Slot*>>::Lock& locked_index, Slot& dst_slot,
+      const K& key, CacheOwner& owner, std::function<std::shared_ptr<V>()>&& factory)
   {
     BATT_CHECK(!dst_slot.is_valid());
 
@@ -280,9 +671,12 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
 
     BATT_CHECK(pinned);
 
-    locked_index->emplace(key,
-                          std::distance(this->slots_.get(),
-                                        batt::CpuCacheLineIsolated<Slot>::pointer_from(&dst_slot)));
+    BATT_CHECK_EQ(dst_slot.get_owner(), nullptr);
+    dst_slot.set_owner(&owner);
+    owner.slot_count += 1;
+    owner.metrics.slot_count.set(owner.slot_count);
+
+    locked_index->emplace(key, &dst_slot);
 
     this->metrics_.insert_count.fetch_add(1);
     this->metrics_.indexed_slots.set(locked_index->size());
@@ -298,8 +692,8 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
   void notify_pinned(Slot* slot, u64 expected_state)
   {
     auto locked_lru = this->lru_.lock();
-    if (slot->get_state() == expected_state && slot->CacheLRUHook::is_linked()) {
-      locked_lru->erase(locked_lru->iterator_to(*slot));
+    if (slot->get_state() == expected_state) {
+      unlink_lru(*locked_lru, *slot);
     }
   }
 
@@ -307,28 +701,56 @@ class Cache : public boost::intrusive_ref_counter<Cache<K, V>>
   {
     auto locked_lru = this->lru_.lock();
     if (slot->get_state() == expected_state) {
-      if (slot->CacheLRUHook::is_linked()) {
-        locked_lru->erase(locked_lru->iterator_to(*slot));
-      }
+      unlink_lru(*locked_lru, *slot);
+
+      const usize lru_class = static_cast<usize>(slot->get_priority());
+      BATT_CHECK_LT(lru_class, kNumCachePriorities);
+      slot->set_lru_class(lru_class);
+
       // Front is least recently used; back is most recently used.
       //
+      LRUList& lru_list = (*locked_lru)[lru_class];
       if (slot->get_obsolete_hint()) {
-        locked_lru->push_front(*slot);
+        lru_list.push_front(*slot);
       } else {
-        locked_lru->push_back(*slot);
+        lru_list.push_back(*slot);
       }
       BATT_CHECK(slot->CacheLRUHook::is_linked());
     }
   }
   //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 
-  const usize n_slots_;
   const std::string name_;
-  std::unique_ptr<batt::CpuCacheLineIsolated<Slot>[]> slots_;
-  batt::Mutex<std::unordered_map<K, usize>> index_;
+
+  // See `set_evict_fn`.
+  //
+  EvictFn evict_fn_;
+
+  // The target number of slots, and the number of slots not in `retired_`.
+  //
+  std::atomic<usize> capacity_;
+  std::atomic<usize> slot_count_{0};
+
+  // Protected by `free_pool_`.
+  //
+  std::vector<std::unique_ptr<batt::CpuCacheLineIsolated<Slot>[]>> slot_chunks_;
+
+  // Locks must be acquired in the order they are declared here.
+  //
+  batt::Mutex<std::unordered_map<K, Slot*>> index_;
   Metrics metrics_;
+
+  // Protected by `index_`.
+  //
+  std::unordered_map<CacheOwnerId, std::unique_ptr<CacheOwner>> owners_;
+  bool quotas_enabled_ = false;
+
   batt::Mutex<LRUList> free_pool_;
-  batt::Mutex<LRUList> lru_;
+
+  // Unpinned slots, one list per CachePriority (lowest first).
+  //
+  batt::Mutex<LRULists> lru_;
+  batt::Mutex<LRUList> retired_;
 };
 
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
@@ -401,6 +823,14 @@ class CacheSlot
     return *this->key_;
   }
 
+  // Returns a pointer to the current key, or nullptr if the slot has been cleared.  Only safe to
+  // call when the slot can't be concurrently filled (e.g., it is invalid).
+  //
+  const K* key_or_null() const
+  {
+    return this->key_ ? &*this->key_ : nullptr;
+  }
+
   // Returns the current value held in the slot, if valid; if the slot is invalid, behavior is
   // undefined.
   //
@@ -598,6 +1028,8 @@ class CacheSlot
     this->key_.emplace(key);
     this->value_ = std::move(value);
     this->obsolete_hint_ = false;
+    this->priority_ = CachePriority::kNormal;
+    this->erased_ = false;
     this->set_valid();
   }
 
@@ -611,9 +1043,21 @@ class CacheSlot
     this->key_ = None;
     this->value_ = nullptr;
     this->obsolete_hint_ = false;
+    this->priority_ = CachePriority::kNormal;
+    this->erased_ = false;
     this->set_valid();
   }
 
+  // Moves the value out of the slot, leaving it null.  May only be called when the slot is in an
+  // invalid state.
+  //
+  std::shared_ptr<V> release_value()
+  {
+    BATT_CHECK(!this->is_valid());
+
+    return std::move(this->value_);
+  }
+
   // Get the current state word.  This is used to make sure we don't reorder LRU list operations
   // when transitioning from pinned to unpinned (and vice versa).
   //
@@ -636,6 +1080,32 @@ class CacheSlot
     return this->obsolete_hint_.load();
   }
 
+  // Sets the eviction priority class of this slot; takes effect the next time the slot is unpinned.
+  // Reset to CachePriority::kNormal whenever the slot is (re-)filled.
+  //
+  void set_priority(CachePriority priority)
+  {
+    this->priority_.store(priority);
+  }
+
+  CachePriority get_priority() const
+  {
+    return this->priority_.load();
+  }
+
+  // Marks the slot as erased from the cache index (see Cache::erase); reset whenever the slot is
+  // (re-)filled or cleared.
+  //
+  void set_erased()
+  {
+    this->erased_.store(true);
+  }
+
+  bool is_erased() const
+  {
+    return this->erased_.load();
+  }
+
  private:
   // Must be provided by derived classes; invoked when the pin count goes from 0 -> 1.
   //
@@ -666,6 +1136,8 @@ class CacheSlot
   std::atomic<u64> state_{0};
   std::atomic<u64> ref_count_{0};
   std::atomic<bool> obsolete_hint_{false};
+  std::atomic<CachePriority> priority_{CachePriority::kNormal};
+  std::atomic<bool> erased_{false};
 };
 
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
@@ -691,6 +1163,32 @@ class AttachedCacheSlot
     return this->cache_;
   }
 
+  // The owner on whose behalf the slot was last filled, or nullptr if it has since been evicted.
+  // Only accessed with the Cache's index mutex held.
+  //
+  CacheOwner* get_owner() const
+  {
+    return this->owner_;
+  }
+
+  void set_owner(CacheOwner* owner)
+  {
+    this->owner_ = owner;
+  }
+
+  // The index of the Cache LRU list this slot was last linked into.  Only accessed with the Cache's
+  // LRU mutex held.
+  //
+  usize get_lru_class() const
+  {
+    return this->lru_class_;
+  }
+
+  void set_lru_class(usize lru_class)
+  {
+    this->lru_class_ = lru_class;
+  }
+
  private:
   void notify_pinned(u64 expected_state) override
   {
@@ -713,6 +1211,8 @@ class AttachedCacheSlot
   }
 
   Cache<K, V>* cache_ = nullptr;
+  CacheOwner* owner_ = nullptr;
+  usize lru_class_ = 0;
 };
 
 namespace detail {
@@ -210,4 +210,269 @@ TEST(CacheTest, Basic)
   }
 }
 
+TEST(CacheTest, SetCapacity)
+{
+  using TestCache = Cache<int, std::string>;
+
+  auto p_c = TestCache::make_new(4, "TestSetCapacity");
+  auto& c = *p_c;
+
+  const auto insert = [&c](int key) {
+    return c.find_or_insert(key, [key] {
+      return std::make_shared<std::string>(std::to_string(key));
+    });
+  };
+
+  const auto is_cached = [&c](int key) {
+    bool cached = true;
+    auto slot = c.find_or_insert(key, [&cached] {
+      cached = false;
+      return std::make_shared<std::string>("reloaded");
+    });
+    return cached;
+  };
+
+  auto pinned1 = insert(1);
+  ASSERT_TRUE(pinned1.ok());
+  for (int key : {2, 3, 4}) {
+    EXPECT_TRUE(insert(key).ok());
+  }
+  EXPECT_EQ(c.slot_count(), 4u);
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Shrinking retires unpinned slots in LRU order.
+  //
+  c.set_capacity(2);
+
+  EXPECT_EQ(c.capacity(), 2u);
+  EXPECT_EQ(c.slot_count(), 2u);
+  EXPECT_EQ(c.metrics().retired_slots.load(), 2u);
+  EXPECT_TRUE(is_cached(4));
+  EXPECT_FALSE(is_cached(2));
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Pinned slots are not disturbed; they are retired once unpinned.
+  //
+  c.set_capacity(0);
+
+  EXPECT_EQ(c.slot_count(), 1u);
+  EXPECT_THAT(**pinned1, ::testing::StrEq("1"));
+
+  *pinned1 = {};
+
+  EXPECT_TRUE(c.shrink_to_capacity());
+  EXPECT_EQ(c.slot_count(), 0u);
+  EXPECT_FALSE(insert(5).ok());
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Growing reuses retired slots, then allocates new ones.
+  //
+  c.set_capacity(3);
+
+  EXPECT_EQ(c.slot_count(), 3u);
+  EXPECT_EQ(c.metrics().retired_slots.load(), 1u);
+
+  std::vector<TestCache::PinnedSlot> pins;
+  for (int key : {5, 6, 7}) {
+    auto pinned = insert(key);
+    ASSERT_TRUE(pinned.ok());
+    pins.emplace_back(std::move(*pinned));
+  }
+  EXPECT_FALSE(insert(8).ok());
+
+  c.set_capacity(6);
+
+  EXPECT_EQ(c.slot_count(), 6u);
+  EXPECT_EQ(c.metrics().retired_slots.load(), 0u);
+  EXPECT_TRUE(insert(8).ok());
+}
+
+TEST(CacheTest, ShrinkAndGrowUnfilled)
+{
+  using TestCache = Cache<int, std::string>;
+
+  auto p_c = TestCache::make_new(4, "TestShrinkAndGrowUnfilled");
+  auto& c = *p_c;
+
+  const auto insert = [&c](int key) {
+    return c.find_or_insert(key, [key] {
+      return std::make_shared<std::string>(std::to_string(key));
+    });
+  };
+
+  // Fill only one slot, so shrinking retires never-filled slots from the free pool as well as a
+  // (cleared) slot from the LRU list.
+  //
+  EXPECT_TRUE(insert(1).ok());
+
+  c.set_capacity(0);
+
+  EXPECT_EQ(c.slot_count(), 0u);
+  EXPECT_EQ(c.metrics().retired_slots.load(), 4u);
+
+  c.set_capacity(4);
+
+  EXPECT_EQ(c.slot_count(), 4u);
+  EXPECT_EQ(c.metrics().retired_slots.load(), 0u);
+
+  std::vector<TestCache::PinnedSlot> pins;
+  for (int key : {2, 3, 4, 5}) {
+    auto pinned = insert(key);
+    ASSERT_TRUE(pinned.ok());
+    EXPECT_THAT(**pinned, ::testing::StrEq(std::to_string(key)));
+    pins.emplace_back(std::move(*pinned));
+  }
+  EXPECT_FALSE(insert(6).ok());
+}
+
+TEST(CacheTest, ShrinkOnInsertIsBounded)
+{
+  using TestCache = Cache<int, std::string>;
+
+  constexpr llfs::usize kNumSlots = 8;
+
+  auto p_c = TestCache::make_new(kNumSlots, "TestShrinkOnInsertIsBounded");
+  auto& c = *p_c;
+
+  const auto insert = [&c](int key) {
+    return c.find_or_insert(key, [key] {
+      return std::make_shared<std::string>(std::to_string(key));
+    });
+  };
+
+  // Shrink while every slot is pinned, so that none can be retired yet.
+  //
+  {
+    std::vector<TestCache::PinnedSlot> pins;
+    for (llfs::usize i = 0; i < kNumSlots; ++i) {
+      auto pinned = insert(static_cast<int>(i));
+      ASSERT_TRUE(pinned.ok());
+      pins.emplace_back(std::move(*pinned));
+    }
+
+    c.set_capacity(0);
+
+    EXPECT_EQ(c.slot_count(), kNumSlots);
+  }
+
+  // A miss only retires a few of the now-unpinned slots.
+  //
+  EXPECT_TRUE(insert(static_cast<int>(kNumSlots)).ok());
+  EXPECT_EQ(c.slot_count(), kNumSlots - TestCache::kMaxSlotsToShrinkPerInsert);
+
+  // The rest are retired by `shrink_to_capacity`.
+  //
+  EXPECT_TRUE(c.shrink_to_capacity());
+  EXPECT_EQ(c.slot_count(), 0u);
+  EXPECT_EQ(c.metrics().retired_slots.load(), kNumSlots);
+}
+
+TEST(CacheTest, Priorities)
+{
+  using TestCache = Cache<int, std::string>;
+
+  auto p_c = TestCache::make_new(3, "TestPriorities");
+  auto& c = *p_c;
+
+  const auto insert = [&c](int key, llfs::CachePriority priority) {
+    auto slot = c.find_or_insert(key, [key] {
+      return std::make_shared<std::string>(std::to_string(key));
+    });
+    BATT_CHECK_OK(slot);
+    slot->slot()->set_priority(priority);
+  };
+
+  const auto is_cached = [&c](int key) {
+    bool cached = true;
+    auto slot = c.find_or_insert(key, [&cached] {
+      cached = false;
+      return std::make_shared<std::string>("reloaded");
+    });
+    return cached;
+  };
+
+  insert(1, llfs::CachePriority::kHigh);
+  insert(2, llfs::CachePriority::kNormal);
+  insert(3, llfs::CachePriority::kLow);
+
+  // Lower classes go first, even though 1 is the least recently used.
+  //
+  insert(4, llfs::CachePriority::kNormal);
+  EXPECT_FALSE(is_cached(3));
+
+  // Within a class, eviction is LRU.  (The `is_cached` miss above replaced 2.)
+  //
+  insert(5, llfs::CachePriority::kNormal);
+  EXPECT_TRUE(is_cached(1));
+  EXPECT_TRUE(is_cached(5));
+  EXPECT_FALSE(is_cached(2));
+}
+
+TEST(CacheTest, OwnerQuotas)
+{
+  using TestCache = Cache<int, std::string>;
+
+  constexpr llfs::CacheOwnerId kOwnerA = 1;
+  constexpr llfs::CacheOwnerId kOwnerB = 2;
+  constexpr llfs::CacheOwnerId kOwnerC = 3;
+
+  auto p_c = TestCache::make_new(4, "TestOwnerQuotas");
+  auto& c = *p_c;
+
+  c.set_owner_quota(kOwnerA, /*min_slots=*/2, /*max_slots=*/4);
+  c.set_owner_quota(kOwnerB, /*min_slots=*/0, /*max_slots=*/2);
+
+  // Returns true iff `key` was already cached.
+  //
+  const auto lookup = [&c](llfs::CacheOwnerId owner, int key) {
+    bool cached = true;
+    auto slot = c.find_or_insert(key, owner, [key, &cached] {
+      cached = false;
+      return std::make_shared<std::string>(std::to_string(key));
+    });
+    BATT_CHECK_OK(slot);
+    return cached;
+  };
+
+  EXPECT_FALSE(lookup(kOwnerA, 1));
+  EXPECT_FALSE(lookup(kOwnerA, 2));
+  EXPECT_FALSE(lookup(kOwnerB, 10));
+  EXPECT_FALSE(lookup(kOwnerB, 11));
+
+  EXPECT_EQ(c.owner_metrics(kOwnerA).slot_count.load(), 2u);
+  EXPECT_EQ(c.owner_metrics(kOwnerB).slot_count.load(), 2u);
+
+  // B is at its max share, so it can only replace its own (least recently used) slots, even though
+  // A's are older.
+  //
+  EXPECT_FALSE(lookup(kOwnerB, 12));
+  EXPECT_EQ(c.owner_metrics(kOwnerB).slot_count.load(), 2u);
+  EXPECT_EQ(c.owner_metrics(kOwnerB).miss_count.load(), 3u);
+
+  // C has no quota, but can't take A's reserved slots either.
+  //
+  EXPECT_FALSE(lookup(kOwnerC, 20));
+  EXPECT_FALSE(lookup(kOwnerC, 21));
+  EXPECT_EQ(c.owner_metrics(kOwnerB).slot_count.load(), 0u);
+  EXPECT_EQ(c.owner_metrics(kOwnerC).slot_count.load(), 2u);
+
+  EXPECT_TRUE(lookup(kOwnerA, 1));
+  EXPECT_TRUE(lookup(kOwnerA, 2));
+  EXPECT_EQ(c.owner_metrics(kOwnerA).hit_count.load(), 2u);
+  EXPECT_EQ(c.owner_metrics(kOwnerA).miss_count.load(), 2u);
+
+  // With everyone at or below their reservation (or out of slots), new inserts for an owner with
+  // nothing cached fail.
+  //
+  c.set_owner_quota(kOwnerC, /*min_slots=*/2, /*max_slots=*/2);
+
+  bool factory_called = false;
+  auto no_slot = c.find_or_insert(30, kOwnerB, [&factory_called] {
+    factory_called = true;
+    return std::make_shared<std::string>("30");
+  });
+  EXPECT_EQ(no_slot.status(), llfs::make_status(llfs::StatusCode::kCacheSlotsFull));
+  EXPECT_FALSE(factory_called);
+}
+
 }  // namespace
@@ -0,0 +1,177 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/compressed_page_cache.hpp>
+//
+
+#include <llfs/logging.hpp>
+
+#include <batteries/assert.hpp>
+
+#include <zlib.h>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ CompressedPageCache::CompressedPageCache(u64 max_bytes) noexcept
+    : max_bytes_{max_bytes}
+{
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::shared_ptr<PageBuffer> CompressedPageCache::find(PageId page_id)
+{
+  EntryList found;
+  {
+    std::unique_lock<std::mutex> lock{this->mutex_};
+
+    auto iter = this->index_.find(page_id.int_value());
+    if (iter == this->index_.end()) {
+      this->metrics_.miss_count.add(1);
+      return nullptr;
+    }
+    this->remove_locked(iter->second, found);
+  }
+
+  // Decompress without holding the lock.
+  //
+  const Entry& entry = found.front();
+  std::shared_ptr<PageBuffer> buffer = PageBuffer::allocate(entry.page_size, page_id);
+  MutableBuffer dst = buffer->mutable_buffer();
+
+  uLongf dst_size = dst.size();
+  const int result = uncompress(static_cast<Bytef*>(dst.data()), &dst_size,
+                                reinterpret_cast<const Bytef*>(entry.compressed_data.data()),
+                                static_cast<uLong>(entry.compressed_data.size()));
+
+  if (result != Z_OK || dst_size != dst.size() || buffer->page_id() != page_id) {
+    LLFS_LOG_WARNING() << "CompressedPageCache: corrupt entry; " << BATT_INSPECT(page_id)
+                       << BATT_INSPECT(result) << BATT_INSPECT(dst_size);
+    this->metrics_.miss_count.add(1);
+    return nullptr;
+  }
+
+  this->metrics_.hit_count.add(1);
+  return buffer;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void CompressedPageCache::insert(const PageBuffer& page, u64 purge_generation)
+{
+  const PageId page_id = page.page_id();
+  const ConstBuffer src = page.const_buffer();
+
+  {
+    std::unique_lock<std::mutex> lock{this->mutex_};
+    if (this->index_.count(page_id.int_value())) {
+      return;
+    }
+  }
+
+  // Compress without holding the lock.
+  //
+  uLongf dst_size = compressBound(static_cast<uLong>(src.size()));
+  std::string compressed(dst_size, '\0');
+
+  const int result = compress2(reinterpret_cast<Bytef*>(compressed.data()), &dst_size,
+                               static_cast<const Bytef*>(src.data()),
+                               static_cast<uLong>(src.size()), Z_BEST_SPEED);
+
+  if (result != Z_OK || dst_size >= src.size() || dst_size > this->max_bytes_) {
+    this->metrics_.reject_count.add(1);
+    return;
+  }
+  compressed.resize(dst_size);
+  compressed.shrink_to_fit();
+
+  EntryList evicted;
+  {
+    std::unique_lock<std::mutex> lock{this->mutex_};
+
+    // The page may have been purged, or inserted by another thread, meanwhile.
+    //
+    auto purged = this->purged_.find(page_id.int_value());
+    if (purged != this->purged_.end() && purged->second > purge_generation) {
+      this->metrics_.stale_count.add(1);
+      return;
+    }
+    if (this->index_.count(page_id.int_value())) {
+      return;
+    }
+
+    this->byte_count_ += compressed.size();
+    this->lru_.push_back(Entry{
+        .page_id = page_id,
+        .page_size = page.size(),
+        .compressed_data = std::move(compressed),
+    });
+    this->index_.emplace(page_id.int_value(), std::prev(this->lru_.end()));
+
+    while (this->byte_count_ > this->max_bytes_) {
+      BATT_CHECK(!this->lru_.empty());
+      this->remove_locked(this->lru_.begin(), evicted);
+      this->metrics_.evict_count.add(1);
+    }
+
+    this->metrics_.insert_count.add(1);
+    this->metrics_.page_count.set(this->index_.size());
+    this->metrics_.byte_count.set(this->byte_count_);
+  }
+  // `evicted` is freed here, outside the lock.
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void CompressedPageCache::erase(PageId page_id)
+{
+  EntryList erased;
+  {
+    std::unique_lock<std::mutex> lock{this->mutex_};
+
+    this->purged_[page_id.int_value()] = this->purge_generation_.fetch_add(1) + 1;
+
+    auto iter = this->index_.find(page_id.int_value());
+    if (iter != this->index_.end()) {
+      this->remove_locked(iter->second, erased);
+    }
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void CompressedPageCache::forget_purged(u64 purge_generation)
+{
+  std::unique_lock<std::mutex> lock{this->mutex_};
+
+  for (auto iter = this->purged_.begin(); iter != this->purged_.end();) {
+    if (iter->second <= purge_generation) {
+      iter = this->purged_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void CompressedPageCache::remove_locked(EntryList::iterator iter, EntryList& dst)
+{
+  BATT_CHECK_GE(this->byte_count_, iter->compressed_data.size());
+
+  this->byte_count_ -= iter->compressed_data.size();
+  this->index_.erase(iter->page_id.int_value());
+  dst.splice(dst.end(), this->lru_, iter);
+
+  this->metrics_.page_count.set(this->index_.size());
+  this->metrics_.byte_count.set(this->byte_count_);
+}
+
+}  // namespace llfs
@@ -0,0 +1,160 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_COMPRESSED_PAGE_CACHE_HPP
+#define LLFS_COMPRESSED_PAGE_CACHE_HPP
+
+#include <llfs/int_types.hpp>
+#include <llfs/metrics.hpp>
+#include <llfs/page_buffer.hpp>
+#include <llfs/page_id.hpp>
+#include <llfs/page_size.hpp>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace llfs {
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief An in-memory victim cache of compressed page data, with a fixed byte budget.
+ *
+ * PageCache uses this as a second level below its own cache of decoded pages: pages evicted from
+ * the first level are compressed and inserted here, and on a miss the PageCache looks here before
+ * reading the page from the device.  Since most pages compress several times over, this holds more
+ * of the working set per byte than caching more decoded pages would.
+ *
+ * The cache is exclusive: a hit removes the page (it goes back into the first level, and is
+ * re-inserted the next time it is evicted from there).  When the compressed data exceeds the
+ * budget, the pages that were inserted longest ago are dropped first.  Pages that don't compress
+ * are not inserted.
+ *
+ * Because a PageId names an immutable page (including its generation), an entry never needs to be
+ * invalidated; `erase` is only used to free memory early (e.g., when a page is purged).  Since
+ * compression happens some time after a page is evicted, each `erase` also advances the purge
+ * generation and remembers the erased page; an insert of that page that was started in an earlier
+ * generation is dropped, so that a purged page is not brought back by an insert that was already
+ * in flight.  Inserts of other pages are not affected.  The remembered pages are dropped by
+ * `forget_purged` once the caller knows no such inserts are left.
+ */
+class CompressedPageCache
+{
+ public:
+  struct Metrics {
+    CountMetric<u64> hit_count{0};
+    CountMetric<u64> miss_count{0};
+    CountMetric<u64> insert_count{0};
+    CountMetric<u64> reject_count{0};
+    CountMetric<u64> stale_count{0};
+    CountMetric<u64> evict_count{0};
+    CountMetric<u64> page_count{0};
+    CountMetric<u64> byte_count{0};
+  };
+
+  /** \brief Creates an empty cache that holds at most `max_bytes` of compressed page data.
+   */
+  explicit CompressedPageCache(u64 max_bytes) noexcept;
+
+  CompressedPageCache(const CompressedPageCache&) = delete;
+  CompressedPageCache& operator=(const CompressedPageCache&) = delete;
+
+  u64 max_bytes() const
+  {
+    return this->max_bytes_;
+  }
+
+  const Metrics& metrics() const
+  {
+    return this->metrics_;
+  }
+
+  /** \brief Removes the data for `page_id` from the cache and returns it, decompressed into a new
+   * PageBuffer; returns nullptr if it is not in the cache.
+   */
+  std::shared_ptr<PageBuffer> find(PageId page_id);
+
+  /** \brief Returns the number of calls to `erase` so far.
+   */
+  u64 purge_generation() const
+  {
+    return this->purge_generation_.load();
+  }
+
+  /** \brief Compresses and inserts the data of `page`, dropping older pages as necessary to stay
+   * within the byte budget.  Does nothing if the page is already present or does not compress, or
+   * if `erase` has been called for this page since `purge_generation` was read.
+   */
+  void insert(const PageBuffer& page, u64 purge_generation);
+
+  /** \brief Same as above, in the current purge generation.
+   */
+  void insert(const PageBuffer& page)
+  {
+    this->insert(page, this->purge_generation());
+  }
+
+  /** \brief Drops the data for `page_id`, if present, and advances the purge generation.
+   */
+  void erase(PageId page_id);
+
+  /** \brief Forgets the pages erased up to and including `purge_generation`.  Call this only when
+   * no insert that read an earlier purge generation is still in flight.
+   */
+  void forget_purged(u64 purge_generation);
+
+ private:
+  struct Entry {
+    PageId page_id;
+    PageSize page_size;
+    std::string compressed_data;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  // Unlinks `iter` from `lru_` and `index_`, moving it to the end of `dst`.  The caller must hold
+  // `mutex_`.
+  //
+  void remove_locked(EntryList::iterator iter, EntryList& dst);
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  const u64 max_bytes_;
+
+  Metrics metrics_;
+
+  std::mutex mutex_;
+
+  // Entries in insertion order (front is oldest); protected by `mutex_`.
+  //
+  EntryList lru_;
+
+  // Index of `lru_` by page id; protected by `mutex_`.
+  //
+  std::unordered_map<page_id_int, EntryList::iterator> index_;
+
+  // The total size of `Entry::compressed_data` in `lru_`; protected by `mutex_`.
+  //
+  u64 byte_count_ = 0;
+
+  // Incremented by `erase`; only modified while holding `mutex_`.
+  //
+  std::atomic<u64> purge_generation_{0};
+
+  // The pages passed to `erase` (and not yet forgotten), each with the purge generation its
+  // `erase` advanced to; protected by `mutex_`.
+  //
+  std::unordered_map<page_id_int, u64> purged_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_COMPRESSED_PAGE_CACHE_HPP
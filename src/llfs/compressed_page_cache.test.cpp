@@ -0,0 +1,338 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/compressed_page_cache.hpp>
+//
+#include <llfs/compressed_page_cache.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/logging.hpp>
+
+#include <batteries/env.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+using namespace llfs::int_types;
+
+const llfs::PageSize kPageSize{4096};
+
+// Returns a page whose payload is a random sequence of words, which compresses about as well as
+// typical (e.g., key/value) page data.
+//
+std::shared_ptr<llfs::PageBuffer> make_text_page(llfs::PageId page_id)
+{
+  static const std::array<std::string_view, 32> kWords = {
+      "alpha ",  "bravo ",   "charlie ", "delta ",   "echo ",    "foxtrot ", "golf ",     "hotel ",
+      "india ",  "juliet ",  "kilo ",    "lima ",    "mike ",    "november ", "oscar ",   "papa ",
+      "quebec ", "romeo ",   "sierra ",  "tango ",   "uniform ", "victor ",  "whiskey ",  "xray ",
+      "yankee ", "zulu ",    "key=",     "value=",   "0x00 ",    "0xff ",    "\n",        "; ",
+  };
+
+  std::shared_ptr<llfs::PageBuffer> page = llfs::PageBuffer::allocate(kPageSize, page_id);
+  llfs::MutableBuffer payload = page->mutable_payload();
+
+  std::default_random_engine rng{page_id.int_value()};
+  std::uniform_int_distribution<usize> pick_word(0, kWords.size() - 1);
+
+  char* next = static_cast<char*>(payload.data());
+  char* const last = next + payload.size();
+  while (next != last) {
+    const std::string_view word = kWords[pick_word(rng)];
+    const usize n = std::min<usize>(word.size(), last - next);
+    std::memcpy(next, word.data(), n);
+    next += n;
+  }
+
+  return page;
+}
+
+std::shared_ptr<llfs::PageBuffer> make_random_page(llfs::PageId page_id)
+{
+  std::shared_ptr<llfs::PageBuffer> page = llfs::PageBuffer::allocate(kPageSize, page_id);
+  llfs::MutableBuffer payload = page->mutable_payload();
+
+  std::default_random_engine rng{page_id.int_value()};
+  u8* const bytes = static_cast<u8*>(payload.data());
+  for (usize i = 0; i < payload.size(); ++i) {
+    bytes[i] = static_cast<u8>(rng());
+  }
+
+  return page;
+}
+
+bool same_data(const llfs::PageBuffer& a, const llfs::PageBuffer& b)
+{
+  return a.size() == b.size() &&
+         std::memcmp(a.const_buffer().data(), b.const_buffer().data(), a.size()) == 0;
+}
+
+TEST(CompressedPageCacheTest, InsertFindErase)
+{
+  llfs::CompressedPageCache cache{/*max_bytes=*/64 * 1024};
+
+  const std::shared_ptr<llfs::PageBuffer> page = make_text_page(llfs::PageId{1});
+  cache.insert(*page);
+
+  EXPECT_EQ(cache.metrics().insert_count.load(), 1u);
+  EXPECT_EQ(cache.metrics().page_count.load(), 1u);
+  EXPECT_LT(cache.metrics().byte_count.load(), kPageSize / 2);
+
+  // A hit returns a copy of the data and removes the page from the cache.
+  //
+  std::shared_ptr<llfs::PageBuffer> found = cache.find(llfs::PageId{1});
+  ASSERT_NE(found, nullptr);
+  EXPECT_NE(found.get(), page.get());
+  EXPECT_EQ(found->page_id(), llfs::PageId{1});
+  EXPECT_TRUE(same_data(*found, *page));
+
+  EXPECT_EQ(cache.find(llfs::PageId{1}), nullptr);
+  EXPECT_EQ(cache.metrics().hit_count.load(), 1u);
+  EXPECT_EQ(cache.metrics().miss_count.load(), 1u);
+  EXPECT_EQ(cache.metrics().page_count.load(), 0u);
+  EXPECT_EQ(cache.metrics().byte_count.load(), 0u);
+
+  // Erase.
+  //
+  cache.insert(*make_text_page(llfs::PageId{2}));
+  EXPECT_EQ(cache.metrics().page_count.load(), 1u);
+
+  cache.erase(llfs::PageId{2});
+  EXPECT_EQ(cache.metrics().page_count.load(), 0u);
+  EXPECT_EQ(cache.find(llfs::PageId{2}), nullptr);
+
+  // Pages that don't compress are not inserted.
+  //
+  cache.insert(*make_random_page(llfs::PageId{3}));
+  EXPECT_EQ(cache.metrics().reject_count.load(), 1u);
+  EXPECT_EQ(cache.metrics().page_count.load(), 0u);
+  EXPECT_EQ(cache.find(llfs::PageId{3}), nullptr);
+}
+
+// An insert started before a page was purged must not bring the page back.
+//
+TEST(CompressedPageCacheTest, InsertAfterPurgeIsDropped)
+{
+  llfs::CompressedPageCache cache{/*max_bytes=*/64 * 1024};
+
+  const std::shared_ptr<llfs::PageBuffer> page = make_text_page(llfs::PageId{1});
+  const u64 evicted_generation = cache.purge_generation();
+
+  cache.erase(llfs::PageId{1});
+  EXPECT_EQ(cache.purge_generation(), evicted_generation + 1);
+
+  cache.insert(*page, evicted_generation);
+
+  EXPECT_EQ(cache.metrics().stale_count.load(), 1u);
+  EXPECT_EQ(cache.metrics().insert_count.load(), 0u);
+  EXPECT_EQ(cache.find(llfs::PageId{1}), nullptr);
+
+  // Inserts from the current generation are accepted.
+  //
+  cache.insert(*page, cache.purge_generation());
+
+  EXPECT_EQ(cache.metrics().insert_count.load(), 1u);
+  EXPECT_NE(cache.find(llfs::PageId{1}), nullptr);
+}
+
+// Purging one page must not drop inserts of other pages that were in flight.
+//
+TEST(CompressedPageCacheTest, PurgeOnlyDropsThatPage)
+{
+  llfs::CompressedPageCache cache{/*max_bytes=*/64 * 1024};
+
+  const std::shared_ptr<llfs::PageBuffer> page1 = make_text_page(llfs::PageId{1});
+  const std::shared_ptr<llfs::PageBuffer> page2 = make_text_page(llfs::PageId{2});
+  const u64 evicted_generation = cache.purge_generation();
+
+  cache.erase(llfs::PageId{1});
+
+  cache.insert(*page1, evicted_generation);
+  cache.insert(*page2, evicted_generation);
+
+  EXPECT_EQ(cache.metrics().stale_count.load(), 1u);
+  EXPECT_EQ(cache.metrics().insert_count.load(), 1u);
+  EXPECT_EQ(cache.find(llfs::PageId{1}), nullptr);
+  EXPECT_NE(cache.find(llfs::PageId{2}), nullptr);
+
+  // Once the purge is forgotten, even an old insert of the page is accepted.
+  //
+  cache.forget_purged(cache.purge_generation());
+  cache.insert(*page1, evicted_generation);
+
+  EXPECT_EQ(cache.metrics().insert_count.load(), 2u);
+  EXPECT_NE(cache.find(llfs::PageId{1}), nullptr);
+}
+
+TEST(CompressedPageCacheTest, DropsOldestOverBudget)
+{
+  constexpr u64 kMaxBytes = 8 * 1024;
+  constexpr usize kNumPages = 32;
+
+  llfs::CompressedPageCache cache{kMaxBytes};
+
+  for (usize i = 0; i < kNumPages; ++i) {
+    cache.insert(*make_text_page(llfs::PageId{i}));
+    EXPECT_LE(cache.metrics().byte_count.load(), kMaxBytes);
+  }
+
+  // Text pages compress at least 2x, so the budget holds more pages than it would uncompressed.
+  //
+  const u64 page_count = cache.metrics().page_count.load();
+  EXPECT_GT(page_count, 2 * (kMaxBytes / kPageSize));
+  EXPECT_LT(page_count, kNumPages);
+  EXPECT_EQ(cache.metrics().evict_count.load(), kNumPages - page_count);
+
+  // The newest pages are the ones that were kept.
+  //
+  for (usize i = 0; i < kNumPages; ++i) {
+    const bool expect_found = (i >= kNumPages - page_count);
+    EXPECT_EQ(cache.find(llfs::PageId{i}) != nullptr, expect_found) << BATT_INSPECT(i);
+  }
+}
+
+// An LRU cache of (uncompressed) pages, modelling the first level of PageCache.
+//
+class PageLRU
+{
+ public:
+  explicit PageLRU(usize capacity) noexcept : capacity_{capacity}
+  {
+  }
+
+  std::shared_ptr<llfs::PageBuffer> find(llfs::PageId page_id)
+  {
+    auto iter = this->index_.find(page_id.int_value());
+    if (iter == this->index_.end()) {
+      return nullptr;
+    }
+    this->lru_.splice(this->lru_.end(), this->lru_, iter->second);
+    return *iter->second;
+  }
+
+  // Inserts `page`, returning the page evicted to make room for it (if any).
+  //
+  std::shared_ptr<llfs::PageBuffer> insert(std::shared_ptr<llfs::PageBuffer>&& page)
+  {
+    std::shared_ptr<llfs::PageBuffer> evicted;
+    if (this->lru_.size() == this->capacity_) {
+      evicted = std::move(this->lru_.front());
+      this->index_.erase(evicted->page_id().int_value());
+      this->lru_.pop_front();
+    }
+    const llfs::page_id_int key = page->page_id().int_value();
+    this->lru_.emplace_back(std::move(page));
+    this->index_.emplace(key, std::prev(this->lru_.end()));
+    return evicted;
+  }
+
+ private:
+  const usize capacity_;
+  std::list<std::shared_ptr<llfs::PageBuffer>> lru_;
+  std::unordered_map<llfs::page_id_int, std::list<std::shared_ptr<llfs::PageBuffer>>::iterator>
+      index_;
+};
+
+// Compares a single level of uncompressed pages with an even split of the same memory between
+// uncompressed pages and a CompressedPageCache, on a skewed workload whose hot set is larger than
+// the single level.  Set LLFS_EXTRA_TESTING=1 to run a longer workload.
+//
+TEST(CompressedPageCacheTest, HitRateAtSameMemoryBudget)
+{
+  const bool extra_testing = batt::getenv_as<int>("LLFS_EXTRA_TESTING").value_or(0);
+
+  constexpr usize kNumPages = 4096;
+  constexpr usize kHotPages = 768;
+  constexpr double kHotFraction = 0.9;
+  constexpr usize kBudgetPages = 512;
+  const usize kNumAccesses = extra_testing ? 1000 * 1000 : 100 * 1000;
+
+  struct Result {
+    usize hits = 0;
+    usize compressed_hits = 0;
+    std::chrono::nanoseconds hit_time{0};
+    std::chrono::nanoseconds compressed_hit_time{0};
+  };
+
+  const auto run_workload = [&](usize uncompressed_pages, u64 compressed_bytes) {
+    PageLRU lru{uncompressed_pages};
+    llfs::CompressedPageCache compressed{compressed_bytes};
+
+    std::default_random_engine rng{1};
+    std::bernoulli_distribution pick_hot(kHotFraction);
+    std::uniform_int_distribution<usize> pick_hot_page(0, kHotPages - 1);
+    std::uniform_int_distribution<usize> pick_any_page(0, kNumPages - 1);
+
+    Result result;
+    for (usize i = 0; i < kNumAccesses; ++i) {
+      const llfs::PageId page_id{pick_hot(rng) ? pick_hot_page(rng) : pick_any_page(rng)};
+
+      const auto start = std::chrono::steady_clock::now();
+      std::shared_ptr<llfs::PageBuffer> page = lru.find(page_id);
+      if (page) {
+        result.hits += 1;
+        result.hit_time += std::chrono::steady_clock::now() - start;
+        continue;
+      }
+      if (compressed_bytes != 0) {
+        page = compressed.find(page_id);
+        if (page) {
+          result.compressed_hits += 1;
+          result.compressed_hit_time += std::chrono::steady_clock::now() - start;
+        }
+      }
+      if (!page) {
+        // Stands in for a read from the device.
+        //
+        page = make_text_page(page_id);
+      }
+      std::shared_ptr<llfs::PageBuffer> evicted = lru.insert(std::move(page));
+      if (evicted && compressed_bytes != 0) {
+        compressed.insert(*evicted);
+      }
+    }
+    return result;
+  };
+
+  const Result single = run_workload(kBudgetPages, 0);
+  const Result tiered = run_workload(kBudgetPages / 2, kBudgetPages / 2 * kPageSize);
+
+  const auto hit_rate = [&](usize hits) {
+    return double(hits) / double(kNumAccesses);
+  };
+  const auto mean_usec = [](std::chrono::nanoseconds total, usize count) {
+    return count == 0 ? 0.0 : double(total.count()) / double(count) / 1000.0;
+  };
+
+  LLFS_LOG_INFO() << "uncompressed only (" << kBudgetPages << " pages): hit rate "
+                  << hit_rate(single.hits) << ", mean hit latency "
+                  << mean_usec(single.hit_time, single.hits) << "us";
+
+  LLFS_LOG_INFO() << "uncompressed (" << kBudgetPages / 2 << " pages) + compressed ("
+                  << kBudgetPages / 2 * kPageSize << " bytes): hit rate "
+                  << hit_rate(tiered.hits + tiered.compressed_hits) << " ("
+                  << hit_rate(tiered.hits) << " uncompressed, mean latency "
+                  << mean_usec(tiered.hit_time, tiered.hits) << "us; "
+                  << hit_rate(tiered.compressed_hits) << " compressed, mean latency "
+                  << mean_usec(tiered.compressed_hit_time, tiered.compressed_hits) << "us)";
+
+  EXPECT_GT(tiered.hits + tiered.compressed_hits, single.hits);
+}
+
+}  // namespace
@@ -0,0 +1,104 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/deferred_page_allocator.hpp>
+//
+
+#include <llfs/logging.hpp>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ DeferredPageAllocator::DeferredPageAllocator(batt::TaskScheduler& scheduler,
+                                                          std::string&& name,
+                                                          RecoverFn&& recover_fn) noexcept
+    : recover_fn_{std::move(recover_fn)}
+{
+  this->task_.emplace(
+      scheduler.schedule_task(),
+      [this] {
+        this->recover_task_main();
+      },
+      std::move(name));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+DeferredPageAllocator::~DeferredPageAllocator() noexcept
+{
+  this->halt();
+  this->join();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+bool DeferredPageAllocator::is_ready() const
+{
+  return this->ready_.is_ready();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<PageAllocator*> DeferredPageAllocator::await() const
+{
+  return this->ready_.await();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void DeferredPageAllocator::halt()
+{
+  this->halt_requested_.store(true);
+
+  // If recovery is still running, `recover_task_main` will see `halt_requested_` once it is done.
+  //
+  if (this->ready_.is_ready() && this->allocator_) {
+    this->allocator_->halt();
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void DeferredPageAllocator::join()
+{
+  if (this->task_) {
+    this->task_->join();
+    this->task_ = None;
+  }
+  if (this->allocator_) {
+    this->allocator_->join();
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void DeferredPageAllocator::recover_task_main()
+{
+  StatusOr<std::unique_ptr<PageAllocator>> allocator = [this] {
+    // Release whatever the recover function holds on to as soon as it is done.
+    //
+    RecoverFn recover_fn = std::move(this->recover_fn_);
+    return recover_fn();
+  }();
+
+  if (!allocator.ok()) {
+    LLFS_LOG_ERROR() << "PageAllocator recovery failed: " << allocator.status();
+    this->ready_.set_value(allocator.status());
+    return;
+  }
+
+  this->allocator_ = std::move(*allocator);
+  this->ready_.set_value(this->allocator_.get());
+
+  if (this->halt_requested_.load()) {
+    this->allocator_->halt();
+  }
+}
+
+}  // namespace llfs
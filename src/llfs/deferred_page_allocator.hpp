@@ -0,0 +1,88 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_DEFERRED_PAGE_ALLOCATOR_HPP
+#define LLFS_DEFERRED_PAGE_ALLOCATOR_HPP
+
+#include <llfs/optional.hpp>
+#include <llfs/page_allocator.hpp>
+#include <llfs/status.hpp>
+
+#include <batteries/async/latch.hpp>
+#include <batteries/async/task.hpp>
+#include <batteries/async/task_scheduler.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace llfs {
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief A PageAllocator that is still being recovered on a background Task.
+ *
+ * Replaying a PageAllocator's log is only needed to allocate pages or update ref counts; pages can
+ * be loaded from the arena's PageDevice right away.  A PageArena that holds a DeferredPageAllocator
+ * serves reads immediately, while `PageArena::allocator()` blocks until recovery is done.  See
+ * StorageContext::enable_background_allocator_recovery.
+ */
+class DeferredPageAllocator
+{
+ public:
+  using RecoverFn = std::function<StatusOr<std::unique_ptr<PageAllocator>>()>;
+
+  // Starts a Task on `scheduler` that runs `recover_fn` once.
+  //
+  explicit DeferredPageAllocator(batt::TaskScheduler& scheduler, std::string&& name,
+                                 RecoverFn&& recover_fn) noexcept;
+
+  DeferredPageAllocator(const DeferredPageAllocator&) = delete;
+  DeferredPageAllocator& operator=(const DeferredPageAllocator&) = delete;
+
+  ~DeferredPageAllocator() noexcept;
+
+  // Returns true iff recovery has finished (successfully or not).
+  //
+  bool is_ready() const;
+
+  // Blocks until recovery has finished, returning the recovered allocator or the error that
+  // prevented its recovery.
+  //
+  StatusOr<PageAllocator*> await() const;
+
+  // Halts the allocator; if it is still being recovered, it will be halted as soon as it is done.
+  //
+  void halt();
+
+  // Waits for the recovery Task and the allocator to stop.  `halt()` must be called first.
+  //
+  void join();
+
+ private:
+  void recover_task_main();
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  RecoverFn recover_fn_;
+
+  std::atomic<bool> halt_requested_{false};
+
+  // Set (once) by the recovery Task, before `ready_`.
+  //
+  std::unique_ptr<PageAllocator> allocator_;
+
+  mutable batt::Latch<PageAllocator*> ready_;
+
+  Optional<batt::Task> task_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_DEFERRED_PAGE_ALLOCATOR_HPP
@@ -0,0 +1,47 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/deferred_page_allocator.hpp>
+//
+#include <llfs/deferred_page_allocator.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/memory_page_device.hpp>
+#include <llfs/page_arena.hpp>
+
+#include <batteries/async/runtime.hpp>
+
+namespace {
+
+// A failed background recovery is reported by PageArena::allocator() instead of crashing.
+//
+TEST(DeferredPageAllocatorTest, RecoveryFailure)
+{
+  llfs::PageArena arena{
+      std::make_unique<llfs::MemoryPageDevice>(/*device_id=*/0, llfs::PageCount{4},
+                                               llfs::PageSize{4096}),
+      std::make_unique<llfs::DeferredPageAllocator>(
+          batt::Runtime::instance().default_scheduler(), "DeferredPageAllocatorTest_recover",
+          []() -> llfs::StatusOr<std::unique_ptr<llfs::PageAllocator>> {
+            return {batt::StatusCode::kDataLoss};
+          })};
+
+  EXPECT_FALSE(arena.is_read_only());
+
+  llfs::StatusOr<llfs::PageAllocator*> allocator = arena.allocator();
+
+  EXPECT_EQ(allocator.status(), batt::StatusCode::kDataLoss);
+  EXPECT_TRUE(arena.is_allocator_ready());
+
+  arena.close();
+  arena.join();
+}
+
+}  // namespace
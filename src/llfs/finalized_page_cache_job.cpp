@@ -165,6 +165,67 @@ Status FinalizedPageCacheJob::await_durable() const
 // class CommittablePageCacheJob
 //
 
+struct CommittablePageCacheJob::NewPageWrites {
+  NewPageWrites(const NewPageWrites&) = delete;
+  NewPageWrites& operator=(const NewPageWrites&) = delete;
+
+  explicit NewPageWrites(const JobCommitParams& params, usize n_ops) noexcept
+      : caller_uuid{params.caller_uuid}
+      , caller_slot{params.caller_slot}
+      , n_ops{n_ops}
+      , ops{PageWriteOp::allocate_array(n_ops, this->done_counter)}
+  {
+  }
+
+  ~NewPageWrites() noexcept
+  {
+    // The write handlers point into `ops`, so we must not free it until all have been invoked.
+    //
+    this->done_counter
+        .await_true([this](i64 n) {
+          return n == (i64)this->n_started;
+        })
+        .IgnoreError();
+  }
+
+  // Invokes `handler` once all `n_ops` writes have completed.
+  //
+  void async_await_done(std::function<void(Status)>&& handler)
+  {
+    const i64 n_done = this->done_counter.get_value();
+    if (n_done == (i64)this->n_ops) {
+      handler(OkStatus());
+      return;
+    }
+
+    this->done_counter.async_wait(
+        n_done, [this, handler = std::move(handler)](const StatusOr<i64>& updated) mutable {
+          if (!updated.ok()) {
+            handler(updated.status());
+            return;
+          }
+          this->async_await_done(std::move(handler));
+        });
+  }
+
+  // The caller identity with which the new pages were tagged.
+  //
+  const boost::uuids::uuid* const caller_uuid;
+  const slot_offset_type caller_slot;
+
+  // The number of completed writes.
+  //
+  batt::Watch<i64> done_counter{0};
+
+  const usize n_ops;
+  usize n_started = 0;
+  std::unique_ptr<PageWriteOp[]> ops;
+
+  u64 op_count = 0;
+  u64 used_byte_count = 0;
+  u64 total_byte_count = 0;
+};
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 /*static*/ StatusOr<CommittablePageCacheJob> CommittablePageCacheJob::from(
@@ -190,6 +251,15 @@ CommittablePageCacheJob::CommittablePageCacheJob(
   BATT_CHECK(this->job_->is_pruned());
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+CommittablePageCacheJob::CommittablePageCacheJob(CommittablePageCacheJob&&) noexcept = default;
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+CommittablePageCacheJob& CommittablePageCacheJob::operator=(CommittablePageCacheJob&&) noexcept =
+    default;
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 CommittablePageCacheJob::~CommittablePageCacheJob() noexcept
@@ -348,83 +418,124 @@ Status CommittablePageCacheJob::write_new_pages(const JobCommitParams& params, u
 {
   LLFS_VLOG(1) << "commit(PageCacheJob): writing new pages";
 
-  if (this->job_->get_new_pages().empty()) {
-    return OkStatus();
+  if (!this->new_page_writes_) {
+    Status start_status = this->start_writing_new_pages(params, callers);
+    BATT_REQUIRE_OK(start_status);
   }
 
+  return this->await_new_page_writes(params, callers);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status CommittablePageCacheJob::start_writing_new_pages(const JobCommitParams& params,
+                                                        u64 /*callers*/)
+{
+  BATT_CHECK_EQ(this->new_page_writes_, nullptr)
+      << "start_writing_new_pages may only be called once per job";
+
   const PageCacheJob* const job = this->job_.get();
   BATT_CHECK_NOT_NULLPTR(job);
 
-  u64 op_count = 0;
-  u64 used_byte_count = 0;
-  u64 total_byte_count = 0;
-
   // Write the pages to their respective PageDevice asynchronously/concurrently to maximize
   // throughput.
   //
-  batt::Watch<i64> done_counter{0};
-  const usize n_ops = job->get_new_pages().size();
-  auto ops = PageWriteOp::allocate_array(n_ops, done_counter);
-  LLFS_VLOG(1) << "commit(PageCacheJob): writing new pages";
-  {
-    usize i = 0;
-    for (auto& p : job->get_new_pages()) {
-      const PageId page_id = p.first;
-      const PageCacheJob::NewPage& new_page = p.second;
-      std::shared_ptr<const PageView> new_page_view = new_page.view();
-      BATT_CHECK_NOT_NULLPTR(new_page_view);
-      BATT_CHECK_EQ(page_id, new_page_view->page_id());
-      BATT_CHECK(job->get_already_pinned(page_id) != None) << BATT_INSPECT(page_id);
-
-      // Finalize the client uuid and slot that uniquely identifies this transaction, so we can
-      // guarantee exactly-once side effects in the presence of crashes.
-      {
-        std::shared_ptr<PageBuffer> mutable_page_buffer = new_page.buffer();
-        if (mutable_page_buffer == nullptr) {
-          LLFS_VLOG(1) << "Skipping page header update for recovered page " << page_id;
-        } else {
-          {
-            PackedPageUserSlot& user_slot =
-                mutable_page_header(mutable_page_buffer.get())->user_slot;
-            if (params.caller_uuid) {
-              user_slot.user_id = *params.caller_uuid;
-            } else {
-              std::memset(&user_slot.user_id, 0, sizeof(user_slot.user_id));
-            }
-            user_slot.slot_offset = params.caller_slot;
+  this->new_page_writes_ =
+      std::make_unique<NewPageWrites>(params, /*n_ops=*/job->get_new_pages().size());
+
+  NewPageWrites& writes = *this->new_page_writes_;
+
+  for (auto& p : job->get_new_pages()) {
+    const PageId page_id = p.first;
+    const PageCacheJob::NewPage& new_page = p.second;
+    std::shared_ptr<const PageView> new_page_view = new_page.view();
+    BATT_CHECK_NOT_NULLPTR(new_page_view);
+    BATT_CHECK_EQ(page_id, new_page_view->page_id());
+    BATT_CHECK(job->get_already_pinned(page_id) != None) << BATT_INSPECT(page_id);
+
+    // Finalize the client uuid and slot that uniquely identifies this transaction, so we can
+    // guarantee exactly-once side effects in the presence of crashes.
+    {
+      std::shared_ptr<PageBuffer> mutable_page_buffer = new_page.buffer();
+      if (mutable_page_buffer == nullptr) {
+        LLFS_VLOG(1) << "Skipping page header update for recovered page " << page_id;
+      } else {
+        {
+          PackedPageUserSlot& user_slot = mutable_page_header(mutable_page_buffer.get())->user_slot;
+          if (params.caller_uuid) {
+            user_slot.user_id = *params.caller_uuid;
+          } else {
+            std::memset(&user_slot.user_id, 0, sizeof(user_slot.user_id));
           }
+          user_slot.slot_offset = params.caller_slot;
         }
       }
+    }
 
-      // We will need this information to update the metrics below.
-      //
-      const PackedPageHeader& page_header = new_page.const_page_header();
-      const usize page_size = page_header.size;
-      const usize used_size = page_header.used_size();
+    // We will need this information to update the metrics below.
+    //
+    const PackedPageHeader& page_header = new_page.const_page_header();
+    const usize page_size = page_header.size;
+    const usize used_size = page_header.used_size();
 
-      ops[i].page_id = page_id;
+    PageWriteOp& op = writes.ops[writes.n_started];
+    op.page_id = page_id;
 
-      job->cache().arena_for_page_id(page_id).device().write(new_page.const_buffer(),
-                                                             ops[i].get_handler());
+    writes.n_started += 1;
+    job->cache().arena_for_page_id(page_id).device().write(new_page.const_buffer(),
+                                                           op.get_handler());
 
-      total_byte_count += page_size;
-      used_byte_count += used_size;
-      op_count += page_size / 4096;
-      ++i;
-    }
+    writes.total_byte_count += page_size;
+    writes.used_byte_count += used_size;
+    writes.op_count += page_size / 4096;
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void CommittablePageCacheJob::async_await_new_page_writes(
+    std::function<void(Status)>&& handler) const
+{
+  BATT_CHECK_NOT_NULLPTR(this->new_page_writes_);
+
+  // NewPageWrites (unlike `this`) stays put if the job is moved while the wait is pending.
+  //
+  this->new_page_writes_->async_await_done(std::move(handler));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status CommittablePageCacheJob::await_new_page_writes(const JobCommitParams& params, u64 callers)
+{
+  BATT_CHECK_NOT_NULLPTR(this->new_page_writes_);
+
+  const PageCacheJob* const job = this->job_.get();
+  BATT_CHECK_NOT_NULLPTR(job);
+
+  NewPageWrites& writes = *this->new_page_writes_;
+
+  BATT_CHECK_EQ(writes.caller_uuid, params.caller_uuid)
+      << "The JobCommitParams passed to start_writing_new_pages and commit must match";
+  BATT_CHECK_EQ(writes.caller_slot, params.caller_slot)
+      << "The JobCommitParams passed to start_writing_new_pages and commit must match";
+
+  if (writes.n_ops == 0) {
+    return OkStatus();
   }
 
   // Wait for all concurrent page writes to finish.
   //
-  auto final_count = done_counter.await_true([&](i64 n) {
-    return n == (i64)n_ops;
+  auto final_count = writes.done_counter.await_true([&](i64 n) {
+    return n == (i64)writes.n_ops;
   });
   BATT_REQUIRE_OK(final_count);
 
   // Only proceed if all writes succeeded.
   //
   Status all_ops_status = OkStatus();
-  for (auto& op : as_slice(ops.get(), n_ops)) {
+  for (auto& op : as_slice(writes.ops.get(), writes.n_ops)) {
     job->cache().track_new_page_event(NewPageTracker{
         .ts = 0,
         .job_id = job->job_id,
@@ -437,9 +548,9 @@ Status CommittablePageCacheJob::write_new_pages(const JobCommitParams& params, u
   }
   BATT_REQUIRE_OK(all_ops_status);
 
-  job->cache().metrics().total_bytes_written += total_byte_count;
-  job->cache().metrics().used_bytes_written += used_byte_count;
-  job->cache().metrics().total_write_ops += op_count;
+  job->cache().metrics().total_bytes_written += writes.total_byte_count;
+  job->cache().metrics().used_bytes_written += writes.used_byte_count;
+  job->cache().metrics().total_write_ops += writes.op_count;
 
   return OkStatus();
 }
@@ -465,9 +576,11 @@ auto CommittablePageCacheJob::start_ref_count_updates(const JobCommitParams& par
     const PageArena& arena = this->job_->cache().arena_for_device_id(device_id);
     device_state.p_arena = &arena;
 
+    StatusOr<PageAllocator*> allocator = arena.allocator();
+    BATT_REQUIRE_OK(allocator);
     BATT_ASSIGN_OK_RESULT(
         device_state.sync_point,
-        arena.allocator().update_page_ref_counts(
+        (*allocator)->update_page_ref_counts(
             *params.caller_uuid, params.caller_slot, as_seq(device_state.ref_count_updates),
             /*dead_page_fn=*/
             [&dead_pages, recycle_depth = params.recycle_depth](page_id_int dead_page_id) {
@@ -491,7 +604,9 @@ Status CommittablePageCacheJob::await_ref_count_updates(const PageRefCountUpdate
   // Now wait for the allocator logs to flush.
   //
   for (const auto& [device_id, device_state] : updates.per_device) {
-    Status sync_status = device_state.p_arena->allocator().sync(device_state.sync_point);
+    StatusOr<PageAllocator*> allocator = device_state.p_arena->allocator();
+    BATT_REQUIRE_OK(allocator);
+    Status sync_status = (*allocator)->sync(device_state.sync_point);
     BATT_REQUIRE_OK(sync_status);
     //
     // ^^^ TODO [tastolfi 2021-09-13] deal with partial failure
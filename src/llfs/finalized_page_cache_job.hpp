@@ -22,6 +22,7 @@
 
 #include <boost/uuid/uuid.hpp>
 
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -159,8 +160,8 @@ class CommittablePageCacheJob
   CommittablePageCacheJob(const CommittablePageCacheJob&) = delete;
   CommittablePageCacheJob& operator=(const CommittablePageCacheJob&) = delete;
 
-  CommittablePageCacheJob(CommittablePageCacheJob&&) = default;
-  CommittablePageCacheJob& operator=(CommittablePageCacheJob&&) = default;
+  CommittablePageCacheJob(CommittablePageCacheJob&&) noexcept;
+  CommittablePageCacheJob& operator=(CommittablePageCacheJob&&) noexcept;
 
   // Sets the tracker status to kAborted if not already in a terminal state.
   //
@@ -178,6 +179,23 @@ class CommittablePageCacheJob
 
   BoxedSeq<PageRefCount> root_set_deltas() const;
 
+  // Starts writing the new pages of this job to their devices, without waiting for the writes to
+  // complete.  `params` must be the same as those later passed to `commit`, which will wait for
+  // these writes instead of issuing its own.
+  //
+  // New pages are not reachable until the job is committed, so it is safe to call this before the
+  // caller has made its intent to commit durable (e.g., while a Volume's prepare slot is being
+  // flushed); ref count updates are still not started until `commit` is called.
+  //
+  Status start_writing_new_pages(const JobCommitParams& params, u64 callers);
+
+  // Invokes `handler` once every write started by `start_writing_new_pages` has completed
+  // (successfully or not), without blocking the caller; `commit` will then not wait on any page
+  // I/O.  The status passed to `handler` is only non-ok if the wait itself failed; the results of
+  // the writes are still checked by `commit`.
+  //
+  void async_await_new_page_writes(std::function<void(Status)>&& handler) const;
+
   explicit operator bool() const
   {
     return this->job_ && this->tracker_;
@@ -200,6 +218,11 @@ class CommittablePageCacheJob
     std::vector<PageId> ids;
   };
 
+  // The in-flight writes started by `start_writing_new_pages`; the destructor waits for all writes
+  // to complete.
+  //
+  struct NewPageWrites;
+
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
   explicit CommittablePageCacheJob(std::unique_ptr<PageCacheJob> finalized_job) noexcept;
@@ -208,6 +231,8 @@ class CommittablePageCacheJob
 
   Status write_new_pages(const JobCommitParams& params, u64 callers);
 
+  Status await_new_page_writes(const JobCommitParams& params, u64 callers);
+
   StatusOr<PageRefCountUpdates> get_page_ref_count_updates(u64 callers) const;
 
   StatusOr<DeadPages> start_ref_count_updates(const JobCommitParams& params,
@@ -225,6 +250,7 @@ class CommittablePageCacheJob
 
   std::shared_ptr<const PageCacheJob> job_;
   boost::intrusive_ptr<FinalizedJobTracker> tracker_;
+  std::unique_ptr<NewPageWrites> new_page_writes_;
 };
 
 // Convenience shortcut for use cases where we do not pipeline job commits.
@@ -24,6 +24,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <cstdlib>
+#include <cstring>
 
 namespace llfs {
 
@@ -146,6 +147,12 @@ Status IoRing::run() const
         //
         LLFS_DVLOG(1) << "IoRing::run() io_uring_cqe_seen";
         io_uring_cqe_seen(&this->impl_->ring_, p_cqe);
+
+        // The completed op frees up capacity for the next one in the overflow queue (if any).
+        //
+        BATT_CHECK_GT(this->impl_->in_flight_count_, 0u);
+        this->impl_->in_flight_count_ -= 1;
+        this->drain_overflow_with_lock(lock);
       }
 
       // Invoke the associated handler.  This will also decrement the activity counter.
@@ -184,6 +191,76 @@ void IoRing::invoke_handler(struct io_uring_cqe* cqe) const
   this->impl_->work_count_.fetch_sub(1);
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+struct io_uring_sqe* IoRing::get_sqe_with_lock(const std::unique_lock<std::mutex>&) const
+{
+  // Limit the number of ops in flight to the size of the completion queue so the kernel never has
+  // to drop (or buffer) completion events.
+  //
+  const usize capacity = *this->impl_->ring_.cq.kring_entries;
+
+  if (this->impl_->overflow_next_ != this->impl_->overflow_sqes_.size() ||
+      this->impl_->in_flight_count_ >= capacity) {
+    return nullptr;
+  }
+
+  return io_uring_get_sqe(&this->impl_->ring_);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+struct io_uring_sqe& IoRing::push_overflow_with_lock(const std::unique_lock<std::mutex>&) const
+{
+  struct io_uring_sqe& sqe = this->impl_->overflow_sqes_.emplace_back();
+  std::memset(&sqe, 0, sizeof(sqe));
+  return sqe;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void IoRing::drain_overflow_with_lock(const std::unique_lock<std::mutex>&) const
+{
+  std::vector<struct io_uring_sqe>& overflow_sqes = this->impl_->overflow_sqes_;
+  usize& overflow_next = this->impl_->overflow_next_;
+
+  if (overflow_next == overflow_sqes.size()) {
+    return;
+  }
+
+  const usize capacity = *this->impl_->ring_.cq.kring_entries;
+  int n_to_submit = 0;
+
+  while (overflow_next != overflow_sqes.size() && this->impl_->in_flight_count_ < capacity) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&this->impl_->ring_);
+    if (sqe == nullptr) {
+      break;
+    }
+    *sqe = overflow_sqes[overflow_next];
+    overflow_next += 1;
+    this->impl_->in_flight_count_ += 1;
+    n_to_submit += 1;
+  }
+
+  if (overflow_next == overflow_sqes.size()) {
+    overflow_sqes.clear();
+    overflow_next = 0;
+  }
+
+  if (n_to_submit != 0) {
+    BATT_CHECK_EQ(n_to_submit, io_uring_submit(&this->impl_->ring_)) << std::strerror(errno);
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize IoRing::overflow_count() const
+{
+  std::unique_lock<std::mutex> lock{this->impl_->mutex_};
+
+  return this->impl_->overflow_sqes_.size() - this->impl_->overflow_next_;
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 void IoRing::on_work_started() const
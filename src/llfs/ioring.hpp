@@ -75,6 +75,17 @@ class IoRing
     std::vector<i32> registered_fds_;
     std::vector<i32> free_fds_;
 
+    // The number of ops handed to the kernel whose completion events have not been consumed yet.
+    //
+    usize in_flight_count_{0};
+
+    // Ops that were prepared while the ring was at capacity, in submission order; these are handed
+    // to the kernel as earlier ops complete.  The vector is cleared (but keeps its capacity) once
+    // `overflow_next_` catches up with its size.
+    //
+    std::vector<struct io_uring_sqe> overflow_sqes_;
+    usize overflow_next_{0};
+
     Impl() = default;
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
@@ -153,10 +164,16 @@ class IoRing
   IoRing(IoRing&&) = default;
   IoRing& operator=(IoRing&&) = default;
 
-  template <typename Handler, typename BufferSequence>
-  void submit(BufferSequence&& buffers, Handler&& handler,
-              std::function<void(struct io_uring_sqe*, OpHandler<std::decay_t<Handler>>&)>&&
-                  start_op) const;
+  // Starts an async op; `start_op` is called (exactly once, before `submit` returns) with a
+  // submission queue entry and the OpHandler holding `buffers`, and must prepare the entry.
+  //
+  // At most one op per completion queue entry is handed to the kernel at a time; when the ring is
+  // at capacity, the prepared entry is copied to a user-space overflow queue instead and submitted
+  // as earlier ops complete.  The only allocation per op is the OpHandler, which uses the
+  // allocator associated with `handler`.
+  //
+  template <typename Handler, typename BufferSequence, typename StartOp>
+  void submit(BufferSequence&& buffers, Handler&& handler, StartOp&& start_op) const;
 
   Status run() const;
 
@@ -196,6 +213,10 @@ class IoRing
   //
   Status unregister_fd(i32 user_fd) const;
 
+  // Returns the number of ops waiting in the overflow queue for ring capacity.
+  //
+  usize overflow_count() const;
+
  private:
   explicit IoRing(std::unique_ptr<Impl>&& impl) noexcept;
 
@@ -207,6 +228,19 @@ class IoRing
 
   void invoke_handler(struct io_uring_cqe* cqe) const;
 
+  // Returns a submission queue entry for a new op, or nullptr if the op must be added to the
+  // overflow queue (because the ring is at capacity or earlier ops are still waiting there).
+  //
+  struct io_uring_sqe* get_sqe_with_lock(const std::unique_lock<std::mutex>&) const;
+
+  // Appends a zero-initialized entry to the overflow queue and returns a reference to it.
+  //
+  struct io_uring_sqe& push_overflow_with_lock(const std::unique_lock<std::mutex>&) const;
+
+  // Hands as many ops from the overflow queue to the kernel as capacity allows.
+  //
+  void drain_overflow_with_lock(const std::unique_lock<std::mutex>&) const;
+
   Status unregister_buffers_with_lock(const std::unique_lock<std::mutex>&) const;
 
   // Removes the specified user_fd from the registered fds table, returning the previously
@@ -239,20 +273,35 @@ inline auto IoRing::wrap_handler(Fn&& fn, BufferSequence&& bufs)
   return op;
 }
 
-template <typename Handler, typename BufferSequence>
-inline void IoRing::submit(
-    BufferSequence&& buffers, Handler&& handler,
-    std::function<void(struct io_uring_sqe*, OpHandler<std::decay_t<Handler>>&)>&& start_op) const
-
+template <typename Handler, typename BufferSequence, typename StartOp>
+inline void IoRing::submit(BufferSequence&& buffers, Handler&& handler, StartOp&& start_op) const
 {
+  auto* op_handler = wrap_handler(BATT_FORWARD(handler), BATT_FORWARD(buffers));
+
+  BATT_STATIC_ASSERT_TYPE_EQ(decltype(op_handler->get_fn()), OpHandler<std::decay_t<Handler>>&);
+
   std::unique_lock<std::mutex> lock{this->impl_->mutex_};
 
-  struct io_uring_sqe* sqe = io_uring_get_sqe(&this->impl_->ring_);
-  BATT_CHECK_NOT_NULLPTR(sqe);
+  // Increment work count; decrement in invoke_handler.
+  //
+  LLFS_DVLOG(1) << "(submit) before; " << BATT_INSPECT(this->impl_->work_count_);
+  this->on_work_started();
+  LLFS_DVLOG(1) << "(submit) after; " << BATT_INSPECT(this->impl_->work_count_);
 
-  auto* op_handler = wrap_handler(BATT_FORWARD(handler), BATT_FORWARD(buffers));
+  struct io_uring_sqe* sqe = this->get_sqe_with_lock(lock);
+  if (sqe == nullptr) {
+    // No capacity; prepare the op in the overflow queue.  `start_op` only fills in the entry, so
+    // it is safe to copy the entry into the ring later.
+    //
+    struct io_uring_sqe& overflow_sqe = this->push_overflow_with_lock(lock);
 
-  BATT_STATIC_ASSERT_TYPE_EQ(decltype(op_handler->get_fn()), OpHandler<std::decay_t<Handler>>&);
+    start_op(&overflow_sqe, op_handler->get_fn());
+    io_uring_sqe_set_data(&overflow_sqe, op_handler);
+
+    LLFS_DVLOG(1) << "(submit) ring at capacity; "
+                  << BATT_INSPECT(this->impl_->overflow_sqes_.size());
+    return;
+  }
 
   // Initiate the operation.
   //
@@ -262,14 +311,9 @@ inline void IoRing::submit(
   //
   io_uring_sqe_set_data(sqe, op_handler);
 
-  // Increment work count; decrement in invoke_handler.
-  //
-  LLFS_DVLOG(1) << "(submit) before; " << BATT_INSPECT(this->impl_->work_count_);
-  this->on_work_started();
-  LLFS_DVLOG(1) << "(submit) after; " << BATT_INSPECT(this->impl_->work_count_);
-
   // Finally, submit the request.
   //
+  this->impl_->in_flight_count_ += 1;
   BATT_CHECK_EQ(1, io_uring_submit(&this->impl_->ring_)) << std::strerror(errno);
 }
 
@@ -29,8 +29,10 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
+#include <vector>
 
 namespace {
 
@@ -100,6 +102,40 @@ TEST(Ioring, Test)
   }
 }
 
+// Submitting many more ops than the ring has entries must not fail; the extra ops wait in the
+// overflow queue until earlier ones complete.
+//
+TEST(Ioring, SubmitPastCapacity)
+{
+  StatusOr<IoRing> io = IoRing::make_new(llfs::MaxQueueDepth{4});
+  ASSERT_TRUE(io.ok()) << io.status();
+
+  constexpr usize kNumOps = 1000;
+
+  std::vector<usize> completed;
+  for (usize i = 0; i < kNumOps; ++i) {
+    io->post([&completed, i](StatusOr<i32> result) {
+      EXPECT_TRUE(result.ok()) << BATT_INSPECT(result.status());
+      completed.emplace_back(i);
+    });
+  }
+
+  EXPECT_GT(io->overflow_count(), 0u);
+
+  Status io_status = io->run();
+
+  EXPECT_TRUE(io_status.ok()) << BATT_INSPECT(io_status);
+  EXPECT_EQ(io->overflow_count(), 0u);
+  ASSERT_EQ(completed.size(), kNumOps);
+
+  // Every op completes exactly once.
+  //
+  std::vector<usize> sorted = completed;
+  std::sort(sorted.begin(), sorted.end());
+  EXPECT_EQ(sorted.back(), kNumOps - 1);
+  EXPECT_EQ(std::adjacent_find(sorted.begin(), sorted.end()), sorted.end());
+}
+
 TEST(Ioring, DISABLED_BlockDev)
 {
   StatusOr<IoRing> io = IoRing::make_new(llfs::MaxQueueDepth{64});
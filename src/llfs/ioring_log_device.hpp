@@ -59,13 +59,11 @@ class IoRingLogDeviceFactory : public LogDeviceFactory
     }
   }
 
+  // Opens the log without scanning it; nothing is truncated.
+  //
   StatusOr<std::unique_ptr<IoRingLogDevice>> open_ioring_log_device()
   {
-    auto instance = std::make_unique<IoRingLogDevice>(
-        RingBuffer::TempFile{.byte_size = this->config_.logical_size}, this->fd_, this->config_,
-        this->options_);
-
-    this->fd_ = -1;
+    auto instance = this->make_ioring_log_device();
 
     Status open_status = instance->open();
     BATT_REQUIRE_OK(open_status);
@@ -73,19 +71,42 @@ class IoRingLogDeviceFactory : public LogDeviceFactory
     return instance;
   }
 
+  // Recovers the log, passes it to `scan_fn`, and truncates it at the returned slot offset before
+  // the device starts writing.
+  //
   StatusOr<std::unique_ptr<LogDevice>> open_log_device(const LogScanFn& scan_fn) override
   {
-    auto instance = this->open_ioring_log_device();
-    BATT_REQUIRE_OK(instance);
+    auto instance = this->make_ioring_log_device();
+    IoRingLogDriver& driver = instance->driver().impl();
+
+    Status recover_status = driver.recover();
+    BATT_REQUIRE_OK(recover_status);
 
     auto scan_status =
-        scan_fn(*(*instance)->new_reader(/*slot_lower_bound=*/None, LogReadMode::kDurable));
+        scan_fn(*instance->new_reader(/*slot_lower_bound=*/None, LogReadMode::kDurable));
     BATT_REQUIRE_OK(scan_status);
 
-    return instance;
+    Status truncate_status = this->truncate(driver, *scan_status);
+    BATT_REQUIRE_OK(truncate_status);
+
+    Status open_status = instance->open();
+    BATT_REQUIRE_OK(open_status);
+
+    return std::unique_ptr<LogDevice>{std::move(instance)};
   }
 
  private:
+  std::unique_ptr<IoRingLogDevice> make_ioring_log_device()
+  {
+    auto instance = std::make_unique<IoRingLogDevice>(
+        RingBuffer::TempFile{.byte_size = this->config_.logical_size}, this->fd_, this->config_,
+        this->options_);
+
+    this->fd_ = -1;
+
+    return instance;
+  }
+
   int fd_;
   IoRingLogConfig config_;
   IoRingLogDriverOptions options_;
@@ -123,6 +123,12 @@ class BasicIoRingLogDriver
 
   //----
 
+  /** \brief Reads the log from the file into the ring buffer and restores the trim, flush, and
+   * commit pos.  Called by `open()` if it hasn't been already; IoRingLogDeviceFactory calls it
+   * first so the log can be scanned and truncated before anything new is written.
+   */
+  Status recover();
+
   Status open();
 
   Status close()
@@ -218,6 +224,8 @@ class BasicIoRingLogDriver
   }
 
  private:
+  friend class LogTruncateAccess;
+
   using SlotOffsetHeap = boost::heap::d_ary_heap<slot_offset_type,                   //
                                                  boost::heap::arity<2>,              //
                                                  boost::heap::compare<SlotGreater>,  //
@@ -243,6 +251,23 @@ class BasicIoRingLogDriver
 
   Status read_log_data();
 
+  // Discards all data at and after `truncate_pos`.  Must be called after `recover()` and before
+  // `open()`.  The block that contains `truncate_pos` is rewritten (synchronously) to end there, so
+  // that recovery after a crash never sees the discarded data again, even if nothing new is
+  // flushed before the crash.
+  //
+  Status truncate(slot_offset_type truncate_pos);
+
+  // Runs the IoRing on a temporary background thread while `fn` does blocking I/O, for use before
+  // the flush task is started.
+  //
+  template <typename Fn>
+  Status with_ioring_thread(std::string_view caller, Fn&& fn);
+
+  // Sets `init_upper_bound_` and `flush_state_` from the recovered flush pos.
+  //
+  void init_flush_state();
+
   void start_flush_task();
 
   void flush_task_main();
@@ -275,6 +300,10 @@ class BasicIoRingLogDriver
   IoRing ioring_;
   IoRing::File file_;
 
+  // Set to true once `recover()` succeeds.
+  //
+  bool recovered_ = false;
+
   // Set to true once when halt is first called; used to detect unexpected/premature exit of
   // background tasks.
   //
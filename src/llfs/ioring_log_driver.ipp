@@ -22,6 +22,10 @@
 #include <batteries/seq/boxed.hpp>
 #include <batteries/stream_util.hpp>
 
+#include <cstring>
+#include <memory>
+#include <thread>
+
 namespace llfs {
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -66,13 +70,34 @@ inline BasicIoRingLogDriver<FlushOpImpl>::~BasicIoRingLogDriver() noexcept
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 template <template <typename> class FlushOpImpl>
-inline Status BasicIoRingLogDriver<FlushOpImpl>::open()
+inline Status BasicIoRingLogDriver<FlushOpImpl>::recover()
 {
+  BATT_CHECK(!this->recovered_);
+
   // Read all blocks into the ring buffer.
   //
   Status data_read = this->read_log_data();
   BATT_REQUIRE_OK(data_read) << BATT_INSPECT(this->name_);
 
+  this->recovered_ = true;
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <template <typename> class FlushOpImpl>
+inline Status BasicIoRingLogDriver<FlushOpImpl>::open()
+{
+  if (!this->recovered_) {
+    Status recover_status = this->recover();
+    BATT_REQUIRE_OK(recover_status);
+  }
+
+  // Initialize state according to recovered values.
+  //
+  this->init_flush_state();
+
   Status fd_registered = this->file_.register_fd();
   BATT_REQUIRE_OK(fd_registered);
 
@@ -99,13 +124,15 @@ inline Status BasicIoRingLogDriver<FlushOpImpl>::open()
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 template <template <typename> class FlushOpImpl>
-inline Status BasicIoRingLogDriver<FlushOpImpl>::read_log_data()
+template <typename Fn>
+inline Status BasicIoRingLogDriver<FlushOpImpl>::with_ioring_thread(std::string_view caller,
+                                                                    Fn&& fn)
 {
   BATT_CHECK(!this->flush_task_);
 
   // Each IoRing log device gets its own IoRing.  We must start it on a background thread to process
-  // the read operations in the loop below.  After we are done, we must stop this background thread
-  // and return the IoRing to its original state so that device driver can start up.
+  // the I/O operations issued by `fn`.  After we are done, we must stop this background thread and
+  // return the IoRing to its original state so that device driver can start up.
   //
   this->ioring_.on_work_started();
 
@@ -120,27 +147,116 @@ inline Status BasicIoRingLogDriver<FlushOpImpl>::read_log_data()
   // Shut down the ioring and reset when we leave this scope.
   //
   const auto stop_ioring_thread = batt::finally([&] {
-    LLFS_VLOG(1) << "Stopping ioring (IoRingLogDriver::read_log_data)";
+    LLFS_VLOG(1) << "Stopping ioring (IoRingLogDriver::" << caller << ")";
     this->ioring_.on_work_finished();
     ioring_thread.join();
     this->ioring_.reset();
   });
 
-  IoRingLogRecovery recovery{
-      this->config_, this->context_.buffer_,
-      /*read_data_fn=*/[this](i64 file_offset, MutableBuffer buffer) -> Status {
-        return this->file_.read_all(file_offset + this->config_.physical_offset, buffer);
-      }};
+  return BATT_FORWARD(fn)();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <template <typename> class FlushOpImpl>
+inline Status BasicIoRingLogDriver<FlushOpImpl>::read_log_data()
+{
+  return this->with_ioring_thread("read_log_data", [this]() -> Status {
+    IoRingLogRecovery recovery{
+        this->config_, this->context_.buffer_,
+        /*read_data_fn=*/
+        [this](i64 file_offset, MutableBuffer buffer) -> Status {
+          return this->file_.read_all(file_offset + this->config_.physical_offset, buffer);
+        },
+        this->options_.raw_data};
+
+    LLFS_VLOG(1) << "Starting log recovery..." << BATT_INSPECT(this->name_);
+    Status recovery_status = recovery.run();
+    LLFS_VLOG(1) << "Log recovery finished: " << BATT_INSPECT(recovery_status);
+    BATT_REQUIRE_OK(recovery_status);
+
+    this->trim_pos_.set_value(recovery.get_trim_pos());
+    this->flush_pos_.set_value(recovery.get_flush_pos());
+    this->commit_pos_.set_value(recovery.get_flush_pos());
+    this->durable_trim_pos_.set_value(recovery.get_trim_pos());
+
+    LLFS_VLOG(1) << "log recovery complete; total: "
+                 << (this->config_.block_size() * this->config_.block_count()) << ";"
+                 << BATT_INSPECT(this->trim_pos_.get_value())
+                 << BATT_INSPECT(this->flush_pos_.get_value())
+                 << BATT_INSPECT(this->commit_pos_.get_value());
+
+    return OkStatus();
+  });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <template <typename> class FlushOpImpl>
+inline Status BasicIoRingLogDriver<FlushOpImpl>::truncate(slot_offset_type truncate_pos)
+{
+  BATT_CHECK(this->recovered_);
+  BATT_CHECK(!this->flush_task_) << "the log can only be truncated before it is opened";
+
+  const slot_offset_type trim_pos = this->trim_pos_.get_value();
+  const slot_offset_type flush_pos = this->flush_pos_.get_value();
 
-  LLFS_VLOG(1) << "Starting log recovery..." << BATT_INSPECT(this->name_);
-  Status recovery_status = recovery.run();
-  LLFS_VLOG(1) << "Log recovery finished: " << BATT_INSPECT(recovery_status);
-  BATT_REQUIRE_OK(recovery_status);
+  BATT_CHECK(!slot_less_than(truncate_pos, trim_pos) && !slot_less_than(flush_pos, truncate_pos))
+      << "the truncate point must be within the recovered log;" << BATT_INSPECT(truncate_pos)
+      << BATT_INSPECT(trim_pos) << BATT_INSPECT(flush_pos);
 
-  this->trim_pos_.set_value(recovery.get_trim_pos());
-  this->flush_pos_.set_value(recovery.get_flush_pos());
-  this->commit_pos_.set_value(recovery.get_flush_pos());
-  this->durable_trim_pos_.set_value(recovery.get_trim_pos());
+  if (truncate_pos == flush_pos) {
+    return OkStatus();
+  }
+
+  LLFS_VLOG(1) << "IoRingLogDriver::truncate(" << truncate_pos << ")" << BATT_INSPECT(this->name_)
+               << BATT_INSPECT(flush_pos);
+
+  // Build the new image of the block that contains `truncate_pos`.  Recovery stops at the first
+  // block that isn't full, so the data after `truncate_pos` in later blocks is never read again;
+  // the flush ops re-initialize those blocks before the ones in front of them can fill up (see
+  // `init_upper_bound_`).
+  //
+  const SlotRange block_slot_range =
+      this->calculate_.block_slot_range_from(SlotLowerBoundAt{truncate_pos});
+
+  const usize block_size = this->calculate_.block_size();
+  std::unique_ptr<PackedLogPageBuffer[]> block{
+      new PackedLogPageBuffer[this->calculate_.pages_per_block()]};
+  std::memset(block.get(), 0, block_size);
+
+  PackedLogPageHeader* const header = &block[0].header;
+  header->reset(block_slot_range.lower_bound);
+  header->commit_size = truncate_pos - block_slot_range.lower_bound;
+  header->trim_pos = trim_pos;
+  header->flush_pos = truncate_pos;
+  header->commit_pos = truncate_pos;
+
+  if (header->commit_size > 0) {
+    const ConstBuffer src = this->context_.buffer_.get(block_slot_range.lower_bound);
+    std::memcpy(header + 1, src.data(), header->commit_size);
+  }
+
+  const i64 file_offset =
+      this->calculate_.block_start_file_offset_from(SlotLowerBoundAt{truncate_pos});
+
+  Status write_status = this->with_ioring_thread("truncate", [&] {
+    return this->file_.write_all(file_offset, ConstBuffer{block.get(), block_size});
+  });
+  BATT_REQUIRE_OK(write_status);
+
+  this->flush_pos_.set_value(truncate_pos);
+  this->commit_pos_.set_value(truncate_pos);
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <template <typename> class FlushOpImpl>
+inline void BasicIoRingLogDriver<FlushOpImpl>::init_flush_state()
+{
+  const slot_offset_type flush_pos = this->flush_pos_.get_value();
 
   // Calculate the highest physical block index that has been initialized.
   {
@@ -150,7 +266,7 @@ inline Status BasicIoRingLogDriver<FlushOpImpl>::read_log_data()
     // and only such block in the log); in either case, we add one to get the upper bound. be
     //
     const auto logical_init_upper_bound = LogBlockCalculator::LogicalBlockIndex{
-        this->calculate_.logical_block_index_from(SlotLowerBoundAt{recovery.get_flush_pos()}) + 1};
+        this->calculate_.logical_block_index_from(SlotLowerBoundAt{flush_pos}) + 1};
 
     // If we are at or beyond the block count, set init_upper_bound_ to its maximum value.
     //
@@ -162,17 +278,7 @@ inline Status BasicIoRingLogDriver<FlushOpImpl>::read_log_data()
     }
   }
 
-  // Initialize state according to recovered values.
-  //
   this->flush_state_.emplace(this);
-
-  LLFS_VLOG(1) << "log recovery complete; total: "
-               << (this->config_.block_size() * this->config_.block_count()) << ";"
-               << BATT_INSPECT(this->trim_pos_.get_value())
-               << BATT_INSPECT(this->flush_pos_.get_value())
-               << BATT_INSPECT(this->commit_pos_.get_value());
-
-  return OkStatus();
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -54,6 +54,12 @@ class IoRingLogDriverOptions
   //
   usize queue_depth_log2 = 4;
 
+  // If true, the log holds raw bytes rather than a sequence of slots (e.g., one stripe of a
+  // StripedLogDevice), so recovery keeps all contiguous durable data instead of dropping a trailing
+  // partial slot.
+  //
+  bool raw_data = false;
+
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
   usize queue_depth() const
@@ -78,6 +84,12 @@ class IoRingLogDriverOptions
     this->name = name;
     return *this;
   }
+
+  Self& set_raw_data(bool b)
+  {
+    this->raw_data = b;
+    return *this;
+  }
 };
 
 }  // namespace llfs
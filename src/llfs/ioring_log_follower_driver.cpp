@@ -0,0 +1,351 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/ioring_log_follower_driver.hpp>
+//
+
+#ifndef LLFS_DISABLE_IO_URING
+
+#include <llfs/data_reader.hpp>
+#include <llfs/ioring_log_recovery.hpp>
+#include <llfs/logging.hpp>
+#include <llfs/status_code.hpp>
+
+#include <batteries/stream_util.hpp>
+
+#include <cstring>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ IoRingLogFollowerDriver::IoRingLogFollowerDriver(
+    LogStorageDriverContext& context, IoRing::File&& file, const IoRingLogConfig& config,
+    batt::TaskScheduler& scheduler, const IoRingLogFollowerOptions& options) noexcept
+    : context_{context}
+    , file_{std::move(file)}
+    , config_{config}
+    , scheduler_{scheduler}
+    , options_{options}
+    , metrics_{}
+    , block_storage_{
+          new PackedLogPageBuffer[this->config_.block_size() / sizeof(PackedLogPageBuffer)]}
+{
+  BATT_CHECK_EQ(this->config_.block_size() % sizeof(PackedLogPageBuffer), 0u);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+IoRingLogFollowerDriver::~IoRingLogFollowerDriver() noexcept
+{
+  this->close().IgnoreError();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingLogFollowerDriver::set_trim_pos(slot_offset_type trim_pos)
+{
+  // The writer owns the log file; trimming a follower only lets it reuse its own ring buffer.
+  //
+  clamp_min_slot(this->trim_pos_, trim_pos);
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+slot_offset_type IoRingLogFollowerDriver::get_trim_pos() const
+{
+  return this->trim_pos_.get_value();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<slot_offset_type> IoRingLogFollowerDriver::await_trim_pos(slot_offset_type min_offset)
+{
+  StatusOr<slot_offset_type> result = await_slot_offset(min_offset, this->trim_pos_);
+  if (!result.ok() && this->fell_behind_.load()) {
+    return make_status(StatusCode::kLogFollowerFellBehind);
+  }
+  return result;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+slot_offset_type IoRingLogFollowerDriver::get_flush_pos() const
+{
+  return this->flush_pos_.get_value();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<slot_offset_type> IoRingLogFollowerDriver::await_flush_pos(slot_offset_type min_offset)
+{
+  StatusOr<slot_offset_type> result = await_slot_offset(min_offset, this->flush_pos_);
+  if (!result.ok() && this->fell_behind_.load()) {
+    return make_status(StatusCode::kLogFollowerFellBehind);
+  }
+  return result;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingLogFollowerDriver::set_commit_pos(slot_offset_type /*commit_pos*/)
+{
+  return make_status(StatusCode::kLogDeviceReadOnly);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+slot_offset_type IoRingLogFollowerDriver::get_commit_pos() const
+{
+  return this->commit_pos_.get_value();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<slot_offset_type> IoRingLogFollowerDriver::await_commit_pos(slot_offset_type min_offset)
+{
+  StatusOr<slot_offset_type> result = await_slot_offset(min_offset, this->commit_pos_);
+  if (!result.ok() && this->fell_behind_.load()) {
+    return make_status(StatusCode::kLogFollowerFellBehind);
+  }
+  return result;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingLogFollowerDriver::open()
+{
+  BATT_CHECK(!this->poll_task_);
+
+  // The first poll only establishes the starting position; data is published by the second.
+  //
+  BATT_REQUIRE_OK(this->poll());
+  BATT_REQUIRE_OK(this->poll());
+
+  if (this->options_.poll_interval_ms == 0) {
+    return OkStatus();
+  }
+
+  this->poll_task_.emplace(
+      this->scheduler_.schedule_task(),
+      [this] {
+        this->poll_task_main();
+      },
+      batt::to_string(this->options_.name, "_PollTask"));
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingLogFollowerDriver::close()
+{
+  this->halt_requested_.store(true);
+
+  this->trim_pos_.close();
+  this->flush_pos_.close();
+  this->commit_pos_.close();
+
+  if (this->poll_task_) {
+    this->poll_task_->join();
+    this->poll_task_ = None;
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingLogFollowerDriver::poll()
+{
+  auto last_observed_data_end = this->last_observed_data_end_.lock();
+
+  if (!*last_observed_data_end) {
+    // Nothing is published yet, so it is safe for the scan to write the whole ring buffer.
+    //
+    IoRingLogRecovery recovery{
+        this->config_, this->context_.buffer_,
+        /*read_data_fn=*/[this](i64 file_offset, MutableBuffer buffer) -> Status {
+          this->metrics_.block_read_count.add(1);
+          return this->file_.read_all(file_offset + this->config_.physical_offset, buffer);
+        }};
+
+    BATT_REQUIRE_OK(recovery.run()) << BATT_INSPECT(this->options_.name);
+
+    const slot_offset_type writer_trim_pos = recovery.get_trim_pos();
+
+    this->trim_pos_.set_value(writer_trim_pos);
+    this->flush_pos_.set_value(writer_trim_pos);
+    this->commit_pos_.set_value(writer_trim_pos);
+    *last_observed_data_end = recovery.get_flush_pos();
+
+    return OkStatus();
+  }
+
+  const slot_offset_type trim_pos = this->trim_pos_.get_value();
+  const slot_offset_type flush_pos = this->flush_pos_.get_value();
+
+  // Don't copy anything that would overwrite data at or after the local trim pos.
+  //
+  const slot_offset_type buffer_end = trim_pos + this->context_.buffer_.size();
+
+  // Blocks before the one containing the flush pos are full and already published, so start there
+  // and read forward until a block that is not full (the writer's current block).
+  //
+  const usize block_capacity = this->config_.block_capacity();
+
+  Optional<slot_offset_type> writer_trim_pos;
+  slot_offset_type data_end = flush_pos;
+
+  for (u64 block_i = flush_pos / block_capacity;; ++block_i) {
+    const slot_offset_type block_begin = block_i * block_capacity;
+    if (!slot_less_than(block_begin, buffer_end)) {
+      break;
+    }
+
+    BATT_REQUIRE_OK(this->read_block(block_i));
+
+    const PackedLogPageHeader& header = this->block_header();
+    clamp_min_slot(&writer_trim_pos, header.trim_pos);
+
+    // If the block is from an earlier pass over the file, the writer hasn't reached it yet; if it
+    // is from a later pass, the trim pos check below will fail.
+    //
+    if (header.slot_offset != block_begin) {
+      break;
+    }
+
+    const slot_offset_type block_data_end = block_begin + header.commit_size;
+    if (slot_less_than(data_end, block_data_end)) {
+      const slot_offset_type copy_end = slot_min(block_data_end, buffer_end);
+      const ConstBuffer src{reinterpret_cast<const u8*>(&header + 1) + (data_end - block_begin),
+                            slot_distance(data_end, copy_end)};
+
+      std::memcpy(this->context_.buffer_.get_mut(data_end).data(), src.data(), src.size());
+      data_end = copy_end;
+    }
+
+    if (header.commit_size < block_capacity || data_end != block_data_end) {
+      break;
+    }
+  }
+
+  if (writer_trim_pos && slot_less_than(trim_pos, *writer_trim_pos)) {
+    LLFS_LOG_WARNING() << "The log was trimmed past the follower's trim pos;"
+                       << BATT_INSPECT(this->options_.name) << BATT_INSPECT(trim_pos)
+                       << BATT_INSPECT(writer_trim_pos);
+
+    this->fell_behind_.store(true);
+    this->halt_requested_.store(true);
+    this->trim_pos_.close();
+    this->flush_pos_.close();
+    this->commit_pos_.close();
+
+    return make_status(StatusCode::kLogFollowerFellBehind);
+  }
+
+  // Publish only data that the previous poll also saw as flushed: a block can be read while the
+  // writer is rewriting it, but bytes that were already flushed never change.  Then back off to
+  // the last complete slot.
+  //
+  const slot_offset_type stable_end = slot_min(data_end, **last_observed_data_end);
+
+  *last_observed_data_end = data_end;
+
+  if (!slot_less_than(flush_pos, stable_end)) {
+    return OkStatus();
+  }
+
+  slot_offset_type new_flush_pos = flush_pos;
+  ConstBuffer unscanned = resize_buffer(this->context_.buffer_.get(flush_pos),
+                                        slot_distance(flush_pos, stable_end));
+  for (;;) {
+    DataReader reader{unscanned};
+    const usize bytes_available_before = reader.bytes_available();
+    const Optional<u64> slot_body_size = reader.read_varint();
+    if (!slot_body_size) {
+      break;
+    }
+
+    const usize slot_size = (bytes_available_before - reader.bytes_available()) + *slot_body_size;
+    if (slot_size > unscanned.size()) {
+      break;
+    }
+
+    unscanned += slot_size;
+    new_flush_pos += slot_size;
+  }
+
+  if (new_flush_pos != flush_pos) {
+    this->commit_pos_.set_value(new_flush_pos);
+    this->flush_pos_.set_value(new_flush_pos);
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingLogFollowerDriver::read_block(u64 logical_block_index)
+{
+  const u64 physical_block_index = logical_block_index % this->config_.block_count();
+  const i64 file_offset =
+      this->config_.physical_offset +
+      BATT_CHECKED_CAST(i64, physical_block_index * this->config_.block_size());
+
+  this->metrics_.block_read_count.add(1);
+
+  BATT_REQUIRE_OK(this->file_.read_all(
+      file_offset, MutableBuffer{this->block_storage_.get(), this->config_.block_size()}));
+
+  const PackedLogPageHeader& header = this->block_header();
+  if (header.magic != PackedLogPageHeader::kMagic) {
+    return make_status(StatusCode::kLogBlockBadMagic);
+  }
+  if (header.commit_size > this->config_.block_capacity()) {
+    return make_status(StatusCode::kLogBlockCommitSizeOverflow);
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+const PackedLogPageHeader& IoRingLogFollowerDriver::block_header() const
+{
+  return this->block_storage_[0].header;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void IoRingLogFollowerDriver::poll_task_main()
+{
+  while (!this->halt_requested_.load()) {
+    batt::Task::sleep(boost::posix_time::milliseconds(this->options_.poll_interval_ms));
+    if (this->halt_requested_.load()) {
+      break;
+    }
+
+    Status status = this->poll();
+    if (!status.ok()) {
+      if (this->fell_behind_.load()) {
+        break;
+      }
+      // A block may have been read while the writer was rewriting it; try again next time.
+      //
+      LLFS_VLOG(1) << "IoRingLogFollowerDriver::poll failed;" << BATT_INSPECT(this->options_.name)
+                   << BATT_INSPECT(status);
+    }
+  }
+}
+
+}  // namespace llfs
+
+#endif  // LLFS_DISABLE_IO_URING
@@ -0,0 +1,190 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_IORING_LOG_FOLLOWER_DRIVER_HPP
+#define LLFS_IORING_LOG_FOLLOWER_DRIVER_HPP
+
+#include <llfs/config.hpp>
+
+#ifndef LLFS_DISABLE_IO_URING
+
+#include <llfs/basic_log_storage_driver.hpp>
+#include <llfs/basic_ring_buffer_log_device.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/ioring.hpp>
+#include <llfs/ioring_log_config.hpp>
+#include <llfs/metrics.hpp>
+#include <llfs/optional.hpp>
+#include <llfs/packed_log_page_buffer.hpp>
+#include <llfs/slot.hpp>
+#include <llfs/status.hpp>
+
+#include <batteries/async/mutex.hpp>
+#include <batteries/async/task.hpp>
+#include <batteries/async/task_scheduler.hpp>
+#include <batteries/async/watch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace llfs {
+
+class IoRingLogFollowerDriver;
+
+using IoRingLogFollowerDevice = BasicRingBufferLogDevice<IoRingLogFollowerDriver>;
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+//
+struct IoRingLogFollowerOptions {
+  // The debug name of this log.
+  //
+  std::string name = "(anonymous log follower)";
+
+  // How often to re-read the log file to look for newly flushed data.  If 0, there is no background
+  // polling; the follower only catches up when `IoRingLogFollowerDriver::poll()` is called.
+  //
+  u64 poll_interval_ms = 10;
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief Read-only log storage driver that tails an IoRing log written by another process.
+ *
+ * When opened, the whole log is read using the same block scan as log recovery.  After that, every
+ * `poll_interval_ms` the driver reads only the blocks that may hold data it has not yet published:
+ * the (partially filled) block at the local flush pos and any full blocks after it.  Newly flushed
+ * data is appended to the local ring buffer; readers see it as a normal durable log that grows over
+ * time.  Nothing is ever written to the file: `set_commit_pos` fails with
+ * StatusCode::kLogDeviceReadOnly, and `set_trim_pos` only releases the follower's local copy of the
+ * data.
+ *
+ * A block can be read while the writer is in the middle of rewriting it, so data is only published
+ * once two consecutive polls agree that it has been flushed.  If the writer trims the log past the
+ * follower's (local) trim pos, the follower can no longer trust what it holds: the driver stops
+ * and waiters see StatusCode::kLogFollowerFellBehind.  Writers are expected to hold a trim
+ * lock on behalf of their followers to prevent this; see VolumeFollower.
+ */
+class IoRingLogFollowerDriver
+{
+ public:
+  struct Metrics {
+    // The number of log blocks read from the file, including those read by the initial scan.
+    //
+    CountMetric<u64> block_read_count{0};
+  };
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  explicit IoRingLogFollowerDriver(LogStorageDriverContext& context, IoRing::File&& file,
+                                   const IoRingLogConfig& config, batt::TaskScheduler& scheduler,
+                                   const IoRingLogFollowerOptions& options) noexcept;
+
+  ~IoRingLogFollowerDriver() noexcept;
+
+  IoRingLogFollowerDriver(const IoRingLogFollowerDriver&) = delete;
+  IoRingLogFollowerDriver& operator=(const IoRingLogFollowerDriver&) = delete;
+
+  //----
+
+  Status set_trim_pos(slot_offset_type trim_pos);
+
+  slot_offset_type get_trim_pos() const;
+
+  StatusOr<slot_offset_type> await_trim_pos(slot_offset_type min_offset);
+
+  //----
+
+  slot_offset_type get_flush_pos() const;
+
+  StatusOr<slot_offset_type> await_flush_pos(slot_offset_type min_offset);
+
+  //----
+
+  Status set_commit_pos(slot_offset_type commit_pos);
+
+  slot_offset_type get_commit_pos() const;
+
+  StatusOr<slot_offset_type> await_commit_pos(slot_offset_type min_offset);
+
+  //----
+
+  /** \brief Reads the current contents of the log and starts the background poll task.
+   */
+  Status open();
+
+  Status close();
+
+  /** \brief Re-reads the log file once, publishing any newly flushed data.  This is done
+   * periodically by the poll task, but can also be called directly to catch up immediately.
+   */
+  Status poll();
+
+  const Metrics& metrics() const
+  {
+    return this->metrics_;
+  }
+
+ private:
+  // Reads the block with the given logical index into `block_storage_`.
+  //
+  Status read_block(u64 logical_block_index);
+
+  const PackedLogPageHeader& block_header() const;
+
+  void poll_task_main();
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The ring buffer state.
+  //
+  LogStorageDriverContext& context_;
+
+  // The log file, opened read-only.
+  //
+  IoRing::File file_;
+
+  const IoRingLogConfig config_;
+
+  batt::TaskScheduler& scheduler_;
+
+  const IoRingLogFollowerOptions options_;
+
+  Metrics metrics_;
+
+  // The memory used to load individual log blocks.
+  //
+  std::unique_ptr<PackedLogPageBuffer[]> block_storage_;
+
+  // The end of the contiguous flushed data found by the previous poll (None until the initial scan
+  // is done); this mutex also serializes calls to `poll()`.
+  //
+  // Data is copied to `context_.buffer_` as soon as it is read, but only at or after the local
+  // flush pos, so bytes that readers may be looking at are never rewritten.
+  //
+  batt::Mutex<Optional<slot_offset_type>> last_observed_data_end_;
+
+  // Local log offset pointers; commit_pos_ always equals flush_pos_.
+  //
+  batt::Watch<slot_offset_type> trim_pos_{0};
+  batt::Watch<slot_offset_type> flush_pos_{0};
+  batt::Watch<slot_offset_type> commit_pos_{0};
+
+  std::atomic<bool> halt_requested_{false};
+
+  // Set (before the offset Watches are closed) if the writer trimmed past `trim_pos_`.
+  //
+  std::atomic<bool> fell_behind_{false};
+
+  Optional<batt::Task> poll_task_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_DISABLE_IO_URING
+#endif  // LLFS_IORING_LOG_FOLLOWER_DRIVER_HPP
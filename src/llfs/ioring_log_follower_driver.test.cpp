@@ -0,0 +1,255 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/ioring_log_follower_driver.hpp>
+//
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/ioring.hpp>
+#include <llfs/log_device_config.hpp>
+#include <llfs/status_code.hpp>
+#include <llfs/storage_context.hpp>
+#include <llfs/uuid.hpp>
+#include <llfs/varint.hpp>
+
+#include <batteries/async/runtime.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+using namespace batt::int_types;
+using namespace batt::constants;
+
+const std::filesystem::path kLogFilePath{"/tmp/llfs_IoRingLogFollowerDriverTest_StorageFile.llfs"};
+
+constexpr usize kLogTotalSize = 16 * kKiB;
+constexpr usize kLogPagesPerBlockLog2 = 1;
+
+class IoRingLogFollowerDriverTest : public ::testing::Test
+{
+ public:
+  void SetUp() override
+  {
+    std::filesystem::remove_all(kLogFilePath);
+    ASSERT_FALSE(std::filesystem::exists(kLogFilePath));
+
+    auto scoped_ioring =
+        llfs::ScopedIoRing::make_new(llfs::MaxQueueDepth{256}, llfs::ThreadPoolSize{1});
+    ASSERT_TRUE(scoped_ioring.ok()) << BATT_INSPECT(scoped_ioring.status());
+    this->ioring_.emplace(std::move(*scoped_ioring));
+
+    this->storage_context_ = batt::make_shared<llfs::StorageContext>(
+        batt::Runtime::instance().default_scheduler(), this->ioring_->get_io_ring());
+
+    batt::Status add_file_status = this->storage_context_->add_new_file(
+        kLogFilePath, [&](llfs::StorageFileBuilder& builder) -> batt::Status {
+          BATT_REQUIRE_OK(builder.add_object(llfs::LogDeviceConfigOptions{
+              .uuid = this->log_uuid_,
+              .pages_per_block_log2 = kLogPagesPerBlockLog2,
+              .log_size = kLogTotalSize,
+          }));
+          return batt::OkStatus();
+        });
+    ASSERT_TRUE(add_file_status.ok()) << BATT_INSPECT(add_file_status);
+
+    batt::StatusOr<std::unique_ptr<llfs::IoRingLogDeviceFactory>> factory =
+        this->storage_context_->recover_object(
+            batt::StaticType<llfs::PackedLogDeviceConfig>{}, this->log_uuid_,
+            llfs::IoRingLogDriverOptions::with_default_values().set_name("writer_log"));
+    ASSERT_TRUE(factory.ok()) << BATT_INSPECT(factory.status());
+
+    batt::StatusOr<std::unique_ptr<llfs::IoRingLogDevice>> writer_log =
+        (*factory)->open_ioring_log_device();
+    ASSERT_TRUE(writer_log.ok()) << BATT_INSPECT(writer_log.status());
+    this->writer_log_ = std::move(*writer_log);
+  }
+
+  void TearDown() override
+  {
+    if (this->writer_log_) {
+      this->writer_log_->close().IgnoreError();
+    }
+    std::filesystem::remove_all(kLogFilePath);
+  }
+
+  // Appends a slot of `n` bytes (including the slot header), filled with `ch`, to the writer's log
+  // and waits for it to be flushed.
+  //
+  void append(char ch, usize n)
+  {
+    llfs::LogDevice::Writer& writer = this->writer_log_->writer();
+
+    batt::StatusOr<llfs::MutableBuffer> buffer = writer.prepare(n);
+    ASSERT_TRUE(buffer.ok()) << BATT_INSPECT(buffer.status());
+
+    usize header_size = 1;
+    while (llfs::packed_sizeof_varint(n - header_size) != header_size) {
+      ++header_size;
+    }
+
+    u8* const first = static_cast<u8*>(buffer->data());
+    std::memset(first, ch, n);
+    ASSERT_NE(llfs::pack_varint_to(first, first + header_size, n - header_size), nullptr);
+
+    this->expected_.append(reinterpret_cast<const char*>(first), n);
+
+    batt::StatusOr<llfs::slot_offset_type> commit_pos = writer.commit(n);
+    ASSERT_TRUE(commit_pos.ok()) << BATT_INSPECT(commit_pos.status());
+
+    batt::Status sync_status =
+        this->writer_log_->sync(llfs::LogReadMode::kDurable, llfs::SlotUpperBoundAt{*commit_pos});
+    ASSERT_TRUE(sync_status.ok()) << BATT_INSPECT(sync_status);
+  }
+
+  batt::StatusOr<std::unique_ptr<llfs::IoRingLogFollowerDevice>> open_follower(
+      u64 poll_interval_ms = 1)
+  {
+    return this->storage_context_->recover_object(batt::StaticType<llfs::PackedLogDeviceConfig>{},
+                                                  this->log_uuid_,
+                                                  llfs::IoRingLogFollowerOptions{
+                                                      .name = "follower_log",
+                                                      .poll_interval_ms = poll_interval_ms,
+                                                  });
+  }
+
+  // Returns the data visible to a new reader of `log`, starting at `slot_offset`.
+  //
+  static std::string read_all(llfs::LogDevice& log, llfs::slot_offset_type slot_offset)
+  {
+    std::unique_ptr<llfs::LogDevice::Reader> reader =
+        log.new_reader(slot_offset, llfs::LogReadMode::kDurable);
+    const llfs::ConstBuffer data = reader->data();
+    return std::string{static_cast<const char*>(data.data()), data.size()};
+  }
+
+  const boost::uuids::uuid log_uuid_ = llfs::random_uuid();
+
+  llfs::Optional<llfs::ScopedIoRing> ioring_;
+
+  batt::SharedPtr<llfs::StorageContext> storage_context_;
+
+  std::unique_ptr<llfs::IoRingLogDevice> writer_log_;
+
+  // The contents of the writer's log, starting at slot offset 0.
+  //
+  std::string expected_;
+};
+
+TEST_F(IoRingLogFollowerDriverTest, FollowsNewData)
+{
+  ASSERT_NO_FATAL_FAILURE(this->append('a', 100));
+
+  batt::StatusOr<std::unique_ptr<llfs::IoRingLogFollowerDevice>> follower = this->open_follower();
+  ASSERT_TRUE(follower.ok()) << BATT_INSPECT(follower.status());
+
+  EXPECT_EQ((*follower)->slot_range(llfs::LogReadMode::kDurable), (llfs::SlotRange{0, 100}));
+  EXPECT_EQ(read_all(**follower, 0), this->expected_);
+
+  // New data shows up without re-opening the follower.
+  //
+  ASSERT_NO_FATAL_FAILURE(this->append('b', 1500));
+
+  batt::Status sync_status = (*follower)->sync(llfs::LogReadMode::kDurable,
+                                               llfs::SlotUpperBoundAt{this->expected_.size()});
+  ASSERT_TRUE(sync_status.ok()) << BATT_INSPECT(sync_status);
+
+  EXPECT_EQ(read_all(**follower, 0), this->expected_);
+
+  // The follower can not write.
+  //
+  llfs::LogDevice::Writer& follower_writer = (*follower)->writer();
+  batt::StatusOr<llfs::MutableBuffer> buffer = follower_writer.prepare(10);
+  ASSERT_TRUE(buffer.ok());
+  EXPECT_EQ(follower_writer.commit(10).status(), llfs::StatusCode::kLogDeviceReadOnly);
+}
+
+TEST_F(IoRingLogFollowerDriverTest, PollReadsOnlyNewBlocks)
+{
+  ASSERT_NO_FATAL_FAILURE(this->append('a', 100));
+
+  batt::StatusOr<std::unique_ptr<llfs::IoRingLogFollowerDevice>> follower =
+      this->open_follower(/*poll_interval_ms=*/0);
+  ASSERT_TRUE(follower.ok()) << BATT_INSPECT(follower.status());
+
+  llfs::IoRingLogFollowerDriver& driver = (*follower)->driver().impl();
+
+  const auto poll_and_count_blocks = [&driver] {
+    const u64 before = driver.metrics().block_read_count.load();
+    batt::Status status = driver.poll();
+    BATT_CHECK_OK(status);
+    return driver.metrics().block_read_count.load() - before;
+  };
+
+  // With no new data, only the block at the flush pos is read.
+  //
+  EXPECT_EQ(poll_and_count_blocks(), 1u);
+  EXPECT_EQ(poll_and_count_blocks(), 1u);
+
+  // New data spanning several blocks is read (twice, since it is only published once two polls
+  // agree on it), and after that the follower goes back to reading just the last block.
+  //
+  ASSERT_NO_FATAL_FAILURE(this->append('b', 3000));
+
+  const usize block_capacity =
+      (llfs::kLogPageSize << kLogPagesPerBlockLog2) - sizeof(llfs::PackedLogPageHeader);
+  const u64 new_block_count = this->expected_.size() / block_capacity + 1;
+  ASSERT_GT(new_block_count, 2u);
+
+  EXPECT_EQ(poll_and_count_blocks(), new_block_count);
+  EXPECT_EQ((*follower)->slot_range(llfs::LogReadMode::kDurable), (llfs::SlotRange{0, 100}));
+
+  EXPECT_EQ(poll_and_count_blocks(), new_block_count);
+  EXPECT_EQ((*follower)->slot_range(llfs::LogReadMode::kDurable),
+            (llfs::SlotRange{0, this->expected_.size()}));
+  EXPECT_EQ(read_all(**follower, 0), this->expected_);
+
+  EXPECT_EQ(poll_and_count_blocks(), 1u);
+}
+
+TEST_F(IoRingLogFollowerDriverTest, WriterTrimPastFollower)
+{
+  ASSERT_NO_FATAL_FAILURE(this->append('a', 1000));
+
+  batt::StatusOr<std::unique_ptr<llfs::IoRingLogFollowerDevice>> follower = this->open_follower();
+  ASSERT_TRUE(follower.ok()) << BATT_INSPECT(follower.status());
+
+  // Trimming the writer up to the follower's (local) trim pos is fine.
+  //
+  ASSERT_TRUE((*follower)->trim(500).ok());
+  ASSERT_TRUE(this->writer_log_->trim(400).ok());
+  ASSERT_NO_FATAL_FAILURE(this->append('b', 100));
+
+  batt::Status sync_status = (*follower)->sync(llfs::LogReadMode::kDurable,
+                                               llfs::SlotUpperBoundAt{this->expected_.size()});
+  ASSERT_TRUE(sync_status.ok()) << BATT_INSPECT(sync_status);
+
+  EXPECT_EQ(read_all(**follower, 500), this->expected_.substr(500));
+
+  // Trimming past it is detected.
+  //
+  ASSERT_TRUE(this->writer_log_->trim(600).ok());
+  ASSERT_NO_FATAL_FAILURE(this->append('c', 100));
+
+  // The new trim pos may land in the log file after the data; keep polling until it shows up.
+  //
+  batt::Status poll_status;
+  for (usize i = 0; i < 100 && poll_status.ok(); ++i) {
+    poll_status = (*follower)->driver().impl().poll();
+  }
+  EXPECT_EQ(poll_status, llfs::StatusCode::kLogFollowerFellBehind);
+  EXPECT_EQ((*follower)->sync(llfs::LogReadMode::kDurable,
+                              llfs::SlotUpperBoundAt{this->expected_.size() + 1}),
+            llfs::StatusCode::kLogFollowerFellBehind);
+}
+
+}  // namespace
@@ -18,10 +18,12 @@ namespace llfs {
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 /*explicit*/ IoRingLogRecovery::IoRingLogRecovery(const IoRingLogConfig& config,
-                                                  RingBuffer& ring_buffer, ReadDataFn&& read_data)
+                                                  RingBuffer& ring_buffer, ReadDataFn&& read_data,
+                                                  bool raw_data)
     : config_{config}
     , ring_buffer_{ring_buffer}
     , read_data_{std::move(read_data)}
+    , raw_data_{raw_data}
     , block_storage_{
           new PackedLogPageBuffer[this->config_.block_size() / sizeof(PackedLogPageBuffer)]}
 {
@@ -246,6 +248,14 @@ void IoRingLogRecovery::recover_flush_pos()
         << "SlotIntervalMap should have merged these two intervals!";
   }
 
+  // Raw data has no slot boundaries to respect; everything up to the first gap is valid.
+  //
+  if (this->raw_data_) {
+    this->flush_pos_ = slot_offset + committed_ranges.front().offset_range.size();
+    LLFS_VLOG(1) << " -- Raw data;" << BATT_INSPECT(this->flush_pos_);
+    return;
+  }
+
   constexpr usize kUpdateCadence = 500;
 
   ConstBuffer committed_bytes = resize_buffer(this->ring_buffer_.get(slot_offset),
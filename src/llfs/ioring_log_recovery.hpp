@@ -31,8 +31,14 @@ class IoRingLogRecovery
  public:
   using ReadDataFn = std::function<Status(i64 file_offset, MutableBuffer dst_buffer)>;
 
+  /** \brief Creates a recovery for the log described by `config`.
+   *
+   * If `raw_data` is true, the log is not framed as slots, so the recovered flush pos is the end of
+   * the contiguous durable data after the trim pos; otherwise it is the end of the last complete
+   * slot in that range.
+   */
   explicit IoRingLogRecovery(const IoRingLogConfig& config, RingBuffer& ring_buffer,
-                             ReadDataFn&& read_data);
+                             ReadDataFn&& read_data, bool raw_data = false);
 
   Status run();
 
@@ -73,6 +79,10 @@ class IoRingLogRecovery
   //
   ReadDataFn read_data_;
 
+  // See the constructor.
+  //
+  const bool raw_data_;
+
   // The maximum trim_pos field value read from all valid block headers.
   //
   Optional<slot_offset_type> trim_pos_;
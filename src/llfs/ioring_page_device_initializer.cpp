@@ -0,0 +1,73 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/ioring_page_device_initializer.hpp>
+//
+
+#include <llfs/ioring_page_device_initializer.ipp>
+#include <llfs/logging.hpp>
+#include <llfs/packed_page_header.hpp>
+
+#include <batteries/metrics/metric_collectors.hpp>
+
+namespace llfs {
+
+template class BasicIoRingPageDeviceInitializer<IoRing>;
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status initialize_page_device_headers(RawBlockFile& file, i64 page_0_offset, i64 page_size,
+                                      u64 page_count, usize max_concurrency)
+{
+  LLFS_VLOG(1) << "initializing page headers; " << BATT_INSPECT(page_0_offset)
+               << BATT_INSPECT(page_size) << BATT_INSPECT(page_count);
+
+  batt::LatencyMetric page_write_latency;
+  {
+    batt::LatencyTimer page_write_timer{page_write_latency, page_count};
+
+    IoRing::File* ioring_file = file.get_io_ring_file();
+
+    if (ioring_file) {
+      const usize n_tasks = std::max<u64>(
+          1, std::min<u64>(max_concurrency,
+                           IoRingPageDeviceInitializer::get_run_count(page_size, page_count)));
+
+      IoRingPageDeviceInitializer initializer{n_tasks, *ioring_file, page_0_offset, page_size,
+                                              page_count};
+
+      Status init_status = initializer.run();
+      BATT_REQUIRE_OK(init_status);
+
+    } else {
+      LLFS_LOG_INFO() << "Using slow path for page device initialization";
+
+      std::aligned_storage_t<512, 512> buffer;
+      std::memset(&buffer, 0, sizeof(buffer));
+
+      auto& page_header = reinterpret_cast<PackedPageHeader&>(buffer);
+      page_header.magic = PackedPageHeader::kMagic;
+      page_header.crc32 = PackedPageHeader::kCrc32NotSet;
+      page_header.page_id = PackedPageId{.id_val = kInvalidPageId};
+
+      for (u64 page_i = 0; page_i < page_count; ++page_i) {
+        const i64 page_offset = page_0_offset + page_i * page_size;
+        LLFS_DVLOG(1) << "writing null page header | " << BATT_INSPECT(page_i)
+                      << BATT_INSPECT(page_offset);
+        Status status = write_all(file, page_offset, ConstBuffer{&buffer, sizeof(buffer)});
+        BATT_REQUIRE_OK(status);
+      }
+    }
+  }  // LatencyTimer
+
+  LLFS_VLOG(1) << "Success! " << page_write_latency.rate_per_second() << " pages/sec";
+
+  return OkStatus();
+}
+
+}  // namespace llfs
@@ -0,0 +1,161 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_IORING_PAGE_DEVICE_INITIALIZER_HPP
+#define LLFS_IORING_PAGE_DEVICE_INITIALIZER_HPP
+
+#include <llfs/buffer.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/ioring.hpp>
+#include <llfs/raw_block_file.hpp>
+
+#include <batteries/async/handler.hpp>
+#include <batteries/async/watch.hpp>
+#include <batteries/status.hpp>
+
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+namespace llfs {
+
+// Write a null PackedPageHeader to the start of each page in the given region of `file`.  If
+// `file` is backed by an IoRing, the headers are written in parallel by up to `max_concurrency`
+// outstanding I/Os; otherwise each header is written synchronously in order.
+//
+Status initialize_page_device_headers(RawBlockFile& file, i64 page_0_offset, i64 page_size,
+                                      u64 page_count, usize max_concurrency = 1024);
+
+template <typename IoRingImpl>
+class BasicIoRingPageDeviceInitializer;
+
+using IoRingPageDeviceInitializer = BasicIoRingPageDeviceInitializer<IoRing>;
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+//
+template <typename IoRingImpl>
+class BasicIoRingPageDeviceInitializer
+{
+ public:
+  // The number of bytes written per page (the rest of the page is left untouched).
+  //
+  static constexpr usize kHeaderBlockSize = 512;
+
+  // When pages are exactly `kHeaderBlockSize` bytes, consecutive headers are contiguous on the
+  // device; in this case up to this many headers are combined into a single vectored write.
+  //
+  static constexpr usize kMaxHeadersPerWrite = 16;
+
+  using HeaderBlock = std::aligned_storage_t<kHeaderBlockSize, 512>;
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+  //
+  struct Subtask {
+    // The BasicIoRingPageDeviceInitializer object to which this Subtask belongs.
+    //
+    BasicIoRingPageDeviceInitializer* that = nullptr;
+
+    // The current destination file offset to which this Subtask is writing.
+    //
+    i64 file_offset = 0;
+
+    // The (exclusive) upper bound of the current run of header bytes being written.
+    //
+    i64 end_offset = 0;
+
+    // Scratch space for building the vectored write buffer list; reserved up front so that no
+    // allocation happens per write.
+    //
+    std::vector<ConstBuffer> buffers;
+
+    // Embedded memory for handler-related allocation.
+    //
+    batt::HandlerMemory<512> handler_memory;
+
+    // Used to aggregate the success/error disposition of the initializer.  Should be set only once
+    // per Subtask.
+    //
+    batt::Status final_status;
+
+    // Set to `true` once the Subtask finishes.
+    //
+    bool done = false;
+
+    //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+    void start_write();
+
+    void handle_write(const batt::StatusOr<i32>& n_written);
+
+    void finish(const batt::Status& status);
+
+    usize self_index() const;
+  };
+
+  // Returns the number of units of work (runs of contiguous headers) needed to initialize
+  // `page_count` pages of size `page_size`; this is the maximum useful number of Subtasks.
+  //
+  static u64 get_run_count(i64 page_size, u64 page_count);
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  explicit BasicIoRingPageDeviceInitializer(usize n_tasks, typename IoRingImpl::File& file,
+                                            i64 page_0_offset, i64 page_size,
+                                            u64 page_count) noexcept;
+
+  batt::Status run();
+
+  // Returns the number of units of work to be distributed amongst the Subtasks.
+  //
+  u64 run_count() const;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+ private:
+  // Returns true iff page headers are adjacent to each other in the file.
+  //
+  bool headers_are_contiguous() const;
+
+  // The file to which this initializer is writing page headers.
+  //
+  typename IoRingImpl::File& file_;
+
+  // The file offset of the first page.
+  //
+  i64 page_0_offset_;
+
+  // The size of each page in bytes.
+  //
+  i64 page_size_;
+
+  // The number of pages to initialize.
+  //
+  u64 page_count_;
+
+  // The null page header; this is shared (read-only) by all Subtasks.
+  //
+  HeaderBlock header_block_;
+
+  // The next run index which hasn't been assigned to a Subtask; used by the Subtasks to coordinate
+  // the distribution of work.
+  //
+  std::atomic<u64> next_run_i_{0};
+
+  // Subtasks are responsible to increment this variable by 1 when they are finished; this is how
+  // the initializer knows when we are done.
+  //
+  batt::Watch<usize> finished_count_{0};
+
+  // The Subtask states.
+  //
+  std::vector<Subtask> subtasks_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_IORING_PAGE_DEVICE_INITIALIZER_HPP
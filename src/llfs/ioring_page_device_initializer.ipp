@@ -0,0 +1,211 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_IORING_PAGE_DEVICE_INITIALIZER_IPP
+#define LLFS_IORING_PAGE_DEVICE_INITIALIZER_IPP
+
+#include <llfs/packed_page_header.hpp>
+
+#include <cstring>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+/*explicit*/ inline BasicIoRingPageDeviceInitializer<IoRingImpl>::BasicIoRingPageDeviceInitializer(
+    usize n_tasks, typename IoRingImpl::File& file, i64 page_0_offset, i64 page_size,
+    u64 page_count) noexcept
+    : file_{file}
+    , page_0_offset_{page_0_offset}
+    , page_size_{page_size}
+    , page_count_{page_count}
+    , subtasks_(n_tasks)
+{
+  BATT_CHECK_GE(this->page_size_, static_cast<i64>(kHeaderBlockSize));
+
+  std::memset(&this->header_block_, 0, sizeof(this->header_block_));
+
+  auto& page_header = reinterpret_cast<PackedPageHeader&>(this->header_block_);
+  page_header.magic = PackedPageHeader::kMagic;
+  page_header.crc32 = PackedPageHeader::kCrc32NotSet;
+  page_header.page_id = PackedPageId{.id_val = kInvalidPageId};
+
+  for (auto& task : this->subtasks_) {
+    task.that = this;
+    task.buffers.reserve(kMaxHeadersPerWrite + 1);
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline u64 BasicIoRingPageDeviceInitializer<IoRingImpl>::get_run_count(i64 page_size,
+                                                                       u64 page_count)
+{
+  if (page_size == static_cast<i64>(kHeaderBlockSize)) {
+    return (page_count + kMaxHeadersPerWrite - 1) / kMaxHeadersPerWrite;
+  }
+  return page_count;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline bool BasicIoRingPageDeviceInitializer<IoRingImpl>::headers_are_contiguous() const
+{
+  return this->page_size_ == static_cast<i64>(kHeaderBlockSize);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline u64 BasicIoRingPageDeviceInitializer<IoRingImpl>::run_count() const
+{
+  return get_run_count(this->page_size_, this->page_count_);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline batt::Status BasicIoRingPageDeviceInitializer<IoRingImpl>::run()
+{
+  LLFS_VLOG(1) << "IoRingPageDeviceInitializer::run() Entered; "
+               << BATT_INSPECT(this->page_0_offset_) << BATT_INSPECT(this->page_size_)
+               << BATT_INSPECT(this->page_count_) << BATT_INSPECT(this->subtasks_.size());
+
+  auto on_scope_exit = batt::finally([&] {
+    LLFS_VLOG(1) << "IoRingPageDeviceInitializer::run() Finished";
+  });
+
+  for (auto& task : this->subtasks_) {
+    task.start_write();
+  }
+  Status all_finished = this->finished_count_.await_equal(this->subtasks_.size());
+  BATT_REQUIRE_OK(all_finished);
+
+  for (auto& task : this->subtasks_) {
+    BATT_REQUIRE_OK(task.final_status);
+  }
+
+  return OkStatus();
+}
+
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline void BasicIoRingPageDeviceInitializer<IoRingImpl>::Subtask::start_write()
+{
+  BasicIoRingPageDeviceInitializer* const that = this->that;
+
+  if (this->file_offset == this->end_offset) {
+    const u64 run_i = that->next_run_i_.fetch_add(1);
+
+    // If `run_i` is at or past the end of the device, we are done!  Increment the finished count
+    // and return.
+    //
+    if (run_i >= that->run_count()) {
+      LLFS_VLOG(2) << "[Subtask:" << this->self_index() << "] FINISHED (all headers written)";
+      this->finish(batt::OkStatus());
+      return;
+    }
+
+    // Calculate the byte range of the new run.
+    //
+    if (that->headers_are_contiguous()) {
+      const u64 first_page_i = run_i * kMaxHeadersPerWrite;
+      const u64 last_page_i = std::min<u64>(first_page_i + kMaxHeadersPerWrite, that->page_count_);
+
+      this->file_offset = that->page_0_offset_ + static_cast<i64>(first_page_i) * that->page_size_;
+      this->end_offset = that->page_0_offset_ + static_cast<i64>(last_page_i) * that->page_size_;
+    } else {
+      this->file_offset = that->page_0_offset_ + static_cast<i64>(run_i) * that->page_size_;
+      this->end_offset = this->file_offset + static_cast<i64>(kHeaderBlockSize);
+    }
+  }
+
+  // Build the list of buffers for the remainder of the current run; because all headers are
+  // identical, every buffer points at the same shared header block.
+  //
+  const ConstBuffer header{&that->header_block_, sizeof(HeaderBlock)};
+
+  this->buffers.clear();
+  {
+    i64 offset = this->file_offset;
+    while (offset < this->end_offset) {
+      const i64 offset_in_header = (offset - that->page_0_offset_) % that->page_size_;
+      const ConstBuffer part = header + offset_in_header;
+      this->buffers.emplace_back(part);
+      offset += part.size();
+    }
+  }
+
+  LLFS_VLOG(2) << "[Subtask:" << this->self_index() << "] async_write_some(offset="
+               << this->file_offset << ", buffers=[" << this->buffers.size() << "])";
+
+  that->file_.async_write_some(
+      this->file_offset, this->buffers,
+      batt::make_custom_alloc_handler(this->handler_memory,
+                                      [this](const batt::StatusOr<i32>& n_written) {
+                                        this->handle_write(n_written);
+                                      }));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline void BasicIoRingPageDeviceInitializer<IoRingImpl>::Subtask::handle_write(
+    const batt::StatusOr<i32>& n_written)
+{
+  if (!n_written.ok()) {
+    this->finish(n_written.status());
+    return;
+  }
+
+  BATT_CHECK_GE(*n_written, 0);
+
+  if (*n_written == 0) {
+    this->finish(batt::StatusCode::kDataLoss);
+    return;
+  }
+
+  this->file_offset += *n_written;
+  BATT_CHECK_LE(this->file_offset, this->end_offset);
+
+  this->start_write();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline void BasicIoRingPageDeviceInitializer<IoRingImpl>::Subtask::finish(
+    const batt::Status& status)
+{
+  BATT_CHECK(!this->done);
+
+  this->done = true;
+  this->final_status.Update(status);
+  const auto prior_finished_count = this->that->finished_count_.fetch_add(1);
+
+  LLFS_VLOG(2) << BATT_INSPECT(prior_finished_count);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename IoRingImpl>
+inline usize BasicIoRingPageDeviceInitializer<IoRingImpl>::Subtask::self_index() const
+{
+  return this - this->that->subtasks_.data();
+}
+
+}  // namespace llfs
+
+#endif  // LLFS_IORING_PAGE_DEVICE_INITIALIZER_IPP
@@ -13,16 +13,26 @@
 
 #ifndef LLFS_DISABLE_IO_URING
 
+#include <batteries/math.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include <fcntl.h>
+
 namespace llfs {
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 IoRingPageFileDevice::IoRingPageFileDevice(
-    IoRing::File&& file, const FileOffsetPtr<PackedPageDeviceConfig>& config) noexcept
+    IoRing::File&& file, const FileOffsetPtr<PackedPageDeviceConfig>& config,
+    bool exclusive_file) noexcept
     : file_{std::move(file)}
     , config_{config}
     , page_ids_{PageCount{batt::checked_cast<u32>(this->config_->page_count.value())},
                 this->config_->device_id}
+    , exclusive_file_{exclusive_file}
 {
 }
 
@@ -40,6 +50,37 @@ PageSize IoRingPageFileDevice::page_size()
   return PageSize{batt::checked_cast<u32>(this->config_->page_size())};
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingPageFileDevice::set_write_lifetime(PageWriteLifetime lifetime)
+{
+  // Write-life hints are tracked per inode by the kernel; setting one on a shared file would also
+  // apply it to the other objects' writes (e.g., the page allocator log).
+  //
+  if (!this->exclusive_file_) {
+    return batt::StatusCode::kFailedPrecondition;
+  }
+
+  u64 hint = [&]() -> u64 {
+    switch (lifetime) {
+      case PageWriteLifetime::kNotSet:
+        return RWH_WRITE_LIFE_NOT_SET;
+      case PageWriteLifetime::kShort:
+        return RWH_WRITE_LIFE_SHORT;
+      case PageWriteLifetime::kMedium:
+        return RWH_WRITE_LIFE_MEDIUM;
+      case PageWriteLifetime::kLong:
+        return RWH_WRITE_LIFE_LONG;
+      case PageWriteLifetime::kExtreme:
+        return RWH_WRITE_LIFE_EXTREME;
+    }
+    return RWH_WRITE_LIFE_NOT_SET;
+  }();
+
+  const int retval = ::fcntl(this->file_.get_fd(), F_SET_RW_HINT, &hint);
+  return batt::status_from_retval(retval);
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<std::shared_ptr<PageBuffer>> IoRingPageFileDevice::prepare(PageId page_id)
@@ -215,6 +256,192 @@ void IoRingPageFileDevice::read_some(PageId page_id, i64 page_offset_in_file,
       }));
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void IoRingPageFileDevice::read_range(PageId page_id, const Interval<u64>& byte_range,
+                                      ReadRangeHandler&& handler)
+{
+  LLFS_VLOG(1) << "IoRingPageFileDevice::read_range(page_id=" << page_id
+               << ", byte_range=" << byte_range << ")";
+
+  const PageSize page_size = this->page_size();
+
+  Status range_status = check_page_range(page_size, byte_range);
+  if (!range_status.ok()) {
+    handler(range_status);
+    return;
+  }
+
+  StatusOr<i64> page_offset_in_file = this->get_file_offset_of_page(page_id);
+  if (!page_offset_in_file.ok()) {
+    handler(page_offset_in_file.status());
+    return;
+  }
+
+  // Direct I/O requires block-aligned offsets and sizes.
+  //
+  constexpr i32 kAlignLog2 = IoRing::File::kBlockAlignmentLog2;
+  const u64 header_block_size = std::min<u64>(u64{1} << kAlignLog2, page_size);
+
+  // If the range starts in (or right after) the first block of the page, read the header along
+  // with it; one larger read is cheaper than two adjacent ones.
+  //
+  const u64 aligned_lower_bound = batt::round_down_bits(kAlignLog2, byte_range.lower_bound);
+
+  const Interval<u64> aligned_range{
+      (aligned_lower_bound <= header_block_size) ? 0 : aligned_lower_bound,
+      std::min<u64>(batt::round_up_bits(kAlignLog2, byte_range.upper_bound), page_size),
+  };
+
+  auto range_buffer = std::make_shared<PageRangeBuffer>(aligned_range);
+
+  if (aligned_range.lower_bound == 0) {
+    this->read_range_some(
+        *page_offset_in_file, std::move(range_buffer), /*n_read_so_far=*/0,
+        [this, page_id, handler = std::move(handler)](
+            StatusOr<std::shared_ptr<PageRangeBuffer>> result) mutable {
+          if (!result.ok()) {
+            handler(result.status());
+            return;
+          }
+
+          Status status = this->load_range_header(page_id, **result);
+          if (!status.ok()) {
+            handler(status);
+            return;
+          }
+          handler(std::move(*result));
+        });
+    return;
+  }
+
+  // Otherwise read the header block and the range concurrently, and finish when both are done.  The
+  // header is checked first, so that a stale page is reported the same way as by `read`.
+  //
+  struct JoinState {
+    std::atomic<usize> pending{2};
+    StatusOr<std::shared_ptr<PageRangeBuffer>> header_result;
+    StatusOr<std::shared_ptr<PageRangeBuffer>> range_result;
+    ReadRangeHandler handler;
+  };
+
+  auto join = std::make_shared<JoinState>();
+  join->handler = std::move(handler);
+
+  const auto finish = [this, page_id](JoinState& join) {
+    if (!join.header_result.ok()) {
+      join.handler(join.header_result.status());
+      return;
+    }
+
+    Status status = this->load_range_header(page_id, **join.header_result);
+    if (!status.ok()) {
+      join.handler(status);
+      return;
+    }
+
+    if (!join.range_result.ok()) {
+      join.handler(join.range_result.status());
+      return;
+    }
+    *(*join.range_result)->mutable_header() = (*join.header_result)->header();
+
+    join.handler(std::move(*join.range_result));
+  };
+
+  // Each read stores its own result; whichever finishes last (and so sees both) calls `finish`.
+  //
+  this->read_range_some(*page_offset_in_file,
+                        std::make_shared<PageRangeBuffer>(Interval<u64>{0, header_block_size}),
+                        /*n_read_so_far=*/0,
+                        [join, finish](StatusOr<std::shared_ptr<PageRangeBuffer>> result) {
+                          join->header_result = std::move(result);
+                          if (join->pending.fetch_sub(1) == 1) {
+                            finish(*join);
+                          }
+                        });
+
+  this->read_range_some(*page_offset_in_file, std::move(range_buffer), /*n_read_so_far=*/0,
+                        [join, finish](StatusOr<std::shared_ptr<PageRangeBuffer>> result) {
+                          join->range_result = std::move(result);
+                          if (join->pending.fetch_sub(1) == 1) {
+                            finish(*join);
+                          }
+                        });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void IoRingPageFileDevice::read_range_some(i64 page_offset_in_file,
+                                           std::shared_ptr<PageRangeBuffer>&& range_buffer,
+                                           usize n_read_so_far, RangeBufferHandler&& handler)
+{
+  BATT_CHECK_GE(page_offset_in_file, 0);
+
+  const usize range_size = range_buffer->range().size();
+  BATT_CHECK_LE(n_read_so_far, range_size);
+
+  // If we have reached the end of the buffer, invoke the handler.  Success!
+  //
+  if (n_read_so_far == range_size) {
+    handler(std::move(range_buffer));
+    return;
+  }
+
+  const i64 range_offset_in_file =
+      page_offset_in_file + static_cast<i64>(range_buffer->range().lower_bound);
+
+  MutableBuffer buffer = range_buffer->mutable_buffer() + n_read_so_far;
+
+  this->file_.async_read_some(
+      range_offset_in_file + n_read_so_far, buffer,
+      bind_handler(std::move(handler),
+                   [this, page_offset_in_file, range_buffer = std::move(range_buffer),
+                    n_read_so_far, range_offset_in_file](RangeBufferHandler&& handler,
+                                                         StatusOr<i32> result) mutable {
+                     if (!result.ok()) {
+                       if (batt::status_is_retryable(result.status())) {
+                         this->read_range_some(page_offset_in_file, std::move(range_buffer),
+                                               n_read_so_far, std::move(handler));
+                         return;
+                       }
+
+                       LLFS_LOG_WARNING() << "IoRingPageFileDevice::read_range failed;"
+                                          << BATT_INSPECT(range_offset_in_file)
+                                          << BATT_INSPECT(n_read_so_far);
+
+                       handler(result.status());
+                       return;
+                     }
+                     BATT_CHECK_GT(*result, 0)
+                         << "We must either make progress or receive an error code!";
+
+                     this->read_range_some(page_offset_in_file, std::move(range_buffer),
+                                           n_read_so_far + *result, std::move(handler));
+                   }));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status IoRingPageFileDevice::load_range_header(PageId page_id, PageRangeBuffer& range_buffer) const
+{
+  BATT_CHECK_EQ(range_buffer.range().lower_bound, 0u);
+  BATT_CHECK_GE(range_buffer.range().size(), sizeof(PackedPageHeader));
+
+  std::memcpy(range_buffer.mutable_header(), range_buffer.const_buffer().data(),
+              sizeof(PackedPageHeader));
+
+  Status status = range_buffer.header().sanity_check(
+      PageSize{BATT_CHECKED_CAST(u32, this->config_->page_size())}, page_id, this->page_ids_);
+
+  // As in `read`, a bad generation number means the page we want is no longer there.
+  //
+  if (status == StatusCode::kPageHeaderBadGeneration) {
+    return batt::StatusCode::kNotFound;
+  }
+  return status;
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 void IoRingPageFileDevice::drop(PageId id, WriteHandler&& handler)
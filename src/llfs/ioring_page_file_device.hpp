@@ -26,8 +26,12 @@ namespace llfs {
 class IoRingPageFileDevice : public PageDevice
 {
  public:
+  // `exclusive_file` must be true only if no other storage object (log, page device, etc.) keeps
+  // data in the backing `file`; see set_write_lifetime.
+  //
   explicit IoRingPageFileDevice(IoRing::File&& file,
-                                const FileOffsetPtr<PackedPageDeviceConfig>& config) noexcept;
+                                const FileOffsetPtr<PackedPageDeviceConfig>& config,
+                                bool exclusive_file = false) noexcept;
 
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
@@ -35,15 +39,25 @@ class IoRingPageFileDevice : public PageDevice
 
   PageSize page_size() override;
 
+  // The kernel tracks write-life hints per inode, not per byte range, so the hint is only applied
+  // if this device was created with `exclusive_file == true`; otherwise returns
+  // `batt::StatusCode::kFailedPrecondition` and leaves the file unchanged.
+  //
+  Status set_write_lifetime(PageWriteLifetime lifetime) override;
+
   StatusOr<std::shared_ptr<PageBuffer>> prepare(PageId page_id) override;
 
   void write(std::shared_ptr<const PageBuffer>&& page_buffer, WriteHandler&& handler) override;
 
   void read(PageId id, ReadHandler&& handler) override;
 
+  void read_range(PageId id, const Interval<u64>& byte_range, ReadRangeHandler&& handler) override;
+
   void drop(PageId id, WriteHandler&& handler) override;
 
  private:
+  using RangeBufferHandler = std::function<void(StatusOr<std::shared_ptr<PageRangeBuffer>>)>;
+
   //+++++++++++-+-+--+----- --- -- -  -  -   -
   StatusOr<u64> get_physical_page(PageId page_id) const;
 
@@ -55,6 +69,17 @@ class IoRingPageFileDevice : public PageDevice
   void read_some(PageId page_id, i64 page_offset_in_file, std::shared_ptr<PageBuffer>&& page_buffer,
                  usize page_buffer_size, usize n_read_so_far, ReadHandler&& handler);
 
+  // Reads the whole of `range_buffer` (whose range starts at the page-relative offset
+  // `range_buffer->range().lower_bound`) from the page at `page_offset_in_file`.
+  //
+  void read_range_some(i64 page_offset_in_file, std::shared_ptr<PageRangeBuffer>&& range_buffer,
+                       usize n_read_so_far, RangeBufferHandler&& handler);
+
+  // Copies the page header out of the data in `range_buffer`, which must start at page offset 0,
+  // and sanity checks it.
+  //
+  Status load_range_header(PageId page_id, PageRangeBuffer& range_buffer) const;
+
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
   // The backing file for this page device.  Could be a flat file or a raw block device.
@@ -68,6 +93,10 @@ class IoRingPageFileDevice : public PageDevice
   // Used to construct and parse PageIds for this device.
   //
   PageIdFactory page_ids_;
+
+  // Whether this device is the only storage object in `file_`.
+  //
+  bool exclusive_file_;
 };
 
 }  // namespace llfs
@@ -160,10 +160,12 @@ class LogDeviceFactory
  protected:
   LogDeviceFactory() = default;
 
+  // Returns whatever the driver's `truncate` returns (void, or a Status if truncation can fail).
+  //
   template <typename LogDriverImpl>
-  void truncate(LogDriverImpl& driver_impl, slot_offset_type pos)
+  decltype(auto) truncate(LogDriverImpl& driver_impl, slot_offset_type pos)
   {
-    LogTruncateAccess::truncate(&driver_impl, pos);
+    return LogTruncateAccess::truncate(&driver_impl, pos);
   }
 };
 
@@ -89,4 +89,31 @@ StatusOr<std::unique_ptr<IoRingLogDeviceFactory>> recover_storage_object(
   return std::make_unique<IoRingLogDeviceFactory>(fd, p_config, options);
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::unique_ptr<IoRingLogFollowerDevice>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string& file_name,
+    const FileOffsetPtr<const PackedLogDeviceConfig&>& p_config,
+    const IoRingLogFollowerOptions& options)
+{
+  const int flags = O_DIRECT | O_RDONLY;
+
+  int fd = batt::syscall_retry([&] {
+    return ::open(file_name.c_str(), flags);
+  });
+  BATT_REQUIRE_OK(batt::status_from_retval(fd));
+
+  const IoRingLogConfig config = IoRingLogConfig::from_packed(p_config);
+
+  auto instance = std::make_unique<IoRingLogFollowerDevice>(
+      RingBuffer::TempFile{.byte_size = config.logical_size},
+      IoRing::File{storage_context->get_io_ring(), fd}, config, storage_context->get_scheduler(),
+      options);
+
+  Status open_status = instance->open();
+  BATT_REQUIRE_OK(open_status);
+
+  return instance;
+}
+
 }  // namespace llfs
@@ -14,6 +14,7 @@
 #include <llfs/int_types.hpp>
 #include <llfs/ioring_log_device.hpp>
 #include <llfs/ioring_log_driver_options.hpp>
+#include <llfs/ioring_log_follower_driver.hpp>
 #include <llfs/log_device.hpp>
 #include <llfs/optional.hpp>
 #include <llfs/packed_config.hpp>
@@ -43,6 +44,13 @@ StatusOr<std::unique_ptr<IoRingLogDeviceFactory>> recover_storage_object(
     const FileOffsetPtr<const PackedLogDeviceConfig&>& p_config,
     const IoRingLogDriverOptions& options);
 
+// Opens the log read-only, to follow it while another process writes to it.
+//
+StatusOr<std::unique_ptr<IoRingLogFollowerDevice>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string& file_name,
+    const FileOffsetPtr<const PackedLogDeviceConfig&>& p_config,
+    const IoRingLogFollowerOptions& options);
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
 struct LogDeviceConfigOptions {
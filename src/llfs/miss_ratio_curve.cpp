@@ -0,0 +1,286 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/miss_ratio_curve.hpp>
+//
+
+#include <batteries/assert.hpp>
+#include <batteries/math.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace llfs {
+
+namespace {
+
+u64 sample_threshold_from_rate(double sample_rate)
+{
+  BATT_CHECK_GT(sample_rate, 0.0);
+  BATT_CHECK_LE(sample_rate, 1.0);
+
+  return std::clamp<u64>(
+      static_cast<u64>(std::llround(sample_rate * MissRatioCurveEstimator::kHashModulus)), 1,
+      MissRatioCurveEstimator::kHashModulus);
+}
+
+}  // namespace
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::ostream& operator<<(std::ostream& out, const MissRatioCurvePoint& t)
+{
+  return out << "{.cache_size=" << t.cache_size << ", .miss_ratio=" << t.miss_ratio << ",}";
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ MissRatioCurveEstimator::MissRatioCurveEstimator(double sample_rate,
+                                                             u64 reference_cache_size,
+                                                             usize bucket_count) noexcept
+    : threshold_{sample_threshold_from_rate(sample_rate)}
+    , sample_rate_{double(this->threshold_) / double(kHashModulus)}
+    , reference_cache_size_{std::max<u64>(1, reference_cache_size)}
+    , bucket_count_{bucket_count != 0 ? bucket_count : this->reference_cache_size_ * 4}
+    , bucket_width_{std::max<u64>(
+          1, (this->reference_cache_size_ * 4 + this->bucket_count_ - 1) / this->bucket_count_)}
+    , max_tracked_keys_{
+          static_cast<usize>(std::ceil(double(this->max_cache_size()) * this->sample_rate_)) + 1}
+    , histogram_(this->bucket_count_, 0)
+{
+  // Leave room for as many stale timestamps as live ones, so compaction is amortized O(1).
+  //
+  const usize timestamp_capacity = std::max<usize>(64, this->max_tracked_keys_ * 2);
+
+  this->key_by_timestamp_.resize(timestamp_capacity, 0);
+  this->timestamp_marks_.resize(timestamp_capacity + 1, 0);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+double MissRatioCurveEstimator::estimate_miss_ratio(u64 cache_size) const
+{
+  std::unique_lock<std::mutex> lock{this->mutex_};
+
+  return this->estimate_miss_ratio_locked(cache_size);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::vector<MissRatioCurvePoint> MissRatioCurveEstimator::curve() const
+{
+  std::vector<MissRatioCurvePoint> points;
+  points.reserve(this->bucket_count_);
+
+  std::unique_lock<std::mutex> lock{this->mutex_};
+
+  for (usize i = 1; i <= this->bucket_count_; ++i) {
+    const u64 cache_size = i * this->bucket_width_;
+    points.emplace_back(MissRatioCurvePoint{
+        .cache_size = cache_size,
+        .miss_ratio = this->estimate_miss_ratio_locked(cache_size),
+    });
+  }
+
+  return points;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 MissRatioCurveEstimator::sampled_count() const
+{
+  std::unique_lock<std::mutex> lock{this->mutex_};
+
+  return this->total_count_;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MissRatioCurveEstimator::record_sampled(u64 key)
+{
+  std::unique_lock<std::mutex> lock{this->mutex_};
+
+  this->total_count_ += 1;
+  this->metrics_.sampled_count.add(1);
+
+  auto iter = this->timestamp_by_key_.find(key);
+  if (iter == this->timestamp_by_key_.end()) {
+    this->miss_always_count_ += 1;
+  } else {
+    const u64 prev_timestamp = iter->second;
+
+    // The reuse distance is the number of distinct keys referenced since the previous reference to
+    // `key`, including `key` itself; there is exactly one mark per tracked key.
+    //
+    const u64 distance =
+        this->timestamp_by_key_.size() - this->count_marks_before_locked(prev_timestamp);
+
+    const u64 scaled_distance =
+        static_cast<u64>(std::ceil(double(distance) / this->sample_rate_));
+
+    if (scaled_distance > this->max_cache_size()) {
+      this->miss_always_count_ += 1;
+    } else {
+      this->histogram_[(scaled_distance - 1) / this->bucket_width_] += 1;
+    }
+
+    this->add_mark_locked(prev_timestamp, -1);
+    this->timestamp_by_key_.erase(iter);
+  }
+
+  if (this->timestamp_by_key_.size() >= this->max_tracked_keys_) {
+    this->evict_oldest_locked();
+  }
+  if (this->next_timestamp_ == this->key_by_timestamp_.size()) {
+    this->compact_locked();
+  }
+
+  const u64 timestamp = this->next_timestamp_;
+  this->next_timestamp_ += 1;
+
+  this->timestamp_by_key_.emplace(key, timestamp);
+  this->key_by_timestamp_[timestamp] = key;
+  this->add_mark_locked(timestamp, +1);
+
+  if (this->total_count_ % kMetricsUpdateInterval == 0) {
+    this->update_metrics_locked();
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+double MissRatioCurveEstimator::estimate_miss_ratio_locked(u64 cache_size) const
+{
+  if (this->total_count_ == 0) {
+    return 1.0;
+  }
+
+  // Sum the hits from all buckets that fit entirely within `cache_size`, then interpolate within
+  // the bucket that straddles it (if any).
+  //
+  double hit_count = 0;
+  for (usize i = 0; i < this->bucket_count_; ++i) {
+    const u64 lower = i * this->bucket_width_;
+    const u64 upper = lower + this->bucket_width_;
+
+    if (upper <= cache_size) {
+      hit_count += double(this->histogram_[i]);
+    } else {
+      if (cache_size > lower) {
+        hit_count += double(this->histogram_[i]) * double(cache_size - lower) /
+                     double(this->bucket_width_);
+      }
+      break;
+    }
+  }
+
+  return 1.0 - hit_count / double(this->total_count_);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MissRatioCurveEstimator::update_metrics_locked()
+{
+  const auto to_ppm = [](double ratio) -> u64 {
+    return static_cast<u64>(std::llround(ratio * 1e6));
+  };
+
+  const u64 n = this->reference_cache_size_;
+
+  this->metrics_.miss_ppm_at_50pct.set(to_ppm(this->estimate_miss_ratio_locked(n / 2)));
+  this->metrics_.miss_ppm_at_100pct.set(to_ppm(this->estimate_miss_ratio_locked(n)));
+  this->metrics_.miss_ppm_at_200pct.set(to_ppm(this->estimate_miss_ratio_locked(n * 2)));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MissRatioCurveEstimator::evict_oldest_locked()
+{
+  const u64 oldest_timestamp = this->find_first_mark_locked();
+  const u64 oldest_key = this->key_by_timestamp_[oldest_timestamp];
+
+  this->add_mark_locked(oldest_timestamp, -1);
+
+  const usize n_erased = this->timestamp_by_key_.erase(oldest_key);
+  BATT_CHECK_EQ(n_erased, 1u);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MissRatioCurveEstimator::compact_locked()
+{
+  // Collect the live (key, timestamp) pairs in timestamp order.
+  //
+  std::vector<u64> live_keys;
+  live_keys.reserve(this->timestamp_by_key_.size());
+
+  for (u64 timestamp = 0; timestamp < this->next_timestamp_; ++timestamp) {
+    const u64 key = this->key_by_timestamp_[timestamp];
+    auto iter = this->timestamp_by_key_.find(key);
+    if (iter != this->timestamp_by_key_.end() && iter->second == timestamp) {
+      live_keys.emplace_back(key);
+    }
+  }
+  BATT_CHECK_EQ(live_keys.size(), this->timestamp_by_key_.size());
+  BATT_CHECK_LT(live_keys.size(), this->key_by_timestamp_.size());
+
+  // Renumber.
+  //
+  std::fill(this->timestamp_marks_.begin(), this->timestamp_marks_.end(), 0);
+
+  for (u64 timestamp = 0; timestamp < live_keys.size(); ++timestamp) {
+    const u64 key = live_keys[timestamp];
+    this->key_by_timestamp_[timestamp] = key;
+    this->timestamp_by_key_[key] = timestamp;
+    this->add_mark_locked(timestamp, +1);
+  }
+
+  this->next_timestamp_ = live_keys.size();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MissRatioCurveEstimator::add_mark_locked(u64 ts, i32 delta)
+{
+  const u64 n = this->timestamp_marks_.size();
+  for (u64 i = ts + 1; i < n; i += (i & (~i + 1))) {
+    this->timestamp_marks_[i] += delta;
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 MissRatioCurveEstimator::count_marks_before_locked(u64 ts) const
+{
+  u64 count = 0;
+  for (u64 i = ts; i > 0; i -= (i & (~i + 1))) {
+    count += this->timestamp_marks_[i];
+  }
+  return count;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 MissRatioCurveEstimator::find_first_mark_locked() const
+{
+  const u64 n = this->timestamp_marks_.size() - 1;
+
+  // Binary-lift to the largest position whose prefix sum is 0; the first mark follows it.
+  //
+  u64 pos = 0;
+  for (u64 step = u64{1} << batt::log2_floor(n); step > 0; step >>= 1) {
+    if (pos + step <= n && this->timestamp_marks_[pos + step] == 0) {
+      pos += step;
+    }
+  }
+  BATT_CHECK_LT(pos, n) << "no keys are being tracked";
+
+  return pos;
+}
+
+}  // namespace llfs
@@ -0,0 +1,233 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_MISS_RATIO_CURVE_HPP
+#define LLFS_MISS_RATIO_CURVE_HPP
+
+#include <llfs/int_types.hpp>
+#include <llfs/metrics.hpp>
+
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace llfs {
+
+// A single point on an estimated miss ratio curve: the fraction of references that would miss in an
+// LRU cache of `cache_size` entries.
+//
+struct MissRatioCurvePoint {
+  u64 cache_size;
+  double miss_ratio;
+};
+
+std::ostream& operator<<(std::ostream& out, const MissRatioCurvePoint& t);
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// Online estimator of the LRU miss ratio curve of a stream of key references, using spatially
+// hashed sampling (SHARDS, fixed-rate variant).
+//
+// Each key is hashed; only keys whose hash falls below a threshold (a fixed fraction `sample_rate`
+// of the hash space) are tracked.  For sampled keys we compute the exact reuse (stack) distance
+// within the sampled sub-stream and scale it by `1 / sample_rate` to estimate the reuse distance
+// in the full stream.  Since the sampling decision is a pure function of the key, all references
+// to a given key are either sampled or not, which is what makes the scaled distances unbiased.
+//
+// Cost: an unsampled reference costs one hash and one compare (no locking, no memory traffic).  A
+// sampled reference takes a mutex and does O(log N) work, where N is the number of distinct
+// sampled keys being tracked.  Memory is bounded by the number of sampled keys needed to cover
+// `max_cache_size`; keys with a larger reuse distance are forgotten (they would miss at every
+// cache size on the curve anyway).
+//
+class MissRatioCurveEstimator
+{
+ public:
+  // Denominator of the sampling threshold.
+  //
+  static constexpr u64 kHashModulus = u64{1} << 24;
+
+  // The default number of histogram buckets between 0 and `max_cache_size`.
+  //
+  static constexpr usize kDefaultBucketCount = 64;
+
+  // How often (in sampled references) the exported metrics are recomputed.
+  //
+  static constexpr u64 kMetricsUpdateInterval = 1024;
+
+  struct Metrics {
+    CountMetric<u64> sampled_count{0};
+
+    // Estimated miss ratios (in parts per million) at 1/2, 1, and 2 times the reference cache size
+    // passed in at construction time.
+    //
+    CountMetric<u64> miss_ppm_at_50pct{0};
+    CountMetric<u64> miss_ppm_at_100pct{0};
+    CountMetric<u64> miss_ppm_at_200pct{0};
+  };
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // Creates a new estimator that samples (approximately) `sample_rate` of all distinct keys and
+  // estimates the miss ratio curve for cache sizes up to 4 * `reference_cache_size`.  If
+  // `bucket_count` is 0, the histogram is given one bucket per cache size (i.e., exact results
+  // when `sample_rate` is 1).
+  //
+  explicit MissRatioCurveEstimator(double sample_rate, u64 reference_cache_size,
+                                   usize bucket_count = kDefaultBucketCount) noexcept;
+
+  MissRatioCurveEstimator(const MissRatioCurveEstimator&) = delete;
+  MissRatioCurveEstimator& operator=(const MissRatioCurveEstimator&) = delete;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The fraction of the key space that is actually sampled (after rounding to the hash threshold).
+  //
+  double sample_rate() const
+  {
+    return this->sample_rate_;
+  }
+
+  u64 reference_cache_size() const
+  {
+    return this->reference_cache_size_;
+  }
+
+  // The largest cache size for which the curve is estimated.
+  //
+  u64 max_cache_size() const
+  {
+    return this->bucket_width_ * this->bucket_count_;
+  }
+
+  // Returns true iff references to `key` are tracked by this estimator.
+  //
+  bool is_sampled(u64 key) const
+  {
+    return (hash_key(key) % kHashModulus) < this->threshold_;
+  }
+
+  // Records a single reference to `key`.  Safe to call concurrently from any thread.
+  //
+  void record(u64 key)
+  {
+    if (this->is_sampled(key)) {
+      this->record_sampled(key);
+    }
+  }
+
+  // Returns the estimated fraction of references that would miss in an LRU cache of `cache_size`
+  // entries.  Returns 1 if no references have been sampled yet.
+  //
+  double estimate_miss_ratio(u64 cache_size) const;
+
+  // Returns the estimated miss ratio at each histogram bucket boundary, in ascending order of
+  // cache size.
+  //
+  std::vector<MissRatioCurvePoint> curve() const;
+
+  // The number of references sampled so far.
+  //
+  u64 sampled_count() const;
+
+  const Metrics& metrics() const
+  {
+    return this->metrics_;
+  }
+
+  Metrics& metrics()
+  {
+    return this->metrics_;
+  }
+
+ private:
+  static u64 hash_key(u64 key)
+  {
+    // splitmix64 finalizer; page ids are highly structured, so they must be mixed before sampling.
+    //
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+  }
+
+  void record_sampled(u64 key);
+
+  double estimate_miss_ratio_locked(u64 cache_size) const;
+
+  void update_metrics_locked();
+
+  // Forgets the least recently referenced sampled key.
+  //
+  void evict_oldest_locked();
+
+  // Renumbers all live timestamps to [0, N) so that new timestamps can be assigned.
+  //
+  void compact_locked();
+
+  // Fenwick tree operations over `this->timestamp_marks_`.
+  //
+  void add_mark_locked(u64 ts, i32 delta);
+  u64 count_marks_before_locked(u64 ts) const;
+  u64 find_first_mark_locked() const;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  const u64 threshold_;
+  const double sample_rate_;
+  const u64 reference_cache_size_;
+  const usize bucket_count_;
+  const u64 bucket_width_;
+
+  // The maximum number of sampled keys to track; keys beyond this reuse distance (in the sampled
+  // stream) exceed `max_cache_size()` when scaled.
+  //
+  const usize max_tracked_keys_;
+
+  Metrics metrics_;
+
+  mutable std::mutex mutex_;
+
+  // The timestamp of the most recent reference to each tracked key.
+  //
+  std::unordered_map<u64, u64> timestamp_by_key_;
+
+  // Inverse of `timestamp_by_key_`; entries for stale timestamps are ignored.
+  //
+  std::vector<u64> key_by_timestamp_;
+
+  // Fenwick (binary indexed) tree with a 1 at each timestamp that is the most recent reference to
+  // some tracked key; the number of marks after a key's timestamp is its reuse distance.
+  //
+  std::vector<u32> timestamp_marks_;
+
+  // The next timestamp to assign.
+  //
+  u64 next_timestamp_ = 0;
+
+  // Histogram of scaled reuse distances; bucket i counts distances in (i * w, (i + 1) * w], where
+  // w is `bucket_width_`.
+  //
+  std::vector<u64> histogram_;
+
+  // The number of sampled references that are first references (cold misses) or whose reuse
+  // distance exceeds `max_cache_size()`.
+  //
+  u64 miss_always_count_ = 0;
+
+  // The total number of sampled references.
+  //
+  u64 total_count_ = 0;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_MISS_RATIO_CURVE_HPP
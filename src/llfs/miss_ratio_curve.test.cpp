@@ -0,0 +1,128 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/miss_ratio_curve.hpp>
+//
+#include <llfs/miss_ratio_curve.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using namespace llfs::int_types;
+
+// Returns the exact miss ratio of an LRU cache of size `cache_size` on the reference stream `refs`.
+//
+double simulate_lru_miss_ratio(const std::vector<u64>& refs, usize cache_size)
+{
+  std::list<u64> lru;
+  std::unordered_map<u64, std::list<u64>::iterator> index;
+  usize miss_count = 0;
+
+  for (u64 key : refs) {
+    auto iter = index.find(key);
+    if (iter != index.end()) {
+      lru.splice(lru.begin(), lru, iter->second);
+      continue;
+    }
+    miss_count += 1;
+    if (cache_size == 0) {
+      continue;
+    }
+    if (lru.size() == cache_size) {
+      index.erase(lru.back());
+      lru.pop_back();
+    }
+    lru.push_front(key);
+    index[key] = lru.begin();
+  }
+
+  return double(miss_count) / double(refs.size());
+}
+
+// Generates a skewed reference stream over `key_count` keys; lower-numbered keys are referenced
+// more often.  Keys are spread out the way page ids are.
+//
+std::vector<u64> make_skewed_refs(usize key_count, usize ref_count, u32 seed)
+{
+  std::default_random_engine rng{seed};
+  std::exponential_distribution<double> pick_rank{8.0 / double(key_count)};
+
+  std::vector<u64> refs;
+  refs.reserve(ref_count);
+  for (usize i = 0; i < ref_count; ++i) {
+    const u64 rank = static_cast<u64>(pick_rank(rng)) % key_count;
+    refs.emplace_back((u64{7} << 56) | (rank << 8) | 1);
+  }
+  return refs;
+}
+
+TEST(MissRatioCurveTest, ExactWhenFullySampled)
+{
+  constexpr u64 kReferenceCacheSize = 64;
+
+  const std::vector<u64> refs = make_skewed_refs(/*key_count=*/1000, /*ref_count=*/20000, 1);
+
+  llfs::MissRatioCurveEstimator mrc{/*sample_rate=*/1.0, kReferenceCacheSize, /*bucket_count=*/0};
+
+  EXPECT_EQ(mrc.max_cache_size(), kReferenceCacheSize * 4);
+  EXPECT_EQ(mrc.estimate_miss_ratio(kReferenceCacheSize), 1.0);
+
+  for (u64 key : refs) {
+    EXPECT_TRUE(mrc.is_sampled(key));
+    mrc.record(key);
+  }
+  EXPECT_EQ(mrc.sampled_count(), refs.size());
+
+  for (usize cache_size : {0, 1, 7, 16, 32, 63, 64, 100, 128, 200, 256}) {
+    EXPECT_NEAR(mrc.estimate_miss_ratio(cache_size), simulate_lru_miss_ratio(refs, cache_size),
+                1e-9)
+        << BATT_INSPECT(cache_size);
+  }
+
+  const std::vector<llfs::MissRatioCurvePoint> curve = mrc.curve();
+
+  ASSERT_EQ(curve.size(), kReferenceCacheSize * 4);
+  for (usize i = 1; i < curve.size(); ++i) {
+    EXPECT_LT(curve[i - 1].cache_size, curve[i].cache_size);
+    EXPECT_GE(curve[i - 1].miss_ratio, curve[i].miss_ratio);
+  }
+}
+
+TEST(MissRatioCurveTest, SampledEstimateMatchesSimulation)
+{
+  constexpr u64 kReferenceCacheSize = 4096;
+  constexpr double kSampleRate = 0.05;
+
+  const std::vector<u64> refs = make_skewed_refs(/*key_count=*/50000, /*ref_count=*/500000, 2);
+
+  llfs::MissRatioCurveEstimator mrc{kSampleRate, kReferenceCacheSize};
+
+  for (u64 key : refs) {
+    mrc.record(key);
+  }
+
+  EXPECT_NEAR(double(mrc.sampled_count()) / double(refs.size()), kSampleRate, kSampleRate * 0.5);
+  EXPECT_GT(mrc.metrics().sampled_count.load(), 0u);
+  EXPECT_GT(mrc.metrics().miss_ppm_at_50pct.load(), mrc.metrics().miss_ppm_at_200pct.load());
+
+  for (usize cache_size : {1024, 2048, 4096, 8192, 16384}) {
+    EXPECT_NEAR(mrc.estimate_miss_ratio(cache_size), simulate_lru_miss_ratio(refs, cache_size),
+                0.05)
+        << BATT_INSPECT(cache_size);
+  }
+}
+
+}  // namespace
@@ -0,0 +1,259 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/mmap_page_file_device.hpp>
+//
+
+#include <llfs/packed_page_header.hpp>
+#include <llfs/status_code.hpp>
+
+#include <batteries/checked_cast.hpp>
+#include <batteries/finally.hpp>
+#include <batteries/syscall_retry.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace llfs {
+
+namespace {
+
+int madvise_flag_from_hint(MmapPageAccessHint hint)
+{
+  switch (hint) {
+    case MmapPageAccessHint::kNormal:
+      return MADV_NORMAL;
+    case MmapPageAccessHint::kRandom:
+      return MADV_RANDOM;
+    case MmapPageAccessHint::kSequential:
+      return MADV_SEQUENTIAL;
+    case MmapPageAccessHint::kWillNeed:
+      return MADV_WILLNEED;
+  }
+  BATT_PANIC() << "Bad MmapPageAccessHint value: " << (int)hint;
+  BATT_UNREACHABLE();
+}
+
+}  // namespace
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ MmapPageFileDeviceOptions MmapPageFileDeviceOptions::with_default_values()
+{
+  return MmapPageFileDeviceOptions{
+      .access_hint = MmapPageAccessHint::kRandom,
+      .prefetch_on_read = false,
+  };
+}
+
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ StatusOr<std::shared_ptr<const MmapPageFileDevice::Mapping>>
+MmapPageFileDevice::Mapping::map_file(int fd, i64 offset, i64 size)
+{
+  static const i64 system_page_size = ::sysconf(_SC_PAGESIZE);
+
+  BATT_CHECK_GE(offset, 0);
+  BATT_CHECK_GT(size, 0);
+
+  const i64 aligned_offset = offset - (offset % system_page_size);
+  const i64 skew = offset - aligned_offset;
+
+  void* base = ::mmap(nullptr, skew + size, PROT_READ, MAP_SHARED, fd, aligned_offset);
+  if (base == MAP_FAILED) {
+    return batt::status_from_errno(errno);
+  }
+
+  return std::shared_ptr<const Mapping>{new Mapping{static_cast<const u8*>(base), skew, size}};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ MmapPageFileDevice::Mapping::Mapping(const u8* base, i64 skew, i64 size) noexcept
+    : base_{base}
+    , skew_{skew}
+    , size_{size}
+{
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+MmapPageFileDevice::Mapping::~Mapping() noexcept
+{
+  LLFS_WARN_IF_NOT_OK(batt::status_from_retval(batt::syscall_retry([&] {
+    return ::munmap(const_cast<u8*>(this->base_), this->skew_ + this->size_);
+  })));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status MmapPageFileDevice::Mapping::advise(MmapPageAccessHint hint, i64 offset, i64 size) const
+{
+  static const i64 system_page_size = ::sysconf(_SC_PAGESIZE);
+
+  // madvise requires a system-page-aligned start address; widen the range to include the aligned
+  // start.
+  //
+  const i64 begin = this->skew_ + offset;
+  const i64 aligned_begin = begin - (begin % system_page_size);
+
+  return batt::status_from_retval(
+      ::madvise(const_cast<u8*>(this->base_) + aligned_begin, (begin - aligned_begin) + size,
+                madvise_flag_from_hint(hint)));
+}
+
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ StatusOr<std::unique_ptr<MmapPageFileDevice>> MmapPageFileDevice::open(
+    const std::string& file_name, const FileOffsetPtr<const PackedPageDeviceConfig&>& config,
+    const MmapPageFileDeviceOptions& options)
+{
+  const int fd = batt::syscall_retry([&] {
+    return ::open(file_name.c_str(), O_RDONLY);
+  });
+  BATT_REQUIRE_OK(batt::status_from_retval(fd));
+
+  // The mapping holds its own reference to the file, so we can close the fd as soon as we are done.
+  //
+  auto on_scope_exit = batt::finally([fd] {
+    ::close(fd);
+  });
+
+  const i64 page_region_size = config->page_count.value() * static_cast<i64>(config->page_size());
+
+  StatusOr<std::shared_ptr<const Mapping>> mapping =
+      Mapping::map_file(fd, config.absolute_page_0_offset(), page_region_size);
+  BATT_REQUIRE_OK(mapping);
+
+  Status advise_status = (*mapping)->advise(options.access_hint, 0, page_region_size);
+  BATT_REQUIRE_OK(advise_status);
+
+  return std::make_unique<MmapPageFileDevice>(std::move(*mapping), config.decay_copy(), options);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ MmapPageFileDevice::MmapPageFileDevice(
+    std::shared_ptr<const Mapping>&& mapping, const FileOffsetPtr<PackedPageDeviceConfig>& config,
+    const MmapPageFileDeviceOptions& options) noexcept
+    : mapping_{std::move(mapping)}
+    , config_{config}
+    , page_ids_{PageCount{batt::checked_cast<u32>(this->config_->page_count.value())},
+                this->config_->device_id}
+    , options_{options}
+{
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PageIdFactory MmapPageFileDevice::page_ids()
+{
+  return this->page_ids_;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PageSize MmapPageFileDevice::page_size()
+{
+  return PageSize{batt::checked_cast<u32>(this->config_->page_size())};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::shared_ptr<PageBuffer>> MmapPageFileDevice::prepare(PageId /*page_id*/)
+{
+  return make_status(StatusCode::kPageDeviceReadOnly);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MmapPageFileDevice::write(std::shared_ptr<const PageBuffer>&& /*page_buffer*/,
+                               WriteHandler&& handler)
+{
+  handler(make_status(StatusCode::kPageDeviceReadOnly));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MmapPageFileDevice::read(PageId page_id, ReadHandler&& handler)
+{
+  LLFS_VLOG(1) << "MmapPageFileDevice::read(page_id=" << page_id << ")";
+
+  StatusOr<const PageBuffer*> page_buffer = this->get_page_buffer(page_id);
+  if (!page_buffer.ok()) {
+    handler(page_buffer.status());
+    return;
+  }
+
+  if (this->options_.prefetch_on_read) {
+    this->prefetch(page_id).IgnoreError();
+  }
+
+  // Sanity check the page header; this is the same check done by IoRingPageFileDevice.
+  //
+  Status status =
+      get_page_header(**page_buffer).sanity_check(this->page_size(), page_id, this->page_ids_);
+  if (!status.ok()) {
+    // If the only sanity check that failed was a bad generation number, then we report page not
+    // found.
+    //
+    if (status == StatusCode::kPageHeaderBadGeneration) {
+      status = batt::StatusCode::kNotFound;
+    }
+    handler(status);
+    return;
+  }
+
+  // Use the aliasing constructor so that the returned buffer shares ownership of the mapping; the
+  // PageBuffer is never deleted, so it is never returned to the PageBuffer pool.
+  //
+  handler(std::shared_ptr<const PageBuffer>{this->mapping_, *page_buffer});
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void MmapPageFileDevice::drop(PageId /*page_id*/, WriteHandler&& handler)
+{
+  handler(make_status(StatusCode::kPageDeviceReadOnly));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status MmapPageFileDevice::prefetch(PageId page_id)
+{
+  const i64 physical_page = this->page_ids_.get_physical_page(page_id);
+  if (physical_page >= this->config_->page_count || physical_page < 0) {
+    return Status{batt::StatusCode::kOutOfRange};
+  }
+
+  return this->mapping_->advise(MmapPageAccessHint::kWillNeed,
+                                physical_page << u16{this->config_->page_size_log2},
+                                this->config_->page_size());
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<const PageBuffer*> MmapPageFileDevice::get_page_buffer(PageId page_id) const
+{
+  const i64 physical_page = this->page_ids_.get_physical_page(page_id);
+  if (physical_page >= this->config_->page_count || physical_page < 0) {
+    return Status{batt::StatusCode::kOutOfRange};
+  }
+
+  const ConstBuffer pages = this->mapping_->data();
+  const i64 offset = physical_page << u16{this->config_->page_size_log2};
+
+  return reinterpret_cast<const PageBuffer*>(static_cast<const u8*>(pages.data()) + offset);
+}
+
+}  // namespace llfs
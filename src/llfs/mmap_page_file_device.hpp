@@ -0,0 +1,169 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_MMAP_PAGE_FILE_DEVICE_HPP
+#define LLFS_MMAP_PAGE_FILE_DEVICE_HPP
+
+#include <llfs/file_offset_ptr.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/page_device.hpp>
+#include <llfs/page_device_config.hpp>
+#include <llfs/status.hpp>
+
+#include <memory>
+#include <string>
+
+namespace llfs {
+
+// Hint passed to the kernel (via madvise) describing the expected access pattern for the pages of
+// an MmapPageFileDevice.
+//
+enum struct MmapPageAccessHint {
+  kNormal,
+  kRandom,
+  kSequential,
+  kWillNeed,
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+//
+struct MmapPageFileDeviceOptions {
+  static MmapPageFileDeviceOptions with_default_values();
+
+  // The madvise hint to apply to the entire mapped page region when the device is opened.
+  //
+  MmapPageAccessHint access_hint;
+
+  // If true, each read additionally asks the kernel to start paging in the page being read (as if
+  // by `MmapPageFileDevice::prefetch`).  This is useful for large pages, where the read is likely
+  // to be followed by a scan of most of the page.
+  //
+  bool prefetch_on_read;
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// A read-only PageDevice that maps a page device region of a storage file into memory.
+//
+// `read` hands out PageBuffer objects that point directly into the mapping; no memory is allocated
+// and no data is copied.  The kernel page cache is responsible for residency and read-ahead.  Each
+// returned buffer keeps the mapping alive, so buffers may safely outlive the device.
+//
+// `prepare`, `write`, and `drop` always fail with `StatusCode::kPageDeviceReadOnly`; this device is
+// intended for sealed, immutable arenas only.
+//
+// NOTE: Because pages are accessed via memory loads, a read of a non-resident page blocks the
+// caller's thread on a page fault instead of suspending the calling task.
+//
+class MmapPageFileDevice : public PageDevice
+{
+ public:
+  class Mapping;
+
+  // Opens `file_name` read-only and maps the page region described by `config`.
+  //
+  static StatusOr<std::unique_ptr<MmapPageFileDevice>> open(
+      const std::string& file_name, const FileOffsetPtr<const PackedPageDeviceConfig&>& config,
+      const MmapPageFileDeviceOptions& options = MmapPageFileDeviceOptions::with_default_values());
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  explicit MmapPageFileDevice(std::shared_ptr<const Mapping>&& mapping,
+                              const FileOffsetPtr<PackedPageDeviceConfig>& config,
+                              const MmapPageFileDeviceOptions& options) noexcept;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  PageIdFactory page_ids() override;
+
+  PageSize page_size() override;
+
+  StatusOr<std::shared_ptr<PageBuffer>> prepare(PageId page_id) override;
+
+  void write(std::shared_ptr<const PageBuffer>&& page_buffer, WriteHandler&& handler) override;
+
+  void read(PageId id, ReadHandler&& handler) override;
+
+  void drop(PageId id, WriteHandler&& handler) override;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // Asks the kernel to start reading the given page into memory in the background.
+  //
+  Status prefetch(PageId page_id);
+
+ private:
+  StatusOr<const PageBuffer*> get_page_buffer(PageId page_id) const;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The memory mapping of the pages of this device; shared with all PageBuffers returned by `read`.
+  //
+  std::shared_ptr<const Mapping> mapping_;
+
+  // The config for this device.
+  //
+  FileOffsetPtr<PackedPageDeviceConfig> config_;
+
+  // Used to construct and parse PageIds for this device.
+  //
+  PageIdFactory page_ids_;
+
+  // Runtime options passed in at creation time.
+  //
+  MmapPageFileDeviceOptions options_;
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// A read-only memory mapping of a region of a file; unmaps the region when destroyed.
+//
+class MmapPageFileDevice::Mapping
+{
+ public:
+  // Maps `size` bytes of the file `fd`, starting at `offset`.  `offset` need not be aligned to the
+  // system memory page size.  The fd may be closed once this function returns.
+  //
+  static StatusOr<std::shared_ptr<const Mapping>> map_file(int fd, i64 offset, i64 size);
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  Mapping(const Mapping&) = delete;
+  Mapping& operator=(const Mapping&) = delete;
+
+  ~Mapping() noexcept;
+
+  // Returns the mapped region (starting at the `offset` passed to `map_file`).
+  //
+  ConstBuffer data() const
+  {
+    return ConstBuffer{this->base_ + this->skew_, this->size_};
+  }
+
+  // Applies the given access hint to the byte range `[offset, offset + size)` of `data()`.
+  //
+  Status advise(MmapPageAccessHint hint, i64 offset, i64 size) const;
+
+ private:
+  explicit Mapping(const u8* base, i64 skew, i64 size) noexcept;
+
+  // The system-page-aligned start of the mapping.
+  //
+  const u8* base_;
+
+  // The number of bytes between `base_` and the requested offset.
+  //
+  i64 skew_;
+
+  // The number of bytes requested.
+  //
+  i64 size_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_MMAP_PAGE_FILE_DEVICE_HPP
@@ -0,0 +1,123 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/mmap_page_file_device.hpp>
+//
+#include <llfs/mmap_page_file_device.hpp>
+
+#include <llfs/packed_page_header.hpp>
+#include <llfs/status_code.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace {
+
+using namespace llfs::int_types;
+
+constexpr const char* kTestFileName = "/tmp/llfs_mmap_page_file_device_test_file";
+constexpr i64 kTestConfigOffset = 0;
+constexpr i64 kTestPage0Offset = 4096;
+constexpr u16 kTestPageSizeLog2 = 12;
+constexpr i64 kTestPageSize = i64{1} << kTestPageSizeLog2;
+constexpr i64 kTestPageCount = 4;
+
+TEST(MmapPageFileDeviceTest, ReadOnlyZeroCopy)
+{
+  llfs::PackedPageDeviceConfig config;
+  std::memset(&config, 0, sizeof(config));
+  config.page_0_offset = kTestPage0Offset - kTestConfigOffset;
+  config.device_id = 0;
+  config.page_count = kTestPageCount;
+  config.page_size_log2 = kTestPageSizeLog2;
+
+  llfs::FileOffsetPtr<const llfs::PackedPageDeviceConfig&> p_config{config, kTestConfigOffset};
+
+  const llfs::PageIdFactory ids{llfs::PageCount{kTestPageCount}, /*device_id=*/0};
+  const llfs::PageId page_id = ids.make_page_id(/*physical_page=*/1, /*generation=*/1);
+
+  // Write a single valid page at physical page 1.
+  //
+  {
+    std::shared_ptr<llfs::PageBuffer> page =
+        llfs::PageBuffer::allocate(llfs::PageSize{kTestPageSize}, page_id);
+    llfs::MutableBuffer payload = page->mutable_payload();
+    std::memset(payload.data(), 'x', payload.size());
+
+    int fd = ::open(kTestFileName, O_CREAT | O_TRUNC | O_RDWR, /*mode=*/0644);
+    ASSERT_GE(fd, 0) << std::strerror(errno);
+
+    ASSERT_EQ(::ftruncate(fd, kTestPage0Offset + kTestPageSize * kTestPageCount), 0);
+    ASSERT_EQ(::pwrite(fd, page->const_buffer().data(), kTestPageSize,
+                       kTestPage0Offset + kTestPageSize * 1),
+              kTestPageSize);
+    ::close(fd);
+  }
+
+  llfs::StatusOr<std::unique_ptr<llfs::MmapPageFileDevice>> device =
+      llfs::MmapPageFileDevice::open(kTestFileName, p_config);
+
+  ASSERT_TRUE(device.ok()) << BATT_INSPECT(device.status());
+  EXPECT_EQ((*device)->page_size(), llfs::PageSize{kTestPageSize});
+  EXPECT_EQ((*device)->capacity(), llfs::PageCount{kTestPageCount});
+
+  // Reads of the valid page should point into the mapping.
+  //
+  std::shared_ptr<const llfs::PageBuffer> first, second;
+
+  (*device)->read(page_id, [&](llfs::PageDevice::ReadResult result) {
+    ASSERT_TRUE(result.ok()) << BATT_INSPECT(result.status());
+    first = std::move(*result);
+  });
+  (*device)->read(page_id, [&](llfs::PageDevice::ReadResult result) {
+    ASSERT_TRUE(result.ok()) << BATT_INSPECT(result.status());
+    second = std::move(*result);
+  });
+
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(first->page_id(), page_id);
+  EXPECT_EQ(first->size(), llfs::PageSize{kTestPageSize});
+  EXPECT_EQ(static_cast<const char*>(first->const_payload().data())[0], 'x');
+
+  // Reading a page with a different generation reports not found; reading a page that was never
+  // written fails its sanity check.
+  //
+  (*device)->read(ids.make_page_id(1, 2), [](llfs::PageDevice::ReadResult result) {
+    EXPECT_EQ(result.status(), batt::StatusCode::kNotFound);
+  });
+  (*device)->read(ids.make_page_id(2, 1), [](llfs::PageDevice::ReadResult result) {
+    EXPECT_EQ(result.status(), llfs::StatusCode::kPageHeaderBadMagic);
+  });
+
+  // Writes and drops are rejected.
+  //
+  EXPECT_EQ((*device)->prepare(page_id).status(), llfs::StatusCode::kPageDeviceReadOnly);
+
+  (*device)->write(std::shared_ptr<const llfs::PageBuffer>{first},
+                   [](llfs::PageDevice::WriteResult result) {
+                     EXPECT_EQ(result, llfs::StatusCode::kPageDeviceReadOnly);
+                   });
+  (*device)->drop(page_id, [](llfs::PageDevice::WriteResult result) {
+    EXPECT_EQ(result, llfs::StatusCode::kPageDeviceReadOnly);
+  });
+
+  // Buffers handed out by the device keep the mapping alive.
+  //
+  device->reset();
+
+  EXPECT_EQ(first->page_id(), page_id);
+  EXPECT_EQ(static_cast<const char*>(first->const_payload().data())[1], 'x');
+}
+
+}  // namespace
@@ -32,6 +32,8 @@ namespace llfs {
       return "kPageDevice";
     case kPageAllocator:
       return "kPageAllocator";
+    case kStripedLog:
+      return "kStripedLog";
     case kVolumeContinuation:
       return "kVolumeContinuation";
     default:
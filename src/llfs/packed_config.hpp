@@ -32,6 +32,7 @@ struct PackedConfigSlotBase {
     static constexpr u16 kLogDevice = 3;      //
     static constexpr u16 kPageDevice = 4;     //
     static constexpr u16 kPageAllocator = 5;  //
+    static constexpr u16 kStripedLog = 6;     // <llfs/striped_log_config.hpp>
 
     // The range [0x1000..0x1fff] is reserved for continuation slots.
 
@@ -0,0 +1,307 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/packed_page_id_list.hpp>
+//
+
+#include <llfs/page_id_factory.hpp>
+#include <llfs/status_code.hpp>
+#include <llfs/varint.hpp>
+
+#include <batteries/assert.hpp>
+
+#include <algorithm>
+
+namespace llfs {
+
+namespace {
+
+// Calls `fn(device_id, first, last)` for each maximal run [first, last) of ids on the same device.
+//
+template <typename Fn>
+void for_each_device_group(const Slice<const PageId>& sorted_page_ids, Fn&& fn)
+{
+  const PageId* first = sorted_page_ids.begin();
+  const PageId* const last = sorted_page_ids.end();
+
+  while (first != last) {
+    const page_device_id_int device_id = PageIdFactory::get_device_id(*first);
+    const PageId* const group_last = std::find_if(first, last, [device_id](const PageId& id) {
+      return PageIdFactory::get_device_id(id) != device_id;
+    });
+
+    fn(device_id, first, group_last);
+
+    first = group_last;
+  }
+}
+
+// The first id in a device group is delta-encoded from this value, i.e. it is written with its
+// device bits masked off.
+//
+page_id_int device_base_id(page_device_id_int device_id)
+{
+  return (device_id << kPageDeviceIdShift) & kPageDeviceIdMask;
+}
+
+usize device_delta_varint_size(const Slice<const PageId>& sorted_page_ids)
+{
+  usize total = 0;
+
+  for_each_device_group(sorted_page_ids, [&total](page_device_id_int device_id,
+                                                  const PageId* first, const PageId* last) {
+    total += packed_sizeof_varint(device_id)  //
+             + packed_sizeof_varint(static_cast<u64>(last - first));
+
+    page_id_int prev_id = device_base_id(device_id);
+    for (; first != last; ++first) {
+      total += packed_sizeof_varint(first->int_value() - prev_id);
+      prev_id = first->int_value();
+    }
+  });
+
+  return total;
+}
+
+}  // namespace
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::ostream& operator<<(std::ostream& out, const PackedPageIdList& t)
+{
+  return out << "PackedPageIdList{.size=" << t.size() << ", .encoding=" << (int)t.encoding.value()
+             << ", .payload_size=" << t.payload_size() << ",}";
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// class PackedPageIdListSeq
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ PackedPageIdListSeq::PackedPageIdListSeq(const PackedPageIdList& packed) noexcept
+    : encoding_{packed.encoding}
+    , next_{packed.payload_begin()}
+    , end_{packed.payload_end()}
+{
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Optional<PageId> PackedPageIdListSeq::peek()
+{
+  return batt::make_copy(*this).next();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Optional<PageId> PackedPageIdListSeq::next()
+{
+  if (this->next_ == this->end_) {
+    return None;
+  }
+
+  if (this->encoding_ == PackedPageIdList::kArray) {
+    const auto* packed_id = reinterpret_cast<const PackedPageId*>(this->next_);
+    this->next_ += sizeof(PackedPageId);
+    return packed_id->as_page_id();
+  }
+
+  if (this->group_remaining_ == 0) {
+    const page_device_id_int device_id = this->next_varint();
+    this->group_remaining_ = this->next_varint();
+    this->prev_id_ = device_base_id(device_id);
+  }
+
+  this->prev_id_ += this->next_varint();
+  this->group_remaining_ -= 1;
+
+  return PageId{this->prev_id_};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 PackedPageIdListSeq::next_varint()
+{
+  auto [value, after] = unpack_varint_from(this->next_, this->end_);
+  BATT_CHECK(value) << "PackedPageIdList must be validated before it is decoded";
+
+  this->next_ = after;
+  return *value;
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::vector<PageId> sorted_page_ids(const BoxedSeq<PageId>& page_ids)
+{
+  std::vector<PageId> ids = batt::make_copy(page_ids) | seq::collect_vec();
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize packed_page_id_list_size(const Slice<const PageId>& sorted_page_ids)
+{
+  const usize array_size = sizeof(PackedPageId) * sorted_page_ids.size();
+  const usize compact_size = device_delta_varint_size(sorted_page_ids);
+
+  return sizeof(PackedPageIdList) + std::min(array_size, compact_size);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize packed_page_id_list_size(const BoxedSeq<PageId>& page_ids)
+{
+  const std::vector<PageId> sorted = sorted_page_ids(page_ids);
+
+  return packed_page_id_list_size(as_slice(sorted));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PackedPageIdList* pack_page_id_list_to(const Slice<const PageId>& sorted_page_ids,
+                                       PackedPageIdList* packed, DataPacker* dst)
+{
+  BATT_ASSERT(std::is_sorted(sorted_page_ids.begin(), sorted_page_ids.end()));
+
+  const usize item_count = sorted_page_ids.size();
+  const usize array_size = sizeof(PackedPageId) * item_count;
+  const usize compact_size = device_delta_varint_size(sorted_page_ids);
+
+  packed->item_count = item_count;
+  BATT_CHECK_EQ(packed->item_count.value(), item_count);
+
+  if (compact_size < array_size) {
+    packed->encoding = PackedPageIdList::kDeviceDeltaVarint;
+    packed->encoded_size = compact_size;
+
+    bool ok = true;
+    for_each_device_group(sorted_page_ids, [&ok, dst](page_device_id_int device_id,
+                                                      const PageId* first, const PageId* last) {
+      ok = ok && dst->pack_varint(device_id) && dst->pack_varint(static_cast<u64>(last - first));
+
+      page_id_int prev_id = device_base_id(device_id);
+      for (; ok && first != last; ++first) {
+        ok = (dst->pack_varint(first->int_value() - prev_id) != nullptr);
+        prev_id = first->int_value();
+      }
+    });
+    if (!ok) {
+      return nullptr;
+    }
+  } else {
+    packed->encoding = PackedPageIdList::kArray;
+    packed->encoded_size = 0;
+
+    for (const PageId& page_id : sorted_page_ids) {
+      if (pack_object(page_id, dst) == nullptr) {
+        return nullptr;
+      }
+    }
+  }
+
+  return packed;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PackedPageIdList* pack_page_id_list(const Slice<const PageId>& sorted_page_ids, DataPacker* dst)
+{
+  PackedPageIdList* const packed = dst->pack_record<PackedPageIdList>();
+  if (packed == nullptr) {
+    return nullptr;
+  }
+
+  return pack_page_id_list_to(sorted_page_ids, packed, dst);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PackedPageIdList* pack_page_id_list(const BoxedSeq<PageId>& page_ids, DataPacker* dst)
+{
+  const std::vector<PageId> sorted = sorted_page_ids(page_ids);
+
+  return pack_page_id_list(as_slice(sorted), dst);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize packed_sizeof(const PackedPageIdList& packed)
+{
+  return sizeof(PackedPageIdList) + packed.payload_size();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status validate_packed_value(const PackedPageIdList& packed, const void* buffer_data,
+                             usize buffer_size)
+{
+  BATT_REQUIRE_OK(validate_packed_struct(packed, buffer_data, buffer_size));
+  BATT_REQUIRE_OK(
+      validate_packed_byte_range(&packed, packed_sizeof(packed), buffer_data, buffer_size));
+
+  switch (packed.encoding) {
+    case PackedPageIdList::kArray:
+      if (packed.encoded_size != 0) {
+        return make_status(StatusCode::kBadPackedPageIdList);
+      }
+      return OkStatus();
+
+    case PackedPageIdList::kDeviceDeltaVarint:
+      break;
+
+    default:
+      return make_status(StatusCode::kBadPackedPageIdList);
+  }
+
+  // Walk the whole payload to make sure it decodes to exactly `item_count` ids, each of which stays
+  // within the device named in its group header.
+  //
+  const u8* next = packed.payload_begin();
+  const u8* const end = packed.payload_end();
+
+  const auto read_varint = [&next, end]() -> Optional<u64> {
+    auto [value, after] = unpack_varint_from(next, end);
+    if (value) {
+      next = after;
+    }
+    return value;
+  };
+
+  usize total_count = 0;
+  while (next != end) {
+    const Optional<u64> device_id = read_varint();
+    const Optional<u64> group_count = read_varint();
+    if (!device_id || !group_count || *group_count == 0 ||
+        *device_id > (kPageDeviceIdMask >> kPageDeviceIdShift)) {
+      return make_status(StatusCode::kBadPackedPageIdList);
+    }
+
+    const page_id_int max_id = device_base_id(*device_id) | ~kPageDeviceIdMask;
+    page_id_int id = device_base_id(*device_id);
+
+    for (u64 i = 0; i < *group_count; ++i) {
+      const Optional<u64> delta = read_varint();
+      if (!delta || *delta > max_id - id) {
+        return make_status(StatusCode::kBadPackedPageIdList);
+      }
+      id += *delta;
+    }
+    total_count += *group_count;
+  }
+
+  if (total_count != packed.size()) {
+    return make_status(StatusCode::kBadPackedPageIdList);
+  }
+
+  return OkStatus();
+}
+
+}  // namespace llfs
@@ -0,0 +1,175 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_PACKED_PAGE_ID_LIST_HPP
+#define LLFS_PACKED_PAGE_ID_LIST_HPP
+
+#include <llfs/data_layout.hpp>
+#include <llfs/data_packer.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/optional.hpp>
+#include <llfs/packed_array.hpp>
+#include <llfs/packed_page_id.hpp>
+#include <llfs/page_id.hpp>
+#include <llfs/seq.hpp>
+#include <llfs/slice.hpp>
+#include <llfs/status.hpp>
+
+#include <batteries/static_assert.hpp>
+
+#include <ostream>
+#include <vector>
+
+namespace llfs {
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief A packed set of page ids, stored either as a plain array of PackedPageId or in a compact
+ * sorted encoding.
+ *
+ * The header is layout-compatible with PackedArray<PackedPageId>: `encoding` and `encoded_size`
+ * occupy bytes that PackedArray always sets to zero, so a PackedArray<PackedPageId> written by an
+ * older version is read back as a list with encoding kArray.
+ *
+ * In the compact encoding (kDeviceDeltaVarint) the ids are sorted and grouped by device.  Each
+ * group is written as:
+ *
+ *   varint(device_id), varint(id_count), varint(first id, device bits masked off),
+ *   varint(delta from previous id) * (id_count - 1)
+ *
+ * Page ids allocated together by a job tend to be dense within a device, so most ids take 1-3
+ * bytes instead of 8.
+ */
+struct PackedPageIdList {
+  enum Encoding : u8 {
+    kArray = 0,
+    kDeviceDeltaVarint = 1,
+  };
+
+  little_u24 item_count;
+  little_u8 encoding;
+
+  // The number of bytes following this header for kDeviceDeltaVarint; 0 for kArray.
+  //
+  little_u32 encoded_size;
+
+  u8 data_[0];
+
+  // This struct must never be copied since that would invalidate `data_`.
+  //
+  PackedPageIdList(const PackedPageIdList&) = delete;
+  PackedPageIdList& operator=(const PackedPageIdList&) = delete;
+
+  usize size() const
+  {
+    return this->item_count;
+  }
+
+  bool empty() const
+  {
+    return this->item_count == 0;
+  }
+
+  /** \brief The number of bytes following the header.
+   */
+  usize payload_size() const
+  {
+    if (this->encoding == kArray) {
+      return sizeof(PackedPageId) * this->size();
+    }
+    return this->encoded_size;
+  }
+
+  const u8* payload_begin() const
+  {
+    return this->data_;
+  }
+
+  const u8* payload_end() const
+  {
+    return this->data_ + this->payload_size();
+  }
+};
+
+BATT_STATIC_ASSERT_EQ(sizeof(PackedPageIdList), sizeof(PackedArray<PackedPageId>));
+
+std::ostream& operator<<(std::ostream& out, const PackedPageIdList& t);
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief Seq of PageId decoded lazily from a PackedPageIdList.  The list must have passed
+ * validate_packed_value.
+ */
+class PackedPageIdListSeq
+{
+ public:
+  using Item = PageId;
+
+  explicit PackedPageIdListSeq(const PackedPageIdList& packed) noexcept;
+
+  Optional<PageId> peek();
+
+  Optional<PageId> next();
+
+ private:
+  u64 next_varint();
+
+  u8 encoding_;
+  const u8* next_;
+  const u8* end_;
+
+  // kDeviceDeltaVarint decoder state.
+  //
+  usize group_remaining_ = 0;
+  page_id_int prev_id_ = 0;
+};
+
+inline PackedPageIdListSeq as_seq(const PackedPageIdList& packed)
+{
+  return PackedPageIdListSeq{packed};
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+
+/** \brief Collects `page_ids` into a vector, sorted in the order used by PackedPageIdList.
+ */
+std::vector<PageId> sorted_page_ids(const BoxedSeq<PageId>& page_ids);
+
+/** \brief Returns the exact number of bytes needed to pack `sorted_page_ids` as a PackedPageIdList,
+ * including the header.
+ */
+usize packed_page_id_list_size(const Slice<const PageId>& sorted_page_ids);
+
+/** \brief Returns the exact number of bytes needed to pack `page_ids` (in any order) as a
+ * PackedPageIdList, including the header.
+ */
+usize packed_page_id_list_size(const BoxedSeq<PageId>& page_ids);
+
+/** \brief Initializes the header at `packed` (which must already be allocated from `dst`) and packs
+ * the list payload immediately after it.  Uses whichever of the two encodings is smaller.
+ *
+ * \return `packed` on success, nullptr if `dst` ran out of space.
+ */
+PackedPageIdList* pack_page_id_list_to(const Slice<const PageId>& sorted_page_ids,
+                                       PackedPageIdList* packed, DataPacker* dst);
+
+/** \brief Allocates a new PackedPageIdList from `dst` and packs `sorted_page_ids` into it.
+ */
+PackedPageIdList* pack_page_id_list(const Slice<const PageId>& sorted_page_ids, DataPacker* dst);
+
+/** \brief Allocates a new PackedPageIdList from `dst` and packs `page_ids` (in any order) into it.
+ */
+PackedPageIdList* pack_page_id_list(const BoxedSeq<PageId>& page_ids, DataPacker* dst);
+
+usize packed_sizeof(const PackedPageIdList& packed);
+
+Status validate_packed_value(const PackedPageIdList& packed, const void* buffer_data,
+                             usize buffer_size);
+
+}  // namespace llfs
+
+#endif  // LLFS_PACKED_PAGE_ID_LIST_HPP
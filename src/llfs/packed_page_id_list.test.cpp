@@ -0,0 +1,196 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/packed_page_id_list.hpp>
+//
+#include <llfs/packed_page_id_list.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/page_id_factory.hpp>
+#include <llfs/status_code.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+using namespace llfs::int_types;
+
+constexpr usize kBufferSize = 64 * 1024;
+
+// Packs `page_ids` into `storage` and returns the packed list; also checks that the size estimate
+// is exact.
+//
+const llfs::PackedPageIdList* pack_ids(const std::vector<llfs::PageId>& page_ids,
+                                       std::vector<u8>& storage)
+{
+  const usize expected_size = llfs::packed_page_id_list_size(
+      batt::as_seq(page_ids) | batt::seq::decayed() | batt::seq::boxed());
+
+  storage.clear();
+  storage.resize(kBufferSize, 0);
+
+  llfs::DataPacker packer{llfs::MutableBuffer{storage.data(), storage.size()}};
+
+  const llfs::PackedPageIdList* packed = llfs::pack_page_id_list(
+      batt::as_seq(page_ids) | batt::seq::decayed() | batt::seq::boxed(), &packer);
+
+  EXPECT_NE(packed, nullptr);
+  EXPECT_EQ(storage.size() - packer.space(), expected_size);
+  if (packed != nullptr) {
+    EXPECT_EQ(llfs::packed_sizeof(*packed), expected_size);
+    EXPECT_TRUE(llfs::validate_packed_value(*packed, storage.data(), expected_size).ok());
+  }
+
+  return packed;
+}
+
+std::vector<llfs::PageId> unpack_ids(const llfs::PackedPageIdList& packed)
+{
+  return llfs::as_seq(packed) | batt::seq::collect_vec();
+}
+
+std::vector<llfs::PageId> sorted(std::vector<llfs::PageId> page_ids)
+{
+  std::sort(page_ids.begin(), page_ids.end());
+  return page_ids;
+}
+
+TEST(PackedPageIdListTest, Empty)
+{
+  std::vector<u8> storage;
+  const llfs::PackedPageIdList* packed = pack_ids({}, storage);
+
+  ASSERT_NE(packed, nullptr);
+  EXPECT_TRUE(packed->empty());
+  EXPECT_EQ(llfs::packed_sizeof(*packed), sizeof(llfs::PackedPageIdList));
+  EXPECT_THAT(unpack_ids(*packed), ::testing::IsEmpty());
+}
+
+TEST(PackedPageIdListTest, DenseMultiDeviceIdsAreCompact)
+{
+  std::vector<llfs::PageId> page_ids;
+  for (llfs::page_device_id_int device_id : {3, 0, 7}) {
+    const llfs::PageIdFactory ids{llfs::PageCount{1 << 20}, device_id};
+    for (i64 physical_page = 1000; physical_page < 1100; physical_page += 3) {
+      page_ids.emplace_back(ids.make_page_id(physical_page, /*generation=*/5));
+    }
+  }
+  std::shuffle(page_ids.begin(), page_ids.end(), std::default_random_engine{1});
+
+  std::vector<u8> storage;
+  const llfs::PackedPageIdList* packed = pack_ids(page_ids, storage);
+
+  ASSERT_NE(packed, nullptr);
+  EXPECT_EQ(packed->encoding, llfs::PackedPageIdList::kDeviceDeltaVarint);
+  EXPECT_EQ(packed->size(), page_ids.size());
+  EXPECT_LT(packed->payload_size() * 4, page_ids.size() * sizeof(llfs::PackedPageId));
+  EXPECT_EQ(unpack_ids(*packed), sorted(page_ids));
+}
+
+TEST(PackedPageIdListTest, SparseIdsFallBackToArray)
+{
+  // One id per device, each with a large in-device offset: the compact encoding would be larger.
+  //
+  std::vector<llfs::PageId> page_ids;
+  for (llfs::page_device_id_int device_id = 0; device_id < 8; ++device_id) {
+    page_ids.emplace_back(((device_id + 1) << llfs::kPageDeviceIdShift) - 1);
+  }
+
+  std::vector<u8> storage;
+  const llfs::PackedPageIdList* packed = pack_ids(page_ids, storage);
+
+  ASSERT_NE(packed, nullptr);
+  EXPECT_EQ(packed->encoding, llfs::PackedPageIdList::kArray);
+  EXPECT_EQ(packed->encoded_size, 0u);
+  EXPECT_EQ(unpack_ids(*packed), sorted(page_ids));
+}
+
+TEST(PackedPageIdListTest, ReadsLegacyPackedArray)
+{
+  const std::vector<llfs::PageId> page_ids{llfs::PageId{0x30}, llfs::PageId{0x10},
+                                           llfs::PageId{0x20}};
+
+  std::vector<u8> storage(kBufferSize, 0);
+  llfs::DataPacker packer{llfs::MutableBuffer{storage.data(), storage.size()}};
+
+  llfs::PackedArray<llfs::PackedPageId>* legacy = llfs::pack_object(
+      batt::as_seq(page_ids) | batt::seq::decayed() | batt::seq::boxed(), &packer);
+  ASSERT_NE(legacy, nullptr);
+
+  const auto& packed = reinterpret_cast<const llfs::PackedPageIdList&>(*legacy);
+
+  EXPECT_TRUE(llfs::validate_packed_value(packed, storage.data(), storage.size()).ok());
+  EXPECT_EQ(packed.encoding, llfs::PackedPageIdList::kArray);
+  EXPECT_EQ(llfs::packed_sizeof(packed), llfs::packed_sizeof(*legacy));
+
+  // Legacy arrays are decoded in their original order.
+  //
+  EXPECT_EQ(unpack_ids(packed), page_ids);
+}
+
+TEST(PackedPageIdListTest, PackFailsWhenOutOfSpace)
+{
+  std::vector<llfs::PageId> page_ids;
+  for (u64 i = 0; i < 100; ++i) {
+    page_ids.emplace_back(i * 1000);
+  }
+  const std::vector<llfs::PageId> sorted_page_ids = sorted(page_ids);
+  const usize size = llfs::packed_page_id_list_size(batt::as_slice(sorted_page_ids));
+
+  for (usize truncate_count : {1, 2, 50}) {
+    std::vector<u8> storage(size - truncate_count, 0);
+    llfs::DataPacker packer{llfs::MutableBuffer{storage.data(), storage.size()}};
+
+    EXPECT_EQ(llfs::pack_page_id_list(
+                  batt::as_seq(page_ids) | batt::seq::decayed() | batt::seq::boxed(), &packer),
+              nullptr)
+        << BATT_INSPECT(truncate_count);
+  }
+}
+
+TEST(PackedPageIdListTest, ValidateRejectsCorruptPayload)
+{
+  std::vector<llfs::PageId> page_ids;
+  for (u64 i = 1; i <= 20; ++i) {
+    page_ids.emplace_back(i);
+  }
+
+  std::vector<u8> storage;
+  const llfs::PackedPageIdList* packed = pack_ids(page_ids, storage);
+  ASSERT_NE(packed, nullptr);
+  ASSERT_EQ(packed->encoding, llfs::PackedPageIdList::kDeviceDeltaVarint);
+
+  const usize size = llfs::packed_sizeof(*packed);
+  auto* mutable_packed = const_cast<llfs::PackedPageIdList*>(packed);
+
+  // Wrong item count.
+  //
+  mutable_packed->item_count = page_ids.size() + 1;
+  EXPECT_EQ(llfs::validate_packed_value(*packed, storage.data(), size),
+            llfs::StatusCode::kBadPackedPageIdList);
+  mutable_packed->item_count = page_ids.size();
+
+  // Unknown encoding.
+  //
+  mutable_packed->encoding = 0x7f;
+  EXPECT_EQ(llfs::validate_packed_value(*packed, storage.data(), size),
+            llfs::StatusCode::kBadPackedPageIdList);
+  mutable_packed->encoding = llfs::PackedPageIdList::kDeviceDeltaVarint;
+
+  // Truncated varint at the end of the payload.
+  //
+  storage[size - 1] |= 0x80;
+  EXPECT_EQ(llfs::validate_packed_value(*packed, storage.data(), size),
+            llfs::StatusCode::kBadPackedPageIdList);
+}
+
+}  // namespace
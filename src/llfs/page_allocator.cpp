@@ -19,6 +19,9 @@
 #include <boost/range/irange.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace llfs {
 
 u64 PageAllocator::calculate_log_size(u64 physical_page_count, u64 max_attachments)
@@ -62,15 +65,31 @@ StatusOr<std::unique_ptr<PageAllocator>> PageAllocator::recover(
 
   PageAllocator::Metrics metrics;
 
+  // Ref count updates for different pages are independent, so on larger devices they are replayed
+  // in parallel, partitioned by physical page range.
+  //
+  const usize max_recovery_tasks = (options.max_recovery_tasks != 0)
+                                       ? options.max_recovery_tasks
+                                       : std::max<usize>(1, std::thread::hardware_concurrency());
+
+  const usize partition_count = std::clamp<usize>(
+      page_ids.get_physical_page_count().value() / kMinPagesPerRecoveryTask, 1, max_recovery_tasks);
+
+  PageAllocatorState::DeferredRefCounts deferred(partition_count);
+
   // For each recovered event in the log, update the state machine.
   //
-  auto process_recovered_event = [&recovered_state, &metrics](const SlotParse& slot,
-                                                              const auto& event_payload) -> Status {
+  auto process_recovered_event = [&recovered_state, &metrics, &deferred](
+                                     const SlotParse& slot, const auto& event_payload) -> Status {
     if (!PageAllocatorState::is_valid(recovered_state->propose(event_payload))) {
       return ::llfs::make_status(::llfs::StatusCode::kInvalidPageAllocatorProposal);
     }
 
-    recovered_state->learn(slot.offset.lower_bound, event_payload, metrics);
+    if (deferred.size() > 1) {
+      recovered_state->learn_deferred(slot.offset.lower_bound, event_payload, metrics, deferred);
+    } else {
+      recovered_state->learn(slot.offset.lower_bound, event_payload, metrics);
+    }
     return OkStatus();
   };
 
@@ -90,6 +109,11 @@ StatusOr<std::unique_ptr<PageAllocator>> PageAllocator::recover(
 
   BATT_REQUIRE_OK(recovered_log);
 
+  if (partition_count > 1) {
+    LLFS_VLOG(1) << "PageAllocator replaying ref counts: " << BATT_INSPECT(partition_count);
+    recovered_state->replay_deferred(std::move(deferred), options.scheduler, metrics);
+  }
+
   // Now we can create the PageAllocator.
   //
   return std::unique_ptr<PageAllocator>{new PageAllocator{
@@ -231,6 +255,13 @@ std::pair<i32, slot_offset_type> PageAllocator::get_ref_count(PageId id)
   return this->state_->get_ref_count(id);
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PageRefCount PageAllocator::get_ref_count_obj(PageId id)
+{
+  return this->state_->get_ref_count_obj(id);
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 BoxedSeq<PageRefCount> PageAllocator::page_ref_counts()
@@ -46,6 +46,10 @@ class PageAllocator
  public:
   static constexpr usize kCheckpointGrantSize = 4 * kKiB;
 
+  // Recovery only replays the log on more than one task if each gets at least this many pages.
+  //
+  static constexpr u64 kMinPagesPerRecoveryTask = 16 * 1024;
+
   using Metrics = PageAllocatorMetrics;
   using State = PageAllocatorState;
   using StateNoLock = PageAllocatorStateNoLock;
@@ -99,6 +103,11 @@ class PageAllocator
   //
   std::pair<i32, slot_offset_type> get_ref_count(PageId id);
 
+  // Returns the current ref count of the physical page that `id` refers to, along with the page's
+  // current generation (as part of the returned `page_id`).
+  //
+  PageRefCount get_ref_count_obj(PageId id);
+
   // Updates the index synchronously by applying the specified event.  Must be one of the event
   // types enumerated in page_device_event_types.hpp.
   //
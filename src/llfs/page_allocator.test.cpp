@@ -23,6 +23,7 @@
 
 #include <boost/uuid/uuid_generators.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <random>
 #include <unordered_set>
@@ -131,6 +132,133 @@ TEST(PageAllocatorTest, UpdateRefCounts)
   }
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Recovering a large allocator replays its log in parallel; the result must match a sequential
+// replay of the same log.
+//
+TEST(PageAllocatorTest, ParallelRecovery)
+{
+  constexpr u64 kNumPages = PageAllocator::kMinPagesPerRecoveryTask * 4;
+  constexpr usize kNumTxns = 200;
+  constexpr usize kPagesPerTxn = 300;
+
+  std::default_random_engine rng{1};
+  std::uniform_int_distribution<usize> pick_physical_page(0u, kNumPages - 1u);
+  std::uniform_int_distribution<i32> pick_ref_count_delta(-5, +5);
+
+  MemoryLogDevice mem_log{PageAllocator::calculate_log_size(kNumPages, /*max_attachments=*/1)};
+
+  const auto recover = [&mem_log](usize max_recovery_tasks) {
+    FakeLogDeviceFactory<MemoryLogStorageDriver> fake_log_factory{
+        mem_log, mem_log.driver().impl(), std::make_shared<FakeLogDevice::State>()};
+
+    StatusOr<std::unique_ptr<PageAllocator>> page_allocator = PageAllocator::recover(
+        PageAllocatorRuntimeOptions{
+            .scheduler = batt::Runtime::instance().default_scheduler(),
+            .name = "Test",
+            .max_recovery_tasks = max_recovery_tasks,
+        },
+        PageIdFactory{/*device_capacity=*/PageCount{kNumPages}, /*page_device_id=*/0},
+        fake_log_factory);
+
+    BATT_CHECK_OK(page_allocator);
+    return std::move(*page_allocator);
+  };
+
+  std::vector<i32> expect_ref_count(kNumPages, 0);
+  {
+    std::unique_ptr<PageAllocator> page_allocator = recover(1);
+
+    const auto user_id = boost::uuids::random_generator{}();
+    ASSERT_TRUE(page_allocator
+                    ->update_sync(PackedPageAllocatorAttach{
+                        .user_slot =
+                            {
+                                .user_id = user_id,
+                                .slot_offset = 0,
+                            },
+                    })
+                    .ok());
+
+    StatusOr<slot_offset_type> updated;
+    for (usize txn_i = 1; txn_i <= kNumTxns; ++txn_i) {
+      std::unordered_set<usize> pages_in_txn;
+      std::vector<PageRefCount> prcs;
+      for (usize i = 0; i < kPagesPerTxn; ++i) {
+        const usize page_i = pick_physical_page(rng);
+        if (!pages_in_txn.emplace(page_i).second) {
+          continue;
+        }
+        const i32 delta = pick_ref_count_delta(rng);
+
+        PageRefCount& prc = prcs.emplace_back();
+        prc.page_id = page_i;
+
+        if (expect_ref_count[page_i] == 0) {
+          prc.ref_count = +2;
+        } else if (expect_ref_count[page_i] == 1 && delta < 0) {
+          prc.ref_count = llfs::kRefCount_1_to_0;
+        } else {
+          prc.ref_count = std::clamp<i32>(delta, 1 - expect_ref_count[page_i], +5);
+        }
+
+        if (prc.ref_count == llfs::kRefCount_1_to_0) {
+          expect_ref_count[page_i] = 0;
+        } else {
+          expect_ref_count[page_i] += prc.ref_count;
+        }
+      }
+
+      updated = page_allocator->update_page_ref_counts(user_id, /*user_slot=*/txn_i,
+                                                       llfs::as_seq(prcs));
+      ASSERT_TRUE(updated.ok()) << BATT_INSPECT(updated.status());
+    }
+    ASSERT_TRUE(page_allocator->sync(*updated).ok());
+
+    page_allocator->halt();
+    page_allocator->join();
+  }
+
+  std::unique_ptr<PageAllocator> sequential = recover(1);
+  std::unique_ptr<PageAllocator> parallel = recover(4);
+
+  for (page_id_int page_i = 0; page_i < kNumPages; ++page_i) {
+    const PageRefCount expected = sequential->get_ref_count_obj(PageId{page_i});
+    const PageRefCount actual = parallel->get_ref_count_obj(PageId{page_i});
+
+    ASSERT_EQ(expected.ref_count, expect_ref_count[page_i]) << BATT_INSPECT(page_i);
+    ASSERT_EQ(actual.ref_count, expected.ref_count) << BATT_INSPECT(page_i);
+    ASSERT_EQ(actual.page_id, expected.page_id) << BATT_INSPECT(page_i);
+  }
+
+  const auto user_slots = [](PageAllocator& page_allocator) {
+    std::vector<slot_offset_type> slots;
+    for (const PageAllocatorAttachmentStatus& status :
+         page_allocator.get_all_clients_attachment_status()) {
+      slots.emplace_back(status.user_slot);
+    }
+    return slots;
+  };
+  EXPECT_EQ(user_slots(*parallel), user_slots(*sequential));
+  EXPECT_EQ(user_slots(*parallel), std::vector<slot_offset_type>{kNumTxns});
+
+  // Both free pools must hold the same pages.
+  //
+  const auto allocate_all = [](PageAllocator& page_allocator) {
+    std::vector<PageId> page_ids;
+    for (;;) {
+      StatusOr<PageId> page_id = page_allocator.allocate_page(batt::WaitForResource::kFalse);
+      if (!page_id.ok()) {
+        break;
+      }
+      page_ids.emplace_back(*page_id);
+    }
+    std::sort(page_ids.begin(), page_ids.end());
+    return page_ids;
+  };
+  EXPECT_EQ(allocate_all(*parallel), allocate_all(*sequential));
+}
+
 TEST(PageAllocatorTest, LogCrashRecovery)
 {
   llfs::suppress_log_output_for_test() = true;
@@ -10,13 +10,22 @@
 #ifndef LLFS_PAGE_ALLOCATOR_RUNTIME_OPTIONS_HPP
 #define LLFS_PAGE_ALLOCATOR_RUNTIME_OPTIONS_HPP
 
+#include <llfs/int_types.hpp>
+
 #include <batteries/async/task_scheduler.hpp>
 
+#include <string_view>
+
 namespace llfs {
 
 struct PageAllocatorRuntimeOptions {
   batt::TaskScheduler& scheduler;
   std::string_view name;
+
+  // The maximum number of tasks used to replay the allocator log in parallel during recovery; 0
+  // means one per hardware thread.  Small devices are always replayed on a single task.
+  //
+  usize max_recovery_tasks = 0;
 };
 
 }  // namespace llfs
@@ -11,10 +11,149 @@
 
 #include <llfs/logging.hpp>
 
+#include <batteries/async/task.hpp>
+#include <batteries/stream_util.hpp>
+
+#include <algorithm>
+#include <queue>
+
 namespace llfs {
 
 using Metrics = PageAllocatorMetrics;
 
+namespace {
+
+// Free pool membership as tracked by the intrusive list in PageAllocatorState; see
+// PageAllocatorState::learn_ref_count_delta.
+//
+class LinkedFreePool
+{
+ public:
+  explicit LinkedFreePool(PageAllocatorFreePoolList& list, batt::Watch<u64>& size) noexcept
+      : list_{list}
+      , size_{size}
+  {
+  }
+
+  bool contains(const PageAllocatorRefCount* obj) const
+  {
+    return obj->PageAllocatorFreePoolHook::is_linked();
+  }
+
+  void insert(PageAllocatorRefCount* obj)
+  {
+    this->list_.push_back(*obj);
+    this->size_.fetch_add(1);
+  }
+
+  void erase(PageAllocatorRefCount* obj)
+  {
+    this->list_.erase(this->list_.iterator_to(*obj));
+    this->size_.fetch_sub(1);
+  }
+
+ private:
+  PageAllocatorFreePoolList& list_;
+  batt::Watch<u64>& size_;
+};
+
+// Returns true iff `a` was last updated before `b`.
+//
+inline bool updated_before(const PageAllocatorObject* a, const PageAllocatorObject* b)
+{
+  return slot_less_than(a->last_update(), b->last_update());
+}
+
+// Calls `fn` on every object in `lists`, each of which must be sorted by last update, in order of
+// last update.
+//
+template <typename T, typename Fn>
+void merge_by_last_update(const std::vector<const std::vector<T*>*>& lists, Fn&& fn)
+{
+  using Cursor = std::pair<usize, usize>;  // (list index, position in list)
+
+  const auto updated_after = [&lists](const Cursor& a, const Cursor& b) {
+    return updated_before((*lists[b.first])[b.second], (*lists[a.first])[a.second]);
+  };
+
+  std::priority_queue<Cursor, std::vector<Cursor>, decltype(updated_after)> next{updated_after};
+
+  for (usize i = 0; i < lists.size(); ++i) {
+    if (!lists[i]->empty()) {
+      next.emplace(i, 0);
+    }
+  }
+
+  while (!next.empty()) {
+    Cursor cursor = next.top();
+    next.pop();
+
+    fn((*lists[cursor.first])[cursor.second]);
+
+    cursor.second += 1;
+    if (cursor.second < lists[cursor.first]->size()) {
+      next.push(cursor);
+    }
+  }
+}
+
+}  // namespace
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+
+struct PageAllocatorState::ReplayPartition {
+  // Bits of `page_flags`.
+  //
+  static constexpr u8 kInFreePool = 0x1;
+  static constexpr u8 kLeftFreePool = 0x2;
+  static constexpr u8 kUpdated = 0x4;
+
+  u8& flags_of(const PageAllocatorRefCount* obj)
+  {
+    return this->page_flags[std::distance<const PageAllocatorRefCount*>(this->first_page, obj)];
+  }
+
+  // Free pool membership, in place of LinkedFreePool; see learn_ref_count_delta.
+  //
+  bool contains(const PageAllocatorRefCount* obj)
+  {
+    return (this->flags_of(obj) & kInFreePool) != 0;
+  }
+
+  void insert(PageAllocatorRefCount* obj)
+  {
+    this->flags_of(obj) |= kInFreePool;
+  }
+
+  void erase(PageAllocatorRefCount* obj)
+  {
+    u8& flags = this->flags_of(obj);
+    flags = static_cast<u8>((flags & ~kInFreePool) | kLeftFreePool);
+  }
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The ref count object of the first page in this partition.
+  //
+  PageAllocatorRefCount* first_page = nullptr;
+
+  // The updates to replay, in log order.
+  //
+  std::vector<DeferredRefCount> updates;
+
+  // The flags above, for each page in the partition.
+  //
+  std::vector<u8> page_flags;
+
+  // The pages updated by this partition, sorted by last update once it has been replayed.
+  //
+  std::vector<PageAllocatorObject*> updated_pages;
+
+  // The pages that left the free pool and were then put back, sorted by last update.
+  //
+  std::vector<PageAllocatorRefCount*> refreed_pages;
+};
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 
 PageAllocatorStateNoLock::PageAllocatorStateNoLock(const PageIdFactory& ids) noexcept
@@ -398,35 +537,44 @@ void PageAllocatorState::learn(slot_offset_type index_slot, const PackedPageAllo
 {
   LLFS_VLOG(1) << "(device=" << this->page_ids_.get_device_id() << ") learning " << txn;
 
-  // Update the client attachment for this transaction so we don't double-commit.
-  {
-    auto iter = this->attachments_.find(txn.user_slot.user_id);
-    BATT_CHECK_NE(iter, this->attachments_.end())
-        << "Tried to learn txn from a detached client; this event should have been filtered out by "
-           "propose!";
-
-    PageAllocatorAttachment* const attachment = iter->second.get();
-    BATT_CHECK(slot_less_than(attachment->get_user_slot(), txn.user_slot.slot_offset))
-        << "Tried to learn a txn that we have already learned!  This should have been filtered out "
-           "by propose_exactly_once!";
-
-    attachment->set_user_slot(txn.user_slot.slot_offset);
-    this->set_last_update(attachment, index_slot);
-  }
+  this->learn_txn_attachment(index_slot, txn);
 
   // Apply all ref count updates in the txn.
   //
+  LinkedFreePool free_pool{this->free_pool_, this->free_pool_size_};
+
   for (const PackedPageRefCount& delta : txn.ref_counts) {
     const PageId page_id{delta.page_id.value()};
     const page_id_int physical_page = this->page_ids_.get_physical_page(page_id);
     PageAllocatorRefCount* const obj = &this->page_ref_counts_[physical_page];
-    this->learn_ref_count_delta(delta, obj, metrics);
+    this->learn_ref_count_delta(delta, obj, free_pool, metrics);
     this->set_last_update(obj, index_slot);
   }
 
   this->update_learned_upper_bound(index_slot + packed_sizeof_slot(txn));
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageAllocatorState::learn_txn_attachment(slot_offset_type index_slot,
+                                              const PackedPageAllocatorTxn& txn)
+{
+  // Update the client attachment for this transaction so we don't double-commit.
+  //
+  auto iter = this->attachments_.find(txn.user_slot.user_id);
+  BATT_CHECK_NE(iter, this->attachments_.end())
+      << "Tried to learn txn from a detached client; this event should have been filtered out by "
+         "propose!";
+
+  PageAllocatorAttachment* const attachment = iter->second.get();
+  BATT_CHECK(slot_less_than(attachment->get_user_slot(), txn.user_slot.slot_offset))
+      << "Tried to learn a txn that we have already learned!  This should have been filtered out "
+         "by propose_exactly_once!";
+
+  attachment->set_user_slot(txn.user_slot.slot_offset);
+  this->set_last_update(attachment, index_slot);
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 namespace {
@@ -469,8 +617,10 @@ void run_ref_count_update_sanity_checks(const PackedPageRefCount& delta, i32 bef
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
+template <typename FreePool>
 void PageAllocatorState::learn_ref_count_delta(const PackedPageRefCount& delta,
-                                               PageAllocatorRefCount* const obj, Metrics& metrics)
+                                               PageAllocatorRefCount* const obj,
+                                               FreePool& free_pool, Metrics& metrics)
 {
   const page_generation_int page_generation =
       this->page_ids_.get_generation(PageId{delta.page_id.value()});
@@ -478,7 +628,7 @@ void PageAllocatorState::learn_ref_count_delta(const PackedPageRefCount& delta,
   // Special case for 1 -> 0.
   //
   if (delta.ref_count == kRefCount_1_to_0) {
-    this->learn_ref_count_1_to_0(delta, page_generation, obj, metrics);
+    this->learn_ref_count_1_to_0(delta, page_generation, obj, free_pool, metrics);
     return;
   }
 
@@ -501,9 +651,8 @@ void PageAllocatorState::learn_ref_count_delta(const PackedPageRefCount& delta,
   //
   if (prior_value == 0 && delta.ref_count > 0) {
     BATT_CHECK_GE(delta.ref_count, 2);
-    if (obj->PageAllocatorFreePoolHook::is_linked()) {
-      this->free_pool_.erase(this->free_pool_.iterator_to(*obj));
-      this->free_pool_size_.fetch_sub(1);
+    if (free_pool.contains(obj)) {
+      free_pool.erase(obj);
       metrics.pages_allocated.fetch_add(1);
     }
   }
@@ -511,9 +660,11 @@ void PageAllocatorState::learn_ref_count_delta(const PackedPageRefCount& delta,
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
+template <typename FreePool>
 void PageAllocatorState::learn_ref_count_1_to_0(const PackedPageRefCount& delta,
                                                 page_generation_int page_generation,
-                                                PageAllocatorRefCount* const obj, Metrics& metrics)
+                                                PageAllocatorRefCount* const obj,
+                                                FreePool& free_pool, Metrics& metrics)
 {
   BATT_CHECK_EQ(delta.ref_count, kRefCount_1_to_0);
 
@@ -533,9 +684,8 @@ void PageAllocatorState::learn_ref_count_1_to_0(const PackedPageRefCount& delta,
     if (obj->compare_exchange_weak(count, 0)) {
       LLFS_VLOG(2) << "page ref_count => 0 (adding to free pool): " << std::hex
                    << delta.page_id.value();
-      if (!obj->PageAllocatorFreePoolHook::is_linked()) {
-        this->free_pool_.push_back(*obj);
-        this->free_pool_size_.fetch_add(1);
+      if (!free_pool.contains(obj)) {
+        free_pool.insert(obj);
         metrics.pages_freed.fetch_add(1);
       }
       break;
@@ -543,6 +693,200 @@ void PageAllocatorState::learn_ref_count_1_to_0(const PackedPageRefCount& delta,
   }
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageAllocatorState::learn_deferred(slot_offset_type index_slot,
+                                        const PackedPageAllocatorAttach& attach, Metrics& metrics,
+                                        DeferredRefCounts& /*deferred*/)
+{
+  this->learn(index_slot, attach, metrics);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageAllocatorState::learn_deferred(slot_offset_type index_slot,
+                                        const PackedPageAllocatorDetach& detach, Metrics& metrics,
+                                        DeferredRefCounts& /*deferred*/)
+{
+  this->learn(index_slot, detach, metrics);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageAllocatorState::learn_deferred(slot_offset_type index_slot,
+                                        const PackedPageRefCount& packed, Metrics& /*metrics*/,
+                                        DeferredRefCounts& deferred)
+{
+  const page_id_int physical_page =
+      this->page_ids_.get_physical_page(PageId{packed.page_id.value()});
+
+  deferred[this->replay_partition_of(physical_page, deferred.size())].push_back(DeferredRefCount{
+      .index_slot = index_slot,
+      .ref_count = packed,
+      .is_delta = false,
+  });
+
+  this->update_learned_upper_bound(index_slot + packed_sizeof_slot(packed));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageAllocatorState::learn_deferred(slot_offset_type index_slot,
+                                        const PackedPageAllocatorTxn& txn, Metrics& /*metrics*/,
+                                        DeferredRefCounts& deferred)
+{
+  this->learn_txn_attachment(index_slot, txn);
+
+  for (const PackedPageRefCount& delta : txn.ref_counts) {
+    const page_id_int physical_page =
+        this->page_ids_.get_physical_page(PageId{delta.page_id.value()});
+
+    deferred[this->replay_partition_of(physical_page, deferred.size())].push_back(
+        DeferredRefCount{
+            .index_slot = index_slot,
+            .ref_count = delta,
+            .is_delta = true,
+        });
+  }
+
+  this->update_learned_upper_bound(index_slot + packed_sizeof_slot(txn));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize PageAllocatorState::replay_partition_of(page_id_int physical_page,
+                                              usize partition_count) const
+{
+  BATT_CHECK_LT(physical_page, this->page_device_capacity());
+
+  return physical_page * partition_count / this->page_device_capacity();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageAllocatorState::replay_deferred(DeferredRefCounts&& deferred,
+                                         batt::TaskScheduler& scheduler, Metrics& metrics)
+{
+  const usize partition_count = deferred.size();
+  const u64 capacity = this->page_device_capacity();
+
+  BATT_CHECK_GT(partition_count, 0u);
+  BATT_CHECK_EQ(this->free_pool_.size(), capacity)
+      << "replay_deferred must be called before any ref count updates are learned";
+
+  // Partition `i` holds the physical pages `p` for which `replay_partition_of(p) == i`.
+  //
+  std::vector<ReplayPartition> partitions(partition_count);
+  for (usize i = 0; i < partition_count; ++i) {
+    const u64 begin = (i * capacity + partition_count - 1) / partition_count;
+    const u64 end = ((i + 1) * capacity + partition_count - 1) / partition_count;
+
+    ReplayPartition& partition = partitions[i];
+    partition.first_page = &this->page_ref_counts_[begin];
+    partition.updates = std::move(deferred[i]);
+    partition.page_flags.resize(end - begin, ReplayPartition::kInFreePool);
+  }
+  deferred.clear();
+
+  // Replay all partitions concurrently; this task takes the first.
+  {
+    std::vector<std::unique_ptr<batt::Task>> tasks;
+    for (usize i = 1; i < partition_count; ++i) {
+      tasks.emplace_back(std::make_unique<batt::Task>(
+          scheduler.schedule_task(),
+          [this, &partition = partitions[i], &metrics] {
+            this->replay_partition(partition, metrics);
+          },
+          batt::to_string("PageAllocatorState::replay_partition_", i)));
+    }
+
+    this->replay_partition(partitions[0], metrics);
+
+    for (std::unique_ptr<batt::Task>& task : tasks) {
+      task->join();
+    }
+  }
+
+  // Rebuild the free pool: pages that never left it keep their original order, followed by the
+  // pages that were freed again, in order of last update.
+  //
+  this->free_pool_.clear();
+  for (ReplayPartition& partition : partitions) {
+    for (usize i = 0; i < partition.page_flags.size(); ++i) {
+      const u8 free_flags = partition.page_flags[i] &
+                            (ReplayPartition::kInFreePool | ReplayPartition::kLeftFreePool);
+      if (free_flags == ReplayPartition::kInFreePool) {
+        this->free_pool_.push_back(partition.first_page[i]);
+      }
+    }
+  }
+  {
+    std::vector<const std::vector<PageAllocatorRefCount*>*> refreed;
+    for (const ReplayPartition& partition : partitions) {
+      refreed.emplace_back(&partition.refreed_pages);
+    }
+    merge_by_last_update(refreed, [this](PageAllocatorRefCount* obj) {
+      this->free_pool_.push_back(*obj);
+    });
+  }
+  this->free_pool_size_.set_value(this->free_pool_.size());
+
+  // Rebuild the LRU list, merging the attachments (already learned, in order) with the pages.
+  //
+  {
+    std::vector<PageAllocatorObject*> attachments;
+    for (PageAllocatorObject& obj : this->lru_) {
+      attachments.emplace_back(&obj);
+    }
+    this->lru_.clear();
+
+    std::vector<const std::vector<PageAllocatorObject*>*> updated{&attachments};
+    for (const ReplayPartition& partition : partitions) {
+      updated.emplace_back(&partition.updated_pages);
+    }
+    merge_by_last_update(updated, [this](PageAllocatorObject* obj) {
+      this->lru_.push_back(*obj);
+    });
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageAllocatorState::replay_partition(ReplayPartition& partition, Metrics& metrics)
+{
+  for (const DeferredRefCount& update : partition.updates) {
+    const PageId page_id{update.ref_count.page_id.value()};
+    PageAllocatorRefCount* const obj =
+        &this->page_ref_counts_[this->page_ids_.get_physical_page(page_id)];
+
+    u8& flags = partition.flags_of(obj);
+    if (!(flags & ReplayPartition::kUpdated)) {
+      flags |= ReplayPartition::kUpdated;
+      partition.updated_pages.emplace_back(obj);
+    }
+
+    if (update.is_delta) {
+      this->learn_ref_count_delta(update.ref_count, obj, partition, metrics);
+    } else {
+      obj->set_count(update.ref_count.ref_count);
+      obj->set_generation(this->page_ids_.get_generation(page_id));
+    }
+    obj->set_last_update(update.index_slot);
+  }
+  partition.updates = {};
+
+  std::stable_sort(partition.updated_pages.begin(), partition.updated_pages.end(),
+                   updated_before);
+
+  for (PageAllocatorObject* obj : partition.updated_pages) {
+    auto* const ref_count_obj = static_cast<PageAllocatorRefCount*>(obj);
+    if ((partition.flags_of(ref_count_obj) & ReplayPartition::kLeftFreePool) &&
+        partition.contains(ref_count_obj)) {
+      partition.refreed_pages.emplace_back(ref_count_obj);
+    }
+  }
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 void PageAllocatorState::set_last_update(PageAllocatorObject* obj, slot_offset_type index_slot)
@@ -16,11 +16,14 @@
 #include <llfs/slot.hpp>
 #include <llfs/slot_writer.hpp>
 
+#include <batteries/async/task_scheduler.hpp>
+
 #include <boost/intrusive/list.hpp>
 #include <boost/intrusive/list_hook.hpp>
 #include <boost/uuid/uuid.hpp>
 
 #include <unordered_map>
+#include <vector>
 
 namespace llfs {
 
@@ -334,6 +337,51 @@ class PageAllocatorState : public PageAllocatorStateNoLock
     this->recovering_.store(value);
   }
 
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Partitioned recovery.
+  //
+  // Instead of `learn`, recovery may pass each event to `learn_deferred`, which applies changes to
+  // attachments right away, but only queues per-page ref count updates, partitioned by physical
+  // page range.  Since updates to different pages are independent, `replay_deferred` can then
+  // apply each partition on a separate task before merging the results into the LRU list and free
+  // pool.
+
+  // A ref count update queued by `learn_deferred`.
+  //
+  struct DeferredRefCount {
+    slot_offset_type index_slot;
+    PackedPageRefCount ref_count;
+
+    // True for a delta from a PackedPageAllocatorTxn, false for a PackedPageRefCount (checkpoint)
+    // event, which sets the count.
+    //
+    bool is_delta;
+  };
+
+  // The updates queued by `learn_deferred`, one vector per partition; the number of partitions is
+  // set by the caller.
+  //
+  using DeferredRefCounts = std::vector<std::vector<DeferredRefCount>>;
+
+  void learn_deferred(slot_offset_type index_slot, const PackedPageAllocatorAttach& op,
+                      PageAllocatorMetrics& metrics, DeferredRefCounts& deferred);
+
+  void learn_deferred(slot_offset_type index_slot, const PackedPageAllocatorDetach& op,
+                      PageAllocatorMetrics& metrics, DeferredRefCounts& deferred);
+
+  void learn_deferred(slot_offset_type index_slot, const PackedPageRefCount& op,
+                      PageAllocatorMetrics& metrics, DeferredRefCounts& deferred);
+
+  void learn_deferred(slot_offset_type index_slot, const PackedPageAllocatorTxn& op,
+                      PageAllocatorMetrics& metrics, DeferredRefCounts& deferred);
+
+  // Applies all updates queued by `learn_deferred`, running partitions other than the first on
+  // tasks from `scheduler`.  Must only be called during recovery, on a state that has not learned
+  // any ref count updates through `learn`.
+  //
+  void replay_deferred(DeferredRefCounts&& deferred, batt::TaskScheduler& scheduler,
+                       PageAllocatorMetrics& metrics);
+
   std::vector<PageAllocatorAttachmentStatus> get_all_clients_attachment_status() const;
 
   Optional<PageAllocatorAttachmentStatus> get_client_attachment_status(
@@ -360,11 +408,33 @@ class PageAllocatorState : public PageAllocatorStateNoLock
   //
   void update_learned_upper_bound(slot_offset_type offset);
 
+  // Updates the client attachment for `txn` so it is not learned twice.
+  //
+  void learn_txn_attachment(slot_offset_type index_slot, const PackedPageAllocatorTxn& txn);
+
+  // `FreePool` tracks which pages are in the free pool; it is either the intrusive list
+  // `free_pool_`, or (during `replay_deferred`) a per-partition set of flags.
+  //
+  template <typename FreePool>
   void learn_ref_count_delta(const PackedPageRefCount& delta, PageAllocatorRefCount* const obj,
-                             PageAllocatorMetrics& metrics);
+                             FreePool& free_pool, PageAllocatorMetrics& metrics);
 
+  template <typename FreePool>
   void learn_ref_count_1_to_0(const PackedPageRefCount& delta, page_generation_int page_generation,
-                              PageAllocatorRefCount* const obj, PageAllocatorMetrics& metrics);
+                              PageAllocatorRefCount* const obj, FreePool& free_pool,
+                              PageAllocatorMetrics& metrics);
+
+  // The state of one partition of `replay_deferred`.
+  //
+  struct ReplayPartition;
+
+  // Returns the index of the partition (out of `partition_count`) that contains `physical_page`.
+  //
+  usize replay_partition_of(page_id_int physical_page, usize partition_count) const;
+
+  // Applies the updates of a single partition to its pages; touches nothing outside that range.
+  //
+  void replay_partition(ReplayPartition& partition, PageAllocatorMetrics& metrics);
 
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
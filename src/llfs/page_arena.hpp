@@ -10,6 +10,7 @@
 #ifndef LLFS_PAGE_ARENA_HPP
 #define LLFS_PAGE_ARENA_HPP
 
+#include <llfs/deferred_page_allocator.hpp>
 #include <llfs/page_allocator.hpp>
 #include <llfs/page_buffer.hpp>
 #include <llfs/page_device.hpp>
@@ -18,6 +19,13 @@ namespace llfs {
 
 // A page storage device with a log-structured allocation index.
 //
+// `allocator` may be null for a read-only arena (see StorageContext::enable_follower_mode); such an
+// arena can only be used to load pages that some other process has written.
+//
+// An arena may also be created while its allocator is still being recovered (see
+// DeferredPageAllocator); pages can be loaded right away, but `allocator()` blocks until recovery
+// is done.
+//
 class PageArena
 {
  public:
@@ -28,6 +36,13 @@ class PageArena
   {
   }
 
+  explicit PageArena(std::unique_ptr<PageDevice> device,
+                     std::unique_ptr<DeferredPageAllocator> deferred_allocator) noexcept
+      : device_{std::move(device)}
+      , deferred_allocator_{std::move(deferred_allocator)}
+  {
+  }
+
   PageArena(const PageArena&) = delete;
   PageArena& operator=(const PageArena&) = delete;
 
@@ -44,26 +59,57 @@ class PageArena
     return *this->device_;
   }
 
-  PageAllocator& allocator() const
+  bool is_read_only() const
+  {
+    return this->allocator_ == nullptr && this->deferred_allocator_ == nullptr;
+  }
+
+  // Returns true iff `allocator()` will not block.
+  //
+  bool is_allocator_ready() const
+  {
+    return this->allocator_ != nullptr ||
+           (this->deferred_allocator_ != nullptr && this->deferred_allocator_->is_ready());
+  }
+
+  // Returns the arena's allocator, blocking until it has been recovered if necessary; returns an
+  // error if recovery failed.
+  //
+  StatusOr<PageAllocator*> allocator() const
   {
-    return *this->allocator_;
+    if (this->deferred_allocator_) {
+      return this->deferred_allocator_->await();
+    }
+    BATT_CHECK_NOT_NULLPTR(this->allocator_) << "PageArena is read-only; id=" << this->id();
+    return this->allocator_.get();
   }
 
   void close()
   {
     // this->device_->close();  TODO [tastolfi 2021-04-07]
-    this->allocator_->halt();
+    if (this->allocator_) {
+      this->allocator_->halt();
+    }
+    if (this->deferred_allocator_) {
+      this->deferred_allocator_->halt();
+    }
   }
 
   void join()
   {
     // this->device_->join();  TODO [tastolfi 2021-04-07]
-    this->allocator_->join();
+    if (this->allocator_) {
+      this->allocator_->join();
+    }
+    if (this->deferred_allocator_) {
+      this->deferred_allocator_->join();
+    }
   }
 
  private:
   std::unique_ptr<PageDevice> device_;
   std::unique_ptr<PageAllocator> allocator_;
+  std::unique_ptr<DeferredPageAllocator> deferred_allocator_;
 };
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -11,6 +11,7 @@
 
 #include <llfs/crc.hpp>
 #include <llfs/ioring_log_device.hpp>
+#include <llfs/mmap_page_file_device.hpp>
 #include <llfs/page_allocator.hpp>
 #include <llfs/uuid.hpp>
 
@@ -166,15 +167,17 @@ Status configure_storage_object(StorageFileBuilder::Transaction& txn,
   return OkStatus();
 }
 
+namespace {
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-StatusOr<PageArena> recover_storage_object(
+template <typename PageDeviceOptionsT>
+StatusOr<PageArena> recover_page_arena_impl(
     const batt::SharedPtr<StorageContext>& storage_context,       //
-    const std::string& file_name,                                 //
     const FileOffsetPtr<const PackedPageArenaConfig&>& p_config,  //
     const PageAllocatorRuntimeOptions& allocator_options,         //
     const IoRingLogDriverOptions& allocator_log_options,          //
-    const IoRingFileRuntimeOptions& page_device_file_options)
+    const PageDeviceOptionsT& page_device_options)
 {
   StatusOr<std::unique_ptr<PageAllocator>> page_allocator = storage_context->recover_object(
       batt::StaticType<PackedPageAllocatorConfig>{}, p_config->page_allocator_uuid,
@@ -183,7 +186,7 @@ StatusOr<PageArena> recover_storage_object(
 
   StatusOr<std::unique_ptr<PageDevice>> page_device =
       storage_context->recover_object(batt::StaticType<PackedPageDeviceConfig>{},
-                                      p_config->page_device_uuid, page_device_file_options);
+                                      p_config->page_device_uuid, page_device_options);
   BATT_REQUIRE_OK(page_device);
 
   auto arena = PageArena{
@@ -191,9 +194,41 @@ StatusOr<PageArena> recover_storage_object(
       std::move(*page_allocator),
   };
 
-  BATT_CHECK_EQ(arena.id(), arena.allocator().get_device_id());
+  StatusOr<PageAllocator*> allocator = arena.allocator();
+  BATT_REQUIRE_OK(allocator);
+  BATT_CHECK_EQ(arena.id(), (*allocator)->get_device_id());
 
   return arena;
 }
 
+}  // namespace
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<PageArena> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context,       //
+    const std::string& /*file_name*/,                             //
+    const FileOffsetPtr<const PackedPageArenaConfig&>& p_config,  //
+    const PageAllocatorRuntimeOptions& allocator_options,         //
+    const IoRingLogDriverOptions& allocator_log_options,          //
+    const IoRingFileRuntimeOptions& page_device_file_options)
+{
+  return recover_page_arena_impl(storage_context, p_config, allocator_options,
+                                 allocator_log_options, page_device_file_options);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<PageArena> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context,       //
+    const std::string& /*file_name*/,                             //
+    const FileOffsetPtr<const PackedPageArenaConfig&>& p_config,  //
+    const PageAllocatorRuntimeOptions& allocator_options,         //
+    const IoRingLogDriverOptions& allocator_log_options,          //
+    const MmapPageFileDeviceOptions& page_device_mmap_options)
+{
+  return recover_page_arena_impl(storage_context, p_config, allocator_options,
+                                 allocator_log_options, page_device_mmap_options);
+}
+
 }  // namespace llfs
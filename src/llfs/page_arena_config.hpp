@@ -39,6 +39,16 @@ StatusOr<PageArena> recover_storage_object(                       //
     const IoRingLogDriverOptions& allocator_log_options,          //
     const IoRingFileRuntimeOptions& page_device_file_options);
 
+// Recovers a PageArena whose PageDevice is a read-only MmapPageFileDevice.
+//
+StatusOr<PageArena> recover_storage_object(                       //
+    const batt::SharedPtr<StorageContext>& storage_context,       //
+    const std::string& file_name,                                 //
+    const FileOffsetPtr<const PackedPageArenaConfig&>& p_config,  //
+    const PageAllocatorRuntimeOptions& allocator_options,         //
+    const IoRingLogDriverOptions& allocator_log_options,          //
+    const MmapPageFileDeviceOptions& page_device_mmap_options);
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
 struct PageArenaConfigOptions {
@@ -14,11 +14,122 @@
 #include <llfs/page_cache_job.hpp>
 #include <llfs/status_code.hpp>
 
+#include <batteries/async/runtime.hpp>
+#include <batteries/small_vec.hpp>
+
 #include <boost/range/irange.hpp>
 #include <boost/uuid/random_generator.hpp>  // TODO [tastolfi 2021-04-05] remove me
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
 namespace llfs {
 
+namespace {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// An entry in the per-thread L0 page cache.  Each entry keeps its cache slot pinned, so that a hit
+// only has to copy the pin, which doesn't touch the cache's LRU lists or index.
+//
+struct ThreadLocalCacheEntry {
+  u64 cache_instance_id = 0;
+  page_id_int page_id = kInvalidPageId;
+  PageCache::CacheImpl::PinnedSlot pinned_slot;
+};
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// A thread's L0 page cache.  Every thread's cache is registered in a global set, so that a
+// PageCache can release its entries from all of them when it is destroyed (see `drop_instance`);
+// apart from that, `mutex` is only ever locked by the owning thread, so it is uncontended.
+//
+class ThreadLocalCache
+{
+ public:
+  // Returns the calling thread's L0 cache.
+  //
+  static ThreadLocalCache& get()
+  {
+    thread_local ThreadLocalCache cache;
+    return cache;
+  }
+
+  // Releases the entries of the given PageCache from every thread's L0 cache.
+  //
+  static void drop_instance(u64 cache_instance_id)
+  {
+    std::vector<ThreadLocalCacheEntry> dropped;
+
+    std::unique_lock<std::mutex> registry_lock{registry_mutex()};
+    for (ThreadLocalCache* cache : registry()) {
+      std::unique_lock<std::mutex> lock{cache->mutex};
+      for (ThreadLocalCacheEntry& entry : cache->entries) {
+        if (entry.cache_instance_id == cache_instance_id) {
+          dropped.emplace_back(std::move(entry));
+          entry = ThreadLocalCacheEntry{};
+        }
+      }
+    }
+  }
+
+  ThreadLocalCache()
+  {
+    std::unique_lock<std::mutex> registry_lock{registry_mutex()};
+    registry().insert(this);
+  }
+
+  ThreadLocalCache(const ThreadLocalCache&) = delete;
+  ThreadLocalCache& operator=(const ThreadLocalCache&) = delete;
+
+  ~ThreadLocalCache() noexcept
+  {
+    std::unique_lock<std::mutex> registry_lock{registry_mutex()};
+    registry().erase(this);
+  }
+
+  // Returns the entry for `page_id`, growing the cache to `size` entries if necessary; `size` must
+  // be a power of 2.  The caller must hold `mutex`.
+  //
+  ThreadLocalCacheEntry& entry_for(PageId page_id, usize size)
+  {
+    if (this->entries.size() < size) {
+      this->entries.resize(size);
+    }
+
+    // The low bits of a page id are the physical page number, which is the same across devices, so
+    // mix in the high bits before masking.
+    //
+    const u64 h = page_id.int_value() * u64{0x9e3779b97f4a7c15};
+    return this->entries[(h ^ (h >> 32)) & (size - 1)];
+  }
+
+  std::mutex mutex;
+  std::vector<ThreadLocalCacheEntry> entries;
+
+ private:
+  static std::mutex& registry_mutex()
+  {
+    static std::mutex m;
+    return m;
+  }
+
+  static std::unordered_set<ThreadLocalCache*>& registry()
+  {
+    static std::unordered_set<ThreadLocalCache*> caches;
+    return caches;
+  }
+};
+
+std::atomic<u64>& next_page_cache_instance_id()
+{
+  static std::atomic<u64> next_id{1};
+  return next_id;
+}
+
+}  // namespace
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 /*explicit*/ PageCache::PageDeleterImpl::PageDeleterImpl(PageCache& page_cache) noexcept
@@ -58,6 +169,14 @@ Status PageCache::PageDeleterImpl::delete_pages(const Slice<const PageToRecycle>
   LLFS_VLOG(1) << "[PageDeleterImpl::delete_pages] deleting: "
                << batt::dump_range(to_delete, batt::Pretty::True);
 
+  // Start all page reads up front so they proceed concurrently; `delete_page` below loads each
+  // page in turn in order to trace its references.  These pages are dead, so they are cached at
+  // low priority (and hinted obsolete when the job commits) to keep live pages resident.
+  //
+  for (const PageToRecycle& next_page : to_delete) {
+    this->page_cache_.prefetch_hint(next_page.page_id, CachePriority::kLow);
+  }
+
   for (const PageToRecycle& next_page : to_delete) {
     BATT_CHECK_EQ(next_page.depth, params.recycle_depth);
     Status pre_delete_status = job->delete_page(next_page.page_id);
@@ -72,6 +191,36 @@ Status PageCache::PageDeleterImpl::delete_pages(const Slice<const PageToRecycle>
   return OkStatus();
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::PageDeleterImpl::prefetch_pages(const Slice<const PageId>& page_ids) /*override*/
+{
+  for (PageId page_id : page_ids) {
+    this->page_cache_.prefetch_hint(page_id, CachePriority::kLow);
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::unordered_map<PageId, usize, PageId::Hash> PageCache::PageDeleterImpl::count_page_refs(
+    const Slice<const PageId>& page_ids) /*override*/
+{
+  std::unordered_map<PageId, usize, PageId::Hash> ref_counts;
+
+  // The recycler has already passed these pages to `prefetch_pages`, so the loads below are
+  // concurrent; pages that fail to load are left out (`delete_pages` will report the error).
+  //
+  for (PageId page_id : page_ids) {
+    StatusOr<PinnedPage> pinned_page = this->page_cache_.get(page_id, OkIfNotFound{false});
+    if (!pinned_page.ok()) {
+      continue;
+    }
+    ref_counts.emplace(page_id, (*pinned_page)->trace_refs() | seq::count());
+  }
+
+  return ref_counts;
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 /*static*/ StatusOr<std::shared_ptr<PageCache>> PageCache::make_shared(
@@ -94,13 +243,20 @@ PageCache::PageCache(std::vector<PageArena>&& storage_pool,
     , arenas_by_size_log2_{}
     , arenas_by_device_id_{}
     , impl_for_size_log2_{}
-    , page_readers_{std::make_shared<
-          batt::Mutex<std::unordered_map<PageLayoutId, PageReader, PageLayoutId::Hash>>>()}
+    , mrc_for_size_log2_{}
+    , compressed_pages_{}
+    , page_readers_{std::make_shared<batt::Mutex<PageLayoutReaderMap>>()}
+    , instance_id_{next_page_cache_instance_id().fetch_add(1)}
 {
   // Sort the storage pool by page size (MUST be first).
   //
   std::sort(this->storage_pool_.begin(), this->storage_pool_.end(), PageSizeOrder{});
 
+  if (this->options_.compressed_page_cache_size != 0) {
+    this->compressed_pages_ =
+        std::make_unique<CompressedPageCache>(this->options_.compressed_page_cache_size);
+  }
+
   // Index the storage pool into groups of arenas by page size.
   //
   for (usize size_log2 = 6; size_log2 < kMaxPageSizeLog2; ++size_log2) {
@@ -115,6 +271,22 @@ PageCache::PageCache(std::vector<PageArena>&& storage_pool,
       this->impl_for_size_log2_[size_log2] =
           CacheImpl::make_new(/*n_slots=*/this->options_.max_cached_pages_per_size_log2[size_log2],
                               /*name=*/batt::to_string("size_", u64{1} << size_log2));
+
+      // Pages evicted to make room for others move to the compressed cache (if enabled).
+      //
+      if (this->compressed_pages_) {
+        this->impl_for_size_log2_[size_log2]->set_evict_fn(
+            [this](const page_id_int&,
+                   const std::shared_ptr<batt::Latch<std::shared_ptr<const PageView>>>& latch) {
+              this->queue_page_compress(latch);
+            });
+      }
+
+      const usize n_slots = this->options_.max_cached_pages_per_size_log2[size_log2];
+      if (this->options_.miss_ratio_curve_sample_rate > 0 && n_slots > 0) {
+        this->mrc_for_size_log2_[size_log2] = std::make_unique<MissRatioCurveEstimator>(
+            this->options_.miss_ratio_curve_sample_rate, /*reference_cache_size=*/n_slots);
+      }
     }
   }
 
@@ -128,6 +300,42 @@ PageCache::PageCache(std::vector<PageArena>&& storage_pool,
         << arena.device().get_id();
   }
 
+  // Pass configured write lifetimes down to the devices.
+  //
+  for (PageArena& arena : this->storage_pool_) {
+    const PageWriteLifetime lifetime = this->arena_write_lifetime(arena);
+    if (lifetime == PageWriteLifetime::kNotSet) {
+      continue;
+    }
+    Status status = arena.device().set_write_lifetime(lifetime);
+    if (!status.ok() && status != batt::StatusCode::kUnimplemented) {
+      LLFS_LOG_WARNING() << "Failed to set page device write lifetime; "
+                         << BATT_INSPECT(arena.id()) << BATT_INSPECT(lifetime)
+                         << BATT_INSPECT(status);
+    }
+  }
+
+  // Arenas are never added or removed, and their lifetimes are fixed by the options, so the order
+  // in which to try them for each allocation can be worked out once, here.
+  //
+  for (usize size_log2 = 0; size_log2 < kMaxPageSizeLog2; ++size_log2) {
+    for (usize lifetime_index = 0; lifetime_index < kNumPageWriteLifetimes; ++lifetime_index) {
+      const auto lifetime = static_cast<PageWriteLifetime>(lifetime_index);
+
+      std::vector<const PageArena*>& arenas =
+          this->arena_allocation_order_[size_log2][lifetime_index];
+
+      for (const PageArena& arena : this->arenas_by_size_log2_[size_log2]) {
+        if (!arena.is_read_only()) {
+          arenas.emplace_back(&arena);
+        }
+      }
+      std::stable_partition(arenas.begin(), arenas.end(), [&](const PageArena* arena) {
+        return this->arena_write_lifetime(*arena) == lifetime;
+      });
+    }
+  }
+
   const auto metric_name = [this](std::string_view property) {
     return batt::to_string("PageCache_", property);
   };
@@ -145,6 +353,44 @@ PageCache::PageCache(std::vector<PageArena>&& storage_pool,
   ADD_METRIC_(ref_count_sync_latency);
 
 #undef ADD_METRIC_
+
+  for (usize size_log2 = 0; size_log2 < kMaxPageSizeLog2; ++size_log2) {
+    MissRatioCurveEstimator* mrc = this->mrc_for_size_log2_[size_log2].get();
+    if (!mrc) {
+      continue;
+    }
+
+    const auto mrc_metric_name = [size_log2](std::string_view property) {
+      return batt::to_string("PageCache_size_", u64{1} << size_log2, "_mrc_", property);
+    };
+
+#define ADD_MRC_METRIC_(n) global_metric_registry().add(mrc_metric_name(#n), mrc->metrics().n)
+
+    ADD_MRC_METRIC_(sampled_count);
+    ADD_MRC_METRIC_(miss_ppm_at_50pct);
+    ADD_MRC_METRIC_(miss_ppm_at_100pct);
+    ADD_MRC_METRIC_(miss_ppm_at_200pct);
+
+#undef ADD_MRC_METRIC_
+  }
+
+  if (this->compressed_pages_) {
+    this->page_compress_task_.emplace(
+        /*executor=*/batt::Runtime::instance().schedule_task(),
+        [this] {
+          this->page_compress_task_main();
+        },
+        "PageCache::page_compress_task");
+  }
+
+  while (this->page_decode_tasks_.size() < this->options_.page_decode_task_count) {
+    this->page_decode_tasks_.emplace_back(std::make_unique<batt::Task>(
+        /*executor=*/batt::Runtime::instance().schedule_task(),
+        [this] {
+          this->page_decode_task_main();
+        },
+        "PageCache::page_decode_task"));
+  }
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -154,6 +400,12 @@ PageCache::~PageCache() noexcept
   this->close();
   this->join();
 
+  // Per-thread L0 cache entries keep pages pinned; release the ones that belong to this PageCache.
+  //
+  if (this->options_.thread_local_cache_size != 0) {
+    ThreadLocalCache::drop_instance(this->instance_id_);
+  }
+
   global_metric_registry()  //
       .remove(this->metrics_.total_bytes_written)
       .remove(this->metrics_.used_bytes_written)
@@ -164,6 +416,16 @@ PageCache::~PageCache() noexcept
       .remove(this->metrics_.pipeline_wait_latency)
       .remove(this->metrics_.update_ref_counts_latency)
       .remove(this->metrics_.ref_count_sync_latency);
+
+  for (const std::unique_ptr<MissRatioCurveEstimator>& mrc : this->mrc_for_size_log2_) {
+    if (mrc) {
+      global_metric_registry()  //
+          .remove(mrc->metrics().sampled_count)
+          .remove(mrc->metrics().miss_ppm_at_50pct)
+          .remove(mrc->metrics().miss_ppm_at_100pct)
+          .remove(mrc->metrics().miss_ppm_at_200pct);
+    }
+  }
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -173,11 +435,119 @@ const PageCacheOptions& PageCache::options() const
   return this->options_;
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::set_max_cached_pages_per_size(PageSize page_size, usize n)
+{
+  const usize page_size_log2 = batt::log2_ceil(page_size);
+  BATT_CHECK_LT(page_size_log2, this->impl_for_size_log2_.size());
+
+  CacheImpl* const impl = this->impl_for_size_log2_[page_size_log2].get();
+  if (impl != nullptr) {
+    impl->set_capacity(n);
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize PageCache::max_cached_pages_per_size(PageSize page_size) const
+{
+  const usize page_size_log2 = batt::log2_ceil(page_size);
+  BATT_CHECK_LT(page_size_log2, this->impl_for_size_log2_.size());
+
+  const CacheImpl* const impl = this->impl_for_size_log2_[page_size_log2].get();
+  if (impl == nullptr) {
+    return 0;
+  }
+  return impl->capacity();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::set_cache_owner_quota(PageSize page_size, CacheOwnerId owner, usize min_pages,
+                                      usize max_pages)
+{
+  const usize page_size_log2 = batt::log2_ceil(page_size);
+  BATT_CHECK_LT(page_size_log2, this->impl_for_size_log2_.size());
+
+  CacheImpl* const impl = this->impl_for_size_log2_[page_size_log2].get();
+  if (impl != nullptr) {
+    impl->set_owner_quota(owner, min_pages, max_pages);
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+const CacheOwnerMetrics& PageCache::cache_owner_metrics(PageSize page_size, CacheOwnerId owner)
+{
+  const usize page_size_log2 = batt::log2_ceil(page_size);
+  BATT_CHECK_LT(page_size_log2, this->impl_for_size_log2_.size());
+  BATT_CHECK_NOT_NULLPTR(this->impl_for_size_log2_[page_size_log2]);
+
+  return this->impl_for_size_log2_[page_size_log2]->owner_metrics(owner);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::set_memory_budget(u64 budget)
+{
+  const u64 configured_size = this->configured_memory_size();
+  if (configured_size == 0) {
+    return;
+  }
+  const double scale = std::min(1.0, double(budget) / double(configured_size));
+
+  for (usize size_log2 = 0; size_log2 < this->impl_for_size_log2_.size(); ++size_log2) {
+    CacheImpl* const impl = this->impl_for_size_log2_[size_log2].get();
+    if (impl != nullptr) {
+      impl->set_capacity(
+          static_cast<usize>(scale * this->options_.max_cached_pages_per_size_log2[size_log2]));
+    }
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 PageCache::configured_memory_size() const
+{
+  u64 total = 0;
+  for (usize size_log2 = 0; size_log2 < this->impl_for_size_log2_.size(); ++size_log2) {
+    if (this->impl_for_size_log2_[size_log2] != nullptr) {
+      total += (u64{1} << size_log2) * this->options_.max_cached_pages_per_size_log2[size_log2];
+    }
+  }
+  return total;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::shrink_to_capacity()
+{
+  for (const boost::intrusive_ptr<CacheImpl>& impl : this->impl_for_size_log2_) {
+    if (impl != nullptr) {
+      impl->shrink_to_capacity();
+    }
+  }
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 bool PageCache::register_page_layout(const PageLayoutId& layout_id, const PageReader& reader)
 {
-  return this->page_readers_->lock()->emplace(layout_id, reader).second;
+  return this->register_page_layout(layout_id, reader, CachePriority::kNormal);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+bool PageCache::register_page_layout(const PageLayoutId& layout_id, const PageReader& reader,
+                                     CachePriority cache_priority)
+{
+  return this->page_readers_->lock()
+      ->emplace(layout_id, PageLayoutEntry{
+                               .reader = reader,
+                               .cache_priority = cache_priority,
+                           })
+      .second;
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -187,6 +557,8 @@ void PageCache::close()
   for (PageArena& arena : this->storage_pool_) {
     arena.close();
   }
+  this->page_decode_queue_.close();
+  this->page_compress_queue_.close();
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -196,6 +568,27 @@ void PageCache::join()
   for (PageArena& arena : this->storage_pool_) {
     arena.join();
   }
+  for (std::unique_ptr<batt::Task>& task : this->page_decode_tasks_) {
+    task->join();
+  }
+  this->page_decode_tasks_.clear();
+
+  // Decode any pages that were queued after the tasks stopped, so their waiters are woken.
+  //
+  while (Optional<PageDecodeOp> op = this->page_decode_queue_.try_pop_next()) {
+    decode_page(*op);
+  }
+
+  if (this->page_compress_task_) {
+    this->page_compress_task_->join();
+    this->page_compress_task_ = None;
+  }
+
+  // Pages still waiting to be compressed are simply dropped.
+  //
+  while (Optional<PageCompressOp> op = this->page_compress_queue_.try_pop_next()) {
+    this->page_compress_pending_bytes_.fetch_sub(op->page_data->size());
+  }
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -208,32 +601,66 @@ std::unique_ptr<PageCacheJob> PageCache::new_job()
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<std::shared_ptr<PageBuffer>> PageCache::allocate_page_of_size(
-    PageSize size, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id)
+    PageSize size, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id,
+    PageWriteLifetime lifetime)
 {
   const PageSizeLog2 size_log2 = log2_ceil(size);
   BATT_CHECK_EQ(usize{1} << size_log2, size) << "size must be a power of 2";
 
-  return this->allocate_page_of_size_log2(
-      size_log2, wait_for_resource, callers | Caller::PageCache_allocate_page_of_size, job_id);
+  return this->allocate_page_of_size_log2(size_log2, wait_for_resource,
+                                          callers | Caller::PageCache_allocate_page_of_size,
+                                          job_id, lifetime);
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<std::shared_ptr<PageBuffer>> PageCache::allocate_page_of_size_log2(
-    PageSizeLog2 size_log2, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id)
+    PageSizeLog2 size_log2, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id,
+    PageWriteLifetime lifetime)
 {
   BATT_CHECK_LT(size_log2, kMaxPageSizeLog2);
 
   LatencyTimer alloc_timer{this->metrics_.allocate_page_alloc_latency};
 
-  Slice<const PageArena> arenas = this->arenas_for_page_size_log2(size_log2);
+  // Try arenas dedicated to the requested lifetime first, so that pages likely to be dropped
+  // together are placed together; other arenas of the right size are used only as a fallback.
+  //
+  const usize lifetime_index = static_cast<usize>(lifetime);
+  BATT_CHECK_LT(lifetime_index, kNumPageWriteLifetimes);
+
+  const std::vector<const PageArena*>& arenas =
+      this->arena_allocation_order_[size_log2][lifetime_index];
 
   // TODO [tastolfi 2021-09-08] If the caller wants to wait, which device should we wait on?  First
   // available? Random?  Round-Robin?
   //
   for (auto wait_arg : {batt::WaitForResource::kFalse, batt::WaitForResource::kTrue}) {
-    for (const PageArena& arena : arenas) {
-      StatusOr<PageId> page_id = arena.allocator().allocate_page(wait_arg);
+    // `PageArena::allocator()` blocks while the arena's allocator is still being recovered in the
+    // background, so try the arenas whose allocators are ready first (keeping the lifetime order
+    // within each group).
+    //
+    batt::SmallVec<const PageArena*, 8> arenas_to_try;
+    for (const PageArena* p_arena : arenas) {
+      if (p_arena->is_allocator_ready()) {
+        arenas_to_try.emplace_back(p_arena);
+      }
+    }
+    for (const PageArena* p_arena : arenas) {
+      if (std::find(arenas_to_try.begin(), arenas_to_try.end(), p_arena) == arenas_to_try.end()) {
+        arenas_to_try.emplace_back(p_arena);
+      }
+    }
+
+    for (const PageArena* p_arena : arenas_to_try) {
+      const PageArena& arena = *p_arena;
+
+      // If the allocator could not be recovered, this arena (and the cache) is unusable; report
+      // why rather than pretending that there is no free space.
+      //
+      StatusOr<PageAllocator*> allocator = arena.allocator();
+      BATT_REQUIRE_OK(allocator);
+
+      StatusOr<PageId> page_id = (*allocator)->allocate_page(wait_arg);
       if (!page_id.ok()) {
         continue;
       }
@@ -264,6 +691,17 @@ StatusOr<std::shared_ptr<PageBuffer>> PageCache::allocate_page_of_size_log2(
   return Status{batt::StatusCode::kUnavailable};  // TODO [tastolfi 2021-10-20]
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PageWriteLifetime PageCache::arena_write_lifetime(const PageArena& arena) const
+{
+  auto iter = this->options_.write_lifetime_by_device_id.find(arena.id());
+  if (iter == this->options_.write_lifetime_by_device_id.end()) {
+    return PageWriteLifetime::kNotSet;
+  }
+  return iter->second;
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 void PageCache::deallocate_page(PageId page_id, u64 callers, u64 job_id)
@@ -278,7 +716,15 @@ void PageCache::deallocate_page(PageId page_id, u64 callers, u64 job_id)
       .event_id = (int)NewPageTracker::Event::kDeallocate,
   });
 
-  this->arena_for_page_id(page_id).allocator().deallocate_page(page_id);
+  // The page was allocated from this arena, so its allocator has already been recovered.
+  //
+  StatusOr<PageAllocator*> allocator = this->arena_for_page_id(page_id).allocator();
+  if (allocator.ok()) {
+    (*allocator)->deallocate_page(page_id);
+  } else {
+    LLFS_LOG_ERROR() << "Failed to deallocate page; " << BATT_INSPECT(page_id)
+                     << BATT_INSPECT(allocator.status());
+  }
   this->purge(page_id, callers | Caller::PageCache_deallocate_page, job_id);
 }
 
@@ -294,7 +740,11 @@ Status PageCache::attach(const boost::uuids::uuid& user_id, slot_offset_type slo
       return;
     }
     for (const PageArena* p_arena : attached_arenas) {
-      auto detach_status = p_arena->allocator().detach_user(user_id, slot_offset);
+      auto detach_status = [&]() -> Status {
+        StatusOr<PageAllocator*> allocator = p_arena->allocator();
+        BATT_REQUIRE_OK(allocator);
+        return (*allocator)->detach_user(user_id, slot_offset);
+      }();
       if (!detach_status.ok()) {
         LLFS_LOG_ERROR() << "Failed to detach after failed attachement: "
                          << BATT_INSPECT(p_arena->id());
@@ -303,7 +753,9 @@ Status PageCache::attach(const boost::uuids::uuid& user_id, slot_offset_type slo
   });
 
   for (const PageArena& arena : this->storage_pool_) {
-    auto arena_status = arena.allocator().attach_user(user_id, slot_offset);
+    StatusOr<PageAllocator*> allocator = arena.allocator();
+    BATT_REQUIRE_OK(allocator);
+    auto arena_status = (*allocator)->attach_user(user_id, slot_offset);
     BATT_REQUIRE_OK(arena_status);
     attached_arenas.emplace_back(&arena);
   }
@@ -318,7 +770,9 @@ Status PageCache::attach(const boost::uuids::uuid& user_id, slot_offset_type slo
 Status PageCache::detach(const boost::uuids::uuid& user_id, slot_offset_type slot_offset)
 {
   for (const PageArena& arena : this->storage_pool_) {
-    auto arena_status = arena.allocator().detach_user(user_id, slot_offset);
+    StatusOr<PageAllocator*> allocator = arena.allocator();
+    BATT_REQUIRE_OK(allocator);
+    auto arena_status = (*allocator)->detach_user(user_id, slot_offset);
     BATT_REQUIRE_OK(arena_status);
   }
   //
@@ -331,7 +785,16 @@ Status PageCache::detach(const boost::uuids::uuid& user_id, slot_offset_type slo
 //
 void PageCache::prefetch_hint(PageId page_id)
 {
-  (void)this->find_page_in_cache(page_id, /*require_tag=*/None, OkIfNotFound{false});
+  (void)this->find_page_in_cache(page_id, /*require_tag=*/None, OkIfNotFound{false},
+                                 kDefaultCacheOwner);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::prefetch_hint(PageId page_id, CachePriority priority)
+{
+  (void)this->find_page_in_cache(page_id, /*require_tag=*/None, OkIfNotFound{false},
+                                 kDefaultCacheOwner, priority);
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -382,7 +845,7 @@ const PageArena& PageCache::arena_for_device_id(page_device_id_int device_id_val
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<PinnedPage> PageCache::put_view(std::shared_ptr<const PageView>&& view, u64 callers,
-                                         u64 job_id)
+                                         u64 job_id, CacheOwnerId owner)
 {
   BATT_CHECK_NOT_NULLPTR(view);
 
@@ -396,7 +859,7 @@ StatusOr<PinnedPage> PageCache::put_view(std::shared_ptr<const PageView>&& view,
   // Attempt to insert the new page view into the cache.
   //
   const auto page_id = PageId{id_val};
-  auto pinned_cache_slot = this->impl_for_page(page_id).find_or_insert(id_val, [&] {
+  auto pinned_cache_slot = this->impl_for_page(page_id).find_or_insert(id_val, owner, [&] {
     return std::move(latch);
   });
 
@@ -413,6 +876,14 @@ StatusOr<PinnedPage> PageCache::put_view(std::shared_ptr<const PageView>&& view,
   //
   BATT_REQUIRE_OK(pinned_cache_slot);
 
+  {
+    auto locked = this->page_readers_->lock();
+    auto iter = locked->find(p_view->get_page_layout_id());
+    if (iter != locked->end()) {
+      pinned_cache_slot->slot()->set_priority(iter->second.cache_priority);
+    }
+  }
+
   PinnedPage pinned_page{p_view, std::move(*pinned_cache_slot)};
   BATT_CHECK(bool{pinned_page});
 
@@ -433,6 +904,13 @@ void PageCache::purge(PageId page_id, u64 callers, u64 job_id)
     });
 
     this->impl_for_page(page_id).erase(page_id.int_value());
+
+    // This records the purge after the erase above, so any eviction of this page that is still
+    // waiting to be compressed (see `queue_page_compress`) is dropped.
+    //
+    if (this->compressed_pages_) {
+      this->compressed_pages_->erase(page_id);
+    }
   }
 }
 
@@ -445,23 +923,110 @@ StatusOr<PinnedPage> PageCache::get(PageId page_id, const Optional<PageLayoutId>
     return Status{batt::StatusCode::kUnimplemented};
   }
 
+  return this->get_for_owner(kDefaultCacheOwner, page_id, require_layout, ok_if_not_found);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<PinnedPage> PageCache::get_for_owner(CacheOwnerId owner, PageId page_id,
+                                              const Optional<PageLayoutId>& require_layout,
+                                              OkIfNotFound ok_if_not_found)
+{
   ++this->metrics_.get_count;
 
   if (!page_id) {
     return ::llfs::make_status(StatusCode::kPageIdInvalid);
   }
 
+  if (this->options_.miss_ratio_curve_sample_rate > 0) {
+    this->record_miss_ratio_curve_reference(page_id);
+  }
+
+  const bool use_thread_local_cache = (this->options_.thread_local_cache_size != 0);
+
+  if (use_thread_local_cache) {
+    PinnedPage pinned_page = this->find_page_in_thread_local_cache(page_id);
+    if (pinned_page) {
+      return pinned_page;
+    }
+  }
+
   BATT_ASSIGN_OK_RESULT(CacheImpl::PinnedSlot cache_slot,  //
-                        this->find_page_in_cache(page_id, require_layout, ok_if_not_found));
+                        this->find_page_in_cache(page_id, require_layout, ok_if_not_found,
+                                                 owner));
 
   BATT_ASSIGN_OK_RESULT(StatusOr<std::shared_ptr<const PageView>> loaded,  //
                         cache_slot->await());
 
   BATT_CHECK_EQ(loaded->get() != nullptr, bool{cache_slot});
 
+  if (use_thread_local_cache && cache_slot) {
+    this->insert_page_into_thread_local_cache(page_id, cache_slot);
+  }
+
   return PinnedPage{loaded->get(), std::move(cache_slot)};
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PinnedPage PageCache::find_page_in_thread_local_cache(PageId page_id)
+{
+  ThreadLocalCache& l0_cache = ThreadLocalCache::get();
+
+  // Declared before the lock, so that a released pin (which may lock the cache's LRU lists) is
+  // dropped after unlocking.
+  //
+  CacheImpl::PinnedSlot released_slot;
+  CacheImpl::PinnedSlot pinned_slot;
+  {
+    std::unique_lock<std::mutex> lock{l0_cache.mutex};
+
+    ThreadLocalCacheEntry& entry =
+        l0_cache.entry_for(page_id, this->options_.thread_local_cache_size);
+
+    if (entry.cache_instance_id != this->instance_id_ || entry.page_id != page_id.int_value()) {
+      return {};
+    }
+
+    // The entry's pin keeps the slot from being evicted, so it still holds this page; but if the
+    // page was purged, the slot was erased from the index, and the entry must be dropped.
+    //
+    if (entry.pinned_slot.slot()->is_erased()) {
+      released_slot = std::move(entry.pinned_slot);
+      entry = ThreadLocalCacheEntry{};
+      return {};
+    }
+
+    pinned_slot = entry.pinned_slot;
+  }
+
+  const StatusOr<std::shared_ptr<const PageView>>& loaded = pinned_slot->get_ready_value_or_panic();
+
+  return PinnedPage{loaded->get(), std::move(pinned_slot)};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::insert_page_into_thread_local_cache(PageId page_id,
+                                                    const CacheImpl::PinnedSlot& pinned_slot)
+{
+  ThreadLocalCache& l0_cache = ThreadLocalCache::get();
+
+  CacheImpl::PinnedSlot released_slot;
+  {
+    std::unique_lock<std::mutex> lock{l0_cache.mutex};
+
+    ThreadLocalCacheEntry& entry =
+        l0_cache.entry_for(page_id, this->options_.thread_local_cache_size);
+
+    released_slot = std::move(entry.pinned_slot);
+
+    entry.cache_instance_id = this->instance_id_;
+    entry.page_id = page_id.int_value();
+    entry.pinned_slot = pinned_slot;
+  }
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 auto PageCache::impl_for_page(PageId page_id) -> CacheImpl&
@@ -474,10 +1039,26 @@ auto PageCache::impl_for_page(PageId page_id) -> CacheImpl&
   return *this->impl_for_size_log2_[page_size_log2];
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::record_miss_ratio_curve_reference(PageId page_id)
+{
+  const u32 page_size = this->arena_for_page_id(page_id).device().page_size();
+  const usize page_size_log2 = batt::log2_ceil(page_size);
+
+  BATT_CHECK_LT(page_size_log2, this->mrc_for_size_log2_.size());
+
+  MissRatioCurveEstimator* mrc = this->mrc_for_size_log2_[page_size_log2].get();
+  if (mrc) {
+    mrc->record(page_id.int_value());
+  }
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 auto PageCache::find_page_in_cache(PageId page_id, const Optional<PageLayoutId>& required_layout,
-                                   OkIfNotFound ok_if_not_found)
+                                   OkIfNotFound ok_if_not_found, CacheOwnerId owner,
+                                   Optional<CachePriority> priority_override)
     -> batt::StatusOr<CacheImpl::PinnedSlot>
 {
   if (!page_id) {
@@ -487,7 +1068,7 @@ auto PageCache::find_page_in_cache(PageId page_id, const Optional<PageLayoutId>&
   std::shared_ptr<batt::Latch<std::shared_ptr<const PageView>>> latch = nullptr;
 
   batt::StatusOr<CacheImpl::PinnedSlot> pinned_slot =
-      this->impl_for_page(page_id).find_or_insert(page_id.int_value(), [&latch] {
+      this->impl_for_page(page_id).find_or_insert(page_id.int_value(), owner, [&latch] {
         latch = std::make_shared<batt::Latch<std::shared_ptr<const PageView>>>();
         return latch;
       });
@@ -498,85 +1079,219 @@ auto PageCache::find_page_in_cache(PageId page_id, const Optional<PageLayoutId>&
     BATT_DEBUG_INFO("PageCache::find_page_in_cache - starting async page read: "
                     << BATT_INSPECT(page_id) << BATT_INSPECT(batt::Task::current_stack_pos()));
 
-    this->arena_for_page_id(page_id).device().read(
-        page_id,
-        /*read_handler=*/[
-                             // Save the metrics and start time so we can record read latency etc.
-                             //
-                             p_metrics = &this->metrics_,
-                             start_time = std::chrono::steady_clock::now(),
-
-                             // We need to update the latch, so retain it in the capture.
-                             //
-                             captured_latch = latch,
-
-                             // Keep a copy of pinned_slot while loading the page to limit the
-                             // amount of churn under heavy read loads.
-                             //
-                             pinned_slot = batt::make_copy(*pinned_slot),
-
-                             // Save a shared_ptr to the typed page view readers so we can parse the
-                             // page data.
-                             //
-                             page_readers = this->page_readers_,  //
-                             required_layout, this, page_id, ok_if_not_found
+    auto read_handler = [
+                         // Save the metrics and start time so we can record read latency etc.
+                         //
+                         p_metrics = &this->metrics_,
+                         start_time = std::chrono::steady_clock::now(),
+
+                         // We need to update the latch, so retain it in the capture.
+                         //
+                         captured_latch = latch,
+
+                         // Keep a copy of pinned_slot while loading the page to limit the
+                         // amount of churn under heavy read loads.
+                         //
+                         pinned_slot = batt::make_copy(*pinned_slot),
+
+                         // Save a shared_ptr to the typed page view readers so we can parse the
+                         // page data.
+                         //
+                         page_readers = this->page_readers_,  //
+                         required_layout, priority_override, this, page_id, ok_if_not_found
 
     ](StatusOr<std::shared_ptr<const PageBuffer>>&& result) mutable {
-          BATT_DEBUG_INFO("PageCache::find_page_in_cache - read handler");
-
-          auto cleanup = batt::finally([&] {
-            pinned_slot = {};
-          });
-
-          auto latch = std::move(captured_latch);
-          if (!result.ok()) {
-            LLFS_LOG_WARNING() << "recent events for" << BATT_INSPECT(page_id)
-                               << BATT_INSPECT(ok_if_not_found) << " (now=" << this->history_end_
-                               << "):"
-                               << batt::dump_range(
-                                      this->find_new_page_events(page_id) | seq::collect_vec(),
-                                      batt::Pretty::True);
-            latch->set_value(result.status());
-            return;
-          }
-          p_metrics->page_read_latency.update(start_time);
-
-          // Page read succeeded!  Find the right typed reader.
-          //
-          std::shared_ptr<const PageBuffer>& page_data = *result;
-          p_metrics->total_bytes_read.add(page_data->size());
-
-          const PageLayoutId layout_id = [&] {
-            if (required_layout) {
-              return *required_layout;
-            }
-            return get_page_header(*page_data).layout_id;
-          }();
-
-          PageReader reader_for_layout;
-          {
-            auto locked = page_readers->lock();
-            auto iter = locked->find(layout_id);
-            if (iter == locked->end()) {
-              latch->set_value(make_status(StatusCode::kNoReaderForPageViewType));
-              return;
-            }
-            reader_for_layout = iter->second;
-          }
-          // ^^ Release the page_readers mutex ASAP
+      BATT_DEBUG_INFO("PageCache::find_page_in_cache - read handler");
+
+      auto cleanup = batt::finally([&] {
+        pinned_slot = {};
+      });
+
+      auto latch = std::move(captured_latch);
+      if (!result.ok()) {
+        LLFS_LOG_WARNING() << "recent events for" << BATT_INSPECT(page_id)
+                           << BATT_INSPECT(ok_if_not_found) << " (now=" << this->history_end_
+                           << "):"
+                           << batt::dump_range(
+                                  this->find_new_page_events(page_id) | seq::collect_vec(),
+                                  batt::Pretty::True);
+        latch->set_value(result.status());
+        return;
+      }
+      p_metrics->page_read_latency.update(start_time);
 
-          StatusOr<std::shared_ptr<const PageView>> page_view =
-              reader_for_layout(std::move(page_data));
-          if (page_view.ok()) {
-            BATT_CHECK_EQ(page_view->use_count(), 1u);
+      // Page read succeeded!  Find the right typed reader.
+      //
+      std::shared_ptr<const PageBuffer>& page_data = *result;
+      p_metrics->total_bytes_read.add(page_data->size());
+
+      const PageLayoutId layout_id = [&] {
+        if (required_layout) {
+          return *required_layout;
+        }
+        return get_page_header(*page_data).layout_id;
+      }();
+
+      PageDecodeOp op;
+      {
+        auto locked = page_readers->lock();
+        auto iter = locked->find(layout_id);
+        if (iter == locked->end()) {
+          latch->set_value(make_status(StatusCode::kNoReaderForPageViewType));
+          return;
+        }
+        op.reader = iter->second.reader;
+
+        // The slot is still pinned here, so the priority takes effect when it is first unpinned.
+        //
+        pinned_slot.slot()->set_priority(priority_override.value_or(iter->second.cache_priority));
+      }
+      // ^^ Release the page_readers mutex ASAP
+
+      op.page_data = std::move(page_data);
+      op.latch = std::move(latch);
+
+      // If there is a decode pool, hand the page off to it so that this (completion) thread
+      // isn't held up by the reader; otherwise (or if the pool is shut down) decode it here.  This
+      // checks the (immutable) options rather than `page_decode_tasks_`, which `join()` clears
+      // while I/O completions may still be running.
+      //
+      if (this->options_.page_decode_task_count != 0) {
+        op.pinned_slot = std::move(pinned_slot);
+        if (this->page_decode_queue_.push(std::move(op))) {
+          return;
+        }
+      }
+      decode_page(op);
+    };
+
+    // Look in the compressed cache of pages evicted by this process first, then in the shared
+    // (cross-process) cache for this page size, if there is one; pages we have to read from the
+    // device are published to the latter.
+    //
+    PageDevice& device = this->arena_for_page_id(page_id).device();
+    SharedPageBufferCache* const shared_buffers =
+        this->options_.shared_page_buffers_per_size_log2[batt::log2_ceil(device.page_size())].get();
+
+    std::shared_ptr<PageBuffer> decompressed_data =
+        this->compressed_pages_ ? this->compressed_pages_->find(page_id) : nullptr;
+
+    if (decompressed_data) {
+      read_handler(std::shared_ptr<const PageBuffer>{std::move(decompressed_data)});
+    } else if (shared_buffers == nullptr) {
+      device.read(page_id, std::move(read_handler));
+    } else {
+      std::shared_ptr<PageBuffer> shared_data = shared_buffers->find(page_id);
+      if (shared_data) {
+        read_handler(std::shared_ptr<const PageBuffer>{std::move(shared_data)});
+      } else {
+        device.read(page_id, [shared_buffers, read_handler = std::move(read_handler)](
+                                 StatusOr<std::shared_ptr<const PageBuffer>>&& result) mutable {
+          if (result.ok()) {
+            shared_buffers->insert(**result);
           }
-          latch->set_value(std::move(page_view));
+          read_handler(std::move(result));
         });
+      }
+    }
   }
 
   return pinned_slot;
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ void PageCache::decode_page(PageDecodeOp& op)
+{
+  StatusOr<std::shared_ptr<const PageView>> page_view = op.reader(std::move(op.page_data));
+  if (page_view.ok()) {
+    BATT_CHECK_EQ(page_view->use_count(), 1u);
+  }
+  op.latch->set_value(std::move(page_view));
+  op.pinned_slot = {};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::page_decode_task_main()
+{
+  for (;;) {
+    StatusOr<PageDecodeOp> op = this->page_decode_queue_.await_next();
+    if (!op.ok()) {
+      break;
+    }
+    decode_page(*op);
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::queue_page_compress(
+    const std::shared_ptr<batt::Latch<std::shared_ptr<const PageView>>>& latch)
+{
+  if (!latch->is_ready()) {
+    return;
+  }
+  const StatusOr<std::shared_ptr<const PageView>>& loaded = latch->get_ready_value_or_panic();
+  if (!loaded.ok() || *loaded == nullptr) {
+    return;
+  }
+  std::shared_ptr<const PageBuffer> page_data = (*loaded)->data();
+  if (!page_data) {
+    return;
+  }
+
+  // Don't hold on to more uncompressed data than the compressed cache can hold in total; if the
+  // task falls behind, evicted pages are just dropped.
+  //
+  const usize page_size = page_data->size();
+  const usize pending_bytes = this->page_compress_pending_bytes_.get_value();
+  if (pending_bytes != 0 && pending_bytes + page_size > this->compressed_pages_->max_bytes()) {
+    return;
+  }
+
+  this->page_compress_pending_bytes_.fetch_add(page_size);
+
+  const bool pushed = this->page_compress_queue_.push(PageCompressOp{
+      .page_data = std::move(page_data),
+      .purge_generation = this->compressed_pages_->purge_generation(),
+  });
+
+  if (!pushed) {
+    this->page_compress_pending_bytes_.fetch_sub(page_size);
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCache::page_compress_task_main()
+{
+  for (;;) {
+    StatusOr<PageCompressOp> op = this->page_compress_queue_.await_next();
+    if (!op.ok()) {
+      break;
+    }
+    this->compressed_pages_->insert(*op->page_data, op->purge_generation);
+    this->page_compress_pending_bytes_.fetch_sub(op->page_data->size());
+
+    // Evictions are counted in `page_compress_pending_bytes_` before they read the purge
+    // generation, so if nothing is pending now, any later op reads at least `purge_generation`,
+    // and the pages purged so far no longer need to be remembered.
+    //
+    const u64 purge_generation = this->compressed_pages_->purge_generation();
+    if (this->page_compress_pending_bytes_.get_value() == 0) {
+      this->compressed_pages_->forget_purged(purge_generation);
+    }
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status PageCache::await_compressed_page_inserts()
+{
+  return this->page_compress_pending_bytes_.await_equal(0);
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 bool PageCache::page_might_contain_key(PageId /*page_id*/, const KeyView& /*key*/) const
@@ -13,8 +13,10 @@
 #include <llfs/api_types.hpp>
 #include <llfs/cache.hpp>
 #include <llfs/caller.hpp>
+#include <llfs/compressed_page_cache.hpp>
 #include <llfs/log_device.hpp>
 #include <llfs/metrics.hpp>
+#include <llfs/miss_ratio_curve.hpp>
 #include <llfs/optional.hpp>
 #include <llfs/page_allocator.hpp>
 #include <llfs/page_arena.hpp>
@@ -38,7 +40,13 @@
 #include <batteries/assert.hpp>
 #include <batteries/async/latch.hpp>
 #include <batteries/async/mutex.hpp>
+#include <batteries/async/queue.hpp>
+#include <batteries/async/task.hpp>
+#include <batteries/async/watch.hpp>
 
+#include <boost/uuid/uuid.hpp>
+
+#include <array>
 #include <functional>
 #include <iomanip>
 #include <memory>
@@ -47,6 +55,7 @@
 #include <typeindex>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace llfs {
 
@@ -88,6 +97,14 @@ inline std::ostream& operator<<(std::ostream& out, const NewPageTracker& t)
              << ",}";
 }
 
+// Returns the cache owner id used for pages loaded on behalf of the Volume with the given uuid.
+//
+inline CacheOwnerId cache_owner_for_uuid(const boost::uuids::uuid& uuid)
+{
+  const CacheOwnerId id = boost::uuids::hash_value(uuid);
+  return (id == kDefaultCacheOwner) ? id + 1 : id;
+}
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
 class PageCache : public PageLoader
@@ -104,6 +121,11 @@ class PageCache : public PageLoader
                         slot_offset_type caller_slot, batt::Grant& recycle_grant,
                         i32 recycle_depth) override;
 
+    void prefetch_pages(const Slice<const PageId>& page_ids) override;
+
+    std::unordered_map<PageId, usize, PageId::Hash> count_page_refs(
+        const Slice<const PageId>& page_ids) override;
+
    private:
     PageCache& page_cache_;
   };
@@ -129,8 +151,53 @@ class PageCache : public PageLoader
 
   const PageCacheOptions& options() const;
 
+  // Changes the number of pages of the given size that may be cached at once; initially this is
+  // the value from `options()`.  Shrinking evicts unpinned pages right away; pinned pages are
+  // evicted after they are unpinned (see Cache::set_capacity and `shrink_to_capacity`).
+  //
+  void set_max_cached_pages_per_size(PageSize page_size, usize n);
+
+  // Returns the current number of pages of the given size that may be cached at once.
+  //
+  usize max_cached_pages_per_size(PageSize page_size) const;
+
+  // Reserves `min_pages` cached pages of the given size for `owner`, and limits it to `max_pages`;
+  // see Cache::set_owner_quota.  Pages are charged to the owner passed to `get_for_owner` (or
+  // `put_view`) when they are first cached; see also PageCacheJob::set_cache_owner.
+  //
+  void set_cache_owner_quota(PageSize page_size, CacheOwnerId owner, usize min_pages,
+                             usize max_pages);
+
+  // Returns the number of cached pages of the given size charged to `owner`, and its hit/miss
+  // counts.  Hits served by the per-thread cache (see `PageCacheOptions::thread_local_cache_size`)
+  // are not counted.
+  //
+  const CacheOwnerMetrics& cache_owner_metrics(PageSize page_size, CacheOwnerId owner);
+
+  // Scales the capacity for each page size, in proportion to `options()`, so that cached pages take
+  // up at most `budget` bytes in total.
+  //
+  void set_memory_budget(u64 budget);
+
+  // Returns the number of bytes of page data this cache holds when full, using the capacities from
+  // `options()`.
+  //
+  u64 configured_memory_size() const;
+
+  // Finishes shrinking any page size caches that still hold more pages than their capacity because
+  // pages were pinned when they were shrunk.
+  //
+  void shrink_to_capacity();
+
   bool register_page_layout(const PageLayoutId& layout_id, const PageReader& reader);
 
+  // Same as above, but also sets the eviction priority class of cached pages with this layout;
+  // e.g., B-tree interior node layouts can be registered with CachePriority::kHigh so that they
+  // stay resident while scans churn through leaf pages.  The default is CachePriority::kNormal.
+  //
+  bool register_page_layout(const PageLayoutId& layout_id, const PageReader& reader,
+                            CachePriority cache_priority);
+
   void close();
 
   void join();
@@ -138,10 +205,17 @@ class PageCache : public PageLoader
   std::unique_ptr<PageCacheJob> new_job();
 
   StatusOr<std::shared_ptr<PageBuffer>> allocate_page_of_size(
-      PageSize size, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id);
+      PageSize size, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id,
+      PageWriteLifetime lifetime = PageWriteLifetime::kNotSet);
 
   StatusOr<std::shared_ptr<PageBuffer>> allocate_page_of_size_log2(
-      PageSizeLog2 size_log2, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id);
+      PageSizeLog2 size_log2, batt::WaitForResource wait_for_resource, u64 callers, u64 job_id,
+      PageWriteLifetime lifetime = PageWriteLifetime::kNotSet);
+
+  // Returns the expected page lifetime configured for the given arena (see
+  // `PageCacheOptions::set_device_write_lifetime`).
+  //
+  PageWriteLifetime arena_write_lifetime(const PageArena& arena) const;
 
   // Returns a page allocated via `allocate_page` to the free pool.  This MUST be done before the
   // page is written to the `PageDevice`.
@@ -172,6 +246,13 @@ class PageCache : public PageLoader
   //
   void prefetch_hint(PageId page_id) override;
 
+  // Same as above, but if the page has to be loaded, it is cached with the given eviction priority
+  // instead of the one registered for its layout.  Use CachePriority::kLow for pages that will be
+  // used once and then dropped (e.g., pages read ahead by the PageRecycler), so that reading them
+  // doesn't displace live pages.
+  //
+  void prefetch_hint(PageId page_id, CachePriority priority);
+
   // Loads the specified page or retrieves from cache.
   //
   StatusOr<PinnedPage> get(PageId page_id, const Optional<PageLayoutId>& required_layout,
@@ -179,9 +260,16 @@ class PageCache : public PageLoader
   //
   //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 
+  // Same as `get`, but the lookup (and the page, if it has to be loaded) is charged to `owner`.
+  //
+  StatusOr<PinnedPage> get_for_owner(CacheOwnerId owner, PageId page_id,
+                                     const Optional<PageLayoutId>& required_layout,
+                                     OkIfNotFound ok_if_not_found);
+
   // Insert a newly built PageView into the cache.
   //
-  StatusOr<PinnedPage> put_view(std::shared_ptr<const PageView>&& view, u64 callers, u64 job_id);
+  StatusOr<PinnedPage> put_view(std::shared_ptr<const PageView>&& view, u64 callers, u64 job_id,
+                                CacheOwnerId owner = kDefaultCacheOwner);
 
   // Remove all cached data for the specified page.
   //
@@ -208,9 +296,42 @@ class PageCache : public PageLoader
     return this->impl_for_size_log2_[page_size_log2]->metrics();
   }
 
+  // Returns the second-level cache of compressed pages, or nullptr if it is disabled (see
+  // `PageCacheOptions::set_compressed_page_cache_size`).
+  //
+  const CompressedPageCache* compressed_page_cache() const
+  {
+    return this->compressed_pages_.get();
+  }
+
+  // Pages evicted from the first level are compressed into the compressed page cache on a
+  // background task; blocks until all pages evicted so far have been inserted (or dropped).
+  //
+  Status await_compressed_page_inserts();
+
+  // Returns the online miss ratio curve estimator for the given page size, or nullptr if miss ratio
+  // curve estimation is disabled (see `PageCacheOptions::set_miss_ratio_curve_sample_rate`).
+  //
+  const MissRatioCurveEstimator* miss_ratio_curve_for_page_size(PageSize page_size) const
+  {
+    const i32 page_size_log2 = batt::log2_ceil(page_size);
+
+    BATT_CHECK_LT(static_cast<usize>(page_size_log2), this->mrc_for_size_log2_.size());
+
+    return this->mrc_for_size_log2_[page_size_log2].get();
+  }
+
  private:
   //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
-  using PageLayoutReaderMap = std::unordered_map<PageLayoutId, PageReader, PageLayoutId::Hash>;
+  // A registered page layout.
+  //
+  struct PageLayoutEntry {
+    PageReader reader;
+    CachePriority cache_priority;
+  };
+
+  using PageLayoutReaderMap =
+      std::unordered_map<PageLayoutId, PageLayoutEntry, PageLayoutId::Hash>;
 
   //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 
@@ -221,8 +342,65 @@ class PageCache : public PageLoader
 
   CacheImpl& impl_for_page(PageId page_id);
 
+  // Records a reference to `page_id` in the miss ratio curve estimator for its page size.
+  //
+  void record_miss_ratio_curve_reference(PageId page_id);
+
   batt::StatusOr<CacheImpl::PinnedSlot> find_page_in_cache(
-      PageId page_id, const Optional<PageLayoutId>& required_layout, OkIfNotFound ok_if_not_found);
+      PageId page_id, const Optional<PageLayoutId>& required_layout, OkIfNotFound ok_if_not_found,
+      CacheOwnerId owner, Optional<CachePriority> priority_override = None);
+
+  // Returns `page_id` from this thread's L0 cache (see `PageCacheOptions::thread_local_cache_size`)
+  // if it is there and still valid; otherwise returns an empty PinnedPage.
+  //
+  PinnedPage find_page_in_thread_local_cache(PageId page_id);
+
+  // Records `pinned_slot` (which must hold a loaded page) in this thread's L0 cache, replacing any
+  // entry that `page_id` collides with.
+  //
+  void insert_page_into_thread_local_cache(PageId page_id,
+                                           const CacheImpl::PinnedSlot& pinned_slot);
+
+  // A page that has been read but not yet decoded.
+  //
+  struct PageDecodeOp {
+    PageReader reader;
+    std::shared_ptr<const PageBuffer> page_data;
+    std::shared_ptr<batt::Latch<std::shared_ptr<const PageView>>> latch;
+
+    // Keeps the cache slot pinned until the latch is set.
+    //
+    CacheImpl::PinnedSlot pinned_slot;
+  };
+
+  // Runs the reader for `op` and sets its latch with the result.
+  //
+  static void decode_page(PageDecodeOp& op);
+
+  // Pulls ops from `page_decode_queue_` and decodes them until the queue is closed.
+  //
+  void page_decode_task_main();
+
+  // A page evicted from the first level, waiting to be inserted into `compressed_pages_`.
+  //
+  struct PageCompressOp {
+    std::shared_ptr<const PageBuffer> page_data;
+
+    // The compressed cache's purge generation when the page was evicted; if the page is purged
+    // before it is compressed, the insert is dropped.
+    //
+    u64 purge_generation;
+  };
+
+  // Called with the index lock of `impl_for_size_log2_` held (see CacheImpl::set_evict_fn), so
+  // this only queues the page for `page_compress_task_`.
+  //
+  void queue_page_compress(const std::shared_ptr<batt::Latch<std::shared_ptr<const PageView>>>&);
+
+  // Pulls ops from `page_compress_queue_` and inserts them into `compressed_pages_` until the
+  // queue is closed.
+  //
+  void page_compress_task_main();
 
   //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 
@@ -245,6 +423,12 @@ class PageCache : public PageLoader
   //
   std::array<Slice<PageArena>, kMaxPageSizeLog2> arenas_by_size_log2_;
 
+  // For each page size (log2) and PageWriteLifetime, the writable arenas of that size in the order
+  // `allocate_page_of_size_log2` tries them: those dedicated to the lifetime first, then the rest.
+  //
+  std::array<std::array<std::vector<const PageArena*>, kNumPageWriteLifetimes>, kMaxPageSizeLog2>
+      arena_allocation_order_;
+
   // Index of `this->storage_pool_` by device id, for fast lookup from PageId to the PageArena that
   // contains the page.
   //
@@ -254,11 +438,39 @@ class PageCache : public PageLoader
   //
   std::array<boost::intrusive_ptr<CacheImpl>, kMaxPageSizeLog2> impl_for_size_log2_;
 
-  // A thread-safe shared map from PageLayoutId to PageReader function; layouts must be registered
-  // with the PageCache so that we trace references during page recycling (aka garbage collection).
+  // Estimated miss ratio curves for each page size; all null unless enabled via
+  // `PageCacheOptions::miss_ratio_curve_sample_rate`.
+  //
+  std::array<std::unique_ptr<MissRatioCurveEstimator>, kMaxPageSizeLog2> mrc_for_size_log2_;
+
+  // Compressed copies of pages evicted from `impl_for_size_log2_`; null unless enabled via
+  // `PageCacheOptions::compressed_page_cache_size`.
+  //
+  std::unique_ptr<CompressedPageCache> compressed_pages_;
+
+  // Evicted pages waiting to be compressed, the total size of their data, and the task that
+  // compresses them; only used if `compressed_pages_` is non-null.
+  //
+  batt::Queue<PageCompressOp> page_compress_queue_;
+  batt::Watch<usize> page_compress_pending_bytes_{0};
+  Optional<batt::Task> page_compress_task_;
+
+  // A thread-safe shared map from PageLayoutId to PageReader function (and cache priority); layouts
+  // must be registered with the PageCache so that we trace references during page recycling (aka
+  // garbage collection).
+  //
+  std::shared_ptr<batt::Mutex<PageLayoutReaderMap>> page_readers_;
+
+  // Pages waiting to be decoded, and the tasks that decode them; both are only used if
+  // `PageCacheOptions::page_decode_task_count` is non-zero.
+  //
+  batt::Queue<PageDecodeOp> page_decode_queue_;
+  std::vector<std::unique_ptr<batt::Task>> page_decode_tasks_;
+
+  // Distinguishes this PageCache from all others (past and present) in this process; the per-thread
+  // L0 caches are shared by all PageCache objects, so each entry records which one it belongs to.
   //
-  std::shared_ptr<batt::Mutex<std::unordered_map<PageLayoutId, PageReader, PageLayoutId::Hash>>>
-      page_readers_;
+  const u64 instance_id_;
 
   //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
   // TODO [tastolfi 2021-09-08] We need something akin to the PageRecycler/PageAllocator to durably
@@ -0,0 +1,405 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/page_cache.hpp>
+//
+#include <llfs/page_cache.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/memory_page_arena.hpp>
+#include <llfs/opaque_page_view.hpp>
+#include <llfs/packed_page_header.hpp>
+
+#include <batteries/async/runtime.hpp>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace llfs::int_types;
+
+TEST(PageCacheTest, PageDecodeTasks)
+{
+  const llfs::PageSize kPageSize{4096};
+
+  const llfs::PageLayoutId kTestLayout = [] {
+    llfs::PageLayoutId id;
+    const char tag[sizeof(id.value) + 1] = "(tstpg)";
+    std::memcpy(&id.value, tag, sizeof(id.value));
+    return id;
+  }();
+
+  for (usize task_count : {0, 2}) {
+    std::vector<llfs::PageArena> arenas;
+    arenas.emplace_back(llfs::make_memory_page_arena(batt::Runtime::instance().default_scheduler(),
+                                                     llfs::PageCount{4}, kPageSize, "Arena0",
+                                                     /*device_id=*/0));
+
+    llfs::StatusOr<batt::SharedPtr<llfs::PageCache>> cache = llfs::PageCache::make_shared(
+        std::move(arenas),
+        llfs::PageCacheOptions::with_default_values().set_page_decode_task_count(task_count));
+    ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+    // Record the thread that decodes each page.
+    //
+    std::vector<std::thread::id> decode_threads;
+    (*cache)->register_page_layout(
+        kTestLayout,
+        [&decode_threads](std::shared_ptr<const llfs::PageBuffer> page_buffer)
+            -> llfs::StatusOr<std::shared_ptr<const llfs::PageView>> {
+          decode_threads.emplace_back(std::this_thread::get_id());
+          return {std::make_shared<llfs::OpaquePageView>(std::move(page_buffer))};
+        });
+
+    // Write a page directly to the device, so the first `get` has to read and decode it.
+    //
+    llfs::StatusOr<std::shared_ptr<llfs::PageBuffer>> page_buffer =
+        (*cache)->allocate_page_of_size(kPageSize, batt::WaitForResource::kFalse,
+                                        llfs::Caller::Unknown, /*job_id=*/0);
+    ASSERT_TRUE(page_buffer.ok()) << BATT_INSPECT(page_buffer.status());
+
+    const llfs::PageId page_id = (*page_buffer)->page_id();
+
+    llfs::Status write_status;
+    (*cache)->arena_for_page_id(page_id).device().write(std::move(*page_buffer),
+                                                        [&write_status](llfs::Status status) {
+                                                          write_status = status;
+                                                        });
+    ASSERT_TRUE(write_status.ok()) << BATT_INSPECT(write_status);
+
+    llfs::StatusOr<llfs::PinnedPage> loaded =
+        (*cache)->get(page_id, kTestLayout, llfs::OkIfNotFound{false});
+    ASSERT_TRUE(loaded.ok()) << BATT_INSPECT(loaded.status());
+    EXPECT_EQ(loaded->get()->page_id(), page_id);
+
+    // MemoryPageDevice completes reads on the calling thread, so that is where the page is decoded
+    // unless there are decode tasks.
+    //
+    ASSERT_EQ(decode_threads.size(), 1u);
+    if (task_count == 0) {
+      EXPECT_EQ(decode_threads.front(), std::this_thread::get_id());
+    } else {
+      EXPECT_NE(decode_threads.front(), std::this_thread::get_id());
+    }
+  }
+}
+
+TEST(PageCacheTest, ThreadLocalCache)
+{
+  const llfs::PageSize kPageSize{4096};
+
+  const llfs::PageLayoutId kTestLayout = [] {
+    llfs::PageLayoutId id;
+    const char tag[sizeof(id.value) + 1] = "(tstpg)";
+    std::memcpy(&id.value, tag, sizeof(id.value));
+    return id;
+  }();
+
+  std::vector<llfs::PageArena> arenas;
+  arenas.emplace_back(llfs::make_memory_page_arena(batt::Runtime::instance().default_scheduler(),
+                                                   llfs::PageCount{4}, kPageSize, "Arena0",
+                                                   /*device_id=*/0));
+
+  llfs::StatusOr<batt::SharedPtr<llfs::PageCache>> cache = llfs::PageCache::make_shared(
+      std::move(arenas),
+      llfs::PageCacheOptions::with_default_values().set_thread_local_cache_size(10));
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+  EXPECT_EQ((*cache)->options().thread_local_cache_size, 16u);
+
+  usize decode_count = 0;
+  (*cache)->register_page_layout(
+      kTestLayout,
+      [&decode_count](std::shared_ptr<const llfs::PageBuffer> page_buffer)
+          -> llfs::StatusOr<std::shared_ptr<const llfs::PageView>> {
+        ++decode_count;
+        return {std::make_shared<llfs::OpaquePageView>(std::move(page_buffer))};
+      });
+
+  llfs::StatusOr<std::shared_ptr<llfs::PageBuffer>> page_buffer =
+      (*cache)->allocate_page_of_size(kPageSize, batt::WaitForResource::kFalse,
+                                      llfs::Caller::Unknown, /*job_id=*/0);
+  ASSERT_TRUE(page_buffer.ok()) << BATT_INSPECT(page_buffer.status());
+
+  const llfs::PageId page_id = (*page_buffer)->page_id();
+
+  llfs::Status write_status;
+  (*cache)->arena_for_page_id(page_id).device().write(std::move(*page_buffer),
+                                                      [&write_status](llfs::Status status) {
+                                                        write_status = status;
+                                                      });
+  ASSERT_TRUE(write_status.ok()) << BATT_INSPECT(write_status);
+
+  const auto query_count = [&] {
+    return (*cache)->metrics_for_page_size(kPageSize).query_count.load();
+  };
+
+  const auto get_page = [&] {
+    llfs::StatusOr<llfs::PinnedPage> loaded =
+        (*cache)->get(page_id, kTestLayout, llfs::OkIfNotFound{false});
+    BATT_CHECK_OK(loaded);
+    BATT_CHECK_EQ(loaded->get()->page_id(), page_id);
+    return std::move(*loaded);
+  };
+
+  // The first get goes to the shared cache (and the device); repeated gets on this thread don't.
+  //
+  const llfs::PinnedPage first = get_page();
+  const u64 query_count_after_first = query_count();
+  EXPECT_EQ(decode_count, 1u);
+
+  for (usize i = 0; i < 10; ++i) {
+    llfs::PinnedPage again = get_page();
+    EXPECT_EQ(again.get(), first.get());
+  }
+  EXPECT_EQ(query_count(), query_count_after_first);
+
+  // Other threads have their own L0 cache.
+  //
+  std::thread{get_page}.join();
+  EXPECT_EQ(query_count(), query_count_after_first + 1);
+
+  // After a purge, the page must be reloaded.
+  //
+  (*cache)->purge(page_id, llfs::Caller::Unknown, /*job_id=*/0);
+
+  llfs::PinnedPage reloaded = get_page();
+  EXPECT_NE(reloaded.get(), first.get());
+  EXPECT_EQ(decode_count, 2u);
+  EXPECT_EQ(query_count(), query_count_after_first + 2);
+
+  // Purging some other page doesn't invalidate this page's entry.
+  //
+  llfs::StatusOr<std::shared_ptr<llfs::PageBuffer>> other_page_buffer =
+      (*cache)->allocate_page_of_size(kPageSize, batt::WaitForResource::kFalse,
+                                      llfs::Caller::Unknown, /*job_id=*/0);
+  ASSERT_TRUE(other_page_buffer.ok()) << BATT_INSPECT(other_page_buffer.status());
+
+  (*cache)->purge((*other_page_buffer)->page_id(), llfs::Caller::Unknown, /*job_id=*/0);
+
+  EXPECT_EQ(get_page().get(), reloaded.get());
+  EXPECT_EQ(query_count(), query_count_after_first + 2);
+}
+
+TEST(PageCacheTest, WriteLifetimeArenaSelection)
+{
+  const llfs::PageSize kPageSize{4096};
+
+  std::vector<llfs::PageArena> arenas;
+  for (u64 device_id = 0; device_id < 2; ++device_id) {
+    arenas.emplace_back(llfs::make_memory_page_arena(
+        batt::Runtime::instance().default_scheduler(), llfs::PageCount{2}, kPageSize,
+        batt::to_string("Arena", device_id), device_id));
+  }
+
+  llfs::StatusOr<batt::SharedPtr<llfs::PageCache>> cache = llfs::PageCache::make_shared(
+      std::move(arenas), llfs::PageCacheOptions::with_default_values().set_device_write_lifetime(
+                             /*device_id=*/1, llfs::PageWriteLifetime::kShort));
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+  const auto allocate_from_device = [&](llfs::PageWriteLifetime lifetime) -> u64 {
+    llfs::StatusOr<std::shared_ptr<llfs::PageBuffer>> page_buffer =
+        (*cache)->allocate_page_of_size(kPageSize, batt::WaitForResource::kFalse,
+                                        llfs::Caller::Unknown, /*job_id=*/0, lifetime);
+    BATT_CHECK_OK(page_buffer);
+    return llfs::PageIdFactory::get_device_id((*page_buffer)->page_id());
+  };
+
+  // Pages without a configured lifetime go to the arenas without one first, ...
+  //
+  EXPECT_EQ(allocate_from_device(llfs::PageWriteLifetime::kNotSet), 0u);
+
+  // ...pages with a lifetime go to the arena dedicated to it, ...
+  //
+  EXPECT_EQ(allocate_from_device(llfs::PageWriteLifetime::kShort), 1u);
+  EXPECT_EQ(allocate_from_device(llfs::PageWriteLifetime::kShort), 1u);
+
+  // ...and once that arena is full, allocation falls back to the others.
+  //
+  EXPECT_EQ(allocate_from_device(llfs::PageWriteLifetime::kShort), 0u);
+}
+
+TEST(PageCacheTest, CompressedPageCache)
+{
+  const llfs::PageSize kPageSize{4096};
+
+  const llfs::PageLayoutId kTestLayout = [] {
+    llfs::PageLayoutId id;
+    const char tag[sizeof(id.value) + 1] = "(tstpg)";
+    std::memcpy(&id.value, tag, sizeof(id.value));
+    return id;
+  }();
+
+  std::vector<llfs::PageArena> arenas;
+  arenas.emplace_back(llfs::make_memory_page_arena(batt::Runtime::instance().default_scheduler(),
+                                                   llfs::PageCount{4}, kPageSize, "Arena0",
+                                                   /*device_id=*/0));
+
+  // Only one page fits in the first level.
+  //
+  llfs::StatusOr<batt::SharedPtr<llfs::PageCache>> cache = llfs::PageCache::make_shared(
+      std::move(arenas), llfs::PageCacheOptions::with_default_values()
+                             .set_max_cached_pages_per_size(kPageSize, 1)
+                             .set_compressed_page_cache_size(64 * 1024));
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+  const llfs::CompressedPageCache* compressed = (*cache)->compressed_page_cache();
+  ASSERT_NE(compressed, nullptr);
+
+  (*cache)->register_page_layout(
+      kTestLayout,
+      [](std::shared_ptr<const llfs::PageBuffer> page_buffer)
+          -> llfs::StatusOr<std::shared_ptr<const llfs::PageView>> {
+        return {std::make_shared<llfs::OpaquePageView>(std::move(page_buffer))};
+      });
+
+  // Write two (compressible) pages directly to the device.
+  //
+  std::vector<llfs::PageId> page_ids;
+  for (char fill : {'a', 'b'}) {
+    llfs::StatusOr<std::shared_ptr<llfs::PageBuffer>> page_buffer =
+        (*cache)->allocate_page_of_size(kPageSize, batt::WaitForResource::kFalse,
+                                        llfs::Caller::Unknown, /*job_id=*/0);
+    ASSERT_TRUE(page_buffer.ok()) << BATT_INSPECT(page_buffer.status());
+
+    llfs::MutableBuffer payload = (*page_buffer)->mutable_payload();
+    std::memset(payload.data(), fill, payload.size());
+
+    const llfs::PageId page_id = (*page_buffer)->page_id();
+    page_ids.emplace_back(page_id);
+
+    llfs::Status write_status;
+    (*cache)->arena_for_page_id(page_id).device().write(std::move(*page_buffer),
+                                                        [&write_status](llfs::Status status) {
+                                                          write_status = status;
+                                                        });
+    ASSERT_TRUE(write_status.ok()) << BATT_INSPECT(write_status);
+  }
+
+  const auto get_payload = [&](llfs::PageId page_id) {
+    llfs::StatusOr<llfs::PinnedPage> loaded =
+        (*cache)->get(page_id, kTestLayout, llfs::OkIfNotFound{false});
+    BATT_CHECK_OK(loaded);
+    const llfs::ConstBuffer payload = loaded->get()->data()->const_payload();
+    return std::string{static_cast<const char*>(payload.data()), payload.size()};
+  };
+
+  const std::string expected_a(kPageSize - sizeof(llfs::PackedPageHeader), 'a');
+  const std::string expected_b(kPageSize - sizeof(llfs::PackedPageHeader), 'b');
+
+  EXPECT_EQ(get_payload(page_ids[0]), expected_a);
+  EXPECT_EQ(compressed->metrics().insert_count.load(), 0u);
+
+  // Loading the second page evicts the first one to the compressed cache (which compresses it in
+  // the background)...
+  //
+  EXPECT_EQ(get_payload(page_ids[1]), expected_b);
+  ASSERT_TRUE((*cache)->await_compressed_page_inserts().ok());
+  EXPECT_EQ(compressed->metrics().insert_count.load(), 1u);
+  EXPECT_EQ(compressed->metrics().hit_count.load(), 0u);
+
+  // ...where it is found the next time it is needed.
+  //
+  EXPECT_EQ(get_payload(page_ids[0]), expected_a);
+  ASSERT_TRUE((*cache)->await_compressed_page_inserts().ok());
+  EXPECT_EQ(compressed->metrics().insert_count.load(), 2u);
+  EXPECT_EQ(compressed->metrics().hit_count.load(), 1u);
+
+  // Purged pages are dropped from the compressed cache too.
+  //
+  (*cache)->purge(page_ids[1], llfs::Caller::Unknown, /*job_id=*/0);
+  EXPECT_EQ(compressed->metrics().page_count.load(), 0u);
+}
+
+TEST(PageCacheTest, PrefetchHintPriority)
+{
+  const llfs::PageSize kPageSize{4096};
+
+  const llfs::PageLayoutId kTestLayout = [] {
+    llfs::PageLayoutId id;
+    const char tag[sizeof(id.value) + 1] = "(tstpg)";
+    std::memcpy(&id.value, tag, sizeof(id.value));
+    return id;
+  }();
+
+  std::vector<llfs::PageArena> arenas;
+  arenas.emplace_back(llfs::make_memory_page_arena(batt::Runtime::instance().default_scheduler(),
+                                                   llfs::PageCount{4}, kPageSize, "Arena0",
+                                                   /*device_id=*/0));
+
+  // Only two pages fit in the cache.
+  //
+  llfs::StatusOr<batt::SharedPtr<llfs::PageCache>> cache = llfs::PageCache::make_shared(
+      std::move(arenas),
+      llfs::PageCacheOptions::with_default_values().set_max_cached_pages_per_size(kPageSize, 2));
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+  usize decode_count = 0;
+  (*cache)->register_page_layout(
+      kTestLayout,
+      [&decode_count](std::shared_ptr<const llfs::PageBuffer> page_buffer)
+          -> llfs::StatusOr<std::shared_ptr<const llfs::PageView>> {
+        ++decode_count;
+        return {std::make_shared<llfs::OpaquePageView>(std::move(page_buffer))};
+      },
+      llfs::CachePriority::kHigh);
+
+  std::vector<llfs::PageId> page_ids;
+  for (usize i = 0; i < 3; ++i) {
+    llfs::StatusOr<std::shared_ptr<llfs::PageBuffer>> page_buffer =
+        (*cache)->allocate_page_of_size(kPageSize, batt::WaitForResource::kFalse,
+                                        llfs::Caller::Unknown, /*job_id=*/0);
+    ASSERT_TRUE(page_buffer.ok()) << BATT_INSPECT(page_buffer.status());
+
+    // Prefetched pages are not loaded with a required layout, so it must be in the header.
+    //
+    llfs::mutable_page_header(page_buffer->get())->layout_id = kTestLayout;
+
+    const llfs::PageId page_id = (*page_buffer)->page_id();
+    page_ids.emplace_back(page_id);
+
+    llfs::Status write_status;
+    (*cache)->arena_for_page_id(page_id).device().write(std::move(*page_buffer),
+                                                        [&write_status](llfs::Status status) {
+                                                          write_status = status;
+                                                        });
+    ASSERT_TRUE(write_status.ok()) << BATT_INSPECT(write_status);
+  }
+
+  const auto get_page = [&](llfs::PageId page_id) {
+    llfs::StatusOr<llfs::PinnedPage> loaded =
+        (*cache)->get(page_id, kTestLayout, llfs::OkIfNotFound{false});
+    BATT_CHECK_OK(loaded);
+  };
+
+  // Load a live page; it gets the priority of its layout.
+  //
+  get_page(page_ids[0]);
+  EXPECT_EQ(decode_count, 1u);
+
+  // Read the other two pages ahead at low priority; the second evicts the first, even though the
+  // live page is less recently used.
+  //
+  (*cache)->prefetch_hint(page_ids[1], llfs::CachePriority::kLow);
+  (*cache)->prefetch_hint(page_ids[2], llfs::CachePriority::kLow);
+  EXPECT_EQ(decode_count, 3u);
+
+  get_page(page_ids[0]);
+  EXPECT_EQ(decode_count, 3u);
+
+  get_page(page_ids[2]);
+  EXPECT_EQ(decode_count, 3u);
+
+  get_page(page_ids[1]);
+  EXPECT_EQ(decode_count, 4u);
+}
+
+}  // namespace
@@ -102,13 +102,13 @@ bool PageCacheJob::is_page_new_and_pinned(PageId page_id) const
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<std::shared_ptr<PageBuffer>> PageCacheJob::new_page(
-    PageSize size, batt::WaitForResource wait_for_resource, u64 callers)
+    PageSize size, batt::WaitForResource wait_for_resource, u64 callers, PageWriteLifetime lifetime)
 {
   // TODO [tastolfi 2021-04-07] instead of WaitForResource::kTrue, implement a backoff-and-retry
   // loop with a cancel token.
   //
   StatusOr<std::shared_ptr<PageBuffer>> buffer = this->cache_->allocate_page_of_size(
-      size, wait_for_resource, callers | Caller::PageCacheJob_new_page, this->job_id);
+      size, wait_for_resource, callers | Caller::PageCacheJob_new_page, this->job_id, lifetime);
   BATT_REQUIRE_OK(buffer);
 
   const PageId page_id = buffer->get()->page_id();
@@ -166,7 +166,8 @@ StatusOr<PinnedPage> PageCacheJob::pin_new(std::shared_ptr<PageView>&& page_view
       "PageCacheJob::pin_new() - Cache::put_view",
       [&] {
         return this->cache_->put_view(batt::make_copy(page_view),
-                                      callers | Caller::PageCacheJob_pin_new, this->job_id);
+                                      callers | Caller::PageCacheJob_pin_new, this->job_id,
+                                      this->cache_owner_);
       },
       batt::TaskSleepImpl{},
       [](const batt::Status& status) {
@@ -297,7 +298,8 @@ StatusOr<PinnedPage> PageCacheJob::const_get(PageId page_id,
   if (pinned_page.status() != batt::StatusCode::kUnavailable) {
     return pinned_page;
   }
-  return this->cache_->get(page_id, required_layout, ok_if_not_found);
+  return this->cache_->get_for_owner(this->cache_owner_, page_id, required_layout,
+                                     ok_if_not_found);
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -324,7 +326,9 @@ Status PageCacheJob::recover_page(PageId page_id, const boost::uuids::uuid& call
                                   slot_offset_type caller_slot)
 {
   const PageArena& arena = this->cache_->arena_for_page_id(page_id);
-  PageAllocator& page_allocator = arena.allocator();
+  StatusOr<PageAllocator*> p_allocator = arena.allocator();
+  BATT_REQUIRE_OK(p_allocator);
+  PageAllocator& page_allocator = **p_allocator;
 
   Status allocator_recovered = page_allocator.recover_page(page_id);
   BATT_REQUIRE_OK(allocator_recovered);
@@ -16,6 +16,7 @@
 #include <llfs/page_id.hpp>
 #include <llfs/page_loader.hpp>
 #include <llfs/page_size.hpp>
+#include <llfs/page_write_lifetime.hpp>
 #include <llfs/pinned_page.hpp>
 
 #include <functional>
@@ -101,6 +102,18 @@ class PageCacheJob : public PageLoader
     return *cache_;
   }
 
+  // Charges pages loaded or cached by this job to `owner`; see PageCache::set_cache_owner_quota.
+  //
+  void set_cache_owner(CacheOwnerId owner)
+  {
+    this->cache_owner_ = owner;
+  }
+
+  CacheOwnerId cache_owner() const
+  {
+    return this->cache_owner_;
+  }
+
   // Set `base_job` as the job immediately prior to this one; any changes in `base_job` can be seen
   // by this one (even if `base_job` is not yet durably committed) and proper storage ordering
   // between `this` and `base_job` on commmit will be guaranteed to preserve consistency on crash
@@ -126,9 +139,12 @@ class PageCacheJob : public PageLoader
   // implementation is created for the formatted page and added to the job via `pin_new`.  Otherwise
   // the job will have no way of tracing page references from the new page to determine "liveness".
   //
-  StatusOr<std::shared_ptr<PageBuffer>> new_page(PageSize size,
-                                                 batt::WaitForResource wait_for_resource,
-                                                 u64 callers);
+  // `lifetime` is a hint about how long the page is expected to live before it is dropped; see
+  // `PageCacheOptions::set_device_write_lifetime`.
+  //
+  StatusOr<std::shared_ptr<PageBuffer>> new_page(
+      PageSize size, batt::WaitForResource wait_for_resource, u64 callers,
+      PageWriteLifetime lifetime = PageWriteLifetime::kNotSet);
 
   // Inserts a new page into the cache.  The passed PageView must have been created using a
   // PageBuffer returned by `new_page` for this job, or we will panic.
@@ -285,6 +301,7 @@ class PageCacheJob : public PageLoader
 
  private:
   PageCache* const cache_;
+  CacheOwnerId cache_owner_ = kDefaultCacheOwner;
   std::unordered_map<PageId, PinnedPage, PageId::Hash> pinned_;
   std::unordered_map<PageId, NewPage, PageId::Hash> new_pages_;
   std::unordered_map<PageId, PinnedPage, PageId::Hash> deleted_pages_;
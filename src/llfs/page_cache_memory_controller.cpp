@@ -0,0 +1,194 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/page_cache_memory_controller.hpp>
+//
+
+#include <llfs/logging.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ PageCacheMemoryControllerOptions PageCacheMemoryControllerOptions::with_default_values()
+{
+  return PageCacheMemoryControllerOptions{
+      .pressure_file_path = "/sys/fs/cgroup/memory.pressure",
+      .budget_fn = nullptr,
+      .high_pressure_percent = 10.0,
+      .low_pressure_percent = 1.0,
+      .shrink_factor = 0.8,
+      .grow_factor = 1.1,
+      .min_fraction = 0.1,
+      .update_interval_ms = 1000,
+  };
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// class PageCacheMemoryController
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ Optional<double> PageCacheMemoryController::parse_memory_pressure(
+    std::string_view psi_text)
+{
+  // The format is one line per kind, e.g.:
+  //
+  //   some avg10=0.12 avg60=0.05 avg300=0.01 total=12345
+  //   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+  //
+  std::istringstream in{std::string{psi_text}};
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields{line};
+    std::string kind;
+    std::string avg10;
+    if (!(fields >> kind >> avg10) || kind != "some") {
+      continue;
+    }
+
+    constexpr std::string_view kPrefix = "avg10=";
+    if (avg10.compare(0, kPrefix.size(), kPrefix) != 0) {
+      return None;
+    }
+    try {
+      return std::stod(avg10.substr(kPrefix.size()));
+    } catch (...) {
+      return None;
+    }
+  }
+  return None;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ PageCacheMemoryController::PageCacheMemoryController(PageCache& cache,
+                                                                 const Options& options) noexcept
+    : cache_{cache}
+    , options_{options}
+{
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PageCacheMemoryController::~PageCacheMemoryController() noexcept
+{
+  this->halt();
+  this->join();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCacheMemoryController::start()
+{
+  if (this->thread_.joinable()) {
+    return;
+  }
+  this->thread_ = std::thread{[this] {
+    this->thread_main();
+  }};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCacheMemoryController::halt()
+{
+  {
+    std::unique_lock<std::mutex> lock{this->halt_mutex_};
+    this->halt_requested_ = true;
+  }
+  this->halt_cond_.notify_all();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCacheMemoryController::join()
+{
+  if (this->thread_.joinable()) {
+    this->thread_.join();
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 PageCacheMemoryController::update(Optional<double> pressure_percent,
+                                      Optional<u64> caller_budget)
+{
+  double fraction = this->pressure_fraction_.load();
+  if (pressure_percent) {
+    if (*pressure_percent > this->options_.high_pressure_percent) {
+      fraction = std::max(this->options_.min_fraction, fraction * this->options_.shrink_factor);
+    } else if (*pressure_percent < this->options_.low_pressure_percent) {
+      fraction = std::min(1.0, fraction * this->options_.grow_factor);
+    }
+    this->pressure_fraction_.store(fraction);
+  }
+
+  u64 budget = static_cast<u64>(fraction * this->cache_.configured_memory_size());
+  if (caller_budget) {
+    budget = std::min(budget, *caller_budget);
+  }
+
+  this->cache_.set_memory_budget(budget);
+
+  return budget;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Optional<double> PageCacheMemoryController::read_memory_pressure() const
+{
+  if (this->options_.pressure_file_path.empty()) {
+    return None;
+  }
+
+  std::ifstream in{this->options_.pressure_file_path};
+  if (!in.good()) {
+    return None;
+  }
+
+  std::ostringstream contents;
+  contents << in.rdbuf();
+
+  return parse_memory_pressure(contents.str());
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageCacheMemoryController::thread_main()
+{
+  for (;;) {
+    Optional<u64> caller_budget;
+    if (this->options_.budget_fn) {
+      caller_budget = this->options_.budget_fn();
+    }
+
+    const u64 budget = this->update(this->read_memory_pressure(), caller_budget);
+
+    LLFS_VLOG(1) << "PageCacheMemoryController: " << BATT_INSPECT(budget)
+                 << BATT_INSPECT(this->pressure_fraction());
+
+    std::unique_lock<std::mutex> lock{this->halt_mutex_};
+
+    const bool halted = this->halt_cond_.wait_for(
+        lock, std::chrono::milliseconds(this->options_.update_interval_ms), [this] {
+          return this->halt_requested_;
+        });
+
+    if (halted) {
+      return;
+    }
+  }
+}
+
+}  // namespace llfs
@@ -0,0 +1,123 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_PAGE_CACHE_MEMORY_CONTROLLER_HPP
+#define LLFS_PAGE_CACHE_MEMORY_CONTROLLER_HPP
+
+#include <llfs/int_types.hpp>
+#include <llfs/optional.hpp>
+#include <llfs/page_cache.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace llfs {
+
+struct PageCacheMemoryControllerOptions {
+  static PageCacheMemoryControllerOptions with_default_values();
+
+  // The cgroup v2 PSI file to read memory pressure from; if empty, pressure is not monitored.
+  //
+  std::string pressure_file_path;
+
+  // (Optional) Returns an upper bound on the number of bytes the cache may use; called on every
+  // update.
+  //
+  std::function<u64()> budget_fn;
+
+  // When the "some avg10" memory pressure (percent of time stalled) is above
+  // `high_pressure_percent`, the cache is shrunk by `shrink_factor` on each update; when it is
+  // below `low_pressure_percent`, the cache grows back by `grow_factor` on each update.
+  //
+  double high_pressure_percent;
+  double low_pressure_percent;
+  double shrink_factor;
+  double grow_factor;
+
+  // The cache is never shrunk below this fraction of its configured size because of pressure.
+  //
+  double min_fraction;
+
+  // How often to update the cache capacity.
+  //
+  u64 update_interval_ms;
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief Resizes a PageCache at runtime in response to memory pressure and/or a caller-supplied
+ * memory budget, so that the cache gives memory back when co-located services need it and
+ * gradually reclaims it when they don't.
+ */
+class PageCacheMemoryController
+{
+ public:
+  using Options = PageCacheMemoryControllerOptions;
+
+  /** \brief Returns the "some avg10" value from the contents of a PSI file (e.g.,
+   * /sys/fs/cgroup/memory.pressure), or None if it can't be parsed.
+   */
+  static Optional<double> parse_memory_pressure(std::string_view psi_text);
+
+  explicit PageCacheMemoryController(PageCache& cache, const Options& options) noexcept;
+
+  PageCacheMemoryController(const PageCacheMemoryController&) = delete;
+  PageCacheMemoryController& operator=(const PageCacheMemoryController&) = delete;
+
+  ~PageCacheMemoryController() noexcept;
+
+  /** \brief Starts a background thread that calls `update` every `options.update_interval_ms`.
+   *
+   * This is a plain thread rather than a batt::Task because it reads the pressure file with
+   * blocking I/O, and resizing the cache may retire many slots.
+   */
+  void start();
+
+  void halt();
+
+  void join();
+
+  /** \brief Adjusts the cache capacity for the given inputs; returns the new memory budget.
+   */
+  u64 update(Optional<double> pressure_percent, Optional<u64> caller_budget);
+
+  /** \brief The fraction of the configured cache size currently allowed by memory pressure.
+   */
+  double pressure_fraction() const
+  {
+    return this->pressure_fraction_.load();
+  }
+
+ private:
+  Optional<double> read_memory_pressure() const;
+
+  void thread_main();
+
+  PageCache& cache_;
+
+  const Options options_;
+
+  std::atomic<double> pressure_fraction_{1.0};
+
+  // Protects `halt_requested_`; `halt_cond_` is signalled when it is set, to wake the thread.
+  //
+  std::mutex halt_mutex_;
+  std::condition_variable halt_cond_;
+  bool halt_requested_ = false;
+
+  std::thread thread_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_PAGE_CACHE_MEMORY_CONTROLLER_HPP
@@ -0,0 +1,93 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/page_cache_memory_controller.hpp>
+//
+#include <llfs/page_cache_memory_controller.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/memory_page_cache.hpp>
+
+#include <batteries/async/runtime.hpp>
+
+namespace {
+
+using namespace llfs::int_types;
+
+using llfs::PageCacheMemoryController;
+
+TEST(PageCacheMemoryControllerTest, ParseMemoryPressure)
+{
+  EXPECT_EQ(PageCacheMemoryController::parse_memory_pressure(
+                "some avg10=12.50 avg60=3.00 avg300=1.00 total=12345\n"
+                "full avg10=2.00 avg60=1.00 avg300=0.50 total=999\n"),
+            llfs::Optional<double>{12.5});
+
+  EXPECT_EQ(PageCacheMemoryController::parse_memory_pressure(
+                "full avg10=2.00 avg60=1.00 avg300=0.50 total=999\n"
+                "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"),
+            llfs::Optional<double>{0.0});
+
+  EXPECT_EQ(PageCacheMemoryController::parse_memory_pressure(""), llfs::None);
+  EXPECT_EQ(PageCacheMemoryController::parse_memory_pressure("some avg10=bogus"), llfs::None);
+}
+
+TEST(PageCacheMemoryControllerTest, ShrinkAndGrow)
+{
+  constexpr u32 kPageSizeBytes = 4096;
+  const llfs::PageSize kPageSize{kPageSizeBytes};
+
+  batt::SharedPtr<llfs::PageCache> cache = llfs::make_memory_page_cache(
+      batt::Runtime::instance().default_scheduler(),
+      /*arena_sizes=*/{{llfs::PageCount{16}, kPageSize}}, llfs::MaxRefsPerPage{1});
+
+  const usize configured_pages = cache->options().max_cached_pages_per_size_log2[12];
+  ASSERT_EQ(cache->max_cached_pages_per_size(kPageSize), configured_pages);
+  ASSERT_EQ(cache->configured_memory_size(), configured_pages * kPageSizeBytes);
+
+  auto options = PageCacheMemoryController::Options::with_default_values();
+  options.pressure_file_path.clear();
+
+  PageCacheMemoryController controller{*cache, options};
+
+  // High pressure shrinks the cache a step at a time, down to the minimum fraction.
+  //
+  controller.update(/*pressure_percent=*/50.0, /*caller_budget=*/llfs::None);
+  EXPECT_DOUBLE_EQ(controller.pressure_fraction(), options.shrink_factor);
+  EXPECT_EQ(cache->max_cached_pages_per_size(kPageSize),
+            static_cast<usize>(configured_pages * options.shrink_factor));
+
+  for (usize i = 0; i < 100; ++i) {
+    controller.update(/*pressure_percent=*/50.0, /*caller_budget=*/llfs::None);
+  }
+  EXPECT_DOUBLE_EQ(controller.pressure_fraction(), options.min_fraction);
+
+  // Moderate pressure holds the size steady.
+  //
+  controller.update(/*pressure_percent=*/5.0, /*caller_budget=*/llfs::None);
+  EXPECT_DOUBLE_EQ(controller.pressure_fraction(), options.min_fraction);
+
+  // Low pressure grows the cache back, up to its configured size.
+  //
+  for (usize i = 0; i < 100; ++i) {
+    controller.update(/*pressure_percent=*/0.0, /*caller_budget=*/llfs::None);
+  }
+  EXPECT_DOUBLE_EQ(controller.pressure_fraction(), 1.0);
+  EXPECT_EQ(cache->max_cached_pages_per_size(kPageSize), configured_pages);
+
+  // A caller-supplied budget caps the size regardless of pressure.
+  //
+  const u64 budget = controller.update(/*pressure_percent=*/llfs::None,
+                                       /*caller_budget=*/kPageSizeBytes * 1000);
+  EXPECT_EQ(budget, kPageSizeBytes * 1000);
+  EXPECT_EQ(cache->max_cached_pages_per_size(kPageSize), 1000u);
+}
+
+}  // namespace
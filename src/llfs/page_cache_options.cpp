@@ -19,6 +19,10 @@ PageCacheOptions PageCacheOptions::with_default_values()
 
   opts.default_log_size_ = 64 * kMiB;
   opts.max_cached_pages_per_size_log2.fill(0);
+  opts.miss_ratio_curve_sample_rate = 0;
+  opts.page_decode_task_count = 0;
+  opts.thread_local_cache_size = 0;
+  opts.compressed_page_cache_size = 0;
 
   // Assume that 512..8192 are node sizes; allow a million nodes to be cached.
   //
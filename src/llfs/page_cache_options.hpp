@@ -13,12 +13,17 @@
 #include <llfs/config.hpp>
 #include <llfs/constants.hpp>
 #include <llfs/int_types.hpp>
+#include <llfs/page_id_factory.hpp>
 #include <llfs/page_size.hpp>
+#include <llfs/page_write_lifetime.hpp>
+#include <llfs/shared_page_buffer_cache.hpp>
 
 #include <batteries/assert.hpp>
 #include <batteries/math.hpp>
 
 #include <array>
+#include <memory>
+#include <unordered_map>
 
 namespace llfs {
 
@@ -41,8 +46,97 @@ class PageCacheOptions
     return *this;
   }
 
+  // Dedicates the PageArena with the given device id to pages of the given expected lifetime.  New
+  // pages are allocated from arenas whose lifetime matches the hint passed to
+  // `PageCacheJob::new_page`, falling back to other arenas of the same page size only when no
+  // matching arena has free space.
+  //
+  // The lifetime is also passed to the arena's PageDevice as a write hint, but IoRing page devices
+  // only apply it if the device is alone in its storage file, since the kernel tracks hints per
+  // file.  In the standard layout, each page device shares its file with its allocator log, so
+  // there the device hint is a no-op, and only the arena selection takes effect.
+  //
+  PageCacheOptions& set_device_write_lifetime(page_device_id_int device_id,
+                                              PageWriteLifetime lifetime)
+  {
+    this->write_lifetime_by_device_id[device_id] = lifetime;
+    return *this;
+  }
+
+  // Enables online miss ratio curve estimation for each page size, sampling approximately
+  // `sample_rate` of all page ids referenced via `PageCache::get`.  Pass 0 to disable.
+  //
+  PageCacheOptions& set_miss_ratio_curve_sample_rate(double sample_rate)
+  {
+    BATT_CHECK_GE(sample_rate, 0.0);
+    BATT_CHECK_LE(sample_rate, 1.0);
+    this->miss_ratio_curve_sample_rate = sample_rate;
+    return *this;
+  }
+
+  // Moves page decoding (running the layout's PageReader) off the thread that completes each page
+  // read, which for IoRing-based devices is the ring's completion thread.  When `n` is non-zero, a
+  // read only hands the raw PageBuffer to a pool of `n` PageCache tasks, which decode it and wake
+  // any waiters; pass 0 (the default) to decode inline on the completion thread.
+  //
+  PageCacheOptions& set_page_decode_task_count(usize n)
+  {
+    this->page_decode_task_count = n;
+    return *this;
+  }
+
+  // Enables a small per-thread, direct-mapped cache of recently pinned pages, consulted by
+  // `PageCache::get` before the shared cache index.  A hit costs an uncontended per-thread mutex
+  // and an atomic increment of the page's pin count; it skips the index and LRU locks entirely.
+  // Each entry keeps its page pinned until it is replaced, the page is purged and looked up again,
+  // or the PageCache is destroyed; so each thread that calls `get` keeps up to `n` pages from being
+  // evicted, and `n` times the number of such threads should be small compared to the cache size.
+  // `n` (the number of entries per thread) is rounded up to a power of 2; pass 0 (the default) to
+  // disable.
+  //
+  PageCacheOptions& set_thread_local_cache_size(usize n)
+  {
+    this->thread_local_cache_size = (n == 0) ? 0 : (usize{1} << batt::log2_ceil(n));
+    return *this;
+  }
+
+  // Shares raw page data for pages of `cache->page_size()` with other processes through `cache`.
+  // On a miss, the PageCache looks for the page there before reading it from the device, and pages
+  // that it does read from the device are published there.
+  //
+  PageCacheOptions& set_shared_page_buffer_cache(std::shared_ptr<SharedPageBufferCache> cache)
+  {
+    const int page_size_log2 = batt::log2_ceil(cache->page_size());
+    BATT_CHECK_LT(page_size_log2, kMaxPageSizeLog2);
+    this->shared_page_buffers_per_size_log2[page_size_log2] = std::move(cache);
+    return *this;
+  }
+
+  // Enables a second-level cache holding up to `max_bytes` of compressed data for pages evicted
+  // from the PageCache (see CompressedPageCache); this budget is separate from (and in addition to)
+  // the memory used by the pages cached in decoded form.  Pass 0 (the default) to disable.
+  //
+  PageCacheOptions& set_compressed_page_cache_size(u64 max_bytes)
+  {
+    this->compressed_page_cache_size = max_bytes;
+    return *this;
+  }
+
   std::array<usize, kMaxPageSizeLog2> max_cached_pages_per_size_log2;
 
+  double miss_ratio_curve_sample_rate;
+
+  usize page_decode_task_count;
+
+  usize thread_local_cache_size;
+
+  std::array<std::shared_ptr<SharedPageBufferCache>, kMaxPageSizeLog2>
+      shared_page_buffers_per_size_log2;
+
+  u64 compressed_page_cache_size;
+
+  std::unordered_map<page_device_id_int, PageWriteLifetime> write_lifetime_by_device_id;
+
  private:
   u64 default_log_size_;
 };
@@ -17,6 +17,8 @@
 
 #include <batteries/async/grant.hpp>
 
+#include <unordered_map>
+
 namespace llfs {
 
 class PageRecycler;
@@ -37,6 +39,27 @@ class PageDeleter
                               slot_offset_type caller_slot, batt::Grant& recycle_grant,
                               i32 recycle_depth) = 0;
 
+  // Called by the PageRecycler to indicate that the given pages will probably be passed to
+  // `delete_pages` soon; implementations may use this to start loading the pages in the background
+  // so that reads overlap with the commit of the current batch.
+  //
+  virtual void prefetch_pages(const Slice<const PageId>& page_ids)
+  {
+    (void)page_ids;
+  }
+
+  // Called by the PageRecycler to find out how many refs to other pages each of `page_ids` holds,
+  // so that pages with few refs can be deleted in larger batches (see
+  // `PageRecyclerOptions::max_batch_size`).  Implementations may leave out any page; the recycler
+  // assumes that those hold the maximum number of refs.
+  //
+  virtual std::unordered_map<PageId, usize, PageId::Hash> count_page_refs(
+      const Slice<const PageId>& page_ids)
+  {
+    (void)page_ids;
+    return {};
+  }
+
   // Called to indicate that the PageRecycler identified by `caller_uuid` has drained its backlog of
   // pages to recycle.
   //
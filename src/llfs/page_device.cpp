@@ -22,4 +22,33 @@ auto PageDevice::await_read(PageId id) -> ReadResult
   });
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void PageDevice::read_range(PageId id, const Interval<u64>& byte_range,
+                            ReadRangeHandler&& handler)
+{
+  Status range_status = check_page_range(this->page_size(), byte_range);
+  if (!range_status.ok()) {
+    handler(range_status);
+    return;
+  }
+
+  this->read(id, [byte_range, handler = std::move(handler)](ReadResult result) mutable {
+    if (!result.ok()) {
+      handler(result.status());
+      return;
+    }
+    handler(copy_page_range(**result, byte_range));
+  });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+auto PageDevice::await_read_range(PageId id, const Interval<u64>& byte_range) -> ReadRangeResult
+{
+  return batt::Task::await<ReadRangeResult>([id, &byte_range, this](auto&& handler) {
+    this->read_range(id, byte_range, BATT_FORWARD(handler));
+  });
+}
+
 }  // namespace llfs
@@ -13,7 +13,10 @@
 #include <llfs/page_buffer.hpp>
 #include <llfs/page_id.hpp>
 #include <llfs/page_id_factory.hpp>
+#include <llfs/interval.hpp>
+#include <llfs/page_range_buffer.hpp>
 #include <llfs/page_size.hpp>
+#include <llfs/page_write_lifetime.hpp>
 #include <llfs/status.hpp>
 
 #include <llfs/logging.hpp>
@@ -32,9 +35,11 @@ class PageDevice
  public:
   using WriteResult = Status;
   using ReadResult = StatusOr<std::shared_ptr<const PageBuffer>>;
+  using ReadRangeResult = StatusOr<std::shared_ptr<const PageRangeBuffer>>;
 
   using WriteHandler = std::function<void(WriteResult)>;
   using ReadHandler = std::function<void(ReadResult)>;
+  using ReadRangeHandler = std::function<void(ReadRangeResult)>;
 
   PageDevice(const PageDevice&) = delete;
   PageDevice& operator=(const PageDevice&) = delete;
@@ -45,6 +50,18 @@ class PageDevice
 
   virtual PageSize page_size() = 0;
 
+  // (Optional API) Tell the device the expected lifetime of the data written to it, so that it can
+  // group writes with similar lifetimes on the physical media.  Implementations must not let the
+  // hint affect writes to other devices or logs that share the same storage.
+  //
+  // Returns `batt::OkStatus` on success, error status otherwise (`batt::StatusCode::kUnimplemented`
+  // if not supported by this implementation, which is the default).
+  //
+  virtual Status set_write_lifetime(PageWriteLifetime /*lifetime*/)
+  {
+    return batt::StatusCode::kUnimplemented;
+  }
+
   // For convenience...
   //
   PageCount capacity()
@@ -81,6 +98,20 @@ class PageDevice
   //
   ReadResult await_read(PageId id);
 
+  // (Optional API) Read only the bytes of the page at offsets `byte_range` (relative to the start
+  // of the page, header included).  The device may read more than requested, e.g. to round out to
+  // its I/O block size; the `range()` of the returned buffer always contains `byte_range`.  The
+  // page header is checked against `id` just as it is by `read`.
+  //
+  // The default implementation reads the whole page and copies out the requested range, so this is
+  // supported by all devices; implementations that can transfer less data should override it.
+  //
+  virtual void read_range(PageId id, const Interval<u64>& byte_range, ReadRangeHandler&& handler);
+
+  // Convenience; shortcut for Task::await(...)
+  //
+  ReadRangeResult await_read_range(PageId id, const Interval<u64>& byte_range);
+
   //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
   // Delete phase
   //
@@ -10,8 +10,11 @@
 //
 
 #include <llfs/config.hpp>
+#include <llfs/ioring_page_device_initializer.hpp>
 #include <llfs/ioring_page_file_device.hpp>
+#include <llfs/mmap_page_file_device.hpp>
 #include <llfs/page_layout.hpp>
+#include <llfs/seq.hpp>
 
 #include <batteries/stream_util.hpp>
 
@@ -60,21 +63,9 @@ Status configure_storage_object(StorageFileBuilder::Transaction& txn,
     if (!kFastIoRingPageDeviceInit) {
       // Initialize all the packed page headers.
       //
-      std::aligned_storage_t<512, 512> buffer;
-      std::memset(&buffer, 0, sizeof(buffer));
-
-      auto& page_header = reinterpret_cast<PackedPageHeader&>(buffer);
-      page_header.magic = PackedPageHeader::kMagic;
-      page_header.crc32 = PackedPageHeader::kCrc32NotSet;
-      page_header.page_id = PackedPageId{.id_val = kInvalidPageId};
-
-      for (u64 page_i = 0; page_i < page_count; ++page_i) {
-        const i64 page_offset = pages_offset.lower_bound + page_i * page_size;
-        LLFS_DVLOG(1) << "writing null page header | " << BATT_INSPECT(page_i)
-                      << BATT_INSPECT(page_offset);
-        Status status = write_all(file, page_offset, ConstBuffer{&buffer, sizeof(buffer)});
-        BATT_REQUIRE_OK(status);
-      }
+      Status init_status =
+          initialize_page_device_headers(file, pages_offset.lower_bound, page_size, page_count);
+      BATT_REQUIRE_OK(init_status);
     }
 
     return OkStatus();
@@ -86,14 +77,34 @@ Status configure_storage_object(StorageFileBuilder::Transaction& txn,
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<std::unique_ptr<PageDevice>> recover_storage_object(
-    const batt::SharedPtr<StorageContext>& /*storage_context*/, const std::string& file_name,
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string& file_name,
     const FileOffsetPtr<const PackedPageDeviceConfig&>& p_config,
     const IoRingFileRuntimeOptions& file_options)
 {
   StatusOr<IoRing::File> file = open_ioring_file(file_name, file_options);
   BATT_REQUIRE_OK(file);
 
-  return std::make_unique<IoRingPageFileDevice>(std::move(*file), p_config);
+  // Per-file settings (such as write-life hints) may only be changed by the device if nothing else
+  // is stored in the same file.
+  //
+  const bool exclusive_file =
+      (storage_context->find_objects_by_file_name(file_name) | seq::count()) == 1;
+
+  return std::make_unique<IoRingPageFileDevice>(std::move(*file), p_config, exclusive_file);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::unique_ptr<PageDevice>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& /*storage_context*/, const std::string& file_name,
+    const FileOffsetPtr<const PackedPageDeviceConfig&>& p_config,
+    const MmapPageFileDeviceOptions& mmap_options)
+{
+  StatusOr<std::unique_ptr<MmapPageFileDevice>> device =
+      MmapPageFileDevice::open(file_name, p_config, mmap_options);
+  BATT_REQUIRE_OK(device);
+
+  return std::unique_ptr<PageDevice>{std::move(*device)};
 }
 
 }  // namespace llfs
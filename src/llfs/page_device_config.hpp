@@ -30,6 +30,7 @@
 namespace llfs {
 
 class PageDevice;
+struct MmapPageFileDeviceOptions;
 struct PackedPageDeviceConfig;
 struct PageDeviceConfigOptions;
 
@@ -48,6 +49,13 @@ StatusOr<std::unique_ptr<PageDevice>> recover_storage_object(
 
 #endif  // LLFS_DISABLE_IO_URING
 
+// Recovers the page device as a read-only MmapPageFileDevice.
+//
+StatusOr<std::unique_ptr<PageDevice>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string& file_name,
+    const FileOffsetPtr<const PackedPageDeviceConfig&>& p_config,
+    const MmapPageFileDeviceOptions& mmap_options);
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
 struct PageDeviceConfigOptions {
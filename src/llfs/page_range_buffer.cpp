@@ -0,0 +1,85 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/page_range_buffer.hpp>
+//
+
+#include <batteries/assert.hpp>
+
+#include <cstring>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ PageRangeBuffer::PageRangeBuffer(const Interval<u64>& range) noexcept
+    : range_{range}
+    , blocks_{new Block[(range.size() + sizeof(Block) - 1) / sizeof(Block)]}
+{
+  BATT_CHECK_LE(range.lower_bound, range.upper_bound);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+ConstBuffer PageRangeBuffer::const_buffer() const
+{
+  return ConstBuffer{this->blocks_.get(), this->range_.size()};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+MutableBuffer PageRangeBuffer::mutable_buffer()
+{
+  return MutableBuffer{this->blocks_.get(), this->range_.size()};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+ConstBuffer PageRangeBuffer::get(const Interval<u64>& byte_range) const
+{
+  BATT_CHECK(this->contains(byte_range))
+      << BATT_INSPECT(this->range_) << BATT_INSPECT(byte_range);
+
+  return ConstBuffer{reinterpret_cast<const u8*>(this->blocks_.get()) +
+                         (byte_range.lower_bound - this->range_.lower_bound),
+                     byte_range.size()};
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status check_page_range(PageSize page_size, const Interval<u64>& byte_range)
+{
+  if (byte_range.lower_bound >= byte_range.upper_bound) {
+    return batt::StatusCode::kInvalidArgument;
+  }
+  if (byte_range.upper_bound > page_size) {
+    return batt::StatusCode::kOutOfRange;
+  }
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::shared_ptr<PageRangeBuffer> copy_page_range(const PageBuffer& page,
+                                                 const Interval<u64>& byte_range)
+{
+  BATT_CHECK_LE(byte_range.upper_bound, page.size());
+
+  auto range_buffer = std::make_shared<PageRangeBuffer>(byte_range);
+
+  *range_buffer->mutable_header() = get_page_header(page);
+  std::memcpy(range_buffer->mutable_buffer().data(),
+              static_cast<const u8*>(page.const_buffer().data()) + byte_range.lower_bound,
+              byte_range.size());
+
+  return range_buffer;
+}
+
+}  // namespace llfs
@@ -0,0 +1,108 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_PAGE_RANGE_BUFFER_HPP
+#define LLFS_PAGE_RANGE_BUFFER_HPP
+
+#include <llfs/buffer.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/interval.hpp>
+#include <llfs/packed_page_header.hpp>
+#include <llfs/page_buffer.hpp>
+#include <llfs/page_id.hpp>
+#include <llfs/page_size.hpp>
+#include <llfs/status.hpp>
+
+#include <memory>
+
+namespace llfs {
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// A contiguous byte range of a page, plus a copy of that page's header.  This is what
+// `PageDevice::read_range` produces.
+//
+// Byte offsets are always relative to the start of the page (i.e., the header is at [0, 64)).  The
+// data is stored in `PageBuffer::Block`s, so it is suitably aligned for direct I/O.
+//
+class PageRangeBuffer
+{
+ public:
+  using Block = PageBuffer::Block;
+
+  // Allocates an (uninitialized) buffer for the bytes of a page in `range`.
+  //
+  explicit PageRangeBuffer(const Interval<u64>& range) noexcept;
+
+  PageRangeBuffer(const PageRangeBuffer&) = delete;
+  PageRangeBuffer& operator=(const PageRangeBuffer&) = delete;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The header of the page this range came from.
+  //
+  const PackedPageHeader& header() const
+  {
+    return this->header_;
+  }
+
+  PackedPageHeader* mutable_header()
+  {
+    return &this->header_;
+  }
+
+  PageId page_id() const
+  {
+    return this->header_.page_id.as_page_id();
+  }
+
+  // The byte offsets (within the page) of the data held by this buffer.
+  //
+  const Interval<u64>& range() const
+  {
+    return this->range_;
+  }
+
+  // Returns true iff all of `byte_range` is held by this buffer.
+  //
+  bool contains(const Interval<u64>& byte_range) const
+  {
+    return this->range_.lower_bound <= byte_range.lower_bound &&
+           byte_range.upper_bound <= this->range_.upper_bound;
+  }
+
+  // Returns all the data held by this buffer; the first byte is at page offset
+  // `this->range().lower_bound`.
+  //
+  ConstBuffer const_buffer() const;
+
+  MutableBuffer mutable_buffer();
+
+  // Returns the bytes at page offsets `byte_range`, which must be contained by this buffer.
+  //
+  ConstBuffer get(const Interval<u64>& byte_range) const;
+
+ private:
+  PackedPageHeader header_{};
+  Interval<u64> range_;
+  std::unique_ptr<Block[]> blocks_;
+};
+
+// Returns OkStatus iff `byte_range` is a non-empty range of offsets within a page of size
+// `page_size`.
+//
+Status check_page_range(PageSize page_size, const Interval<u64>& byte_range);
+
+// Returns a new PageRangeBuffer holding a copy of `page`'s header and the bytes in `byte_range`.
+//
+std::shared_ptr<PageRangeBuffer> copy_page_range(const PageBuffer& page,
+                                                 const Interval<u64>& byte_range);
+
+}  // namespace llfs
+
+#endif  // LLFS_PAGE_RANGE_BUFFER_HPP
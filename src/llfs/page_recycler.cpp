@@ -21,6 +21,8 @@ BATT_SUPPRESS("-Wmaybe-uninitialized")
 #include <batteries/finally.hpp>
 #include <batteries/hint.hpp>
 
+#include <algorithm>
+#include <map>
 #include <unordered_map>
 
 namespace llfs {
@@ -205,6 +207,8 @@ PageRecycler::PageRecycler(batt::TaskScheduler& scheduler, const std::string& na
 
   ADD_METRIC_(insert_count);
   ADD_METRIC_(remove_count);
+  ADD_METRIC_(page_drop_ok_count);
+  ADD_METRIC_(page_drop_error_count);
 
 #undef ADD_METRIC_
 }
@@ -220,7 +224,9 @@ PageRecycler::~PageRecycler() noexcept
 
   global_metric_registry()  //
       .remove(this->metrics_.insert_count)
-      .remove(this->metrics_.remove_count);
+      .remove(this->metrics_.remove_count)
+      .remove(this->metrics_.page_drop_ok_count)
+      .remove(this->metrics_.page_drop_error_count);
 
   LLFS_VLOG(1) << "PageRecycler::~PageRecycler() RETURNING";
 }
@@ -241,6 +247,7 @@ void PageRecycler::halt()
 {
   if (!this->stop_requested_.exchange(true)) {
     this->state_.no_lock().pending_count.close();
+    this->caught_up_slot_.close();
     this->recycle_task_grant_.revoke();
     this->insert_grant_pool_.revoke();
     this->slot_writer_.halt();
@@ -286,9 +293,32 @@ StatusOr<slot_offset_type> PageRecycler::recycle_pages(const Slice<const PageId>
 
     const PageRecyclerOptions& options = this->state_.no_lock().options;
 
-    for (PageId page_id : page_ids) {
+    // The most pages we allow to be pending when an external insert starts: the buffered page count
+    // the log was sized for (see `calculate_log_size`), which also bounds the state arena.
+    //
+    const usize max_pending_inserts =
+        PageRecycler::calculate_max_buffered_page_count(
+            MaxRefsPerPage{options.max_refs_per_page}, this->slot_writer_.log_capacity()) +
+        1;
+
+    const usize max_chunk_size =
+        std::max<usize>(1, std::min(options.insert_batch_size, max_pending_inserts));
+
+    for (usize chunk_begin = 0; chunk_begin < page_ids.size(); chunk_begin += max_chunk_size) {
+      const Slice<const PageId> chunk = as_slice(
+          page_ids.begin() + chunk_begin, std::min(max_chunk_size, page_ids.size() - chunk_begin));
+
+      // Multi-page slots take less log space per page than single-page ones, so the grant alone no
+      // longer bounds the number of pending pages; wait for the recycle task to catch up instead.
+      //
+      StatusOr<usize> pending_count =
+          this->state_.no_lock().pending_count.await_true([&](usize count) {
+            return count + chunk.size() <= max_pending_inserts;
+          });
+      BATT_REQUIRE_OK(pending_count);
+
       StatusOr<batt::Grant> local_grant = [&] {
-        const usize needed_size = options.insert_grant_size();
+        const usize needed_size = options.insert_grant_size() * chunk.size();
 
         BATT_DEBUG_INFO("[PageRecycler::recycle_page] waiting for log space; "
                         << BATT_INSPECT(needed_size)
@@ -309,23 +339,28 @@ StatusOr<slot_offset_type> PageRecycler::recycle_pages(const Slice<const PageId>
       {
         auto locked_state = this->state_.lock();
         StatusOr<slot_offset_type> append_slot =
-            this->insert_to_log(*local_grant, page_id, depth, locked_state);
+            this->insert_batch_to_log(*local_grant, chunk, depth, locked_state);
         BATT_REQUIRE_OK(append_slot);
 
         clamp_min_slot(&sync_point, *append_slot);
       }
+
+      // Return whatever the batched slots didn't use.
+      //
+      this->insert_grant_pool_.subsume(std::move(*local_grant));
     }
   } else {
     BATT_CHECK_LT(depth, (i32)kMaxPageRefDepth) << BATT_INSPECT_RANGE(page_ids);
 
+    // These are the dead pages found while deleting a batch; write them using as few slots as
+    // possible, since a large batch of interior nodes can release many pages at once.
+    //
     auto locked_state = this->state_.lock();
-    for (PageId page_id : page_ids) {
-      StatusOr<slot_offset_type> append_slot =
-          this->insert_to_log(*grant, page_id, depth, locked_state);
-      BATT_REQUIRE_OK(append_slot);
+    StatusOr<slot_offset_type> append_slot =
+        this->insert_batch_to_log(*grant, page_ids, depth, locked_state);
+    BATT_REQUIRE_OK(append_slot);
 
-      clamp_min_slot(&sync_point, *append_slot);
-    }
+    clamp_min_slot(&sync_point, *append_slot);
   }
 
   BATT_CHECK(sync_point);
@@ -334,41 +369,88 @@ StatusOr<slot_offset_type> PageRecycler::recycle_pages(const Slice<const PageId>
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-StatusOr<slot_offset_type> PageRecycler::insert_to_log(
-    batt::Grant& grant, PageId page_id, i32 depth,
+StatusOr<slot_offset_type> PageRecycler::insert_batch_to_log(
+    batt::Grant& grant, const Slice<const PageId>& page_ids, i32 depth,
     batt::Mutex<std::unique_ptr<State>>::Lock& locked_state)
 {
   BATT_CHECK(locked_state.is_held());
 
-  // Update the state machine.
+  // Update the state machine.  Every record written below (new pages and refreshed ones alike)
+  // gets the same slot offset, just as the new and refreshed records for a single page would.
   //
   const slot_offset_type current_slot = this->slot_writer_.slot_offset();
-  batt::SmallVec<PageToRecycle, 2> to_append = (*locked_state)
-                                                   ->insert(PageToRecycle{
-                                                       .page_id = page_id,
-                                                       .slot_offset = current_slot,
-                                                       .depth = depth,
-                                                   });
-
-  // The update was not accepted (already pending); return success anyhow (repeat inserts are
-  // idempotent).
+
+  std::map<i32, std::vector<PageId>> to_append_by_depth;
+  usize insert_count = 0;
+
+  for (PageId page_id : page_ids) {
+    batt::SmallVec<PageToRecycle, 2> to_append = (*locked_state)
+                                                     ->insert(PageToRecycle{
+                                                         .page_id = page_id,
+                                                         .slot_offset = current_slot,
+                                                         .depth = depth,
+                                                     });
+    if (to_append.empty()) {
+      continue;
+    }
+    insert_count += 1;
+
+    for (const PageToRecycle& item : to_append) {
+      to_append_by_depth[item.depth].emplace_back(item.page_id);
+    }
+  }
+
+  // None of the updates were accepted (all already pending); return success anyhow (repeat inserts
+  // are idempotent).
   //
-  if (to_append.empty()) {
+  if (to_append_by_depth.empty()) {
     return current_slot;
   }
 
-  // Write the slots.
+  // Write the slots.  A page may have been refreshed more than once (or inserted and then
+  // refreshed) within this batch; one record per page is enough.
   //
   slot_offset_type last_slot = current_slot;
-  for (const PageToRecycle& item : to_append) {
-    StatusOr<SlotRange> append_slot = this->slot_writer_.append(grant, item);
-    BATT_REQUIRE_OK(append_slot);
-    last_slot = slot_max(last_slot, append_slot->upper_bound);
-    LLFS_VLOG(1) << "Write " << item << " to the log; last_slot=" << last_slot;
+  for (auto& [item_depth, item_page_ids] : to_append_by_depth) {
+    std::sort(item_page_ids.begin(), item_page_ids.end());
+    item_page_ids.erase(std::unique(item_page_ids.begin(), item_page_ids.end()),
+                        item_page_ids.end());
+
+    PagesToRecycle batch{
+        .page_ids = std::move(item_page_ids),
+        .slot_offset = current_slot,
+        .depth = item_depth,
+    };
+
+    // Fall back to single-page slots if they are smaller (e.g., for a lone refresh at some other
+    // depth); this keeps the total at or below what `insert_grant_size()` reserves per page.
+    //
+    const usize batch_slot_size = packed_sizeof_slot(batch);
+    const usize single_slots_size =
+        packed_sizeof_slot(batt::StaticType<PackedRecyclePageInserted>{}) * batch.page_ids.size();
+
+    if (batch_slot_size <= single_slots_size) {
+      StatusOr<SlotRange> append_slot = this->slot_writer_.append(grant, batch);
+      BATT_REQUIRE_OK(append_slot);
+      last_slot = slot_max(last_slot, append_slot->upper_bound);
+      LLFS_VLOG(1) << "Write " << batch << " to the log; last_slot=" << last_slot;
+    } else {
+      for (PageId page_id : batch.page_ids) {
+        const PageToRecycle item{
+            .page_id = page_id,
+            .slot_offset = current_slot,
+            .depth = item_depth,
+        };
+        StatusOr<SlotRange> append_slot = this->slot_writer_.append(grant, item);
+        BATT_REQUIRE_OK(append_slot);
+        last_slot = slot_max(last_slot, append_slot->upper_bound);
+        LLFS_VLOG(1) << "Write " << item << " to the log; last_slot=" << last_slot;
+      }
+    }
   }
   BATT_CHECK_NE(this->slot_writer_.slot_offset(), current_slot);
 
-  this->metrics_.insert_count.fetch_add(1);
+  this->metrics_.insert_count.fetch_add(insert_count);
 
   return last_slot;
 }
@@ -384,6 +466,32 @@ Status PageRecycler::await_flush(Optional<slot_offset_type> min_upper_bound)
                                  SlotUpperBoundAt{.offset = *min_upper_bound});
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<u64> PageRecycler::drop_page_trees(const Slice<const PageId>& root_ids)
+{
+  const u64 initial_drop_count = this->metrics_.page_drop_ok_count.load();
+
+  StatusOr<slot_offset_type> sync_point = this->recycle_pages(root_ids);
+  BATT_REQUIRE_OK(sync_point);
+
+  // The recycle task publishes the log upper bound each time it runs out of pending pages; once
+  // that passes the slots we just wrote, all pages reachable from `root_ids` have been deleted.
+  //
+  StatusOr<slot_offset_type> caught_up_slot =
+      this->caught_up_slot_.await_true([&](slot_offset_type observed) {
+        return !slot_less_than(observed, *sync_point);
+      });
+  BATT_REQUIRE_OK(caught_up_slot);
+
+  const u64 drop_count = this->metrics_.page_drop_ok_count.load() - initial_drop_count;
+
+  LLFS_VLOG(1) << "PageRecycler::drop_page_trees(root_ids=" << batt::dump_range(root_ids)
+               << ") done; " << BATT_INSPECT(drop_count) << " " << this->name_;
+
+  return drop_count;
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 void PageRecycler::start_recycle_task()
@@ -468,6 +576,7 @@ void PageRecycler::recycle_task_main()
     this->slot_writer_.halt();
     this->recycle_task_grant_.revoke();
     this->insert_grant_pool_.revoke();
+    this->caught_up_slot_.close();
   });
 
   this->recycle_task_status_ = [this]() -> Status {
@@ -496,8 +605,15 @@ void PageRecycler::recycle_task_main()
                         << BATT_INSPECT(this->wal_device_->slot_range(LogReadMode::kSpeculative))
                         << BATT_INSPECT(this->wal_device_->slot_range(LogReadMode::kDurable)));
 
+        // Read the upper bound *before* the pending count: pages are counted as pending before
+        // their slots are appended, so if the count is zero, everything below this offset is done.
+        //
+        const slot_offset_type observed_upper_bound =
+            this->slot_upper_bound(LogReadMode::kSpeculative);
+
         const usize observed_pending_count = this->state_.no_lock().pending_count.get_value();
         if (observed_pending_count == 0) {
+          this->caught_up_slot_.set_value(observed_upper_bound);
           this->page_deleter_.notify_caught_up(*this,
                                                this->slot_upper_bound(LogReadMode::kSpeculative));
 
@@ -506,11 +622,32 @@ void PageRecycler::recycle_task_main()
         }
       }
 
+      // Peek at the pages we will most likely recycle next (in order): up to `max_batch_size`
+      // candidates for this batch, then `read_ahead_page_count` more.  Start loading all of them,
+      // so that when walking a large tree the device is kept busy while this batch is prepared and
+      // committed.
+      //
+      const usize max_batch_size = std::max(options.batch_size, options.max_batch_size);
+
+      const std::vector<PageId> next_page_ids = this->state_.lock()->get()->peek_pending(
+          max_batch_size + options.read_ahead_page_count);
+
+      if (!next_page_ids.empty()) {
+        this->page_deleter_.prefetch_pages(as_slice(next_page_ids));
+      }
+
+      // Find out how many refs the candidates hold so that pages with few refs (e.g., leaves) can
+      // share a batch; this is what lets us make fewer, larger ref count updates.
+      //
+      const std::unordered_map<PageId, usize, PageId::Hash> ref_counts =
+          this->page_deleter_.count_page_refs(
+              as_slice(next_page_ids.data(), std::min(next_page_ids.size(), max_batch_size)));
+
       // De-queue the next page.  Block for the first page, then pull as many as we can after that
       // from the same depth.
       //
       std::vector<PageToRecycle> to_recycle =
-          this->state_.lock()->get()->collect_batch(options.batch_size, this->metrics_);
+          this->state_.lock()->get()->collect_batch(max_batch_size, this->metrics_, ref_counts);
 
       // We must write a PackedRecyclePagePrepare event to the WAL in case we need to recover from
       // a crash.
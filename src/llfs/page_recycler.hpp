@@ -22,6 +22,7 @@
 #include <batteries/async/mutex.hpp>
 #include <batteries/async/task.hpp>
 #include <batteries/async/task_scheduler.hpp>
+#include <batteries/async/watch.hpp>
 #include <batteries/metrics/metric_collectors.hpp>
 #include <batteries/small_vec.hpp>
 
@@ -31,6 +32,7 @@
 
 #include <array>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace llfs {
@@ -106,6 +108,14 @@ class PageRecycler
   //
   Status await_flush(Optional<slot_offset_type> min_upper_bound);
 
+  // Recycles the page trees rooted at `root_ids` (as `recycle_pages` does) and blocks until the
+  // recycler has caught up, i.e. every page in those trees that became dead has been deleted.  Use
+  // this to drop a whole table or snapshot; the recycler reads pages ahead along the depth-first
+  // walk and deletes pages with few refs (e.g., leaves) in large batches.  Returns the number of
+  // pages the recycler deleted during the call (including any scheduled concurrently by others).
+  //
+  StatusOr<u64> drop_page_trees(const Slice<const PageId>& root_ids);
+
   slot_offset_type slot_upper_bound(LogReadMode mode) const
   {
     return this->wal_device_->slot_range(mode).upper_bound;
@@ -230,7 +240,19 @@ class PageRecycler
       return this->arena_size_;
     }
 
-    std::vector<PageToRecycle> collect_batch(usize max_page_count, Metrics& metrics);
+    // Removes up to `max_page_count` pages from the highest non-empty depth, for as long as the log
+    // space they need fits in `options.total_grant_size_for_depth(depth)`.  Pages not found in
+    // `ref_counts` are assumed to hold `options.max_refs_per_page` refs, so at most
+    // `options.batch_size` of those are taken at once.
+    //
+    std::vector<PageToRecycle> collect_batch(
+        usize max_page_count, Metrics& metrics,
+        const std::unordered_map<PageId, usize, PageId::Hash>& ref_counts = {});
+
+    // Returns up to `max_page_count` pending page ids, in the order they will be removed by
+    // `collect_batch` (assuming no new pages are inserted in the meantime).
+    //
+    std::vector<PageId> peek_pending(usize max_page_count) const;
 
    private:
     WorkItem& new_work_item(const PageToRecycle& p);
@@ -279,8 +301,12 @@ class PageRecycler
   //
   void refresh_grants();
 
-  StatusOr<slot_offset_type> insert_to_log(batt::Grant& grant, PageId page_id, i32 depth,
-                                           batt::Mutex<std::unique_ptr<State>>::Lock& locked_state);
+  // Inserts all of `page_ids` into the state machine and writes the resulting records using as few
+  // slots as possible (one PagesToRecycle slot per depth, unless single-page slots are smaller).
+  //
+  StatusOr<slot_offset_type> insert_batch_to_log(
+      batt::Grant& grant, const Slice<const PageId>& page_ids, i32 depth,
+      batt::Mutex<std::unique_ptr<State>>::Lock& locked_state);
 
   StatusOr<Batch> prepare_batch(std::vector<PageToRecycle>&& to_recycle);
 
@@ -317,6 +343,11 @@ class PageRecycler
   Optional<Batch> prepared_batch_;
 
   Optional<slot_offset_type> latest_batch_upper_bound_;
+
+  // The log upper bound as of the last time the recycle task ran out of pending pages; every page
+  // inserted below this offset has been deleted.
+  //
+  batt::Watch<slot_offset_type> caught_up_slot_{0};
 };
 
 inline std::ostream& operator<<(std::ostream& out, const PageRecycler::Batch& t)
@@ -19,6 +19,7 @@
 #include <batteries/async/runtime.hpp>
 #include <batteries/stream_util.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <random>
 #include <unordered_map>
@@ -263,10 +264,32 @@ class FakePageDeleter : public PageDeleter
       LLFS_VLOG(1) << "deleting " << fake_page << " at recycler slot " << caller_slot;
       fake_page.deleted = true;
     }
+    this->max_batch_size_ = std::max(this->max_batch_size_, to_delete.size());
 
     return OkStatus();
   }
 
+  void prefetch_pages(const Slice<const PageId>& page_ids) override
+  {
+    // Only pages that are waiting to be recycled should be read ahead.
+    //
+    for (PageId page_id : page_ids) {
+      FakePage& fake_page = *this->test_->fake_pages_[page_id];
+      BATT_CHECK_EQ(fake_page.in_ref_count, 0) << BATT_INSPECT(fake_page);
+    }
+    this->prefetch_count_ += page_ids.size();
+  }
+
+  std::unordered_map<PageId, usize, PageId::Hash> count_page_refs(
+      const Slice<const PageId>& page_ids) override
+  {
+    std::unordered_map<PageId, usize, PageId::Hash> ref_counts;
+    for (PageId page_id : page_ids) {
+      ref_counts.emplace(page_id, this->test_->fake_pages_[page_id]->out_refs.size());
+    }
+    return ref_counts;
+  }
+
   void notify_caught_up(PageRecycler& recycler, slot_offset_type slot) override
   {
     LLFS_VLOG(1) << "CAUGHT UP ==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -";
@@ -292,6 +315,8 @@ class FakePageDeleter : public PageDeleter
   std::unordered_map<boost::uuids::uuid, slot_offset_type, boost::hash<boost::uuids::uuid>>
       current_slot_;
   batt::Queue<StatusOr<slot_offset_type>> recursive_recycle_events_;
+  usize prefetch_count_ = 0;
+  usize max_batch_size_ = 0;
 };
 
 TEST_F(PageRecyclerTest, CrashRecovery)
@@ -309,11 +334,180 @@ TEST_F(PageRecyclerTest, CrashRecovery)
   task.join();
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// The pages read ahead by the recycler task must be the ones it will recycle next.
+//
+TEST(PageRecyclerStateTest, PeekPendingMatchesRemoveOrder)
+{
+  const llfs::PageRecyclerOptions options;
+
+  PageRecycler::State state{llfs::random_uuid(), /*latest_info_refresh_slot=*/0, options,
+                            /*wal_capacity=*/options.total_page_grant_size() * 64,
+                            llfs::SlotRange{0, 0}};
+
+  slot_offset_type slot = 0;
+  const auto insert = [&](u64 page_id, i32 depth) {
+    (void)state.insert(PageToRecycle{
+        .page_id = PageId{page_id},
+        .slot_offset = slot,
+        .depth = depth,
+    });
+    slot += 64;
+  };
+
+  for (u64 page_id : {1, 2, 3, 4, 5}) {
+    insert(page_id, 0);
+  }
+  for (u64 page_id : {10, 11, 12}) {
+    insert(page_id, 1);
+  }
+  insert(20, 2);
+  insert(6, 0);
+
+  const std::vector<PageId> peeked = state.peek_pending(/*max_page_count=*/100);
+  EXPECT_EQ(peeked.size(), 10u);
+  EXPECT_THAT(state.peek_pending(/*max_page_count=*/4),
+              ::testing::ElementsAreArray(peeked.begin(), peeked.begin() + 4));
+
+  PageRecycler::Metrics metrics;
+  std::vector<PageId> removed;
+  while (state.pending_count.get_value() > 0) {
+    for (const PageToRecycle& p : state.collect_batch(/*max_page_count=*/3, metrics)) {
+      removed.emplace_back(p.page_id);
+    }
+  }
+
+  EXPECT_THAT(removed, ::testing::ElementsAreArray(peeked));
+  EXPECT_EQ(state.peek_pending(/*max_page_count=*/100).size(), 0u);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Pages whose ref counts are known take only the log space they need, so more than `batch_size` of
+// them fit in a batch; pages with unknown ref counts are limited to `batch_size`.
+//
+TEST(PageRecyclerStateTest, CollectBatchUsesRefCounts)
+{
+  llfs::PageRecyclerOptions options;
+  options.max_refs_per_page = 8;
+
+  PageRecycler::State state{llfs::random_uuid(), /*latest_info_refresh_slot=*/0, options,
+                            /*wal_capacity=*/options.total_page_grant_size() * 1024,
+                            llfs::SlotRange{0, 0}};
+
+  std::unordered_map<PageId, usize, PageId::Hash> ref_counts;
+  for (u64 page_id = 1; page_id <= 200; ++page_id) {
+    (void)state.insert(PageToRecycle{
+        .page_id = PageId{page_id},
+        .slot_offset = page_id * 64,
+        .depth = 0,
+    });
+    if (page_id > 100) {
+      ref_counts.emplace(PageId{page_id}, 0);
+    }
+  }
+
+  PageRecycler::Metrics metrics;
+
+  // The most recently inserted pages come out first; these are the leaves (no refs), so the batch
+  // is limited only by `max_page_count`.
+  //
+  EXPECT_EQ(state.collect_batch(/*max_page_count=*/64, metrics, ref_counts).size(), 64u);
+
+  // Taking the remaining 36 leaves uses up a little of the budget, so one page fewer than
+  // `batch_size` pages with the maximum ref count fit after them.
+  //
+  EXPECT_EQ(state.collect_batch(/*max_page_count=*/512, metrics, ref_counts).size(),
+            36u + options.batch_size - 1);
+
+  // Without ref counts, every page is assumed to hold the maximum number of refs.
+  //
+  EXPECT_EQ(state.collect_batch(/*max_page_count=*/512, metrics).size(), options.batch_size);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Drop a tree that is too big for one batch with `drop_page_trees`; it must return only once every
+// page has been deleted, and the leaves must have been deleted in batches larger than `batch_size`.
+//
+TEST_F(PageRecyclerTest, DropPageTrees)
+{
+  const usize fan_out = 8;
+  const usize max_refs_per_page = 64;
+
+  // Build a tree of height 3: root -> 64 nodes -> 8 leaves each.
+  //
+  this->fake_pages_.clear();
+  u64 next_page_id = 0;
+  const auto new_page = [&]() -> FakePage& {
+    auto fake_page = std::make_unique<FakePage>();
+    fake_page->page_id = PageId{next_page_id++};
+    FakePage& result = *fake_page;
+    this->fake_pages_.emplace(result.page_id, std::move(fake_page));
+    return result;
+  };
+
+  FakePage& root = new_page();
+  for (usize i = 0; i < max_refs_per_page; ++i) {
+    FakePage& node = new_page();
+    for (usize j = 0; j < fan_out; ++j) {
+      FakePage& leaf = new_page();
+      leaf.in_ref_count = 1;
+      node.out_refs.emplace_back(leaf.page_id);
+    }
+    node.in_ref_count = 1;
+    node.max_ref_depth = 1;
+    root.out_refs.emplace_back(node.page_id);
+  }
+  root.max_ref_depth = 2;
+
+  boost::asio::io_context io;
+
+  batt::Task task{
+      io.get_executor(),
+      [&] {
+        llfs::MemoryLogDeviceFactory log_factory{
+            PageRecycler::calculate_log_size(MaxRefsPerPage{max_refs_per_page})};
+
+        FakePageDeleter fake_deleter{this};
+
+        StatusOr<std::unique_ptr<PageRecycler>> recycler = PageRecycler::recover(
+            batt::Runtime::instance().default_scheduler(), "DropPageTrees",
+            MaxRefsPerPage{max_refs_per_page}, fake_deleter, log_factory);
+
+        ASSERT_TRUE(recycler.ok()) << BATT_INSPECT(recycler.status());
+
+        this->recycler_ = recycler->get();
+        fake_deleter.current_slot_[(*recycler)->uuid()] = 0;
+
+        (*recycler)->start();
+
+        StatusOr<u64> drop_count = (*recycler)->drop_page_trees(as_slice(&root.page_id, 1));
+
+        ASSERT_TRUE(drop_count.ok()) << BATT_INSPECT(drop_count.status());
+        EXPECT_EQ(*drop_count, this->fake_pages_.size());
+
+        for (const auto& [page_id, p_fake_page] : this->fake_pages_) {
+          EXPECT_TRUE(p_fake_page->deleted) << BATT_INSPECT(*p_fake_page);
+        }
+        EXPECT_GT(fake_deleter.max_batch_size_, llfs::PageRecyclerOptions{}.batch_size);
+
+        (*recycler)->halt();
+        (*recycler)->join();
+        this->recycler_ = nullptr;
+      },
+      "PageRecyclerTest_DropPageTrees"};
+
+  ASSERT_NO_FATAL_FAILURE(io.run());
+
+  task.join();
+}
+
 void PageRecyclerTest::run_crash_recovery_test()
 {
   const usize fake_page_count = 256;
   const u32 max_branching_factor = 8;
 
+  usize total_prefetch_count = 0;
+
   for (u64 seed = 0; seed < 10000; ++seed) {
     std::default_random_engine rng{seed};
     for (usize i = 0; i < 10; ++i) {
@@ -368,10 +562,15 @@ void PageRecyclerTest::run_crash_recovery_test()
     usize progress = 0;
 
     //+++++++++++-+-+--+----- --- -- -  -  -   -
+    // Odd seeds insert several roots per call to exercise the batched insert path.
+    //
+    const usize roots_per_call = (seed % 2 == 0) ? 1 : 4;
+
     const auto recycle_root_pages = [&](PageRecycler& recycler,
                                         const Slice<const PageId>& root_pages) {
-      for (PageId root_id : root_pages) {
-        const std::array<PageId, 1> to_recycle = {root_id};
+      for (usize i = 0; i < root_pages.size(); i += roots_per_call) {
+        const usize n = std::min(roots_per_call, root_pages.size() - i);
+        const Slice<const PageId> to_recycle = as_slice(root_pages.begin() + i, n);
 
         BATT_DEBUG_INFO("Test - recycle_pages");
         StatusOr<slot_offset_type> recycle_status = recycler.recycle_pages(to_recycle);
@@ -387,7 +586,7 @@ void PageRecyclerTest::run_crash_recovery_test()
           break;
         }
 
-        ++progress;
+        progress += n;
       }
     };
 
@@ -474,7 +673,14 @@ void PageRecyclerTest::run_crash_recovery_test()
 
     LLFS_VLOG(1) << "Run Finished" << BATT_INSPECT(seed)
                  << BATT_INSPECT(fake_recovered_log_state->device_time);
+
+    total_prefetch_count += fake_deleter.prefetch_count_;
   }
+
+  // Dropping a DAG of this size leaves more pages pending than fit in one batch, so some of them
+  // should have been read ahead.
+  //
+  EXPECT_GT(total_prefetch_count, 0u);
 }
 
 }  // namespace
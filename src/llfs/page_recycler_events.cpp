@@ -11,6 +11,10 @@
 
 #include <llfs/page_recycler_options.hpp>
 
+#include <batteries/stream_util.hpp>
+
+#include <cstring>
+
 namespace llfs {
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -21,6 +25,60 @@ std::ostream& operator<<(std::ostream& out, const PageToRecycle& t)
              << ", .depth=" << t.depth << ",}";
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::ostream& operator<<(std::ostream& out, const PagesToRecycle& t)
+{
+  return out << "PagesToRecycle{.page_ids=" << batt::dump_range(t.page_ids)
+             << ", .slot_offset=" << t.slot_offset << ", .depth=" << t.depth << ",}";
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize packed_sizeof(const PackedRecyclePagesInserted& packed)
+{
+  return sizeof(PackedRecyclePagesInserted) - sizeof(PackedPageIdList) +
+         packed_sizeof(packed.page_ids);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize packed_sizeof(const PagesToRecycle& object)
+{
+  return sizeof(PackedRecyclePagesInserted) - sizeof(PackedPageIdList) +
+         packed_page_id_list_size(as_slice(object.page_ids));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PackedRecyclePagesInserted* pack_object_to(const PagesToRecycle& object,
+                                           PackedRecyclePagesInserted* packed, DataPacker* dst)
+{
+  packed->slot_offset = object.slot_offset;
+  packed->depth = object.depth;
+  std::memset(packed->reserved_, 0, sizeof(packed->reserved_));
+
+  if (pack_page_id_list_to(as_slice(object.page_ids), &packed->page_ids, dst) == nullptr) {
+    return nullptr;
+  }
+
+  return packed;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<PagesToRecycle> unpack_object(const PackedRecyclePagesInserted& packed, DataReader* src)
+{
+  BATT_REQUIRE_OK(validate_packed_value(packed.page_ids, src->buffer_begin(),
+                                        byte_distance(src->buffer_begin(), src->buffer_end())));
+
+  return PagesToRecycle{
+      .page_ids = as_seq(packed.page_ids) | seq::collect_vec(),
+      .slot_offset = packed.slot_offset,
+      .depth = packed.depth,
+  };
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 std::ostream& operator<<(std::ostream& out, const PackedPageRecyclerInfo&)
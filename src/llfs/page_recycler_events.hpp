@@ -12,11 +12,14 @@
 
 #include <llfs/data_layout.hpp>
 #include <llfs/data_reader.hpp>
+#include <llfs/packed_page_id_list.hpp>
 #include <llfs/page_layout.hpp>
 #include <llfs/slot.hpp>
 
 #include <batteries/static_assert.hpp>
 
+#include <vector>
+
 namespace llfs {
 
 struct PageToRecycle {
@@ -60,12 +63,14 @@ struct PackedRecyclePageInserted;
 struct PackedRecyclePagePrepare;
 struct PackedRecycleBatchCommit;
 struct PackedPageRecyclerInfo;
+struct PackedRecyclePagesInserted;
 
 using PageRecycleEvent = PackedVariant<  //
     PackedRecyclePageInserted,           //
     PackedRecyclePagePrepare,            //
     PackedRecycleBatchCommit,            //
-    PackedPageRecyclerInfo               //
+    PackedPageRecyclerInfo,              //
+    PackedRecyclePagesInserted           //
     >;
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -154,6 +159,46 @@ inline slot_offset_type get_slot_offset(const PackedRecyclePageInserted& inserte
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 
+// A group of pages at the same depth, inserted (or refreshed) together and written as a single
+// slot.  All pages in the group share `slot_offset`.
+//
+struct PagesToRecycle {
+  // Sorted in the order used by PackedPageIdList.
+  //
+  std::vector<PageId> page_ids;
+  slot_offset_type slot_offset;
+  i32 depth;
+};
+
+std::ostream& operator<<(std::ostream& out, const PagesToRecycle& t);
+
+struct PackedRecyclePagesInserted {
+  little_u64 slot_offset;
+  little_i32 depth;
+  u8 reserved_[4];
+  PackedPageIdList page_ids;
+};
+
+BATT_STATIC_ASSERT_EQ(24, sizeof(PackedRecyclePagesInserted));
+
+usize packed_sizeof(const PackedRecyclePagesInserted& packed);
+
+usize packed_sizeof(const PagesToRecycle& object);
+
+LLFS_DEFINE_PACKED_TYPE_FOR(PagesToRecycle, PackedRecyclePagesInserted);
+
+PackedRecyclePagesInserted* pack_object_to(const PagesToRecycle& object,
+                                           PackedRecyclePagesInserted* packed, DataPacker* dst);
+
+StatusOr<PagesToRecycle> unpack_object(const PackedRecyclePagesInserted& packed, DataReader* src);
+
+inline slot_offset_type get_slot_offset(const PackedRecyclePagesInserted& inserted)
+{
+  return inserted.slot_offset.value();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+
 struct PackedRecyclePagePrepare {
   little_page_id_int page_id;
   little_u64 batch_slot;
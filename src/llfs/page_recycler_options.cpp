@@ -39,11 +39,17 @@ usize PageRecyclerOptions::total_page_grant_size() const
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-usize PageRecyclerOptions::total_grant_size_for_depth(u32 depth) const
+usize PageRecyclerOptions::page_grant_size_for_depth(u32 depth, usize ref_count) const
 {
   return this->total_page_grant_size() *
-         ((1 /*the page itself*/) + (kMaxPageRefDepth - depth) * this->max_refs_per_page) *
-         this->batch_size;
+         ((1 /*the page itself*/) + (kMaxPageRefDepth - depth) * ref_count);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize PageRecyclerOptions::total_grant_size_for_depth(u32 depth) const
+{
+  return this->page_grant_size_for_depth(depth, this->max_refs_per_page) * this->batch_size;
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -32,11 +32,37 @@ struct PageRecyclerOptions {
   //
   usize batch_size = 24;
 
+  // The maximum number of pages to recycle at a time when the recycler knows how many refs they
+  // hold (see `PageDeleter::count_page_refs`).  The log space reserved for a batch assumes that
+  // each of its `batch_size` pages has `max_refs_per_page` refs; pages with fewer refs (e.g., the
+  // leaves of a tree, which have none) need much less, so more of them can share that space.  This
+  // makes for fewer, larger `PageAllocator::update_page_ref_counts` calls when dropping a big tree.
+  //
+  // NOTE: this is a runtime tuning parameter only; it is not stored in the recycler log.
+  //
+  usize max_batch_size = 512;
+
   // The log amplification factor to target when writing refresh records so we can trim the log. For
   // example, refresh_factor = 2 means that for each page inserted, one is inserted.
   //
   usize refresh_factor = 2;
 
+  // The maximum number of pending pages (beyond the current batch) to prefetch via
+  // `PageDeleter::prefetch_pages` each time a batch is collected.  When dropping a large tree,
+  // this keeps many page reads in flight while the current batch is being committed.
+  //
+  // NOTE: this is a runtime tuning parameter only; it is not stored in the recycler log.
+  //
+  usize read_ahead_page_count = 96;
+
+  // The maximum number of pages from one external `PageRecycler::recycle_pages` call to insert
+  // under a single grant, state lock, and as few multi-page log slots as possible.  Larger calls
+  // are split into chunks of this size.
+  //
+  // NOTE: this is a runtime tuning parameter only; it is not stored in the recycler log.
+  //
+  usize insert_batch_size = 1024;
+
   // The log space needed to insert a single page.
   //
   usize insert_grant_size() const;
@@ -49,6 +75,11 @@ struct PageRecyclerOptions {
   //
   usize total_page_grant_size() const;
 
+  // The log space needed to recycle a single page at the given discovery depth that holds
+  // `ref_count` refs to other pages.
+  //
+  usize page_grant_size_for_depth(u32 depth, usize ref_count) const;
+
   // Calculates the total required grant size for a single page at a given discovery depth.
   // (Discovery depth is the number of page references followed to find out that a page is now
   // recyclable; it is not necessarily the same as tree depth, though tree depth provides an upper
@@ -121,6 +121,23 @@ Status PageRecyclerRecoveryVisitor::operator()(const SlotParse& slot,
   return OkStatus();
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status PageRecyclerRecoveryVisitor::operator()(const SlotParse& slot,
+                                               const PagesToRecycle& to_recycle)
+{
+  LLFS_VLOG(1) << "Recovered slot: |" << slot.offset << "| " << to_recycle;
+
+  for (PageId page_id : to_recycle.page_ids) {
+    this->recovered_pages_[page_id] = PageToRecycle{
+        .page_id = page_id,
+        .slot_offset = to_recycle.slot_offset,
+        .depth = to_recycle.depth,
+    };
+  }
+  return OkStatus();
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 Status PageRecyclerRecoveryVisitor::operator()(const SlotParse& slot,
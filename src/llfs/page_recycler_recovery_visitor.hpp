@@ -44,6 +44,7 @@ class PageRecyclerRecoveryVisitor
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
   Status operator()(const SlotParse&, const PageToRecycle& to_recycle);
+  Status operator()(const SlotParse&, const PagesToRecycle& to_recycle);
   Status operator()(const SlotParse&, const PackedRecyclePagePrepare& prepare);
   Status operator()(const SlotParse&, const PackedRecycleBatchCommit& commit);
   Status operator()(const SlotParse&, const PackedPageRecyclerInfo& info);
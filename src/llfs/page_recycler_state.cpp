@@ -9,6 +9,8 @@
 #include <llfs/page_recycler.hpp>
 //
 
+#include <algorithm>
+
 namespace llfs {
 
 //#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
@@ -264,24 +266,53 @@ PageRecycler::WorkItem* PageRecycler::State::refresh_oldest_work_item()
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-std::vector<PageToRecycle> PageRecycler::State::collect_batch(usize max_page_count,
-                                                              Metrics& metrics)
+std::vector<PageToRecycle> PageRecycler::State::collect_batch(
+    usize max_page_count, Metrics& metrics,
+    const std::unordered_map<PageId, usize, PageId::Hash>& ref_counts)
 {
   std::vector<PageToRecycle> to_recycle;
 
+  const auto page_grant_size = [&](const PageToRecycle& p) -> usize {
+    usize ref_count = this->options.max_refs_per_page;
+    auto iter = ref_counts.find(p.page_id);
+    if (iter != ref_counts.end()) {
+      ref_count = std::min(ref_count, iter->second);
+    }
+    return this->options.page_grant_size_for_depth(p.depth, ref_count);
+  };
+
+  usize grant_size = 0;
+  usize max_grant_size = 0;
+
   for (usize i = 0; i < max_page_count; ++i) {
     if (i == 0) {
       to_recycle.emplace_back(this->remove());
       BATT_CHECK_NE(to_recycle.back().page_id, PageId{kInvalidPageId});
+
+      grant_size = page_grant_size(to_recycle.back());
+      max_grant_size = this->options.total_grant_size_for_depth(to_recycle.back().depth);
     } else {
-      Optional<PageToRecycle> next =
-          this->try_remove(/*required_depth=*/BATT_CHECKED_CAST(i32, to_recycle.back().depth));
+      // All higher levels of the stack are still empty, so the next page `try_remove` would
+      // return (if any) is the most recently inserted one at this depth.
+      //
+      const i32 depth = to_recycle.front().depth;
+      if (this->stack_[depth].empty()) {
+        break;
+      }
+      const usize next_grant_size = page_grant_size(this->stack_[depth].back().to_recycle);
+      if (grant_size + next_grant_size > max_grant_size) {
+        break;
+      }
+
+      Optional<PageToRecycle> next = this->try_remove(/*required_depth=*/depth);
       if (!next) {
         break;
       }
       BATT_CHECK(!to_recycle.empty());
       BATT_CHECK_EQ(next->depth, to_recycle.front().depth);
       to_recycle.emplace_back(*next);
+
+      grant_size += next_grant_size;
     }
     metrics.remove_count.fetch_add(1);
   }
@@ -289,4 +320,25 @@ std::vector<PageToRecycle> PageRecycler::State::collect_batch(usize max_page_cou
   return to_recycle;
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::vector<PageId> PageRecycler::State::peek_pending(usize max_page_count) const
+{
+  std::vector<PageId> page_ids;
+
+  // Mirror the depth-first order of `remove()`: highest stack level first, most recently inserted
+  // first within each level.
+  //
+  for (auto level = this->stack_.rbegin(); level != this->stack_.rend(); ++level) {
+    for (auto item = level->rbegin(); item != level->rend(); ++item) {
+      if (page_ids.size() >= max_page_count) {
+        return page_ids;
+      }
+      page_ids.emplace_back(item->to_recycle.page_id);
+    }
+  }
+
+  return page_ids;
+}
+
 }  // namespace llfs
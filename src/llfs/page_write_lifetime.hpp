@@ -0,0 +1,57 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_PAGE_WRITE_LIFETIME_HPP
+#define LLFS_PAGE_WRITE_LIFETIME_HPP
+
+#include <llfs/int_types.hpp>
+
+#include <ostream>
+
+namespace llfs {
+
+// The expected lifetime ("temperature") of a page's data from the time it is written until it is
+// dropped.  Passed as a hint when allocating new pages so that pages which will be erased at about
+// the same time are placed together on the storage device, reducing device-level write
+// amplification.
+//
+// These values mirror the kernel's `RWH_WRITE_LIFE_*` write hints.
+//
+enum struct PageWriteLifetime : u8 {
+  kNotSet = 0,
+  kShort = 1,
+  kMedium = 2,
+  kLong = 3,
+  kExtreme = 4,
+};
+
+// The number of PageWriteLifetime values.
+//
+constexpr usize kNumPageWriteLifetimes = 5;
+
+inline std::ostream& operator<<(std::ostream& out, PageWriteLifetime t)
+{
+  switch (t) {
+    case PageWriteLifetime::kNotSet:
+      return out << "NotSet";
+    case PageWriteLifetime::kShort:
+      return out << "Short";
+    case PageWriteLifetime::kMedium:
+      return out << "Medium";
+    case PageWriteLifetime::kLong:
+      return out << "Long";
+    case PageWriteLifetime::kExtreme:
+      return out << "Extreme";
+  }
+  return out << "(bad PageWriteLifetime:" << (int)t << ")";
+}
+
+}  // namespace llfs
+
+#endif  // LLFS_PAGE_WRITE_LIFETIME_HPP
@@ -0,0 +1,144 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/partial_page.hpp>
+//
+
+#include <batteries/assert.hpp>
+
+#include <algorithm>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ PartialPage::PartialPage(PageDevice& device, PageId page_id,
+                                      usize segment_size) noexcept
+    : device_{device}
+    , page_id_{page_id}
+    , page_size_{device.page_size()}
+    , segment_size_{segment_size}
+    , segments_((this->page_size_ + segment_size - 1) / segment_size)
+{
+  BATT_CHECK_GT(this->segment_size_, 0u);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<PackedPageHeader> PartialPage::header()
+{
+  // Every range buffer carries a copy of the page header.
+  //
+  for (const std::shared_ptr<const PageRangeBuffer>& segment : this->segments_) {
+    if (segment != nullptr) {
+      return segment->header();
+    }
+  }
+
+  StatusOr<std::shared_ptr<const PageRangeBuffer>> loaded =
+      this->load_range(Interval<u64>{0, std::min<u64>(this->segment_size_, this->page_size_)});
+  BATT_REQUIRE_OK(loaded);
+
+  return (*loaded)->header();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::shared_ptr<const PageRangeBuffer>> PartialPage::load_range(
+    const Interval<u64>& byte_range)
+{
+  BATT_REQUIRE_OK(check_page_range(this->page_size_, byte_range));
+
+  const usize first = this->segment_of(byte_range.lower_bound);
+  const usize last = this->segment_of(byte_range.upper_bound - 1);
+
+  // Fast path: the whole range is already resident in a single buffer.
+  //
+  {
+    const std::shared_ptr<const PageRangeBuffer>& resident = this->segments_[first];
+    if (resident != nullptr && resident->contains(byte_range)) {
+      return resident;
+    }
+  }
+
+  // Read all the segments covering the range in one request, so the result is contiguous (even if
+  // some of them are already resident).
+  //
+  const Interval<u64> segment_range{
+      first * this->segment_size_,
+      std::min<u64>((last + 1) * this->segment_size_, this->page_size_),
+  };
+
+  StatusOr<std::shared_ptr<const PageRangeBuffer>> loaded =
+      this->device_.await_read_range(this->page_id_, segment_range);
+  BATT_REQUIRE_OK(loaded);
+
+  const std::shared_ptr<const PageRangeBuffer>& buffer = *loaded;
+  BATT_CHECK(buffer->contains(segment_range));
+
+  // The device may have read more than we asked for; keep every whole segment it covers.
+  //
+  const Interval<u64>& loaded_range = buffer->range();
+  for (usize i = this->segment_of(loaded_range.lower_bound + this->segment_size_ - 1);
+       i < this->segments_.size() &&
+       std::min<u64>((i + 1) * this->segment_size_, this->page_size_) <= loaded_range.upper_bound;
+       ++i) {
+    this->segments_[i] = buffer;
+  }
+
+  return buffer;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+bool PartialPage::is_resident(const Interval<u64>& byte_range) const
+{
+  if (!check_page_range(this->page_size_, byte_range).ok()) {
+    return false;
+  }
+
+  const usize first = this->segment_of(byte_range.lower_bound);
+  const usize last = this->segment_of(byte_range.upper_bound - 1);
+
+  return std::all_of(this->segments_.begin() + first, this->segments_.begin() + last + 1,
+                     [](const std::shared_ptr<const PageRangeBuffer>& segment) {
+                       return segment != nullptr;
+                     });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize PartialPage::resident_segment_count() const
+{
+  return std::count_if(this->segments_.begin(), this->segments_.end(),
+                       [](const std::shared_ptr<const PageRangeBuffer>& segment) {
+                         return segment != nullptr;
+                       });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize PartialPage::resident_size() const
+{
+  std::vector<const PageRangeBuffer*> buffers;
+  for (const std::shared_ptr<const PageRangeBuffer>& segment : this->segments_) {
+    if (segment != nullptr) {
+      buffers.emplace_back(segment.get());
+    }
+  }
+  std::sort(buffers.begin(), buffers.end());
+  buffers.erase(std::unique(buffers.begin(), buffers.end()), buffers.end());
+
+  usize total = 0;
+  for (const PageRangeBuffer* buffer : buffers) {
+    total += buffer->range().size();
+  }
+  return total;
+}
+
+}  // namespace llfs
@@ -0,0 +1,121 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_PARTIAL_PAGE_HPP
+#define LLFS_PARTIAL_PAGE_HPP
+
+#include <llfs/config.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/interval.hpp>
+#include <llfs/packed_page_header.hpp>
+#include <llfs/page_device.hpp>
+#include <llfs/page_id.hpp>
+#include <llfs/page_range_buffer.hpp>
+#include <llfs/page_size.hpp>
+#include <llfs/status.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace llfs {
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// A page that is read from its device lazily, one fixed-size segment at a time.
+//
+// Large pages (e.g., multi-MB leaves) are often accessed only a few KB at a time; a PartialPage
+// uses `PageDevice::read_range` to load just the segments covering each requested byte range and
+// keeps them resident, so repeated accesses to the same part of the page do no further I/O.  The
+// amount of memory held is reported by `resident_size()`, for use in cache accounting.
+//
+// This class is not thread-safe.
+//
+class PartialPage
+{
+ public:
+  static constexpr usize kDefaultSegmentSize = 4 * kKiB;
+
+  explicit PartialPage(PageDevice& device, PageId page_id,
+                       usize segment_size = kDefaultSegmentSize) noexcept;
+
+  PartialPage(const PartialPage&) = delete;
+  PartialPage& operator=(const PartialPage&) = delete;
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  PageId page_id() const
+  {
+    return this->page_id_;
+  }
+
+  PageSize page_size() const
+  {
+    return this->page_size_;
+  }
+
+  usize segment_size() const
+  {
+    return this->segment_size_;
+  }
+
+  usize segment_count() const
+  {
+    return this->segments_.size();
+  }
+
+  // Returns the header of the page, loading the first segment if no part of the page is resident.
+  //
+  StatusOr<PackedPageHeader> header();
+
+  // Returns a buffer that contains the bytes at page offsets `byte_range`, reading whichever
+  // segments that cover the range are not yet resident.  Use `PageRangeBuffer::get(byte_range)` to
+  // access the data.
+  //
+  StatusOr<std::shared_ptr<const PageRangeBuffer>> load_range(const Interval<u64>& byte_range);
+
+  // Returns true iff `byte_range` can be accessed without doing any I/O.
+  //
+  bool is_resident(const Interval<u64>& byte_range) const;
+
+  // Returns the number of segments that are currently resident.
+  //
+  usize resident_segment_count() const;
+
+  // Returns the number of bytes of page data held in memory by this object.  This may be larger
+  // than `resident_segment_count() * segment_size()`, since the device may read more than requested
+  // and a buffer stays in memory as long as any of its segments is still in use.
+  //
+  usize resident_size() const;
+
+ private:
+  // Returns the index of the segment containing the byte at page offset `offset`.
+  //
+  usize segment_of(u64 offset) const
+  {
+    return offset / this->segment_size_;
+  }
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  PageDevice& device_;
+
+  const PageId page_id_;
+
+  const PageSize page_size_;
+
+  const usize segment_size_;
+
+  // The buffer holding each segment of the page, or nullptr if the segment is not resident.  A
+  // buffer is shared by all the (consecutive) segments it covers.
+  //
+  std::vector<std::shared_ptr<const PageRangeBuffer>> segments_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_PARTIAL_PAGE_HPP
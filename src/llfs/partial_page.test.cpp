@@ -0,0 +1,160 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/partial_page.hpp>
+//
+#include <llfs/partial_page.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/memory_page_device.hpp>
+
+#include <cstring>
+#include <memory>
+
+namespace {
+
+using namespace llfs::int_types;
+
+using llfs::Interval;
+using llfs::PageRangeBuffer;
+using llfs::PartialPage;
+using llfs::StatusOr;
+
+constexpr u32 kPageSize = 64 * 1024;
+constexpr usize kSegmentSize = 4096;
+
+class PartialPageTest : public ::testing::Test
+{
+ public:
+  void SetUp() override
+  {
+    this->page_id_ = this->device_.page_ids().make_page_id(/*physical_page=*/1, /*generation=*/1);
+
+    StatusOr<std::shared_ptr<llfs::PageBuffer>> page = this->device_.prepare(this->page_id_);
+    ASSERT_TRUE(page.ok()) << BATT_INSPECT(page.status());
+
+    llfs::MutableBuffer payload = (*page)->mutable_payload();
+    for (usize i = 0; i < payload.size(); ++i) {
+      static_cast<u8*>(payload.data())[i] = this->expected_byte(sizeof(llfs::PackedPageHeader) + i);
+    }
+
+    llfs::Status write_status;
+    this->device_.write(std::move(*page), [&write_status](llfs::Status status) {
+      write_status = status;
+    });
+    ASSERT_TRUE(write_status.ok()) << BATT_INSPECT(write_status);
+  }
+
+  u8 expected_byte(u64 offset) const
+  {
+    return static_cast<u8>((offset * 7) ^ (offset >> 8));
+  }
+
+  void verify(const PageRangeBuffer& buffer, const Interval<u64>& byte_range) const
+  {
+    ASSERT_TRUE(buffer.contains(byte_range));
+
+    const llfs::ConstBuffer data = buffer.get(byte_range);
+    ASSERT_EQ(data.size(), byte_range.size());
+
+    for (u64 offset = byte_range.lower_bound; offset < byte_range.upper_bound; ++offset) {
+      ASSERT_EQ(static_cast<const u8*>(data.data())[offset - byte_range.lower_bound],
+                this->expected_byte(offset))
+          << BATT_INSPECT(offset);
+    }
+  }
+
+  llfs::MemoryPageDevice device_{/*device_id=*/0, llfs::PageCount{4}, llfs::PageSize{kPageSize}};
+
+  llfs::PageId page_id_;
+};
+
+TEST_F(PartialPageTest, ReadRange)
+{
+  const Interval<u64> byte_range{10000, 10100};
+
+  StatusOr<std::shared_ptr<const PageRangeBuffer>> buffer =
+      this->device_.await_read_range(this->page_id_, byte_range);
+
+  ASSERT_TRUE(buffer.ok()) << BATT_INSPECT(buffer.status());
+  EXPECT_EQ((*buffer)->page_id(), this->page_id_);
+  ASSERT_NO_FATAL_FAILURE(this->verify(**buffer, byte_range));
+
+  // Bad ranges.
+  //
+  EXPECT_EQ(this->device_.await_read_range(this->page_id_, Interval<u64>{100, 100}).status(),
+            batt::StatusCode::kInvalidArgument);
+  EXPECT_EQ(
+      this->device_.await_read_range(this->page_id_, Interval<u64>{100, kPageSize + 1}).status(),
+      batt::StatusCode::kOutOfRange);
+
+  // Stale generation.
+  //
+  const llfs::PageId stale_page_id =
+      this->device_.page_ids().make_page_id(/*physical_page=*/1, /*generation=*/2);
+
+  EXPECT_EQ(this->device_.await_read_range(stale_page_id, byte_range).status(),
+            batt::StatusCode::kNotFound);
+}
+
+TEST_F(PartialPageTest, LoadSegmentsLazily)
+{
+  PartialPage page{this->device_, this->page_id_, kSegmentSize};
+
+  EXPECT_EQ(page.segment_count(), kPageSize / kSegmentSize);
+  EXPECT_EQ(page.resident_segment_count(), 0u);
+  EXPECT_EQ(page.resident_size(), 0u);
+
+  // A range within one segment loads only that segment.
+  //
+  const Interval<u64> range_1{3 * kSegmentSize + 100, 3 * kSegmentSize + 200};
+  {
+    StatusOr<std::shared_ptr<const PageRangeBuffer>> buffer = page.load_range(range_1);
+    ASSERT_TRUE(buffer.ok()) << BATT_INSPECT(buffer.status());
+    ASSERT_NO_FATAL_FAILURE(this->verify(**buffer, range_1));
+  }
+  EXPECT_TRUE(page.is_resident(range_1));
+  EXPECT_FALSE(page.is_resident(Interval<u64>{0, 1}));
+  EXPECT_EQ(page.resident_segment_count(), 1u);
+  EXPECT_EQ(page.resident_size(), kSegmentSize);
+
+  // A range that straddles a segment boundary loads both segments as one contiguous buffer.
+  //
+  const Interval<u64> range_2{6 * kSegmentSize - 10, 6 * kSegmentSize + 10};
+  {
+    StatusOr<std::shared_ptr<const PageRangeBuffer>> buffer = page.load_range(range_2);
+    ASSERT_TRUE(buffer.ok()) << BATT_INSPECT(buffer.status());
+    ASSERT_NO_FATAL_FAILURE(this->verify(**buffer, range_2));
+  }
+  EXPECT_EQ(page.resident_segment_count(), 3u);
+  EXPECT_EQ(page.resident_size(), 3 * kSegmentSize);
+
+  // Reloading resident data returns the same buffer.
+  //
+  {
+    StatusOr<std::shared_ptr<const PageRangeBuffer>> buffer_1 = page.load_range(range_1);
+    StatusOr<std::shared_ptr<const PageRangeBuffer>> buffer_2 =
+        page.load_range(Interval<u64>{range_1.lower_bound + 1, range_1.upper_bound + 1});
+    ASSERT_TRUE(buffer_1.ok());
+    ASSERT_TRUE(buffer_2.ok());
+    EXPECT_EQ(buffer_1->get(), buffer_2->get());
+  }
+  EXPECT_EQ(page.resident_segment_count(), 3u);
+
+  // The header comes along with every range.
+  //
+  StatusOr<llfs::PackedPageHeader> header = page.header();
+  ASSERT_TRUE(header.ok());
+  EXPECT_EQ(header->page_id.as_page_id(), this->page_id_);
+  EXPECT_EQ(header->size, kPageSize);
+  EXPECT_EQ(page.resident_segment_count(), 3u);
+}
+
+}  // namespace
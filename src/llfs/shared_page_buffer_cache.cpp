@@ -0,0 +1,368 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/shared_page_buffer_cache.hpp>
+//
+
+#include <batteries/finally.hpp>
+#include <batteries/syscall_retry.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace llfs {
+
+namespace {
+
+// Changed whenever the layout of Header or Slot changes.
+//
+constexpr u64 kSharedPageBufferCacheMagic = 0x7b5c1e0d24a6f391ull;
+
+enum : u32 {
+  kHeaderUninitialized = 0,
+  kHeaderInitializing = 1,
+  kHeaderReady = 2,
+};
+
+// steady_clock is CLOCK_MONOTONIC on Linux, which is the same for all processes on the host.
+//
+i64 now_nsec()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Returns true if there is definitely no process `pid` any more.  A zombie still counts as alive,
+// though it can't write to the mapping either; at worst its slots stay busy until it is reaped.
+//
+bool process_is_dead(i64 pid)
+{
+  return ::kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH;
+}
+
+}  // namespace
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// The first bytes of the shared file.  A new file is all zeros, so the first process to CAS `state`
+// from kHeaderUninitialized initializes the rest.
+//
+struct SharedPageBufferCache::Header {
+  std::atomic<u32> state;
+  u32 page_size;
+  u64 slot_count;
+  u64 magic;
+};
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Per-slot sequence lock and index entry.  `seq` is even when the slot is stable (0 means never
+// written) and odd while a writer holds it.  Writers exclude each other by claiming `owner_pid`
+// (0 when there is no writer) before they touch `seq`.
+//
+struct SharedPageBufferCache::Slot {
+  std::atomic<u64> seq;
+  std::atomic<i64> owner_pid;
+  std::atomic<u64> page_id;
+  std::atomic<i64> lease_deadline;
+  std::atomic<i64> last_hit;
+};
+
+// The mapped file is shared between processes, so these must not rely on per-process locks.
+//
+static_assert(std::atomic<u64>::is_always_lock_free);
+static_assert(std::atomic<i64>::is_always_lock_free);
+static_assert(std::atomic<u32>::is_always_lock_free);
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ StatusOr<std::shared_ptr<SharedPageBufferCache>> SharedPageBufferCache::open(
+    const std::string& file_name, PageSize page_size, usize slot_count,
+    std::chrono::nanoseconds write_lease)
+{
+  if (slot_count < 2 || page_size == 0 || (page_size & (page_size - 1)) != 0) {
+    return {batt::StatusCode::kInvalidArgument};
+  }
+
+  static const usize system_page_size = ::sysconf(_SC_PAGESIZE);
+
+  const usize index_size = sizeof(Header) + sizeof(Slot) * slot_count;
+  const usize data_offset =
+      (index_size + system_page_size - 1) / system_page_size * system_page_size;
+  const usize mapped_size = data_offset + usize{page_size} * slot_count;
+
+  const int fd = batt::syscall_retry([&] {
+    return ::open(file_name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+  });
+  BATT_REQUIRE_OK(batt::status_from_retval(fd));
+
+  // The mapping keeps its own reference to the file.
+  //
+  auto on_scope_exit = batt::finally([fd] {
+    ::close(fd);
+  });
+
+  // Growing the file is idempotent (new space reads as zeros), so every process can do it.
+  //
+  struct stat st;
+  BATT_REQUIRE_OK(batt::status_from_retval(::fstat(fd, &st)));
+  if (static_cast<usize>(st.st_size) < mapped_size) {
+    BATT_REQUIRE_OK(batt::status_from_retval(batt::syscall_retry([&] {
+      return ::ftruncate(fd, mapped_size);
+    })));
+  }
+
+  void* base = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    return batt::status_from_errno(errno);
+  }
+
+  std::shared_ptr<SharedPageBufferCache> cache{new SharedPageBufferCache{
+      static_cast<u8*>(base), mapped_size, page_size, slot_count, write_lease}};
+
+  Header& header = *reinterpret_cast<Header*>(base);
+
+  u32 state = kHeaderUninitialized;
+  if (header.state.compare_exchange_strong(state, kHeaderInitializing)) {
+    header.page_size = page_size;
+    header.slot_count = slot_count;
+    header.magic = kSharedPageBufferCacheMagic;
+    header.state.store(kHeaderReady, std::memory_order_release);
+  } else {
+    // Give up if the initializing process seems to have died before it finished.
+    //
+    const i64 deadline = now_nsec() + write_lease.count();
+    while (header.state.load(std::memory_order_acquire) != kHeaderReady) {
+      if (now_nsec() > deadline) {
+        return {batt::StatusCode::kUnavailable};
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  if (header.magic != kSharedPageBufferCacheMagic || header.page_size != page_size ||
+      header.slot_count != slot_count) {
+    return {batt::StatusCode::kInvalidArgument};
+  }
+
+  return cache;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ SharedPageBufferCache::SharedPageBufferCache(
+    u8* base, usize mapped_size, PageSize page_size, usize slot_count,
+    std::chrono::nanoseconds write_lease) noexcept
+    : base_{base}
+    , mapped_size_{mapped_size}
+    , page_size_{page_size}
+    , slot_count_{slot_count}
+    , write_lease_{write_lease}
+{
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+SharedPageBufferCache::~SharedPageBufferCache() noexcept
+{
+  LLFS_WARN_IF_NOT_OK(batt::status_from_retval(batt::syscall_retry([&] {
+    return ::munmap(this->base_, this->mapped_size_);
+  })));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::pair<usize, usize> SharedPageBufferCache::slots_for_page(PageId page_id) const
+{
+  const usize h = PageId::Hash{}(page_id);
+  const usize first = h % this->slot_count_;
+  const usize second = (first + 1 + (h / this->slot_count_) % (this->slot_count_ - 1)) %
+                       this->slot_count_;
+
+  return {first, second};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+auto SharedPageBufferCache::slot(usize i) const -> Slot&
+{
+  return reinterpret_cast<Slot*>(this->base_ + sizeof(Header))[i];
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u8* SharedPageBufferCache::slot_data(usize i) const
+{
+  return this->base_ + (this->mapped_size_ - usize{this->page_size_} * this->slot_count_) +
+         usize{this->page_size_} * i;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+bool SharedPageBufferCache::try_read_slot(usize i, PageId page_id, PageBuffer& dst)
+{
+  Slot& slot = this->slot(i);
+
+  const u64 seq_before = slot.seq.load(std::memory_order_acquire);
+  if (seq_before == 0 || (seq_before & 1) != 0 ||
+      slot.page_id.load(std::memory_order_relaxed) != page_id.int_value()) {
+    return false;
+  }
+
+  std::memcpy(dst.mutable_buffer().data(), this->slot_data(i), this->page_size_);
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.seq.load(std::memory_order_relaxed) != seq_before) {
+    return false;
+  }
+
+  slot.last_hit.store(now_nsec(), std::memory_order_relaxed);
+  return true;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::shared_ptr<PageBuffer> SharedPageBufferCache::find(PageId page_id)
+{
+  const auto [first, second] = this->slots_for_page(page_id);
+
+  std::shared_ptr<PageBuffer> buffer;
+
+  for (usize i : {first, second}) {
+    if (this->slot(i).page_id.load(std::memory_order_relaxed) != page_id.int_value()) {
+      continue;
+    }
+    if (!buffer) {
+      buffer = PageBuffer::allocate(this->page_size_, page_id);
+    }
+    if (this->try_read_slot(i, page_id, *buffer) && buffer->page_id() == page_id) {
+      this->metrics_.hit_count.add(1);
+      return buffer;
+    }
+  }
+
+  this->metrics_.miss_count.add(1);
+  return nullptr;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void SharedPageBufferCache::insert(const PageBuffer& page)
+{
+  BATT_CHECK_EQ(page.size(), this->page_size_);
+
+  const PageId page_id = page.page_id();
+  const auto [first, second] = this->slots_for_page(page_id);
+
+  // Replace the way that was hit least recently, unless the page is already present.
+  //
+  usize victim = first;
+  for (usize i : {first, second}) {
+    const Slot& slot = this->slot(i);
+    const u64 seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 0 && (seq & 1) == 0 &&
+        slot.page_id.load(std::memory_order_relaxed) == page_id.int_value()) {
+      return;
+    }
+  }
+  if (this->slot(second).last_hit.load(std::memory_order_relaxed) <
+      this->slot(first).last_hit.load(std::memory_order_relaxed)) {
+    victim = second;
+  }
+
+  for (usize i : {victim, victim == first ? second : first}) {
+    const Optional<u64> locked_seq = this->try_lock_slot(i);
+    if (!locked_seq) {
+      continue;
+    }
+    Slot& slot = this->slot(i);
+
+    slot.page_id.store(page_id.int_value(), std::memory_order_relaxed);
+    std::memcpy(this->slot_data(i), page.const_buffer().data(), this->page_size_);
+    slot.last_hit.store(now_nsec(), std::memory_order_relaxed);
+
+    this->unlock_slot(i, *locked_seq);
+
+    this->metrics_.insert_count.add(1);
+    return;
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Optional<u64> SharedPageBufferCache::try_lock_slot(usize i)
+{
+  static const i64 this_pid = ::getpid();
+
+  Slot& slot = this->slot(i);
+  const i64 now = now_nsec();
+
+  // Claim the slot if no one is writing it, or if the writer's lease expired and its process has
+  // died (presumably mid-write).  A writer that is merely slow keeps the slot: if its lease were
+  // broken, it could go on to overwrite the data or `seq` under the new writer.
+  //
+  i64 owner_pid = slot.owner_pid.load(std::memory_order_acquire);
+  if (owner_pid != 0) {
+    if (slot.lease_deadline.load(std::memory_order_relaxed) >= now ||
+        !process_is_dead(owner_pid)) {
+      return None;
+    }
+  }
+  if (!slot.owner_pid.compare_exchange_strong(owner_pid, this_pid, std::memory_order_acquire)) {
+    return None;
+  }
+  if (owner_pid != 0) {
+    this->metrics_.lease_break_count.add(1);
+  }
+  slot.lease_deadline.store(now + this->write_lease_.count(), std::memory_order_relaxed);
+
+  // `seq` is only ever changed by the owner, so it is still odd here if the previous owner died
+  // while writing.
+  //
+  const u64 seq = slot.seq.load(std::memory_order_relaxed);
+  const u64 locked_seq = ((seq & 1) == 0) ? seq + 1 : seq + 2;
+
+  slot.seq.store(locked_seq, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  return locked_seq;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void SharedPageBufferCache::unlock_slot(usize i, u64 locked_seq)
+{
+  Slot& slot = this->slot(i);
+
+  slot.seq.store(locked_seq + 1, std::memory_order_release);
+  slot.owner_pid.store(0, std::memory_order_release);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+bool SharedPageBufferCache::abandon_insert_for_testing(PageId page_id)
+{
+  const auto [first, second] = this->slots_for_page(page_id);
+
+  for (usize i : {first, second}) {
+    const Optional<u64> locked_seq = this->try_lock_slot(i);
+    if (locked_seq) {
+      this->slot(i).page_id.store(page_id.int_value(), std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace llfs
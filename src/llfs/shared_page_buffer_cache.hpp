@@ -0,0 +1,144 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_SHARED_PAGE_BUFFER_CACHE_HPP
+#define LLFS_SHARED_PAGE_BUFFER_CACHE_HPP
+
+#include <llfs/int_types.hpp>
+#include <llfs/metrics.hpp>
+#include <llfs/optional.hpp>
+#include <llfs/page_buffer.hpp>
+#include <llfs/page_id.hpp>
+#include <llfs/page_size.hpp>
+#include <llfs/status.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace llfs {
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief A cache of raw page data in a memory-mapped file (e.g. under /dev/shm), shared by all
+ * the processes that open the same file.
+ *
+ * PageCache uses this as a second level below its own (per-process) cache: on a miss it looks for
+ * the page here before reading it from the device, and pages read from the device are published
+ * here for the other processes.  Each process still decodes its own PageView from a local copy of
+ * the data, so PageView/PinnedPage lifetimes never cross process boundaries.
+ *
+ * Because a PageId names an immutable page (including its generation), an entry never needs to be
+ * invalidated; a recycled page simply gets a new id.  Each slot is guarded by a sequence lock:
+ * readers copy the data out and count it as a miss if the sequence changed meanwhile, so they
+ * never block and hold no cross-process references.  A writer marks the slot busy for a limited
+ * lease; if it crashes mid-write, the slot reads as a miss until another writer breaks the expired
+ * lease.  Leases are only broken once the owning process has exited, so a slow writer can never
+ * clobber a slot that has been handed to someone else; all processes sharing the file must
+ * therefore be in the same PID namespace.
+ *
+ * The cache is 2-way set associative; on insert, the way that was hit least recently is replaced.
+ */
+class SharedPageBufferCache
+{
+ public:
+  struct Metrics {
+    CountMetric<u64> hit_count{0};
+    CountMetric<u64> miss_count{0};
+    CountMetric<u64> insert_count{0};
+    CountMetric<u64> lease_break_count{0};
+  };
+
+  static constexpr std::chrono::milliseconds kDefaultWriteLease{1000};
+
+  /** \brief Opens (creating if necessary) a shared cache of `slot_count` pages of `page_size`
+   * bytes, backed by the file `file_name`.
+   *
+   * All processes must open the file with the same `page_size` and `slot_count`; otherwise
+   * batt::StatusCode::kInvalidArgument is returned.
+   */
+  static StatusOr<std::shared_ptr<SharedPageBufferCache>> open(
+      const std::string& file_name, PageSize page_size, usize slot_count,
+      std::chrono::nanoseconds write_lease = kDefaultWriteLease);
+
+  SharedPageBufferCache(const SharedPageBufferCache&) = delete;
+  SharedPageBufferCache& operator=(const SharedPageBufferCache&) = delete;
+
+  ~SharedPageBufferCache() noexcept;
+
+  PageSize page_size() const
+  {
+    return this->page_size_;
+  }
+
+  usize slot_count() const
+  {
+    return this->slot_count_;
+  }
+
+  const Metrics& metrics() const
+  {
+    return this->metrics_;
+  }
+
+  /** \brief Returns a new (process-local) copy of the data for `page_id`, or nullptr if it is not
+   * in the shared cache.
+   */
+  std::shared_ptr<PageBuffer> find(PageId page_id);
+
+  /** \brief Publishes the data of `page` to the shared cache.  This is best-effort: if both slots
+   * the page maps to are being written by others, the page is not inserted.
+   */
+  void insert(const PageBuffer& page);
+
+  /** \brief Locks a slot for `page_id` as though a writer had started to insert it, and never
+   * unlocks it; used to simulate a crash mid-write.  Returns false if no slot could be locked.
+   */
+  bool abandon_insert_for_testing(PageId page_id);
+
+ private:
+  struct Header;
+  struct Slot;
+
+  explicit SharedPageBufferCache(u8* base, usize mapped_size, PageSize page_size, usize slot_count,
+                                 std::chrono::nanoseconds write_lease) noexcept;
+
+  // Returns the indices of the two slots that `page_id` may be stored in.
+  //
+  std::pair<usize, usize> slots_for_page(PageId page_id) const;
+
+  Slot& slot(usize i) const;
+
+  u8* slot_data(usize i) const;
+
+  // Copies the page in slot `i` to `dst` if it holds `page_id`; returns false on any mismatch or
+  // concurrent write.
+  //
+  bool try_read_slot(usize i, PageId page_id, PageBuffer& dst);
+
+  // Makes this process the writer of slot `i`, breaking the lease of a writer that died; returns
+  // the (odd) locked sequence number, or None if another live writer holds the slot.
+  //
+  Optional<u64> try_lock_slot(usize i);
+
+  // Publishes the data written to slot `i` and releases it.
+  //
+  void unlock_slot(usize i, u64 locked_seq);
+
+  u8* const base_;
+  const usize mapped_size_;
+  const PageSize page_size_;
+  const usize slot_count_;
+  const std::chrono::nanoseconds write_lease_;
+  Metrics metrics_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_SHARED_PAGE_BUFFER_CACHE_HPP
@@ -0,0 +1,194 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/shared_page_buffer_cache.hpp>
+//
+#include <llfs/shared_page_buffer_cache.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using namespace llfs::int_types;
+
+const std::filesystem::path kCacheFilePath{"/tmp/llfs_shared_page_buffer_cache_test_file"};
+
+constexpr usize kSlotCount = 16;
+
+const llfs::PageSize kPageSize{4096};
+
+std::shared_ptr<llfs::PageBuffer> make_page(llfs::PageId page_id, u8 fill)
+{
+  std::shared_ptr<llfs::PageBuffer> page = llfs::PageBuffer::allocate(kPageSize, page_id);
+  llfs::MutableBuffer payload = page->mutable_payload();
+  std::memset(payload.data(), fill, payload.size());
+  return page;
+}
+
+class SharedPageBufferCacheTest : public ::testing::Test
+{
+ public:
+  void SetUp() override
+  {
+    std::filesystem::remove_all(kCacheFilePath);
+    ASSERT_FALSE(std::filesystem::exists(kCacheFilePath));
+  }
+
+  void TearDown() override
+  {
+    std::filesystem::remove_all(kCacheFilePath);
+  }
+};
+
+TEST_F(SharedPageBufferCacheTest, InsertIsVisibleToOtherMappings)
+{
+  // Two separate mappings of the same file stand in for two processes.
+  //
+  llfs::StatusOr<std::shared_ptr<llfs::SharedPageBufferCache>> writer =
+      llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount);
+  ASSERT_TRUE(writer.ok()) << BATT_INSPECT(writer.status());
+
+  llfs::StatusOr<std::shared_ptr<llfs::SharedPageBufferCache>> reader =
+      llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount);
+  ASSERT_TRUE(reader.ok()) << BATT_INSPECT(reader.status());
+
+  const llfs::PageId page_id{0x1234};
+
+  EXPECT_EQ((*reader)->find(page_id), nullptr);
+  EXPECT_EQ((*reader)->metrics().miss_count.load(), 1u);
+
+  std::shared_ptr<llfs::PageBuffer> page = make_page(page_id, 0xa5);
+  (*writer)->insert(*page);
+
+  EXPECT_EQ((*writer)->metrics().insert_count.load(), 1u);
+
+  std::shared_ptr<llfs::PageBuffer> found = (*reader)->find(page_id);
+  ASSERT_NE(found, nullptr);
+  EXPECT_NE(found.get(), page.get());
+  EXPECT_EQ(found->page_id(), page_id);
+  EXPECT_EQ(std::memcmp(found->const_buffer().data(), page->const_buffer().data(), kPageSize), 0);
+  EXPECT_EQ((*reader)->metrics().hit_count.load(), 1u);
+}
+
+TEST_F(SharedPageBufferCacheTest, ReplacesLeastRecentlyHitWay)
+{
+  llfs::StatusOr<std::shared_ptr<llfs::SharedPageBufferCache>> cache =
+      llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount);
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+  // Insert many more pages than there are slots; every page that is still cached must come back
+  // intact, and the most recent insert must always be found.
+  //
+  for (u64 i = 1; i <= kSlotCount * 4; ++i) {
+    const llfs::PageId page_id{i};
+    (*cache)->insert(*make_page(page_id, static_cast<u8>(i)));
+
+    std::shared_ptr<llfs::PageBuffer> found = (*cache)->find(page_id);
+    ASSERT_NE(found, nullptr) << BATT_INSPECT(i);
+  }
+
+  usize found_count = 0;
+  for (u64 i = 1; i <= kSlotCount * 4; ++i) {
+    std::shared_ptr<llfs::PageBuffer> found = (*cache)->find(llfs::PageId{i});
+    if (found != nullptr) {
+      found_count += 1;
+      EXPECT_EQ(found->page_id(), llfs::PageId{i});
+      EXPECT_EQ(static_cast<const u8*>(found->const_payload().data())[0], static_cast<u8>(i));
+    }
+  }
+  EXPECT_GT(found_count, 0u);
+  EXPECT_LE(found_count, kSlotCount);
+}
+
+TEST_F(SharedPageBufferCacheTest, BreaksLeaseOfDeadWriter)
+{
+  const llfs::PageId page_id{0x5678};
+
+  // A child process starts to write both slots for the page and dies before it finishes.
+  //
+  const pid_t child = ::fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    llfs::StatusOr<std::shared_ptr<llfs::SharedPageBufferCache>> cache =
+        llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount);
+    const bool ok = cache.ok() && (*cache)->abandon_insert_for_testing(page_id) &&
+                    (*cache)->abandon_insert_for_testing(page_id);
+    ::_exit(ok ? 0 : 1);
+  }
+
+  int child_status = 0;
+  ASSERT_EQ(::waitpid(child, &child_status, 0), child);
+  ASSERT_TRUE(WIFEXITED(child_status));
+  ASSERT_EQ(WEXITSTATUS(child_status), 0);
+
+  llfs::StatusOr<std::shared_ptr<llfs::SharedPageBufferCache>> cache =
+      llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount,
+                                        /*write_lease=*/std::chrono::nanoseconds{0});
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+  EXPECT_EQ((*cache)->find(page_id), nullptr);
+
+  (*cache)->insert(*make_page(page_id, 0x3c));
+
+  EXPECT_EQ((*cache)->metrics().lease_break_count.load(), 1u);
+  EXPECT_EQ((*cache)->metrics().insert_count.load(), 1u);
+
+  std::shared_ptr<llfs::PageBuffer> found = (*cache)->find(page_id);
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(static_cast<const u8*>(found->const_payload().data())[0], 0x3c);
+}
+
+TEST_F(SharedPageBufferCacheTest, NeverBreaksLeaseOfLiveWriter)
+{
+  // Even with an expired lease, a writer whose process is still running (here, this one) might
+  // still be copying data into the slot, so the slot must not be handed to anyone else.
+  //
+  llfs::StatusOr<std::shared_ptr<llfs::SharedPageBufferCache>> cache =
+      llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount,
+                                        /*write_lease=*/std::chrono::nanoseconds{0});
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+  const llfs::PageId page_id{0x9abc};
+
+  ASSERT_TRUE((*cache)->abandon_insert_for_testing(page_id));
+  ASSERT_TRUE((*cache)->abandon_insert_for_testing(page_id));
+  EXPECT_FALSE((*cache)->abandon_insert_for_testing(page_id));
+
+  (*cache)->insert(*make_page(page_id, 0x3c));
+
+  EXPECT_EQ((*cache)->metrics().lease_break_count.load(), 0u);
+  EXPECT_EQ((*cache)->metrics().insert_count.load(), 0u);
+  EXPECT_EQ((*cache)->find(page_id), nullptr);
+}
+
+TEST_F(SharedPageBufferCacheTest, ConfigMismatch)
+{
+  llfs::StatusOr<std::shared_ptr<llfs::SharedPageBufferCache>> cache =
+      llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount);
+  ASSERT_TRUE(cache.ok()) << BATT_INSPECT(cache.status());
+
+  EXPECT_EQ(llfs::SharedPageBufferCache::open(kCacheFilePath.string(), kPageSize, kSlotCount * 2)
+                .status(),
+            batt::StatusCode::kInvalidArgument);
+
+  EXPECT_EQ(llfs::SharedPageBufferCache::open(kCacheFilePath.string(), llfs::PageSize{8192},
+                                              kSlotCount)
+                .status(),
+            batt::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
@@ -0,0 +1,87 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/slot_compression.hpp>
+//
+
+#include <llfs/status_code.hpp>
+
+#include <batteries/checked_cast.hpp>
+
+#include <zlib.h>
+
+#include <cstring>
+#include <limits>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Optional<std::string> compress_slot_body(const ConstBuffer& slot_body)
+{
+  if (slot_body.size() <= sizeof(PackedCompressedSlotHeader) ||
+      slot_body.size() > std::numeric_limits<u32>::max()) {
+    return None;
+  }
+
+  const auto src_size = static_cast<uLong>(slot_body.size());
+  uLongf dst_size = compressBound(src_size);
+
+  std::string compressed(sizeof(PackedCompressedSlotHeader) + dst_size, '\0');
+
+  const int result = compress2(
+      reinterpret_cast<Bytef*>(compressed.data() + sizeof(PackedCompressedSlotHeader)), &dst_size,
+      static_cast<const Bytef*>(slot_body.data()), src_size, Z_DEFAULT_COMPRESSION);
+
+  if (result != Z_OK || sizeof(PackedCompressedSlotHeader) + dst_size >= slot_body.size()) {
+    return None;
+  }
+  compressed.resize(sizeof(PackedCompressedSlotHeader) + dst_size);
+
+  auto* header = reinterpret_cast<PackedCompressedSlotHeader*>(compressed.data());
+  header->marker = PackedCompressedSlotHeader::kMarker;
+  header->algorithm = PackedCompressedSlotHeader::kZlib;
+  header->uncompressed_size = BATT_CHECKED_CAST(u32, slot_body.size());
+
+  return compressed;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::shared_ptr<const std::string>> decompress_slot_body(
+    const std::string_view& compressed_slot_body)
+{
+  if (compressed_slot_body.size() < sizeof(PackedCompressedSlotHeader)) {
+    return make_status(StatusCode::kBadCompressedSlot);
+  }
+
+  PackedCompressedSlotHeader header;
+  std::memcpy(&header, compressed_slot_body.data(), sizeof(PackedCompressedSlotHeader));
+
+  if (header.marker != PackedCompressedSlotHeader::kMarker ||
+      header.algorithm != PackedCompressedSlotHeader::kZlib || header.uncompressed_size == 0) {
+    return make_status(StatusCode::kBadCompressedSlot);
+  }
+
+  const std::string_view compressed_data = compressed_slot_body.substr(sizeof(header));
+
+  auto body = std::make_shared<std::string>(header.uncompressed_size.value(), '\0');
+  uLongf body_size = body->size();
+
+  const int result = uncompress(reinterpret_cast<Bytef*>(body->data()), &body_size,
+                                reinterpret_cast<const Bytef*>(compressed_data.data()),
+                                static_cast<uLong>(compressed_data.size()));
+
+  if (result != Z_OK || body_size != body->size()) {
+    return make_status(StatusCode::kBadCompressedSlot);
+  }
+
+  return std::shared_ptr<const std::string>{std::move(body)};
+}
+
+}  // namespace llfs
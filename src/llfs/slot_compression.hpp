@@ -0,0 +1,81 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_SLOT_COMPRESSION_HPP
+#define LLFS_SLOT_COMPRESSION_HPP
+
+#include <llfs/buffer.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/optional.hpp>
+#include <llfs/status.hpp>
+
+#include <batteries/static_assert.hpp>
+#include <batteries/strong_typedef.hpp>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace llfs {
+
+// Slots whose body is at least this many bytes are compressed (if compression makes them smaller);
+// 0 means never compress.
+//
+BATT_STRONG_TYPEDEF(u64, SlotCompressionMinSize);
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// The header at the start of the body of a compressed slot.
+//
+// Slot bodies written by TypedSlotWriter normally begin with a PackedVariant head, whose `which`
+// field is always less than 255; a first byte of `kMarker` flags the slot as compressed instead.
+// The compressed data that follows the header decompresses to the original slot body (variant head
+// and all), so SlotReader can substitute it transparently.
+//
+struct PackedCompressedSlotHeader {
+  static constexpr u8 kMarker = 0xff;
+
+  static constexpr u8 kZlib = 1;
+
+  // Always `kMarker`.
+  //
+  u8 marker;
+
+  // The compression algorithm used for the rest of the slot body.
+  //
+  u8 algorithm;
+
+  // The size of the original slot body.
+  //
+  little_u32 uncompressed_size;
+};
+
+BATT_STATIC_ASSERT_EQ(sizeof(PackedCompressedSlotHeader), 6);
+
+// Returns true iff `slot_body` begins with a PackedCompressedSlotHeader.
+//
+inline bool is_compressed_slot_body(const std::string_view& slot_body)
+{
+  return !slot_body.empty() &&
+         static_cast<u8>(slot_body.front()) == PackedCompressedSlotHeader::kMarker;
+}
+
+// Returns the compressed form (header included) of `slot_body`, or None if compressing it would not
+// make it smaller.
+//
+Optional<std::string> compress_slot_body(const ConstBuffer& slot_body);
+
+// Returns the original slot body for `compressed_slot_body`, which must begin with a
+// PackedCompressedSlotHeader.
+//
+StatusOr<std::shared_ptr<const std::string>> decompress_slot_body(
+    const std::string_view& compressed_slot_body);
+
+}  // namespace llfs
+
+#endif  // LLFS_SLOT_COMPRESSION_HPP
@@ -0,0 +1,154 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/slot_compression.hpp>
+//
+#include <llfs/slot_compression.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/memory_log_device.hpp>
+#include <llfs/pack_as_raw.hpp>
+#include <llfs/packable_ref.hpp>
+#include <llfs/slot_reader.hpp>
+#include <llfs/slot_writer.hpp>
+#include <llfs/status_code.hpp>
+#include <llfs/volume_events.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace llfs::int_types;
+
+// Returns a string of `size` bytes of JSON-like (i.e., highly compressible) text.
+//
+std::string make_compressible_data(usize size)
+{
+  std::string data;
+  for (usize i = 0; data.size() < size; ++i) {
+    data += "{\"key\": \"item-" + std::to_string(i % 10) + "\", \"value\": true},";
+  }
+  data.resize(size);
+  return data;
+}
+
+std::string make_random_data(usize size)
+{
+  std::default_random_engine rng{1};
+  std::string data(size, '\0');
+  for (char& ch : data) {
+    ch = static_cast<char>(rng());
+  }
+  return data;
+}
+
+TEST(SlotCompressionTest, CompressDecompress)
+{
+  const std::string body = make_compressible_data(4000);
+
+  llfs::Optional<std::string> compressed =
+      llfs::compress_slot_body(llfs::ConstBuffer{body.data(), body.size()});
+
+  ASSERT_TRUE(compressed);
+  EXPECT_LT(compressed->size(), body.size() / 4);
+  EXPECT_TRUE(llfs::is_compressed_slot_body(*compressed));
+
+  llfs::StatusOr<std::shared_ptr<const std::string>> decompressed =
+      llfs::decompress_slot_body(*compressed);
+
+  ASSERT_TRUE(decompressed.ok()) << BATT_INSPECT(decompressed.status());
+  EXPECT_EQ(**decompressed, body);
+
+  // Corrupt data is reported as an error.
+  //
+  std::string truncated = compressed->substr(0, compressed->size() / 2);
+  EXPECT_EQ(llfs::decompress_slot_body(truncated).status(), llfs::StatusCode::kBadCompressedSlot);
+  EXPECT_EQ(llfs::decompress_slot_body(compressed->substr(0, 3)).status(),
+            llfs::StatusCode::kBadCompressedSlot);
+}
+
+TEST(SlotCompressionTest, IncompressibleDataIsNotCompressed)
+{
+  const std::string body = make_random_data(4000);
+
+  EXPECT_FALSE(llfs::compress_slot_body(llfs::ConstBuffer{body.data(), body.size()}));
+}
+
+TEST(SlotCompressionTest, WriteAndReadSlots)
+{
+  constexpr usize kMinSize = 256;
+
+  const std::vector<std::string> payloads = {
+      make_compressible_data(kMinSize / 2),  // too small to compress
+      make_compressible_data(8000),          // compressed
+      make_random_data(8000),                // incompressible
+  };
+
+  llfs::MemoryLogDevice log{64 * 1024};
+  llfs::TypedSlotWriter<llfs::VolumeEventVariant> slot_writer{log};
+
+  std::vector<llfs::SlotRange> slot_ranges;
+  for (const std::string& data : payloads) {
+    llfs::PackableRef payload{llfs::pack_as_raw(data)};
+    const usize max_slot_size = llfs::packed_sizeof_slot(payload);
+
+    llfs::StatusOr<batt::Grant> grant =
+        slot_writer.reserve(max_slot_size, batt::WaitForResource::kFalse);
+    ASSERT_TRUE(grant.ok()) << BATT_INSPECT(grant.status());
+
+    llfs::StatusOr<llfs::SlotRange> slot_range =
+        slot_writer.append(*grant, payload, llfs::SlotCompressionMinSize{kMinSize});
+    ASSERT_TRUE(slot_range.ok()) << BATT_INSPECT(slot_range.status());
+
+    // Only the size of the slot as written is taken from the grant.
+    //
+    EXPECT_EQ(grant->size(), max_slot_size - slot_range->size());
+
+    slot_ranges.emplace_back(*slot_range);
+  }
+
+  EXPECT_EQ(slot_ranges[0].size(), llfs::packed_sizeof_slot(llfs::pack_as_raw(payloads[0])));
+  EXPECT_LT(slot_ranges[1].size() * 4, payloads[1].size());
+  EXPECT_EQ(slot_ranges[2].size(), llfs::packed_sizeof_slot(llfs::pack_as_raw(payloads[2])));
+
+  // The reader decompresses slots transparently.
+  //
+  std::unique_ptr<llfs::LogDevice::Reader> log_reader =
+      log.new_reader(/*slot_lower_bound=*/llfs::None, llfs::LogReadMode::kSpeculative);
+
+  llfs::TypedSlotReader<llfs::VolumeEventVariant> slot_reader{*log_reader};
+
+  usize slot_i = 0;
+  llfs::StatusOr<usize> n_read = slot_reader.run(
+      batt::WaitForResource::kFalse,
+      batt::make_case_of_visitor(
+          [&](const llfs::SlotParse& slot, const llfs::Ref<const llfs::PackedRawData>& raw) {
+            EXPECT_LT(slot_i, payloads.size());
+            if (slot_i < payloads.size()) {
+              EXPECT_EQ(slot.offset, slot_ranges[slot_i]);
+              EXPECT_EQ(slot.decompressed_body != nullptr, slot_i == 1);
+              EXPECT_EQ(llfs::raw_data_from_slot(slot, raw.pointer()), payloads[slot_i]);
+            }
+            ++slot_i;
+            return llfs::OkStatus();
+          },
+          [&](const llfs::SlotParse& slot, const auto& /*payload*/) {
+            ADD_FAILURE() << "unexpected slot type at " << slot.offset;
+            return llfs::OkStatus();
+          }));
+
+  ASSERT_TRUE(n_read.ok()) << BATT_INSPECT(n_read.status());
+  EXPECT_EQ(*n_read, payloads.size());
+  EXPECT_EQ(slot_i, payloads.size());
+}
+
+}  // namespace
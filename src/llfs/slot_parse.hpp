@@ -14,7 +14,9 @@
 
 #include <batteries/stream_util.hpp>
 
+#include <memory>
 #include <ostream>
+#include <string>
 #include <string_view>
 
 namespace llfs {
@@ -25,6 +27,13 @@ struct SlotParse {
   SlotRange offset;
   std::string_view body;
   Optional<SlotRange> depends_on_offset;
+
+  // If the slot was compressed in the log, this holds the decompressed data that `body` points to;
+  // it is shared by all copies of this SlotParse, so data referenced via `body` stays valid for as
+  // long as the SlotParse is kept.  Otherwise `body` points directly into the log buffer and this
+  // is nullptr.
+  //
+  std::shared_ptr<const std::string> decompressed_body;
 };
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -9,6 +9,8 @@
 #include <llfs/slot_reader.hpp>
 //
 
+#include <llfs/slot_compression.hpp>
+
 namespace llfs {
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -136,7 +138,7 @@ StatusOr<SlotParse> SlotReader::parse_next(batt::WaitForResource wait_for_data)
     // Initialize the slot_range according to the log reader's offset attribute; we will update
     // `upper_bound` inside the variant visitor passed to `DataReader::read_variant`.
     //
-    return SlotParse{
+    SlotParse slot{
         .offset =
             SlotRange{
                 .lower_bound = current_slot,
@@ -144,7 +146,21 @@ StatusOr<SlotParse> SlotReader::parse_next(batt::WaitForResource wait_for_data)
             },
         .body = slot_body,
         .depends_on_offset = None,
+        .decompressed_body = nullptr,
     };
+
+    // Compressed slots are decompressed here, so visitors always see the original slot body.  The
+    // slot's offset range still describes its (compressed) extent in the log.
+    //
+    if (is_compressed_slot_body(slot_body)) {
+      StatusOr<std::shared_ptr<const std::string>> decompressed = decompress_slot_body(slot_body);
+      BATT_REQUIRE_OK(decompressed);
+
+      slot.decompressed_body = std::move(*decompressed);
+      slot.body = *slot.decompressed_body;
+    }
+
+    return slot;
   }
 }
 
@@ -15,6 +15,7 @@
 #include <batteries/async/latch.hpp>
 #include <batteries/shared_ptr.hpp>
 #include <batteries/stream_util.hpp>
+#include <batteries/utility.hpp>
 
 #include <functional>
 #include <memory>
@@ -70,6 +71,20 @@ class SlotSequencer
 
   StatusOr<SlotRange> await_prev() const;
 
+  // Invokes `handler` with the result of `await_prev()` as soon as it is available, instead of
+  // blocking.  `handler` is called with the signature `void(const StatusOr<SlotRange>&)`; it may be
+  // called before this function returns.
+  //
+  template <typename Handler>
+  void async_await_prev(Handler&& handler) const
+  {
+    if (this->prev_ == nullptr) {
+      BATT_FORWARD(handler)(StatusOr<SlotRange>{SlotRange{0, 0}});
+      return;
+    }
+    this->prev_->async_get(BATT_FORWARD(handler));
+  }
+
   Optional<SlotRange> get_current() const;
 
   bool set_current(const SlotRange& slot_range);
@@ -87,6 +87,27 @@ auto SlotWriter::prepare(batt::Grant& caller_grant, usize slot_body_size,
   }};
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<SlotRange> SlotWriter::append_maybe_compressed(batt::Grant& grant,
+                                                        const ConstBuffer& slot_body)
+{
+  // Compress before `prepare`, so we aren't holding the log writer lock while we do it.
+  //
+  const Optional<std::string> compressed = compress_slot_body(slot_body);
+  const ConstBuffer body_to_write =
+      compressed ? ConstBuffer{compressed->data(), compressed->size()} : slot_body;
+
+  StatusOr<Append> op = this->prepare(grant, body_to_write.size());
+  BATT_REQUIRE_OK(op);
+
+  if (!op->packer().pack_raw_data(body_to_write.data(), body_to_write.size())) {
+    return ::llfs::make_status(StatusCode::kFailedToPackSlotVarTail);
+  }
+
+  return op->commit();
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 SlotWriter::Append::Append(SlotWriter* that, batt::Mutex<LogDevice::Writer*>::Lock writer_lock,
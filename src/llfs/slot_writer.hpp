@@ -14,11 +14,14 @@
 
 #include <llfs/data_layout.hpp>
 #include <llfs/data_packer.hpp>
+#include <llfs/slot_compression.hpp>
 
 #include <batteries/async/grant.hpp>
 #include <batteries/async/mutex.hpp>
 #include <batteries/async/types.hpp>
 
+#include <memory>
+
 namespace llfs {
 
 struct PackedRawData;
@@ -97,6 +100,11 @@ class SlotWriter
   StatusOr<Append> prepare(batt::Grant& grant, usize slot_body_size,
                            Optional<std::string_view> name = None);
 
+  // Append a slot with the given (fully packed) body, compressing it if that makes it smaller.  The
+  // grant is charged for the size of the slot as written.
+  //
+  StatusOr<SlotRange> append_maybe_compressed(batt::Grant& grant, const ConstBuffer& slot_body);
+
  private:
   LogDevice& log_device_;
 
@@ -204,28 +212,59 @@ class TypedSlotWriter<PackedVariant<Ts...>> : public SlotWriter
   using Append = typename SlotWriter::Append;
   using SlotWriter::SlotWriter;
 
+  // The first byte of a slot body is reserved to flag compressed slots.
+  //
+  static_assert(sizeof...(Ts) < PackedCompressedSlotHeader::kMarker,
+                "TypedSlotWriter can not be used with a PackedVariant that has 255 or more cases");
+
+  // Append a slot containing `payload`.  If `compression_min_size` is non-zero and the slot body is
+  // at least that large, the body is compressed when that makes it smaller; SlotReader undoes this
+  // transparently.  The grant is charged for the size of the slot as written, so it is safe (if
+  // conservative) to size it with `packed_sizeof_slot(payload)`.
+  //
   template <typename T>
-  StatusOr<SlotRange> append(batt::Grant& caller_grant, T&& payload)
+  StatusOr<SlotRange> append(batt::Grant& caller_grant, T&& payload,
+                             SlotCompressionMinSize compression_min_size =
+                                 SlotCompressionMinSize{0})
   {
     const usize slot_body_size = sizeof(PackedVariant<Ts...>) + packed_sizeof(payload);
     BATT_CHECK_NE(slot_body_size, 0u);
 
+    if (compression_min_size != 0 && slot_body_size >= compression_min_size) {
+      std::unique_ptr<u8[]> slot_body{new u8[slot_body_size]};
+      DataPacker packer{MutableBuffer{slot_body.get(), slot_body_size}};
+
+      BATT_REQUIRE_OK(pack_slot_body(packer, BATT_FORWARD(payload)));
+
+      return this->append_maybe_compressed(caller_grant,
+                                           ConstBuffer{slot_body.get(), slot_body_size});
+    }
+
     StatusOr<Append> op = this->prepare(caller_grant, slot_body_size);
     BATT_REQUIRE_OK(op);
 
+    BATT_REQUIRE_OK(pack_slot_body(op->packer(), BATT_FORWARD(payload)));
+
+    return op->commit();
+  }
+
+ private:
+  template <typename T>
+  static Status pack_slot_body(DataPacker& packer, T&& payload)
+  {
     PackedVariant<Ts...>* variant_head =
-        op->packer().pack_record(batt::StaticType<PackedVariant<Ts...>>{});
+        packer.pack_record(batt::StaticType<PackedVariant<Ts...>>{});
     if (!variant_head) {
       return ::llfs::make_status(StatusCode::kFailedToPackSlotVarHead);
     }
 
     variant_head->init(batt::StaticType<PackedTypeFor<T>>{});
 
-    if (!pack_object(BATT_FORWARD(payload), &(op->packer()))) {
+    if (!pack_object(BATT_FORWARD(payload), &packer)) {
       return ::llfs::make_status(StatusCode::kFailedToPackSlotVarTail);
     }
 
-    return op->commit();
+    return OkStatus();
   }
 };
 
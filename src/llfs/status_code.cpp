@@ -120,6 +120,20 @@ bool initialize_status_codes()
                      "Failed to read storage file"),  // 56,
       CODE_WITH_MSG_(StatusCode::kStorageFileBadConfigBlockCrc,
                      "Failed to read storage file"),  // 57,
+      CODE_WITH_MSG_(StatusCode::kPageDeviceReadOnly,
+                     "The PageDevice does not support writing or dropping pages"),  // 58,
+      CODE_WITH_MSG_(StatusCode::kBadPackedPageIdList,
+                     "PackedPageIdList payload is malformed or does not match its header"),  // 59,
+      CODE_WITH_MSG_(StatusCode::kStripedLogInconsistent,
+                     "StripedLogDevice stripes do not form a consistent logical log"),  // 60,
+      CODE_WITH_MSG_(StatusCode::kBadCompressedSlot,
+                     "Compressed log slot has a bad header or does not decompress"),  // 61,
+      CODE_WITH_MSG_(StatusCode::kSnapshotRootNotLive,
+                     "Volume snapshot root page is free, stale, or pending recycle"),  // 62,
+      CODE_WITH_MSG_(StatusCode::kLogDeviceReadOnly,
+                     "The LogDevice is a read-only follower and can not be written"),  // 63,
+      CODE_WITH_MSG_(StatusCode::kLogFollowerFellBehind,
+                     "The log was trimmed past data that a follower had not yet read"),  // 64,
 
   });
   return initialized;
@@ -73,6 +73,13 @@ enum struct StatusCode {
   kLogBlockCommitSizeOverflow = 55,
   kStorageFileBadConfigBlockMagic = 56,
   kStorageFileBadConfigBlockCrc = 57,
+  kPageDeviceReadOnly = 58,
+  kBadPackedPageIdList = 59,
+  kStripedLogInconsistent = 60,
+  kBadCompressedSlot = 61,
+  kSnapshotRootNotLive = 62,
+  kLogDeviceReadOnly = 63,
+  kLogFollowerFellBehind = 64,
 };
 
 bool initialize_status_codes();
@@ -9,7 +9,10 @@
 #include <llfs/storage_context.hpp>
 //
 
+#include <llfs/deferred_page_allocator.hpp>
+#include <llfs/page_allocator_config.hpp>
 #include <llfs/page_arena_config.hpp>
+#include <llfs/page_device_config.hpp>
 #include <llfs/raw_block_file_impl.hpp>
 #include <llfs/status_code.hpp>
 
@@ -101,6 +104,25 @@ void StorageContext::set_page_cache_options(const PageCacheOptions& options)
   this->page_cache_options_ = options;
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void StorageContext::enable_follower_mode()
+{
+  BATT_CHECK(!this->page_cache_) << "enable_follower_mode must be called before get_page_cache";
+
+  this->follower_mode_ = true;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void StorageContext::enable_background_allocator_recovery()
+{
+  BATT_CHECK(!this->page_cache_)
+      << "enable_background_allocator_recovery must be called before get_page_cache";
+
+  this->background_allocator_recovery_ = true;
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<batt::SharedPtr<PageCache>> StorageContext::get_page_cache()
@@ -119,23 +141,77 @@ StatusOr<batt::SharedPtr<PageCache>> StorageContext::get_page_cache()
       const std::string base_name =
           batt::to_string("PageDevice_", packed_arena_config.page_device_uuid);
 
-      StatusOr<PageArena> arena = this->recover_object(
-          batt::StaticType<PackedPageArenaConfig>{}, uuid,
-          PageAllocatorRuntimeOptions{
-              .scheduler = this->scheduler_,
-              .name = batt::to_string(base_name, "_Allocator"),
-          },
-          [&] {
-            IoRingLogDriverOptions options;
-            options.name = batt::to_string(base_name, "_AllocatorLog");
-            return options;
-          }(),
-          IoRingFileRuntimeOptions{
-              .io_ring = *this->io_ring_,
-              .use_raw_io = true,
-              .allow_read = true,
-              .allow_write = true,
-          });
+      if (this->follower_mode_) {
+        StatusOr<std::unique_ptr<PageDevice>> page_device = this->recover_object(
+            batt::StaticType<PackedPageDeviceConfig>{}, packed_arena_config.page_device_uuid,
+            IoRingFileRuntimeOptions{
+                .io_ring = *this->io_ring_,
+                .use_raw_io = true,
+                .allow_read = true,
+                .allow_write = false,
+            });
+
+        BATT_REQUIRE_OK(page_device);
+
+        storage_pool.emplace_back(std::move(*page_device),
+                                  /*allocator=*/std::unique_ptr<PageAllocator>{nullptr});
+        continue;
+      }
+
+      const std::string allocator_name = batt::to_string(base_name, "_Allocator");
+
+      const auto allocator_log_options = [&] {
+        IoRingLogDriverOptions options;
+        options.name = batt::to_string(base_name, "_AllocatorLog");
+        return options;
+      }();
+
+      const auto page_device_options = IoRingFileRuntimeOptions{
+          .io_ring = *this->io_ring_,
+          .use_raw_io = true,
+          .allow_read = true,
+          .allow_write = true,
+      };
+
+      if (this->background_allocator_recovery_) {
+        StatusOr<std::unique_ptr<PageDevice>> page_device =
+            this->recover_object(batt::StaticType<PackedPageDeviceConfig>{},
+                                 packed_arena_config.page_device_uuid, page_device_options);
+
+        BATT_REQUIRE_OK(page_device);
+
+        const page_device_id_int device_id = (*page_device)->page_ids().get_device_id();
+
+        storage_pool.emplace_back(
+            std::move(*page_device),
+            std::make_unique<DeferredPageAllocator>(
+                this->scheduler_, batt::to_string(base_name, "_AllocatorRecovery"),
+                [self = batt::shared_ptr_from(this),
+                 allocator_uuid = packed_arena_config.page_allocator_uuid, allocator_name,
+                 allocator_log_options, device_id]() -> StatusOr<std::unique_ptr<PageAllocator>> {
+                  StatusOr<std::unique_ptr<PageAllocator>> page_allocator = self->recover_object(
+                      batt::StaticType<PackedPageAllocatorConfig>{}, allocator_uuid,
+                      PageAllocatorRuntimeOptions{
+                          .scheduler = self->get_scheduler(),
+                          .name = allocator_name,
+                      },
+                      allocator_log_options);
+
+                  BATT_REQUIRE_OK(page_allocator);
+                  BATT_CHECK_EQ(device_id, (*page_allocator)->get_device_id());
+
+                  return page_allocator;
+                }));
+        continue;
+      }
+
+      StatusOr<PageArena> arena =
+          this->recover_object(batt::StaticType<PackedPageArenaConfig>{}, uuid,
+                               PageAllocatorRuntimeOptions{
+                                   .scheduler = this->scheduler_,
+                                   .name = allocator_name,
+                               },
+                               allocator_log_options, page_device_options);
 
       BATT_REQUIRE_OK(arena);
 
@@ -169,4 +245,21 @@ batt::BoxedSeq<batt::SharedPtr<StorageObjectInfo>> StorageContext::find_objects_
          | seq::boxed();
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+batt::BoxedSeq<batt::SharedPtr<StorageObjectInfo>> StorageContext::find_objects_by_file_name(
+    const std::string& file_name)
+{
+  return as_seq(this->index_.begin(), this->index_.end())  //
+         | seq::filter_map(
+               [file_name](const auto& kv_pair) -> Optional<batt::SharedPtr<StorageObjectInfo>> {
+                 if (kv_pair.second->storage_file->file_name() == file_name) {
+                   return kv_pair.second;
+                 } else {
+                   return None;
+                 }
+               })  //
+         | seq::boxed();
+}
+
 }  // namespace llfs
@@ -64,6 +64,33 @@ class StorageContext : public batt::RefCounted<StorageContext>
    */
   void set_page_cache_options(const PageCacheOptions& options);
 
+  /*! \brief Puts this context in follower mode: storage objects are opened read-only so that this
+   * process can read the storage of Volumes that another (writer) process is actively using.
+   *
+   * In follower mode, the PageCache is built from the PageDevices only; PageAllocators are never
+   * recovered and pages can not be allocated.  Volumes must be recovered as VolumeFollowers (by
+   * passing VolumeFollowerRuntimeOptions to `recover_object`).  Must be called before
+   * `get_page_cache`.
+   */
+  void enable_follower_mode();
+
+  /*! \brief Returns true iff `enable_follower_mode` has been called.
+   */
+  bool is_follower() const
+  {
+    return this->follower_mode_;
+  }
+
+  /*! \brief Makes `get_page_cache` return as soon as the PageDevices are open, before the
+   * PageAllocator logs have been replayed.
+   *
+   * Each PageAllocator is recovered on a background Task instead (see DeferredPageAllocator).
+   * Pages can be loaded through the PageCache right away; anything that needs an allocator (page
+   * allocation, ref count updates, Volume attachment) waits for that allocator's recovery.  Must
+   * be called before `get_page_cache`.
+   */
+  void enable_background_allocator_recovery();
+
   // Returns a PageCache object that can be used to access all PageDevices in the StorageContext.
   // The PageCache is created the first time this function is called, and cached to be returned on
   // subsequent calls.
@@ -80,6 +107,12 @@ class StorageContext : public batt::RefCounted<StorageContext>
   //
   batt::BoxedSeq<batt::SharedPtr<StorageObjectInfo>> find_objects_by_tag(u16 tag);
 
+  // Returns a sequence of StorageObjectInfo for all objects in the file(s) with the given name
+  // (there can be more than one StorageFile per name, at different start offsets).
+  //
+  batt::BoxedSeq<batt::SharedPtr<StorageObjectInfo>> find_objects_by_file_name(
+      const std::string& file_name);
+
   // Adds an already existing file to this context.
   //
   Status add_existing_named_file(std::string&& file_name, i64 start_offset = 0);
@@ -146,6 +179,14 @@ class StorageContext : public batt::RefCounted<StorageContext>
   //
   PageCacheOptions page_cache_options_ = PageCacheOptions::with_default_values();
 
+  // Set by `enable_follower_mode()`.
+  //
+  bool follower_mode_ = false;
+
+  // Set by `enable_background_allocator_recovery()`.
+  //
+  bool background_allocator_recovery_ = false;
+
   // The PageCache for this context; this is lazily created the first time
   // `StorageContext::get_page_cache()` is called.
   //
@@ -15,7 +15,9 @@
 
 #include <llfs/constants.hpp>
 #include <llfs/ioring_log_device.hpp>
+#include <llfs/log_device_config.hpp>
 #include <llfs/page_arena_config.hpp>
+#include <llfs/page_device_config.hpp>
 #include <llfs/raw_block_file_impl.hpp>
 #include <llfs/uuid.hpp>
 
@@ -136,4 +138,78 @@ TEST(StorageContextTest, GetPageCache)
   EXPECT_EQ(arenas_2mb.size(), 1u);
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Write-life hints apply to a whole file, so an IoRing page device must only set one when it is the
+// only object in its storage file.
+//
+TEST(StorageContextTest, PageDeviceWriteLifetimeRequiresExclusiveFile)
+{
+  const char* shared_file_name =
+      "/tmp/llfs_StorageContextTest_PageDeviceWriteLifetime_shared_file.llfs";
+  const char* exclusive_file_name =
+      "/tmp/llfs_StorageContextTest_PageDeviceWriteLifetime_exclusive_file.llfs";
+
+  llfs::delete_file(shared_file_name).IgnoreError();
+  llfs::delete_file(exclusive_file_name).IgnoreError();
+
+  llfs::StatusOr<llfs::ScopedIoRing> io =
+      llfs::ScopedIoRing::make_new(llfs::MaxQueueDepth{1024}, llfs::ThreadPoolSize{1});
+
+  ASSERT_TRUE(io.ok()) << BATT_INSPECT(io.status());
+
+  batt::SharedPtr<llfs::StorageContext> storage_context = batt::make_shared<llfs::StorageContext>(
+      batt::Runtime::instance().default_scheduler(), io->get_io_ring());
+
+  const boost::uuids::uuid shared_device_uuid = llfs::random_uuid();
+  const boost::uuids::uuid exclusive_device_uuid = llfs::random_uuid();
+
+  const auto page_device_options = [](const boost::uuids::uuid& uuid) {
+    return llfs::PageDeviceConfigOptions{
+        .uuid = uuid,
+        .device_id = llfs::None,
+        .page_count = llfs::PageCount{8},
+        .page_size_log2 = llfs::PageSizeLog2{12},
+    };
+  };
+
+  // The shared file holds a page device and a log device.
+  //
+  llfs::Status shared_create_status = storage_context->add_new_file(
+      shared_file_name, [&](llfs::StorageFileBuilder& builder) -> llfs::Status {
+        BATT_REQUIRE_OK(builder.add_object(page_device_options(shared_device_uuid)));
+        BATT_REQUIRE_OK(builder.add_object(llfs::LogDeviceConfigOptions{
+            .uuid = llfs::None,
+            .pages_per_block_log2 = llfs::None,
+            .log_size = 64 * kKiB,
+        }));
+        return llfs::OkStatus();
+      });
+  ASSERT_TRUE(shared_create_status.ok()) << BATT_INSPECT(shared_create_status);
+
+  llfs::Status exclusive_create_status = storage_context->add_new_file(
+      exclusive_file_name, [&](llfs::StorageFileBuilder& builder) -> llfs::Status {
+        BATT_REQUIRE_OK(builder.add_object(page_device_options(exclusive_device_uuid)));
+        return llfs::OkStatus();
+      });
+  ASSERT_TRUE(exclusive_create_status.ok()) << BATT_INSPECT(exclusive_create_status);
+
+  const auto file_options = llfs::IoRingFileRuntimeOptions::with_default_values(io->get_io_ring());
+
+  llfs::StatusOr<std::unique_ptr<llfs::PageDevice>> shared_device = storage_context->recover_object(
+      batt::StaticType<llfs::PackedPageDeviceConfig>{}, shared_device_uuid, file_options);
+  ASSERT_TRUE(shared_device.ok()) << BATT_INSPECT(shared_device.status());
+
+  llfs::StatusOr<std::unique_ptr<llfs::PageDevice>> exclusive_device =
+      storage_context->recover_object(batt::StaticType<llfs::PackedPageDeviceConfig>{},
+                                      exclusive_device_uuid, file_options);
+  ASSERT_TRUE(exclusive_device.ok()) << BATT_INSPECT(exclusive_device.status());
+
+  EXPECT_EQ((*shared_device)->set_write_lifetime(llfs::PageWriteLifetime::kShort),
+            batt::StatusCode::kFailedPrecondition);
+
+  llfs::Status exclusive_status =
+      (*exclusive_device)->set_write_lifetime(llfs::PageWriteLifetime::kShort);
+  EXPECT_TRUE(exclusive_status.ok()) << BATT_INSPECT(exclusive_status);
+}
+
 }  // namespace
@@ -0,0 +1,107 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/striped_log_config.hpp>
+//
+
+#include <llfs/ioring_log_device.hpp>
+#include <llfs/status_code.hpp>
+#include <llfs/system_config.hpp>
+#include <llfs/uuid.hpp>
+
+#include <batteries/checked_cast.hpp>
+#include <batteries/stream_util.hpp>
+
+#include <string>
+#include <vector>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::ostream& operator<<(std::ostream& out, const PackedStripedLogConfig& t)
+{
+  return out << "PackedStripedLogConfig{.uuid=" << t.uuid << ", .chunk_size=" << t.chunk_size
+             << ", .stripe_capacity=" << t.stripe_capacity
+             << ", .stripe_count=" << t.stripe_count() << ",}";
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status configure_storage_object(StorageFileBuilder::Transaction& txn,
+                                FileOffsetPtr<PackedStripedLogConfig&> p_config,
+                                const StripedLogConfigOptions& options)
+{
+  const u64 stripe_capacity = round_up_to_page_size_multiple(options.stripe_size);
+
+  BATT_CHECK_GT(options.stripe_count, 0u);
+  BATT_CHECK_GT(stripe_capacity, options.chunk_size)
+      << "Each stripe must be able to hold more than one chunk";
+
+  std::string stripe_uuids;
+
+  for (usize stripe_i = 0; stripe_i < options.stripe_count; ++stripe_i) {
+    StatusOr<FileOffsetPtr<const PackedLogDeviceConfig&>> p_stripe_config =
+        txn.add_object(LogDeviceConfigOptions{
+            .uuid = None,
+            .pages_per_block_log2 = options.pages_per_block_log2,
+            .log_size = stripe_capacity,
+        });
+
+    BATT_REQUIRE_OK(p_stripe_config);
+
+    const boost::uuids::uuid stripe_uuid = (*p_stripe_config)->uuid;
+    stripe_uuids.append(reinterpret_cast<const char*>(&stripe_uuid), sizeof(stripe_uuid));
+  }
+
+  p_config->uuid = options.uuid.value_or(random_uuid());
+  p_config->chunk_size = BATT_CHECKED_CAST(u32, options.chunk_size);
+  p_config->stripe_capacity = stripe_capacity;
+
+  if (!txn.packer().pack_string_to(&p_config->stripe_uuids, stripe_uuids)) {
+    return ::batt::StatusCode::kResourceExhausted;
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::unique_ptr<StripedLogDeviceFactory>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string& /*file_name*/,
+    const FileOffsetPtr<const PackedStripedLogConfig&>& p_config,
+    const IoRingLogDriverOptions& options)
+{
+  std::vector<std::unique_ptr<LogDeviceFactory>> stripe_factories;
+
+  for (usize stripe_i = 0; stripe_i < p_config->stripe_count(); ++stripe_i) {
+    // Stripes hold slices of the logical log, not whole slots.
+    //
+    IoRingLogDriverOptions stripe_options = options;
+    stripe_options.set_name(batt::to_string(options.name, "_stripe", stripe_i)).set_raw_data(true);
+
+    StatusOr<std::unique_ptr<IoRingLogDeviceFactory>> stripe_factory =
+        storage_context->recover_object(batt::StaticType<PackedLogDeviceConfig>{},
+                                        p_config->stripe_uuid(stripe_i), stripe_options);
+
+    BATT_REQUIRE_OK(stripe_factory);
+
+    stripe_factories.emplace_back(std::move(*stripe_factory));
+  }
+
+  if (stripe_factories.empty()) {
+    return make_status(StatusCode::kStripedLogInconsistent);
+  }
+
+  return std::make_unique<StripedLogDeviceFactory>(std::move(stripe_factories),
+                                                   p_config->stripe_capacity,
+                                                   storage_context->get_scheduler(),
+                                                   p_config->chunk_size);
+}
+
+}  // namespace llfs
@@ -0,0 +1,145 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_STRIPED_LOG_CONFIG_HPP
+#define LLFS_STRIPED_LOG_CONFIG_HPP
+
+#include <llfs/int_types.hpp>
+#include <llfs/ioring_log_driver_options.hpp>
+#include <llfs/log_device_config.hpp>
+#include <llfs/optional.hpp>
+#include <llfs/packed_bytes.hpp>
+#include <llfs/packed_config.hpp>
+#include <llfs/status.hpp>
+#include <llfs/storage_context.hpp>
+#include <llfs/storage_file_builder.hpp>
+#include <llfs/striped_log_driver.hpp>
+
+#include <batteries/static_assert.hpp>
+
+#include <boost/uuid/uuid.hpp>
+
+#include <cstring>
+#include <memory>
+#include <ostream>
+
+namespace llfs {
+
+struct PackedStripedLogConfig;
+struct StripedLogConfigOptions;
+
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+// Adds a PackedStripedLogConfig to the passed transaction, along with a PackedLogDeviceConfig for
+// each stripe.
+//
+Status configure_storage_object(StorageFileBuilder::Transaction& txn,
+                                FileOffsetPtr<PackedStripedLogConfig&> p_config,
+                                const StripedLogConfigOptions& options);
+
+// Returns a factory that opens the striped log, with an IoRing log device for each stripe.  Each
+// stripe is opened with a copy of `options` (see StripedLogDeviceFactory).
+//
+StatusOr<std::unique_ptr<StripedLogDeviceFactory>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string& file_name,
+    const FileOffsetPtr<const PackedStripedLogConfig&>& p_config,
+    const IoRingLogDriverOptions& options);
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+//
+struct StripedLogConfigOptions {
+  using PackedConfigType = PackedStripedLogConfig;
+
+  // The unique identifier for the striped log; if None, a random UUID will be generated.
+  //
+  Optional<boost::uuids::uuid> uuid;
+
+  // The number of log devices to stripe across.
+  //
+  usize stripe_count;
+
+  // The capacity in bytes of each stripe's log device.  The logical capacity of the striped log is
+  // a little less than `stripe_count * stripe_size`; see StripedLogDeviceFactory::logical_capacity.
+  //
+  usize stripe_size;
+
+  // log2 of the number of 4kib (memory) pages per flush block of each stripe; see
+  // LogDeviceConfigOptions.
+  //
+  Optional<u16> pages_per_block_log2;
+
+  // The number of contiguous logical bytes stored on one stripe before moving to the next.
+  //
+  usize chunk_size = StripedLogDeviceFactory::kDefaultChunkSize;
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+//
+struct PackedStripedLogConfig : PackedConfigSlotHeader {
+  static constexpr usize kSize = PackedConfigSlot::kSize;
+
+  // byte 20 +++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // See StripedLogConfigOptions::chunk_size.
+  //
+  little_u32 chunk_size;
+
+  // byte 24 +++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The logical size of each stripe's log device.
+  //
+  little_u64 stripe_capacity;
+
+  // byte 32 +++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The uuids of the stripe log devices (PackedLogDeviceConfig), in stripe order, packed
+  // back-to-back.
+  //
+  PackedBytes stripe_uuids;
+
+  // byte 40 +++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // Must be zero for now.
+  //
+  little_u8 reserved_[24];
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  usize stripe_count() const
+  {
+    return this->stripe_uuids.size() / sizeof(boost::uuids::uuid);
+  }
+
+  boost::uuids::uuid stripe_uuid(usize stripe_i) const
+  {
+    BATT_CHECK_LT(stripe_i, this->stripe_count());
+
+    boost::uuids::uuid uuid;
+    std::memcpy(&uuid, static_cast<const u8*>(this->stripe_uuids.data()) + stripe_i * sizeof(uuid),
+                sizeof(uuid));
+    return uuid;
+  }
+};
+
+BATT_STATIC_ASSERT_EQ(sizeof(PackedStripedLogConfig), PackedStripedLogConfig::kSize);
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+
+template <>
+struct PackedConfigTagFor<PackedStripedLogConfig> {
+  static constexpr u32 value = PackedConfigSlot::Tag::kStripedLog;
+};
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+
+std::ostream& operator<<(std::ostream& out, const PackedStripedLogConfig& t);
+
+}  // namespace llfs
+
+#endif  // LLFS_STRIPED_LOG_CONFIG_HPP
@@ -0,0 +1,346 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/striped_log_config.hpp>
+//
+#include <llfs/striped_log_config.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/constants.hpp>
+#include <llfs/ioring.hpp>
+#include <llfs/storage_context.hpp>
+
+#include <batteries/async/runtime.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace llfs::int_types;
+using namespace llfs::constants;
+
+using llfs::LogDevice;
+using llfs::LogReadMode;
+using llfs::slot_offset_type;
+using llfs::SlotRange;
+using llfs::StatusOr;
+
+const std::filesystem::path kStorageFilePath{"/tmp/llfs_striped_log_config_test_file"};
+
+constexpr usize kStripeCount = 3;
+constexpr usize kStripeSize = 16 * kKiB;
+constexpr u16 kPagesPerBlockLog2 = 1;
+constexpr usize kChunkSize = 1000;
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+//
+class StripedLogConfigTest : public ::testing::Test
+{
+ public:
+  void SetUp() override
+  {
+    llfs::delete_file(kStorageFilePath.string()).IgnoreError();
+
+    StatusOr<llfs::ScopedIoRing> io =
+        llfs::ScopedIoRing::make_new(llfs::MaxQueueDepth{256}, llfs::ThreadPoolSize{1});
+    ASSERT_TRUE(io.ok()) << BATT_INSPECT(io.status());
+
+    this->ioring_ = std::move(*io);
+
+    this->storage_context_ = batt::make_shared<llfs::StorageContext>(
+        batt::Runtime::instance().default_scheduler(), this->ioring_.get_io_ring());
+
+    llfs::Status file_create_status = this->storage_context_->add_new_file(
+        kStorageFilePath.string(), [&](llfs::StorageFileBuilder& builder) -> llfs::Status {
+          StatusOr<llfs::FileOffsetPtr<const llfs::PackedStripedLogConfig&>> p_config =
+              builder.add_object(llfs::StripedLogConfigOptions{
+                  .uuid = llfs::None,
+                  .stripe_count = kStripeCount,
+                  .stripe_size = kStripeSize,
+                  .pages_per_block_log2 = kPagesPerBlockLog2,
+                  .chunk_size = kChunkSize,
+              });
+
+          BATT_REQUIRE_OK(p_config);
+
+          this->log_uuid_ = (*p_config)->uuid;
+          for (usize i = 0; i < (*p_config)->stripe_count(); ++i) {
+            this->stripe_uuids_.emplace_back((*p_config)->stripe_uuid(i));
+          }
+
+          return llfs::OkStatus();
+        });
+
+    ASSERT_TRUE(file_create_status.ok()) << BATT_INSPECT(file_create_status);
+    ASSERT_EQ(this->stripe_uuids_.size(), kStripeCount);
+  }
+
+  void TearDown() override
+  {
+    llfs::delete_file(kStorageFilePath.string()).IgnoreError();
+  }
+
+  // Opens (or re-opens) the striped log, checking that the recovered contents are a prefix of
+  // `expected_` and truncating `expected_` to match.
+  //
+  std::unique_ptr<LogDevice> open_log()
+  {
+    StatusOr<std::unique_ptr<llfs::StripedLogDeviceFactory>> factory =
+        this->storage_context_->recover_object(batt::StaticType<llfs::PackedStripedLogConfig>{},
+                                               this->log_uuid_, this->log_options());
+
+    EXPECT_TRUE(factory.ok()) << BATT_INSPECT(factory.status());
+    if (!factory.ok()) {
+      return nullptr;
+    }
+
+    StatusOr<std::unique_ptr<LogDevice>> device = (*factory)->open_log_device(
+        [this](LogDevice::Reader& reader) -> StatusOr<slot_offset_type> {
+          const llfs::ConstBuffer data = reader.data();
+          const slot_offset_type end = reader.slot_offset() + data.size();
+
+          EXPECT_LE(end, this->expected_.size());
+          EXPECT_EQ(std::string_view(static_cast<const char*>(data.data()), data.size()),
+                    std::string_view{this->expected_}.substr(reader.slot_offset(), data.size()));
+
+          this->expected_.resize(end);
+
+          return end;
+        });
+
+    EXPECT_TRUE(device.ok()) << BATT_INSPECT(device.status());
+    if (!device.ok()) {
+      return nullptr;
+    }
+    return std::move(*device);
+  }
+
+  // Opens the IoRing log device of one stripe by itself.  If `truncate_by` is non-zero, the stripe
+  // loses that many bytes from the end of its data, as though they had not been flushed before a
+  // crash.
+  //
+  std::unique_ptr<LogDevice> open_stripe(usize stripe_i, usize truncate_by = 0)
+  {
+    StatusOr<std::unique_ptr<llfs::IoRingLogDeviceFactory>> factory =
+        this->storage_context_->recover_object(batt::StaticType<llfs::PackedLogDeviceConfig>{},
+                                               this->stripe_uuids_[stripe_i],
+                                               this->log_options().set_raw_data(true));
+
+    EXPECT_TRUE(factory.ok()) << BATT_INSPECT(factory.status());
+    if (!factory.ok()) {
+      return nullptr;
+    }
+
+    StatusOr<std::unique_ptr<LogDevice>> device = (*factory)->open_log_device(
+        [truncate_by](LogDevice::Reader& reader) -> StatusOr<slot_offset_type> {
+          return reader.slot_offset() + reader.data().size() - truncate_by;
+        });
+
+    EXPECT_TRUE(device.ok()) << BATT_INSPECT(device.status());
+    if (!device.ok()) {
+      return nullptr;
+    }
+    return std::move(*device);
+  }
+
+  llfs::IoRingLogDriverOptions log_options() const
+  {
+    return llfs::IoRingLogDriverOptions::with_default_values().set_name("test_log").set_queue_depth(
+        2);
+  }
+
+  // Appends `byte_count` bytes to `log` and waits for them to be flushed.  If `data` is empty,
+  // random bytes are appended to the logical log (and `expected_`).
+  //
+  void append(LogDevice& log, usize byte_count, std::string data = {})
+  {
+    const bool logical = data.empty();
+    if (logical) {
+      data.resize(byte_count);
+      for (char& ch : data) {
+        ch = static_cast<char>(this->rng_());
+      }
+    }
+
+    LogDevice::Writer& writer = log.writer();
+
+    StatusOr<llfs::MutableBuffer> buffer = writer.prepare(byte_count);
+    ASSERT_TRUE(buffer.ok()) << BATT_INSPECT(buffer.status());
+
+    std::memcpy(buffer->data(), data.data(), byte_count);
+
+    StatusOr<slot_offset_type> commit_pos = writer.commit(byte_count);
+    ASSERT_TRUE(commit_pos.ok()) << BATT_INSPECT(commit_pos.status());
+
+    ASSERT_TRUE(log.flush().ok());
+
+    if (logical) {
+      this->expected_ += data;
+      EXPECT_EQ(*commit_pos, this->expected_.size());
+    }
+  }
+
+  // Reopens the log, appends some new data, and reopens it again to check that nothing written
+  // before or after recovery was lost.
+  //
+  void verify_append_after_recovery()
+  {
+    {
+      std::unique_ptr<LogDevice> log = this->open_log();
+      ASSERT_NE(log, nullptr);
+
+      ASSERT_NO_FATAL_FAILURE(this->append(*log, 5 * kChunkSize + 321));
+    }
+
+    const usize expected_size = this->expected_.size();
+
+    std::unique_ptr<LogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, expected_size}));
+  }
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  llfs::ScopedIoRing ioring_;
+
+  batt::SharedPtr<llfs::StorageContext> storage_context_;
+
+  boost::uuids::uuid log_uuid_;
+
+  std::vector<boost::uuids::uuid> stripe_uuids_;
+
+  const llfs::StripedLogLayout layout_{.stripe_count = kStripeCount, .chunk_size = kChunkSize};
+
+  std::default_random_engine rng_{1};
+
+  // The logical log contents, starting at offset 0.
+  //
+  std::string expected_;
+};
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+TEST_F(StripedLogConfigTest, WriteReopenRead)
+{
+  {
+    std::unique_ptr<LogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, 0}));
+
+    ASSERT_NO_FATAL_FAILURE(this->append(*log, 7 * kChunkSize + 500));
+  }
+
+  ASSERT_NO_FATAL_FAILURE(this->verify_append_after_recovery());
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Simulate a crash after one stripe flushed data that never became durable on the stripes before
+// it; that data must be discarded on recovery (on disk, not just in memory), so that new data isn't
+// written after it.
+//
+TEST_F(StripedLogConfigTest, StripeAheadOfOthers)
+{
+  constexpr usize kInitialSize = 2 * kChunkSize + kChunkSize / 2;
+  {
+    std::unique_ptr<LogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    ASSERT_NO_FATAL_FAILURE(this->append(*log, kInitialSize));
+  }
+  {
+    std::unique_ptr<LogDevice> stripe = this->open_stripe(0);
+    ASSERT_NE(stripe, nullptr);
+
+    EXPECT_EQ(stripe->slot_range(LogReadMode::kDurable).upper_bound, kChunkSize);
+
+    ASSERT_NO_FATAL_FAILURE(
+        this->append(*stripe, kChunkSize / 2, std::string(kChunkSize / 2, 'X')));
+  }
+  {
+    std::unique_ptr<LogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, kInitialSize}));
+  }
+
+  // The stripe was truncated on disk by the open above, even though nothing new was written.
+  //
+  for (usize i = 0; i < kStripeCount; ++i) {
+    std::unique_ptr<LogDevice> stripe = this->open_stripe(i);
+    ASSERT_NE(stripe, nullptr);
+
+    EXPECT_EQ(stripe->slot_range(LogReadMode::kDurable).upper_bound,
+              this->layout_.stripe_offset_for(i, kInitialSize))
+        << BATT_INSPECT(i);
+  }
+
+  ASSERT_NO_FATAL_FAILURE(this->verify_append_after_recovery());
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Simulate a crash in which one stripe lost the tail of its data; the stripes after it are left
+// longer than the recovered log and must be truncated to match.
+//
+TEST_F(StripedLogConfigTest, StripeBehindOthers)
+{
+  {
+    std::unique_ptr<LogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    ASSERT_NO_FATAL_FAILURE(this->append(*log, 8 * kChunkSize + 700));
+  }
+
+  constexpr usize kLostSize = 1200;
+
+  slot_offset_type stripe_1_end = 0;
+  {
+    std::unique_ptr<LogDevice> stripe = this->open_stripe(1, kLostSize);
+    ASSERT_NE(stripe, nullptr);
+
+    stripe_1_end = stripe->slot_range(LogReadMode::kDurable).upper_bound;
+  }
+  {
+    // Truncation of an IoRing log must survive reopening it without writing anything new.
+    //
+    std::unique_ptr<LogDevice> stripe = this->open_stripe(1);
+    ASSERT_NE(stripe, nullptr);
+
+    EXPECT_EQ(stripe->slot_range(LogReadMode::kDurable).upper_bound, stripe_1_end);
+  }
+
+  const slot_offset_type expected_end = this->layout_.logical_offset_of(1, stripe_1_end);
+  ASSERT_LT(expected_end, this->expected_.size());
+  {
+    std::unique_ptr<LogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, expected_end}));
+  }
+
+  for (usize i = 0; i < kStripeCount; ++i) {
+    std::unique_ptr<LogDevice> stripe = this->open_stripe(i);
+    ASSERT_NE(stripe, nullptr);
+
+    EXPECT_EQ(stripe->slot_range(LogReadMode::kDurable).upper_bound,
+              this->layout_.stripe_offset_for(i, expected_end))
+        << BATT_INSPECT(i);
+  }
+
+  ASSERT_NO_FATAL_FAILURE(this->verify_append_after_recovery());
+}
+
+}  // namespace
@@ -0,0 +1,531 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/striped_log_driver.hpp>
+//
+
+#include <llfs/logging.hpp>
+#include <llfs/status_code.hpp>
+#include <llfs/system_config.hpp>
+
+#include <batteries/small_vec.hpp>
+#include <batteries/stream_util.hpp>
+
+#include <cstring>
+#include <limits>
+
+namespace llfs {
+
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+// class StripedLogDriver
+//
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ StripedLogDriver::StripedLogDriver(LogStorageDriverContext& context,
+                                                const StripedLogLayout& layout,
+                                                batt::TaskScheduler& scheduler) noexcept
+    : context_{context}
+    , layout_{layout}
+    , scheduler_{scheduler}
+{
+  BATT_CHECK_GT(this->layout_.stripe_count, 0u);
+  BATT_CHECK_GT(this->layout_.chunk_size, 0u);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StripedLogDriver::~StripedLogDriver() noexcept
+{
+  this->close().IgnoreError();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status StripedLogDriver::set_trim_pos(slot_offset_type trim_pos)
+{
+  for (usize stripe_i = 0; stripe_i < this->stripes_.size(); ++stripe_i) {
+    Status status = this->stripes_[stripe_i]->device->trim(
+        this->layout_.stripe_offset_for(stripe_i, trim_pos));
+    BATT_REQUIRE_OK(status);
+  }
+
+  this->trim_pos_.set_value(trim_pos);
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+slot_offset_type StripedLogDriver::get_trim_pos() const
+{
+  return this->trim_pos_.get_value();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<slot_offset_type> StripedLogDriver::await_trim_pos(slot_offset_type min_offset)
+{
+  return await_slot_offset(min_offset, this->trim_pos_);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+slot_offset_type StripedLogDriver::get_flush_pos() const
+{
+  return this->flush_pos_.get_value();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<slot_offset_type> StripedLogDriver::await_flush_pos(slot_offset_type min_offset)
+{
+  return await_slot_offset(min_offset, this->flush_pos_);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status StripedLogDriver::set_commit_pos(slot_offset_type commit_pos)
+{
+  const slot_offset_type prior_commit_pos = this->commit_pos_.get_value();
+
+  BATT_CHECK(!slot_less_than(commit_pos, prior_commit_pos));
+  BATT_CHECK_EQ(this->stripes_.size(), this->layout_.stripe_count);
+
+  if (commit_pos == prior_commit_pos) {
+    return OkStatus();
+  }
+
+  // Reserve space on each stripe for its share of the new data.  A single commit touches each
+  // stripe at most once, since a stripe's chunks are contiguous in its own offset space.
+  //
+  batt::SmallVec<MutableBuffer, 8> stripe_buffers;
+  for (usize stripe_i = 0; stripe_i < this->stripes_.size(); ++stripe_i) {
+    const usize byte_count = this->layout_.stripe_offset_for(stripe_i, commit_pos) -
+                             this->layout_.stripe_offset_for(stripe_i, prior_commit_pos);
+    if (byte_count == 0) {
+      stripe_buffers.emplace_back();
+      continue;
+    }
+
+    StatusOr<MutableBuffer> buffer =
+        this->stripes_[stripe_i]->device->writer().prepare(byte_count);
+    BATT_REQUIRE_OK(buffer);
+
+    stripe_buffers.emplace_back(*buffer);
+  }
+
+  // Copy the new data out of the ring buffer, one chunk (or partial chunk) at a time.
+  //
+  const ConstBuffer src = this->context_.buffer_.get(prior_commit_pos);
+  {
+    slot_offset_type pos = prior_commit_pos;
+    while (pos != commit_pos) {
+      const usize stripe_i = this->layout_.stripe_of(pos);
+      const usize n_to_copy = std::min<u64>(
+          this->layout_.chunk_size - pos % this->layout_.chunk_size, commit_pos - pos);
+      const usize dst_offset = this->layout_.stripe_offset_for(stripe_i, pos) -
+                               this->layout_.stripe_offset_for(stripe_i, prior_commit_pos);
+
+      std::memcpy(static_cast<u8*>(stripe_buffers[stripe_i].data()) + dst_offset,
+                  static_cast<const u8*>(src.data()) + (pos - prior_commit_pos), n_to_copy);
+
+      pos += n_to_copy;
+    }
+  }
+
+  for (usize stripe_i = 0; stripe_i < this->stripes_.size(); ++stripe_i) {
+    if (stripe_buffers[stripe_i].size() == 0) {
+      continue;
+    }
+    StatusOr<slot_offset_type> stripe_commit_pos =
+        this->stripes_[stripe_i]->device->writer().commit(stripe_buffers[stripe_i].size());
+    BATT_REQUIRE_OK(stripe_commit_pos);
+  }
+
+  // Update the logical commit pos *before* waking up the stripe flush tasks, so that when they
+  // recalculate the logical flush pos they always see the new commit pos.
+  //
+  this->commit_pos_.set_value(commit_pos);
+
+  for (usize stripe_i = 0; stripe_i < this->stripes_.size(); ++stripe_i) {
+    if (stripe_buffers[stripe_i].size() != 0) {
+      this->stripes_[stripe_i]->commit_pos.set_value(
+          this->layout_.stripe_offset_for(stripe_i, commit_pos));
+    }
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+slot_offset_type StripedLogDriver::get_commit_pos() const
+{
+  return this->commit_pos_.get_value();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<slot_offset_type> StripedLogDriver::await_commit_pos(slot_offset_type min_offset)
+{
+  return await_slot_offset(min_offset, this->commit_pos_);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status StripedLogDriver::open()
+{
+  BATT_CHECK_EQ(this->stripes_.size(), this->layout_.stripe_count)
+      << "attach_stripes must be called before open";
+
+  for (usize stripe_i = 0; stripe_i < this->stripes_.size(); ++stripe_i) {
+    Stripe& stripe = *this->stripes_[stripe_i];
+
+    BATT_CHECK(!stripe.flush_task);
+    stripe.flush_task.emplace(
+        this->scheduler_.schedule_task(),
+        [this, stripe_i] {
+          this->flush_task_main(stripe_i);
+        },
+        batt::to_string("StripedLogDriver::flush_task[", stripe_i, "]"));
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status StripedLogDriver::close()
+{
+  this->trim_pos_.close();
+  this->flush_pos_.close();
+  this->commit_pos_.close();
+
+  for (const std::unique_ptr<Stripe>& stripe : this->stripes_) {
+    stripe->commit_pos.close();
+    stripe->flush_pos.close();
+    stripe->device->close().IgnoreError();
+  }
+
+  for (const std::unique_ptr<Stripe>& stripe : this->stripes_) {
+    if (stripe->flush_task) {
+      stripe->flush_task->join();
+      stripe->flush_task = None;
+    }
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status StripedLogDriver::recover_from(const std::vector<LogDevice::Reader*>& stripe_readers)
+{
+  BATT_CHECK_EQ(stripe_readers.size(), this->layout_.stripe_count);
+
+  // Each stripe bounds the recoverable range from both ends: below, by the data it has trimmed;
+  // above, by the end of its durable data.  Stripes are trimmed and flushed independently, so they
+  // can disagree by up to a chunk or so (or more, if one stripe flushed far ahead of the others
+  // before a crash).
+  //
+  u64 lower_bound = 0;
+  u64 upper_bound = std::numeric_limits<u64>::max();
+
+  for (usize stripe_i = 0; stripe_i < stripe_readers.size(); ++stripe_i) {
+    LogDevice::Reader& reader = *stripe_readers[stripe_i];
+
+    const slot_offset_type stripe_begin = reader.slot_offset();
+    const slot_offset_type stripe_end = stripe_begin + reader.data().size();
+
+    if (stripe_begin != 0) {
+      lower_bound = std::max<u64>(
+          lower_bound, this->layout_.logical_offset_of(stripe_i, stripe_begin - 1) + 1);
+    }
+    upper_bound = std::min<u64>(upper_bound, this->layout_.logical_offset_of(stripe_i, stripe_end));
+  }
+
+  LLFS_VLOG(1) << "StripedLogDriver::recover_from" << BATT_INSPECT(lower_bound)
+               << BATT_INSPECT(upper_bound);
+
+  if (upper_bound < lower_bound || upper_bound - lower_bound > this->context_.buffer_.size()) {
+    return make_status(StatusCode::kStripedLogInconsistent);
+  }
+
+  // Reassemble the logical log in the ring buffer.
+  //
+  const MutableBuffer dst = this->context_.buffer_.get_mut(lower_bound);
+
+  for (u64 pos = lower_bound; pos != upper_bound;) {
+    const usize stripe_i = this->layout_.stripe_of(pos);
+    const usize n_to_copy =
+        std::min<u64>(this->layout_.chunk_size - pos % this->layout_.chunk_size, upper_bound - pos);
+
+    LogDevice::Reader& reader = *stripe_readers[stripe_i];
+    const usize src_offset = this->layout_.stripe_offset_for(stripe_i, pos) - reader.slot_offset();
+
+    std::memcpy(static_cast<u8*>(dst.data()) + (pos - lower_bound),
+                static_cast<const u8*>(reader.data().data()) + src_offset, n_to_copy);
+
+    pos += n_to_copy;
+  }
+
+  this->trim_pos_.set_value(lower_bound);
+  this->commit_pos_.set_value(upper_bound);
+  this->flush_pos_.set_value(upper_bound);
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status StripedLogDriver::attach_stripes(std::vector<std::unique_ptr<LogDevice>>&& stripe_devices)
+{
+  BATT_CHECK(this->stripes_.empty());
+  BATT_CHECK_EQ(stripe_devices.size(), this->layout_.stripe_count);
+
+  const slot_offset_type commit_pos = this->commit_pos_.get_value();
+
+  for (usize stripe_i = 0; stripe_i < stripe_devices.size(); ++stripe_i) {
+    const slot_offset_type expected_pos = this->layout_.stripe_offset_for(stripe_i, commit_pos);
+    const SlotRange stripe_range = stripe_devices[stripe_i]->slot_range(LogReadMode::kSpeculative);
+
+    // If a stripe factory ignored the truncate point, new chunks would land after stale data and
+    // the layout would no longer describe the stripe's contents.  (Stripes that flushed ahead of
+    // the others before a crash are truncated by their factories, so this only catches factories
+    // that don't support truncation.)
+    //
+    if (stripe_range.upper_bound != expected_pos) {
+      LLFS_LOG_WARNING() << "StripedLogDriver: stripe " << stripe_i << " was not truncated;"
+                         << BATT_INSPECT(stripe_range) << BATT_INSPECT(expected_pos);
+      return make_status(StatusCode::kStripedLogInconsistent);
+    }
+
+    this->stripes_.emplace_back(
+        std::make_unique<Stripe>(std::move(stripe_devices[stripe_i]), expected_pos));
+  }
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void StripedLogDriver::truncate(slot_offset_type truncate_pos)
+{
+  this->commit_pos_.set_value(truncate_pos);
+  this->flush_pos_.set_value(truncate_pos);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void StripedLogDriver::flush_task_main(usize stripe_i)
+{
+  Stripe& stripe = *this->stripes_[stripe_i];
+
+  Status status = [&]() -> Status {
+    for (;;) {
+      const slot_offset_type flushed_pos = stripe.flush_pos.get_value();
+
+      StatusOr<slot_offset_type> target_pos =
+          stripe.commit_pos.await_true([flushed_pos](slot_offset_type commit_pos) {
+            return slot_less_than(flushed_pos, commit_pos);
+          });
+      BATT_REQUIRE_OK(target_pos);
+
+      Status sync_status =
+          stripe.device->sync(LogReadMode::kDurable, SlotUpperBoundAt{.offset = *target_pos});
+      BATT_REQUIRE_OK(sync_status);
+
+      stripe.flush_pos.set_value(*target_pos);
+      this->update_flush_pos();
+    }
+  }();
+
+  LLFS_VLOG(1) << "StripedLogDriver::flush_task_main exited;" << BATT_INSPECT(stripe_i)
+               << BATT_INSPECT(status);
+
+  // Nothing past this stripe's flush pos can ever become durable now; wake up anyone waiting for
+  // it rather than leaving them blocked.
+  //
+  this->flush_pos_.close();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void StripedLogDriver::update_flush_pos()
+{
+  slot_offset_type flush_pos = this->commit_pos_.get_value();
+
+  for (usize stripe_i = 0; stripe_i < this->stripes_.size(); ++stripe_i) {
+    flush_pos = slot_min(flush_pos, this->layout_.logical_offset_of(
+                                        stripe_i, this->stripes_[stripe_i]->flush_pos.get_value()));
+  }
+
+  // Flush tasks may race to update the flush pos; each computes a valid lower bound, so take the
+  // max.
+  //
+  clamp_min_slot(this->flush_pos_, flush_pos);
+}
+
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+// class StripedLogDeviceFactory
+//
+
+struct StripedLogDeviceFactory::Recovery {
+  const LogScanFn& scan_fn;
+
+  // The recovery-mode reader for each stripe; all are live while the innermost stripe is open.
+  //
+  std::vector<LogDevice::Reader*> stripe_readers;
+
+  std::vector<std::unique_ptr<LogDevice>> stripe_devices;
+
+  std::unique_ptr<StripedLogDevice> device;
+
+  slot_offset_type truncate_pos = 0;
+};
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ u64 StripedLogDeviceFactory::logical_capacity(const StripedLogLayout& layout,
+                                                         u64 stripe_capacity)
+{
+  BATT_CHECK_GT(stripe_capacity, layout.chunk_size);
+
+  return round_down_to_page_size_multiple(layout.stripe_count *
+                                          (stripe_capacity - layout.chunk_size));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ StripedLogDeviceFactory::StripedLogDeviceFactory(
+    std::vector<LogDeviceFactory*>&& stripe_factories, u64 stripe_capacity,
+    batt::TaskScheduler& scheduler, usize chunk_size) noexcept
+    : stripe_factories_{std::move(stripe_factories)}
+    , stripe_capacity_{stripe_capacity}
+    , scheduler_{scheduler}
+    , layout_{
+          .stripe_count = this->stripe_factories_.size(),
+          .chunk_size = chunk_size,
+      }
+{
+  BATT_CHECK(!this->stripe_factories_.empty());
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ StripedLogDeviceFactory::StripedLogDeviceFactory(
+    std::vector<std::unique_ptr<LogDeviceFactory>>&& owned_stripe_factories, u64 stripe_capacity,
+    batt::TaskScheduler& scheduler, usize chunk_size) noexcept
+    : StripedLogDeviceFactory{[&owned_stripe_factories] {
+                                std::vector<LogDeviceFactory*> stripe_factories;
+                                for (const auto& factory : owned_stripe_factories) {
+                                  stripe_factories.emplace_back(factory.get());
+                                }
+                                return stripe_factories;
+                              }(),
+                              stripe_capacity, scheduler, chunk_size}
+{
+  this->owned_stripe_factories_ = std::move(owned_stripe_factories);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::unique_ptr<StripedLogDevice>> StripedLogDeviceFactory::open_striped_log_device(
+    const LogScanFn& scan_fn)
+{
+  Recovery recovery{
+      .scan_fn = scan_fn,
+      .stripe_readers = std::vector<LogDevice::Reader*>(this->layout_.stripe_count, nullptr),
+      .stripe_devices = std::vector<std::unique_ptr<LogDevice>>(this->layout_.stripe_count),
+      .device = nullptr,
+      .truncate_pos = 0,
+  };
+
+  BATT_REQUIRE_OK(this->open_stripes_from(0, recovery));
+
+  for (const std::unique_ptr<LogDevice>& stripe_device : recovery.stripe_devices) {
+    if (stripe_device->capacity() < this->stripe_capacity_) {
+      return make_status(StatusCode::kStripedLogInconsistent);
+    }
+  }
+
+  Status attach_status =
+      recovery.device->driver().impl().attach_stripes(std::move(recovery.stripe_devices));
+  BATT_REQUIRE_OK(attach_status);
+
+  Status open_status = recovery.device->open();
+  BATT_REQUIRE_OK(open_status);
+
+  return {std::move(recovery.device)};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::unique_ptr<LogDevice>> StripedLogDeviceFactory::open_log_device(
+    const LogScanFn& scan_fn) /*override*/
+{
+  StatusOr<std::unique_ptr<StripedLogDevice>> device = this->open_striped_log_device(scan_fn);
+  BATT_REQUIRE_OK(device);
+
+  return std::unique_ptr<LogDevice>{std::move(*device)};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status StripedLogDeviceFactory::open_stripes_from(usize stripe_i, Recovery& recovery)
+{
+  if (stripe_i == this->layout_.stripe_count) {
+    recovery.device = std::make_unique<StripedLogDevice>(
+        RingBuffer::TempFile{
+            .byte_size = StripedLogDeviceFactory::logical_capacity(this->layout_,
+                                                                   this->stripe_capacity_),
+        },
+        this->layout_, this->scheduler_);
+
+    StripedLogDriver& driver = recovery.device->driver().impl();
+
+    Status recover_status = driver.recover_from(recovery.stripe_readers);
+    BATT_REQUIRE_OK(recover_status);
+
+    StatusOr<slot_offset_type> scan_status = recovery.scan_fn(
+        *recovery.device->new_reader(/*slot_lower_bound=*/None, LogReadMode::kDurable));
+    BATT_REQUIRE_OK(scan_status);
+
+    BATT_CHECK(!slot_less_than(*scan_status, driver.get_trim_pos()) &&
+               !slot_less_than(driver.get_commit_pos(), *scan_status))
+        << "the truncate point must be within the recovered log;" << BATT_INSPECT(*scan_status)
+        << BATT_INSPECT(driver.get_trim_pos()) << BATT_INSPECT(driver.get_commit_pos());
+
+    // Truncate the log at the indicated point.
+    //
+    this->truncate(driver, *scan_status);
+    recovery.truncate_pos = *scan_status;
+
+    return OkStatus();
+  }
+
+  StatusOr<std::unique_ptr<LogDevice>> stripe_device =
+      this->stripe_factories_[stripe_i]->open_log_device(
+          [&](LogDevice::Reader& stripe_reader) -> StatusOr<slot_offset_type> {
+            recovery.stripe_readers[stripe_i] = &stripe_reader;
+
+            Status status = this->open_stripes_from(stripe_i + 1, recovery);
+            recovery.stripe_readers[stripe_i] = nullptr;
+            BATT_REQUIRE_OK(status);
+
+            return this->layout_.stripe_offset_for(stripe_i, recovery.truncate_pos);
+          });
+  BATT_REQUIRE_OK(stripe_device);
+
+  recovery.stripe_devices[stripe_i] = std::move(*stripe_device);
+
+  return OkStatus();
+}
+
+}  // namespace llfs
@@ -0,0 +1,261 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_STRIPED_LOG_DRIVER_HPP
+#define LLFS_STRIPED_LOG_DRIVER_HPP
+
+#include <llfs/basic_log_storage_driver.hpp>
+#include <llfs/basic_ring_buffer_log_device.hpp>
+#include <llfs/config.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/log_device.hpp>
+#include <llfs/optional.hpp>
+#include <llfs/slot.hpp>
+#include <llfs/status.hpp>
+
+#include <batteries/async/task.hpp>
+#include <batteries/async/task_scheduler.hpp>
+#include <batteries/async/watch.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace llfs {
+
+class StripedLogDriver;
+class StripedLogDeviceFactory;
+
+using StripedLogDevice = BasicRingBufferLogDevice<StripedLogDriver>;
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief Maps logical log offsets to (stripe, stripe offset) pairs.
+ *
+ * The logical log is divided into fixed-size chunks, which are dealt round-robin to the stripes:
+ * chunk `k` is stored on stripe `k % stripe_count`.  Each stripe holds its chunks back-to-back, so
+ * its own slot offsets are a pure function of the logical offset.
+ */
+struct StripedLogLayout {
+  usize stripe_count;
+  usize chunk_size;
+
+  /** \brief Returns the index of the stripe that stores the byte at `logical_offset`.
+   */
+  usize stripe_of(u64 logical_offset) const
+  {
+    return (logical_offset / this->chunk_size) % this->stripe_count;
+  }
+
+  /** \brief Returns the number of bytes on stripe `stripe_i` that come before `logical_offset`;
+   * this is also the stripe offset of the first byte on `stripe_i` at or after `logical_offset`.
+   */
+  u64 stripe_offset_for(usize stripe_i, u64 logical_offset) const
+  {
+    const u64 round_size = this->chunk_size * this->stripe_count;
+    const u64 round_count = logical_offset / round_size;
+    const u64 round_offset = logical_offset % round_size;
+    const u64 chunk_begin = stripe_i * this->chunk_size;
+
+    u64 partial = 0;
+    if (round_offset > chunk_begin) {
+      partial = std::min<u64>(round_offset - chunk_begin, this->chunk_size);
+    }
+    return round_count * this->chunk_size + partial;
+  }
+
+  /** \brief Returns the logical offset of the byte at `stripe_offset` on stripe `stripe_i`.
+   */
+  u64 logical_offset_of(usize stripe_i, u64 stripe_offset) const
+  {
+    const u64 chunk_i = stripe_offset / this->chunk_size;
+
+    return (chunk_i * this->stripe_count + stripe_i) * this->chunk_size +
+           stripe_offset % this->chunk_size;
+  }
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief Log storage driver that spreads a single logical log across several LogDevices
+ * ("stripes").
+ *
+ * The full logical log is buffered in the ring buffer, so readers see one contiguous slot order.
+ * Each commit is copied out to the stripe devices according to StripedLogLayout, and every stripe
+ * is flushed independently by its own background task.  The logical flush pos is the lowest
+ * logical offset not yet durable on its stripe, so slots on different devices become durable in
+ * parallel while the log as a whole stays prefix-durable.
+ *
+ * Stripe devices must be created empty, together, and always be opened in the same order with the
+ * same layout.  See StripedLogDeviceFactory.
+ */
+class StripedLogDriver
+{
+ public:
+  explicit StripedLogDriver(LogStorageDriverContext& context, const StripedLogLayout& layout,
+                            batt::TaskScheduler& scheduler) noexcept;
+
+  ~StripedLogDriver() noexcept;
+
+  StripedLogDriver(const StripedLogDriver&) = delete;
+  StripedLogDriver& operator=(const StripedLogDriver&) = delete;
+
+  const StripedLogLayout& layout() const
+  {
+    return this->layout_;
+  }
+
+  //----
+
+  Status set_trim_pos(slot_offset_type trim_pos);
+
+  slot_offset_type get_trim_pos() const;
+
+  StatusOr<slot_offset_type> await_trim_pos(slot_offset_type min_offset);
+
+  //----
+
+  slot_offset_type get_flush_pos() const;
+
+  StatusOr<slot_offset_type> await_flush_pos(slot_offset_type min_offset);
+
+  //----
+
+  Status set_commit_pos(slot_offset_type commit_pos);
+
+  slot_offset_type get_commit_pos() const;
+
+  StatusOr<slot_offset_type> await_commit_pos(slot_offset_type min_offset);
+
+  //----
+
+  Status open();
+
+  Status close();
+
+ private:
+  friend class LogTruncateAccess;
+  friend class StripedLogDeviceFactory;
+
+  struct Stripe {
+    explicit Stripe(std::unique_ptr<LogDevice>&& device_arg, slot_offset_type pos) noexcept
+        : device{std::move(device_arg)}
+        , commit_pos{pos}
+        , flush_pos{pos}
+    {
+    }
+
+    // The log device that stores this stripe's chunks.
+    //
+    std::unique_ptr<LogDevice> device;
+
+    // The upper bound of data committed to/flushed from `device`, in stripe offsets.
+    //
+    batt::Watch<slot_offset_type> commit_pos;
+    batt::Watch<slot_offset_type> flush_pos;
+
+    // Flushes `device` up to `commit_pos` whenever it advances.
+    //
+    Optional<batt::Task> flush_task;
+  };
+
+  // Loads the logical log from the stripe readers passed to a StripedLogDeviceFactory scan; the
+  // recovered range is the longest one that every stripe has durable data for.
+  //
+  Status recover_from(const std::vector<LogDevice::Reader*>& stripe_readers);
+
+  // Takes ownership of the stripe devices; they must already be truncated to match the current
+  // commit pos.  Must be called before `open()`.
+  //
+  Status attach_stripes(std::vector<std::unique_ptr<LogDevice>>&& stripe_devices);
+
+  void truncate(slot_offset_type truncate_pos);
+
+  void flush_task_main(usize stripe_i);
+
+  void update_flush_pos();
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // The ring buffer state.
+  //
+  LogStorageDriverContext& context_;
+
+  // How logical offsets are assigned to stripes.
+  //
+  const StripedLogLayout layout_;
+
+  // Scheduler used to launch the per-stripe flush tasks.
+  //
+  batt::TaskScheduler& scheduler_;
+
+  std::vector<std::unique_ptr<Stripe>> stripes_;
+
+  // Logical log offset pointers.
+  //
+  batt::Watch<slot_offset_type> trim_pos_{0};
+  batt::Watch<slot_offset_type> flush_pos_{0};
+  batt::Watch<slot_offset_type> commit_pos_{0};
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief Opens a StripedLogDevice on top of one factory per stripe.
+ *
+ * All stripe devices are held open in recovery mode at once so that the longest logical prefix
+ * present on every stripe can be reassembled before `scan_fn` runs; each stripe is then truncated
+ * to match the truncate point returned by `scan_fn`, which discards the data that stripes flushed
+ * ahead of the others before a crash.  Stripe factories must honor the truncate point, as the
+ * memory and IoRing log factories do; a stripe left longer than expected makes the open fail with
+ * StatusCode::kStripedLogInconsistent.  IoRing stripes must be opened with
+ * `IoRingLogDriverOptions::raw_data` set.
+ *
+ * To create a striped log in a storage file, see StripedLogConfigOptions.
+ */
+class StripedLogDeviceFactory : public LogDeviceFactory
+{
+ public:
+  static constexpr usize kDefaultChunkSize = 16 * kKiB;
+
+  /** \brief Returns the logical capacity of a log striped according to `layout` across devices of
+   * `stripe_capacity` bytes each.  One chunk per stripe is held back, because a stripe may have up
+   * to one more chunk in use than its fair share.
+   */
+  static u64 logical_capacity(const StripedLogLayout& layout, u64 stripe_capacity);
+
+  explicit StripedLogDeviceFactory(std::vector<LogDeviceFactory*>&& stripe_factories,
+                                   u64 stripe_capacity, batt::TaskScheduler& scheduler,
+                                   usize chunk_size = kDefaultChunkSize) noexcept;
+
+  /** \brief Creates a factory that owns its stripe factories.
+   */
+  explicit StripedLogDeviceFactory(
+      std::vector<std::unique_ptr<LogDeviceFactory>>&& owned_stripe_factories,
+      u64 stripe_capacity, batt::TaskScheduler& scheduler,
+      usize chunk_size = kDefaultChunkSize) noexcept;
+
+  StatusOr<std::unique_ptr<StripedLogDevice>> open_striped_log_device(const LogScanFn& scan_fn);
+
+  StatusOr<std::unique_ptr<LogDevice>> open_log_device(const LogScanFn& scan_fn) override;
+
+ private:
+  struct Recovery;
+
+  // Opens stripe `stripe_i` and (from inside its scan function) all stripes after it; the last one
+  // to open recovers the logical log and runs the user's scan function.
+  //
+  Status open_stripes_from(usize stripe_i, Recovery& recovery);
+
+  std::vector<std::unique_ptr<LogDeviceFactory>> owned_stripe_factories_;
+  std::vector<LogDeviceFactory*> stripe_factories_;
+  u64 stripe_capacity_;
+  batt::TaskScheduler& scheduler_;
+  StripedLogLayout layout_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_STRIPED_LOG_DRIVER_HPP
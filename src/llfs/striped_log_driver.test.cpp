@@ -0,0 +1,284 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/striped_log_driver.hpp>
+//
+#include <llfs/striped_log_driver.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/memory_log_device.hpp>
+#include <llfs/testing/fake_log_device.hpp>
+
+#include <batteries/async/runtime.hpp>
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace llfs::int_types;
+
+using llfs::testing::FakeLogDeviceFactory;
+
+using llfs::LogDevice;
+using llfs::LogReadMode;
+using llfs::MemoryLogDevice;
+using llfs::MemoryLogStorageDriver;
+using llfs::slot_offset_type;
+using llfs::SlotRange;
+using llfs::StatusOr;
+using llfs::StripedLogDevice;
+using llfs::StripedLogDeviceFactory;
+using llfs::StripedLogLayout;
+
+constexpr usize kStripeCount = 3;
+constexpr u64 kStripeCapacity = 64 * 1024;
+
+// Deliberately not a power of two, so chunk boundaries don't line up with anything else.
+//
+constexpr usize kChunkSize = 1000;
+
+TEST(StripedLogLayoutTest, OffsetMapping)
+{
+  const StripedLogLayout layout{.stripe_count = kStripeCount, .chunk_size = kChunkSize};
+
+  for (u64 logical_offset = 0; logical_offset < kChunkSize * kStripeCount * 5;
+       logical_offset += 37) {
+    const usize stripe_i = layout.stripe_of(logical_offset);
+    const u64 stripe_offset = layout.stripe_offset_for(stripe_i, logical_offset);
+
+    EXPECT_EQ(layout.logical_offset_of(stripe_i, stripe_offset), logical_offset);
+
+    // Every byte before `logical_offset` lives on exactly one stripe.
+    //
+    u64 total = 0;
+    for (usize i = 0; i < kStripeCount; ++i) {
+      total += layout.stripe_offset_for(i, logical_offset);
+    }
+    EXPECT_EQ(total, logical_offset);
+  }
+}
+
+class StripedLogDeviceTest : public ::testing::Test
+{
+ public:
+  StripedLogDeviceTest()
+  {
+    for (usize i = 0; i < kStripeCount; ++i) {
+      this->mem_logs_.emplace_back(std::make_unique<MemoryLogDevice>(kStripeCapacity));
+    }
+  }
+
+  // Opens (or re-opens) the striped log, checking that the recovered contents match `expected_`.
+  //
+  std::unique_ptr<StripedLogDevice> open_log()
+  {
+    std::vector<FakeLogDeviceFactory<MemoryLogStorageDriver>> stripe_factories;
+    std::vector<llfs::LogDeviceFactory*> stripe_factory_ptrs;
+
+    stripe_factories.reserve(kStripeCount);
+    for (const std::unique_ptr<MemoryLogDevice>& mem_log : this->mem_logs_) {
+      stripe_factories.emplace_back(*mem_log, mem_log->driver().impl(),
+                                    std::make_shared<llfs::testing::FakeLogDevice::State>());
+      stripe_factory_ptrs.emplace_back(&stripe_factories.back());
+    }
+
+    StripedLogDeviceFactory factory{std::move(stripe_factory_ptrs), kStripeCapacity,
+                                    batt::Runtime::instance().default_scheduler(), kChunkSize};
+
+    StatusOr<std::unique_ptr<StripedLogDevice>> device = factory.open_striped_log_device(
+        [this](LogDevice::Reader& reader) -> StatusOr<slot_offset_type> {
+          const llfs::ConstBuffer data = reader.data();
+          const slot_offset_type end = reader.slot_offset() + data.size();
+
+          EXPECT_LE(end, this->expected_.size());
+          EXPECT_EQ(std::string_view(static_cast<const char*>(data.data()), data.size()),
+                    std::string_view{this->expected_}.substr(reader.slot_offset(), data.size()));
+
+          // Forget anything the log lost.
+          //
+          this->expected_.resize(end);
+
+          return end;
+        });
+
+    EXPECT_TRUE(device.ok()) << BATT_INSPECT(device.status());
+    if (!device.ok()) {
+      return nullptr;
+    }
+    return std::move(*device);
+  }
+
+  // Appends `byte_count` random bytes to `log`.
+  //
+  void append(LogDevice& log, usize byte_count)
+  {
+    LogDevice::Writer& writer = log.writer();
+
+    ASSERT_EQ(writer.slot_offset(), this->expected_.size());
+
+    StatusOr<llfs::MutableBuffer> buffer = writer.prepare(byte_count);
+    ASSERT_TRUE(buffer.ok()) << BATT_INSPECT(buffer.status());
+
+    std::string data(byte_count, '\0');
+    for (char& ch : data) {
+      ch = static_cast<char>(this->rng_());
+    }
+    std::memcpy(buffer->data(), data.data(), byte_count);
+
+    StatusOr<slot_offset_type> commit_pos = writer.commit(byte_count);
+    ASSERT_TRUE(commit_pos.ok()) << BATT_INSPECT(commit_pos.status());
+
+    this->expected_ += data;
+    EXPECT_EQ(*commit_pos, this->expected_.size());
+  }
+
+  void append_random(LogDevice& log, usize total_size)
+  {
+    std::uniform_int_distribution<usize> pick_size{1, 3 * kChunkSize};
+
+    for (usize appended = 0; appended < total_size;) {
+      const usize n = std::min(pick_size(this->rng_), total_size - appended);
+      ASSERT_NO_FATAL_FAILURE(this->append(log, n));
+      appended += n;
+    }
+  }
+
+  const StripedLogLayout layout_{.stripe_count = kStripeCount, .chunk_size = kChunkSize};
+
+  std::default_random_engine rng_{1};
+
+  std::vector<std::unique_ptr<MemoryLogDevice>> mem_logs_;
+
+  // The logical log contents, starting at offset 0.
+  //
+  std::string expected_;
+};
+
+TEST_F(StripedLogDeviceTest, WriteReopenRead)
+{
+  {
+    std::unique_ptr<StripedLogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    EXPECT_EQ(log->capacity(), StripedLogDeviceFactory::logical_capacity(
+                                   this->layout_, kStripeCapacity));
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, 0}));
+
+    ASSERT_NO_FATAL_FAILURE(this->append_random(*log, 150 * 1000));
+    ASSERT_TRUE(log->flush().ok());
+
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable).upper_bound, this->expected_.size());
+
+    // Each stripe holds exactly its share of the data.
+    //
+    for (usize i = 0; i < kStripeCount; ++i) {
+      EXPECT_EQ(this->mem_logs_[i]->slot_range(LogReadMode::kDurable).upper_bound,
+                this->layout_.stripe_offset_for(i, this->expected_.size()));
+    }
+  }
+
+  const usize expected_size = this->expected_.size();
+
+  std::unique_ptr<StripedLogDevice> log = this->open_log();
+  ASSERT_NE(log, nullptr);
+
+  EXPECT_EQ(this->expected_.size(), expected_size);
+  EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, expected_size}));
+}
+
+TEST_F(StripedLogDeviceTest, TrimAndWrapAround)
+{
+  constexpr slot_offset_type kTrimPos = 100 * 1000 + 17;
+
+  {
+    std::unique_ptr<StripedLogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    ASSERT_NO_FATAL_FAILURE(this->append_random(*log, 150 * 1000));
+    ASSERT_TRUE(log->trim(kTrimPos).ok());
+
+    // Write enough after the trim to wrap around the logical ring buffer and every stripe.
+    //
+    ASSERT_NO_FATAL_FAILURE(this->append_random(*log, 120 * 1000));
+    ASSERT_TRUE(log->flush().ok());
+
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable),
+              (SlotRange{kTrimPos, this->expected_.size()}));
+  }
+
+  std::unique_ptr<StripedLogDevice> log = this->open_log();
+  ASSERT_NE(log, nullptr);
+
+  EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{kTrimPos, this->expected_.size()}));
+}
+
+TEST_F(StripedLogDeviceTest, RecoveryTruncatesToShortestStripe)
+{
+  {
+    std::unique_ptr<StripedLogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    ASSERT_NO_FATAL_FAILURE(this->append_random(*log, 50 * 1000));
+    ASSERT_TRUE(log->flush().ok());
+  }
+
+  // Simulate stripe 1 losing the tail of its data in a crash.
+  //
+  constexpr usize kLostSize = 1500;
+  {
+    FakeLogDeviceFactory<MemoryLogStorageDriver> stripe_factory{
+        *this->mem_logs_[1], this->mem_logs_[1]->driver().impl(),
+        std::make_shared<llfs::testing::FakeLogDevice::State>()};
+
+    StatusOr<std::unique_ptr<LogDevice>> stripe = stripe_factory.open_log_device(
+        [](LogDevice::Reader& reader) -> StatusOr<slot_offset_type> {
+          return reader.slot_offset() + reader.data().size() - kLostSize;
+        });
+    ASSERT_TRUE(stripe.ok());
+  }
+
+  const slot_offset_type stripe_1_end =
+      this->mem_logs_[1]->slot_range(LogReadMode::kDurable).upper_bound;
+  const slot_offset_type expected_end = this->layout_.logical_offset_of(1, stripe_1_end);
+
+  ASSERT_LT(expected_end, this->expected_.size());
+  {
+    std::unique_ptr<StripedLogDevice> log = this->open_log();
+    ASSERT_NE(log, nullptr);
+
+    EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, expected_end}));
+
+    // The other stripes must have been truncated to match.
+    //
+    for (usize i = 0; i < kStripeCount; ++i) {
+      EXPECT_EQ(this->mem_logs_[i]->slot_range(LogReadMode::kDurable).upper_bound,
+                this->layout_.stripe_offset_for(i, expected_end));
+    }
+
+    // New data goes right after the recovered end.
+    //
+    ASSERT_NO_FATAL_FAILURE(this->append_random(*log, 10 * 1000));
+    ASSERT_TRUE(log->flush().ok());
+  }
+
+  const usize expected_size = this->expected_.size();
+
+  std::unique_ptr<StripedLogDevice> log = this->open_log();
+  ASSERT_NE(log, nullptr);
+
+  EXPECT_EQ(log->slot_range(LogReadMode::kDurable), (SlotRange{0, expected_size}));
+}
+
+}  // namespace
@@ -10,6 +10,7 @@
 #ifndef LLFS_TRACE_REFS_RECURSIVE_HPP
 #define LLFS_TRACE_REFS_RECURSIVE_HPP
 
+#include <llfs/int_types.hpp>
 #include <llfs/page_id.hpp>
 #include <llfs/page_loader.hpp>
 #include <llfs/pinned_page.hpp>
@@ -19,7 +20,9 @@
 #include <batteries/utility.hpp>
 
 #include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace llfs {
@@ -61,6 +64,142 @@ inline batt::Status trace_refs_recursive(PageLoader& page_loader, IdTypePairSeq&
   return batt::OkStatus();
 }
 
+/** \brief Calls `fn(page_id)` once for each page that is reachable from `to_roots` but not from
+ * `from_roots`, without walking the parts of the two page graphs that they share.
+ *
+ * Pages are immutable and a PageId names a single generation of a physical page, so as soon as the
+ * two walks meet at the same PageId, everything below it is shared and is not loaded.  The graphs
+ * are walked breadth-first in lockstep, one level per round; every page of a round is passed to
+ * `PageLoader::prefetch_hint` before any are loaded, so their reads can proceed in parallel.  The
+ * cost is roughly proportional to the number of changed pages (and their ancestors on both sides),
+ * not to the size of either graph.
+ *
+ * The two graphs need not have the same height: when one side reaches a page that the other side
+ * has already expanded, that side is propagated to everything already found below the page.
+ * Pages are therefore reported only after both walks are done.
+ *
+ * Only pages for which `should_recursively_trace(page_id)` returns true are loaded; the others are
+ * still reported, but their refs are not followed.
+ *
+ * The result is exact as long as each page has at most one parent within each graph (as in a
+ * copy-on-write tree).  Otherwise it is conservative: a page is never missed, but one that the
+ * `from` side only reaches through a page that was shared before either side expanded it may be
+ * reported.
+ */
+template <typename FromRootSeq, typename ToRootSeq, typename Pred, typename Fn>
+inline batt::Status trace_refs_recursive_diff(PageLoader& page_loader, FromRootSeq&& from_roots,
+                                              ToRootSeq&& to_roots, Pred&& should_recursively_trace,
+                                              Fn&& fn)
+{
+  static_assert(std::is_convertible_v<std::decay_t<SeqItem<FromRootSeq>>, PageId>,
+                "`from_roots` arg must be a Seq of PageId");
+  static_assert(std::is_convertible_v<std::decay_t<SeqItem<ToRootSeq>>, PageId>,
+                "`to_roots` arg must be a Seq of PageId");
+
+  // Which of the two graphs a page has been seen in.
+  //
+  using SideMask = u8;
+  constexpr SideMask kFrom = 1;
+  constexpr SideMask kTo = 2;
+  constexpr SideMask kShared = kFrom | kTo;
+
+  std::unordered_map<PageId, SideMask, PageId::Hash> seen;
+  std::unordered_map<PageId, std::vector<PageId>, PageId::Hash> expanded;
+  std::vector<PageId> discovered;
+  std::vector<PageId> pending;
+  std::vector<PageId> next_pending;
+  std::vector<PageId> to_propagate;
+
+  // Marks `page_id` as seen from `side`.  New pages are added to the next round; if the page has
+  // already been expanded, `side` is propagated to the pages found below it.
+  //
+  const auto push = [&](const PageId& page_id, SideMask side) {
+    to_propagate.push_back(page_id);
+    while (!to_propagate.empty()) {
+      const PageId next = to_propagate.back();
+      to_propagate.pop_back();
+
+      SideMask& mask = seen[next];
+      if ((mask & side) != 0) {
+        continue;
+      }
+      if (mask == 0) {
+        discovered.push_back(next);
+        next_pending.push_back(next);
+      }
+      mask |= side;
+
+      auto iter = expanded.find(next);
+      if (iter != expanded.end()) {
+        to_propagate.insert(to_propagate.end(), iter->second.begin(), iter->second.end());
+      }
+    }
+  };
+
+  BATT_FORWARD(from_roots) | seq::for_each([&](const PageId& page_id) {
+    push(page_id, kFrom);
+  });
+  BATT_FORWARD(to_roots) | seq::for_each([&](const PageId& page_id) {
+    push(page_id, kTo);
+  });
+
+  // Loads `page_id` (if it should be traced) and pushes its refs onto the next round as `side`.
+  //
+  const auto expand = [&](const PageId& page_id, SideMask side) -> batt::Status {
+    if (!should_recursively_trace(page_id)) {
+      return batt::OkStatus();
+    }
+
+    batt::StatusOr<PinnedPage> status_or_page = page_loader.get(page_id, OkIfNotFound{false});
+    BATT_REQUIRE_OK(status_or_page);
+
+    PinnedPage& page = *status_or_page;
+    BATT_CHECK_NOT_NULLPTR(page);
+
+    std::vector<PageId>& refs = expanded[page_id];
+    page->trace_refs() | seq::emplace_back(&refs);
+
+    for (const PageId& id : refs) {
+      push(id, side);
+    }
+
+    return batt::OkStatus();
+  };
+
+  while (!next_pending.empty()) {
+    std::swap(pending, next_pending);
+    next_pending.clear();
+
+    for (const PageId& page_id : pending) {
+      if (seen[page_id] != kShared && should_recursively_trace(page_id)) {
+        page_loader.prefetch_hint(page_id);
+      }
+    }
+
+    // Expand the `from` side of the round first, since it may turn some of the `to` side's pages
+    // into shared ones.
+    //
+    for (const PageId& page_id : pending) {
+      if (seen[page_id] == kFrom) {
+        BATT_REQUIRE_OK(expand(page_id, kFrom));
+      }
+    }
+    for (const PageId& page_id : pending) {
+      if (seen[page_id] == kTo) {
+        BATT_REQUIRE_OK(expand(page_id, kTo));
+      }
+    }
+  }
+
+  for (const PageId& page_id : discovered) {
+    if (seen[page_id] == kTo) {
+      fn(page_id);
+    }
+  }
+
+  return batt::OkStatus();
+}
+
 }  // namespace llfs
 
 #endif  // LLFS_TRACE_REFS_RECURSIVE_HPP
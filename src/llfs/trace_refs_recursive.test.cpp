@@ -0,0 +1,272 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/trace_refs_recursive.hpp>
+//
+#include <llfs/trace_refs_recursive.hpp>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <llfs/memory_page_cache.hpp>
+#include <llfs/page_filter.hpp>
+#include <llfs/page_view.hpp>
+
+#include <batteries/async/runtime.hpp>
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace {
+
+using namespace llfs::int_types;
+
+using llfs::PageId;
+
+// A page whose only content is its list of references.
+//
+class RefsPageView : public llfs::PageView
+{
+ public:
+  explicit RefsPageView(std::shared_ptr<const llfs::PageBuffer>&& data,
+                        std::vector<PageId>&& refs) noexcept
+      : llfs::PageView{std::move(data)}
+      , refs_{std::move(refs)}
+  {
+  }
+
+  llfs::PageLayoutId get_page_layout_id() const override
+  {
+    llfs::PageLayoutId id;
+    const char tag[sizeof(id.value) + 1] = "(refs)";
+    std::memcpy(&id.value, tag, sizeof(id.value));
+    return id;
+  }
+
+  llfs::BoxedSeq<PageId> trace_refs() const override
+  {
+    return llfs::as_seq(this->refs_) | llfs::seq::decayed() | llfs::seq::boxed();
+  }
+
+  llfs::Optional<llfs::KeyView> min_key() const override
+  {
+    return llfs::None;
+  }
+
+  llfs::Optional<llfs::KeyView> max_key() const override
+  {
+    return llfs::None;
+  }
+
+  std::shared_ptr<llfs::PageFilter> build_filter() const override
+  {
+    return std::make_shared<llfs::NullPageFilter>(this->page_id());
+  }
+
+  void dump_to_ostream(std::ostream& out) const override
+  {
+    out << "(refs)";
+  }
+
+ private:
+  std::vector<PageId> refs_;
+};
+
+// Forwards to another PageLoader, recording which pages were loaded.
+//
+class RecordingPageLoader : public llfs::PageLoader
+{
+ public:
+  using llfs::PageLoader::get;
+
+  explicit RecordingPageLoader(llfs::PageLoader& loader) noexcept : loader_{loader}
+  {
+  }
+
+  void prefetch_hint(PageId page_id) override
+  {
+    this->loader_.prefetch_hint(page_id);
+  }
+
+  llfs::StatusOr<llfs::PinnedPage> get(PageId page_id,
+                                       const llfs::Optional<llfs::PageLayoutId>& required_layout,
+                                       llfs::PinPageToJob pin_page_to_job,
+                                       llfs::OkIfNotFound ok_if_not_found) override
+  {
+    this->loaded.insert(page_id);
+    return this->loader_.get(page_id, required_layout, pin_page_to_job, ok_if_not_found);
+  }
+
+  std::set<PageId> loaded;
+
+ private:
+  llfs::PageLoader& loader_;
+};
+
+class TraceRefsRecursiveDiffTest : public ::testing::Test
+{
+ public:
+  void SetUp() override
+  {
+    llfs::StatusOr<batt::SharedPtr<llfs::PageCache>> page_cache_created =
+        llfs::make_memory_page_cache(batt::Runtime::instance().default_scheduler(),
+                                     /*arena_sizes=*/
+                                     {
+                                         {llfs::PageCount{32}, llfs::PageSize{256}},
+                                     },
+                                     llfs::MaxRefsPerPage{8});
+
+    ASSERT_TRUE(page_cache_created.ok());
+
+    this->page_cache = std::move(*page_cache_created);
+    this->job = this->page_cache->new_job();
+  }
+
+  // Creates a new page (in `this->job`) that refers to `refs`.
+  //
+  PageId make_page(std::vector<PageId> refs)
+  {
+    llfs::StatusOr<std::shared_ptr<llfs::PageBuffer>> page_allocated = this->job->new_page(
+        llfs::PageSize{256}, batt::WaitForResource::kFalse, llfs::Caller::Unknown);
+    BATT_CHECK_OK(page_allocated);
+
+    const PageId page_id = page_allocated->get()->page_id();
+
+    BATT_CHECK_OK(this->job->pin_new(
+        std::make_shared<RefsPageView>(std::move(*page_allocated), std::move(refs)),
+        llfs::Caller::Unknown));
+
+    return page_id;
+  }
+
+  // Returns the pages reported by `trace_refs_recursive_diff` and checks that they are reported
+  // only once each.
+  //
+  std::set<PageId> diff(llfs::PageLoader& loader, PageId from_root, PageId to_root)
+  {
+    std::vector<PageId> reported;
+
+    batt::Status status = llfs::trace_refs_recursive_diff(
+        loader, batt::seq::single_item(from_root), batt::seq::single_item(to_root),
+        /*should_recursively_trace=*/
+        [](PageId) {
+          return true;
+        },
+        [&reported](PageId page_id) {
+          reported.emplace_back(page_id);
+        });
+
+    EXPECT_TRUE(status.ok()) << BATT_INSPECT(status);
+
+    std::set<PageId> result(reported.begin(), reported.end());
+    EXPECT_EQ(result.size(), reported.size());
+
+    return result;
+  }
+
+  batt::SharedPtr<llfs::PageCache> page_cache;
+
+  std::unique_ptr<llfs::PageCacheJob> job;
+};
+
+TEST_F(TraceRefsRecursiveDiffTest, SkipsSharedSubtrees)
+{
+  // from:  a -> {x, y},  x -> {x1, x2},  y -> {y1, y2}
+  // to:    b -> {x, z},  z -> {y1, z1}
+  //
+  const PageId x1 = this->make_page({});
+  const PageId x2 = this->make_page({});
+  const PageId x = this->make_page({x1, x2});
+  const PageId y1 = this->make_page({});
+  const PageId y2 = this->make_page({});
+  const PageId y = this->make_page({y1, y2});
+  const PageId a = this->make_page({x, y});
+  const PageId z1 = this->make_page({});
+  const PageId z = this->make_page({y1, z1});
+  const PageId b = this->make_page({x, z});
+
+  {
+    RecordingPageLoader loader{*this->job};
+
+    EXPECT_THAT(this->diff(loader, a, b), ::testing::UnorderedElementsAre(b, z, z1));
+
+    // Nothing below the shared pages is loaded.
+    //
+    EXPECT_THAT(loader.loaded, ::testing::UnorderedElementsAre(a, b, y, z, y2, z1));
+  }
+  {
+    RecordingPageLoader loader{*this->job};
+
+    EXPECT_THAT(this->diff(loader, b, a), ::testing::UnorderedElementsAre(a, y, y2));
+  }
+  {
+    RecordingPageLoader loader{*this->job};
+
+    EXPECT_THAT(this->diff(loader, a, a), ::testing::IsEmpty());
+    EXPECT_THAT(loader.loaded, ::testing::IsEmpty());
+  }
+}
+
+TEST_F(TraceRefsRecursiveDiffTest, DifferentHeights)
+{
+  // from:  a -> m1,  m1 -> m2,  m2 -> x,  x -> x1
+  // to:    b -> x
+  //
+  // `x` is one level deep on the `to` side but three levels deep on the `from` side, so the `to`
+  // side expands it before the `from` side reaches it.
+  //
+  const PageId x1 = this->make_page({});
+  const PageId x = this->make_page({x1});
+  const PageId m2 = this->make_page({x});
+  const PageId m1 = this->make_page({m2});
+  const PageId a = this->make_page({m1});
+  const PageId b = this->make_page({x});
+
+  {
+    RecordingPageLoader loader{*this->job};
+
+    EXPECT_THAT(this->diff(loader, a, b), ::testing::UnorderedElementsAre(b));
+
+    // `x1` is found to be shared before it is loaded.
+    //
+    EXPECT_THAT(loader.loaded, ::testing::UnorderedElementsAre(a, b, m1, m2, x));
+  }
+  {
+    RecordingPageLoader loader{*this->job};
+
+    EXPECT_THAT(this->diff(loader, b, a), ::testing::UnorderedElementsAre(a, m1, m2));
+  }
+}
+
+TEST_F(TraceRefsRecursiveDiffTest, UntracedPagesAreStillReported)
+{
+  const PageId leaf_1 = this->make_page({});
+  const PageId leaf_2 = this->make_page({});
+  const PageId a = this->make_page({leaf_1});
+  const PageId b = this->make_page({leaf_1, leaf_2});
+
+  RecordingPageLoader loader{*this->job};
+  std::vector<PageId> reported;
+
+  batt::Status status = llfs::trace_refs_recursive_diff(
+      loader, batt::seq::single_item(a), batt::seq::single_item(b),
+      /*should_recursively_trace=*/
+      [&](PageId page_id) {
+        return page_id == a || page_id == b;
+      },
+      [&reported](PageId page_id) {
+        reported.emplace_back(page_id);
+      });
+
+  ASSERT_TRUE(status.ok()) << BATT_INSPECT(status);
+  EXPECT_THAT(reported, ::testing::UnorderedElementsAre(b, leaf_2));
+  EXPECT_THAT(loader.loaded, ::testing::UnorderedElementsAre(a, b));
+}
+
+}  // namespace
@@ -10,11 +10,14 @@
 //
 
 #include <llfs/pack_as_raw.hpp>
+#include <llfs/status_code.hpp>
 #include <llfs/volume_reader.hpp>
 #include <llfs/volume_recovery_visitor.hpp>
 
 #include <boost/uuid/random_generator.hpp>
 
+#include <algorithm>
+
 namespace llfs {
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
@@ -32,8 +35,9 @@ const boost::uuids::uuid& Volume::get_volume_uuid() const
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-const boost::uuids::uuid& Volume::get_recycler_uuid() const
+StatusOr<boost::uuids::uuid> Volume::get_recycler_uuid() const
 {
+  BATT_REQUIRE_OK(this->await_write_recovery());
   return this->recycler_->uuid();
 }
 
@@ -66,7 +70,59 @@ u64 Volume::calculate_grant_size(const std::string_view& payload) const
 //
 u64 Volume::calculate_grant_size(const AppendableJob& appendable) const
 {
-  return (packed_sizeof_slot(prepare(appendable)) +
+  return this->calculate_job_grant_size(prepare(appendable));
+}
+
+namespace {
+
+// Returns the record of a snapshot of `user_data` with the given id.
+//
+VolumeSnapshot make_volume_snapshot(slot_offset_type id, const PackableRef& user_data)
+{
+  VolumeSnapshot snapshot{
+      .id = id,
+      .root_page_ids = sorted_page_ids(trace_refs(user_data)),
+      .user_data = std::string(packed_sizeof(user_data), '\0'),
+  };
+
+  DataPacker packer{MutableBuffer{snapshot.user_data.data(), snapshot.user_data.size()}};
+  BATT_CHECK_NOT_NULLPTR(pack_object(user_data, &packer));
+
+  return snapshot;
+}
+
+}  // namespace
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 Volume::calculate_snapshot_grant_size(const PackableRef& user_data) const
+{
+  const PrepareJob prepare_job =
+      make_prepare_job(/*new_page_ids=*/seq::Empty<PageId>{} | seq::boxed(),
+                       /*deleted_page_ids=*/seq::Empty<PageId>{} | seq::boxed(), user_data);
+
+  // Half is appended; the other half goes to the trimmer, so it can save the job in TrimEvent slots
+  // and refresh the snapshot slot as the log is trimmed.
+  //
+  return (packed_sizeof_slot(prepare_job) +
+          packed_sizeof_slot(make_volume_snapshot(/*id=*/0, user_data))) *
+         2;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 Volume::calculate_release_snapshot_grant_size() const
+{
+  // See `release_snapshot`.
+  //
+  return packed_sizeof_slot(batt::StaticType<PackedCommitJob>{}) * 2;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+u64 Volume::calculate_job_grant_size(const PrepareJob& prepare_job) const
+{
+  return (packed_sizeof_slot(prepare_job) +
           packed_sizeof_slot(batt::StaticType<PackedCommitJob>{}))
 
          // We double the grant size to reserve log space to save the list of pages (and the record
@@ -76,6 +132,194 @@ u64 Volume::calculate_grant_size(const AppendableJob& appendable) const
          * 2;
 }
 
+namespace {
+
+// Everything collected by the root log scan in `Volume::recover` that is needed to finish recovery
+// (possibly on a background task, after `recover` has returned).
+//
+struct VolumeRecoveryState {
+  explicit VolumeRecoveryState(const VolumeReader::SlotVisitorFn& slot_visitor_fn) noexcept
+      : pending_jobs{}
+      , visitor{batt::make_copy(slot_visitor_fn), this->pending_jobs}
+  {
+  }
+
+  VolumePendingJobsMap pending_jobs;
+  VolumeRecoveryVisitor visitor;
+  Optional<VolumeTrimmer::RecoveryVisitor> trimmer_visitor;
+};
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+// Put the main log in a clean state.  This means all configuration data must be recorded, device
+// attachments created, and pending jobs resolved.
+//
+// Returns the amount to allocate to the trimmer to refresh all metadata appended to the log.
+//
+StatusOr<usize> recover_volume_write_state(const VolumeOptions& options, PageCache& cache,
+                                           PageRecycler& recycler, VolumeRecoveryVisitor& visitor,
+                                           TypedSlotWriter<VolumeEventVariant>& slot_writer)
+{
+  usize trimmer_grant_size = 0;
+
+  StatusOr<batt::Grant> grant =
+      slot_writer.reserve(slot_writer.pool_size(), batt::WaitForResource::kFalse);
+
+  BATT_REQUIRE_OK(grant);
+
+  // If no uuids were found while opening the log, create them now.
+  //
+  if (!visitor.ids) {
+    LLFS_VLOG(1) << "Initializing Volume uuids for the first time";
+
+    visitor.ids.emplace(SlotWithPayload<PackedVolumeIds>{
+        .slot_range = {0, 1},
+        .payload =
+            {
+                .main_uuid = options.uuid.value_or(boost::uuids::random_generator{}()),
+                .recycler_uuid = recycler.uuid(),
+                .trimmer_uuid = boost::uuids::random_generator{}(),
+            },
+    });
+
+    StatusOr<SlotRange> ids_slot = slot_writer.append(*grant, visitor.ids->payload);
+
+    BATT_UNTESTED_COND(!ids_slot.ok());
+    BATT_REQUIRE_OK(ids_slot);
+
+    Status flush_status =
+        slot_writer.sync(LogReadMode::kDurable, SlotUpperBoundAt{ids_slot->upper_bound});
+
+    BATT_UNTESTED_COND(!flush_status.ok());
+    BATT_REQUIRE_OK(flush_status);
+  }
+  LLFS_VLOG(1) << BATT_INSPECT(visitor.ids->payload);
+
+  // Attach the main uuid, recycler uuid, and trimmer uuid to each device in
+  // the cache storage pool.
+  //
+  {
+    // Loop through all combinations of uuid, device_id.
+    //
+    LLFS_VLOG(1) << "Recovered attachments: " << batt::dump_range(visitor.device_attachments);
+
+    for (const auto& uuid : {
+             visitor.ids->payload.main_uuid,
+             visitor.ids->payload.recycler_uuid,
+             visitor.ids->payload.trimmer_uuid,
+         }) {
+      for (const PageArena& arena : cache.all_arenas()) {
+        const slot_offset_type slot_offset = [&] {
+          // Find the lowest available slot offset for the log associated with `uuid`.
+          //
+          if (uuid == visitor.ids->payload.recycler_uuid) {
+            return recycler.slot_upper_bound(LogReadMode::kDurable);
+          } else {
+            // Both the volume (main) and trimmer share the same WAL (the main log).
+            //
+            return slot_writer.slot_offset();
+          }
+        }();
+
+        auto attach_event = PackedVolumeAttachEvent{{
+            .id =
+                VolumeAttachmentId{
+                    .client = uuid,
+                    .device = arena.device().get_id(),
+                },
+            .user_slot_offset = slot_offset,
+        }};
+
+        trimmer_grant_size += packed_sizeof_slot(attach_event);
+
+        if (visitor.device_attachments.count(attach_event.id)) {
+          continue;
+        }
+
+        LLFS_VLOG(1) << "[Volume::recover] attaching client " << uuid << " to device "
+                     << arena.device().get_id() << BATT_INSPECT(slot_offset);
+
+        StatusOr<PageAllocator*> allocator = arena.allocator();
+        BATT_REQUIRE_OK(allocator);
+
+        StatusOr<slot_offset_type> sync_slot =
+            (*allocator)->attach_user(uuid, /*user_slot=*/slot_offset);
+
+        BATT_UNTESTED_COND(!sync_slot.ok());
+        BATT_REQUIRE_OK(sync_slot);
+
+        Status sync_status = (*allocator)->sync(*sync_slot);
+
+        BATT_UNTESTED_COND(!sync_status.ok());
+        BATT_REQUIRE_OK(sync_status);
+
+        StatusOr<SlotRange> ids_slot = slot_writer.append(*grant, attach_event);
+
+        BATT_UNTESTED_COND(!ids_slot.ok());
+        BATT_REQUIRE_OK(ids_slot);
+
+        Status flush_status =
+            slot_writer.sync(LogReadMode::kDurable, SlotUpperBoundAt{ids_slot->upper_bound});
+
+        BATT_UNTESTED_COND(!flush_status.ok());
+        BATT_REQUIRE_OK(flush_status);
+      }
+    }
+
+    LLFS_VLOG(1) << "Page devices attached";
+  }
+
+  // Resolve any jobs with a PrepareJob slot but no CommitJob or RollbackJob.
+  //
+  LLFS_VLOG(1) << "Resolving pending jobs...";
+  Status jobs_resolved = visitor.resolve_pending_jobs(
+      cache, recycler, /*volume_uuid=*/visitor.ids->payload.main_uuid, slot_writer, *grant);
+
+  BATT_UNTESTED_COND(!jobs_resolved.ok());
+  BATT_REQUIRE_OK(jobs_resolved);
+
+  LLFS_VLOG(1) << "Pending jobs resolved";
+
+  // Volume::append starts writing a job's new pages before its prepare slot is durable, tagging
+  // them with the prepare slot offset.  If we crashed before the prepare was flushed, the log now
+  // ends at that offset, and the allocator (which never persisted the allocation) will hand out the
+  // same PageIds again.  Appending a slot here guarantees that no future prepare lands on an offset
+  // used before the crash, so a stale page image can never match a later prepare's user slot.
+  //
+  // If the log still ends with the slot appended by the last recovery, nothing (including any lost
+  // prepare) can have written pages since then, because the first prepares after recovery don't
+  // start their page writes until a later slot is durable (see `Volume::append_prepare_slot`); in
+  // that case, we skip the append so that opening an idle Volume doesn't grow its log.
+  //
+  if (!visitor.recovered_slot || visitor.recovered_slot->upper_bound != slot_writer.slot_offset()) {
+    const usize recovered_slot_size = packed_sizeof_slot(PackedVolumeRecovered{});
+
+    StatusOr<batt::Grant> recovered_grant =
+        grant->spend(recovered_slot_size, batt::WaitForResource::kFalse);
+
+    BATT_REQUIRE_OK(recovered_grant);
+
+    StatusOr<SlotRange> recovered_slot =
+        slot_writer.append(*recovered_grant, PackedVolumeRecovered{});
+
+    BATT_UNTESTED_COND(!recovered_slot.ok());
+    BATT_REQUIRE_OK(recovered_slot);
+
+    // Like the prepare and commit slots, the trimmer holds this slot's size until it is trimmed.
+    //
+    trimmer_grant_size += recovered_slot_size;
+
+    Status flush_status =
+        slot_writer.sync(LogReadMode::kDurable, SlotUpperBoundAt{recovered_slot->upper_bound});
+
+    BATT_UNTESTED_COND(!flush_status.ok());
+    BATT_REQUIRE_OK(flush_status);
+  }
+
+  return trimmer_grant_size;
+}
+
+}  // namespace
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 /*static*/ auto Volume::recover(VolumeRecoverParams&& params,
@@ -86,7 +330,6 @@ u64 Volume::calculate_grant_size(const AppendableJob& appendable) const
   const VolumeOptions& options = params.options;
   batt::SharedPtr<PageCache> cache = params.cache;
   LogDeviceFactory& root_log_factory = *params.root_log_factory;
-  LogDeviceFactory& recycler_log_factory = *params.recycler_log_factory;
 
   if (!params.trim_control) {
     params.trim_control = std::make_shared<SlotLockManager>();
@@ -94,14 +337,9 @@ u64 Volume::calculate_grant_size(const AppendableJob& appendable) const
 
   auto page_deleter = std::make_unique<PageCache::PageDeleterImpl>(*cache);
 
-  BATT_ASSIGN_OK_RESULT(
-      std::unique_ptr<PageRecycler> recycler,
-      PageRecycler::recover(scheduler, options.name + "_PageRecycler", options.max_refs_per_page,
-                            *page_deleter, recycler_log_factory));
-
-  VolumePendingJobsMap pending_jobs;
-  VolumeRecoveryVisitor visitor{batt::make_copy(slot_visitor_fn), pending_jobs};
-  Optional<VolumeTrimmer::RecoveryVisitor> trimmer_visitor;
+  auto state = std::make_shared<VolumeRecoveryState>(slot_visitor_fn);
+  VolumeRecoveryVisitor& visitor = state->visitor;
+  Optional<VolumeTrimmer::RecoveryVisitor>& trimmer_visitor = state->trimmer_visitor;
 
   // Open the log device and scan all slots.
   //
@@ -126,144 +364,102 @@ u64 Volume::calculate_grant_size(const AppendableJob& appendable) const
                               return log_reader.slot_offset();
                             }));
 
-  // The amount to allocate to the trimmer to refresh all metadata we append to the log below.
+  // A new Volume has nothing to read yet, and its ids must be written before it can be created, so
+  // it is always recovered in the foreground.
   //
-  usize trimmer_grant_size = 0;
-
-  // Put the main log in a clean state.  This means all configuration data must
-  // be recorded, device attachments created, and pending jobs resolved.
-  {
-    TypedSlotWriter<VolumeEventVariant> slot_writer{*root_log};
-    batt::Grant grant = BATT_OK_RESULT_OR_PANIC(
-        slot_writer.reserve(slot_writer.pool_size(), batt::WaitForResource::kFalse));
-
-    // If no uuids were found while opening the log, create them now.
-    //
-    if (!visitor.ids) {
-      LLFS_VLOG(1) << "Initializing Volume uuids for the first time";
+  const bool in_background = params.background_write_recovery && visitor.ids;
 
-      visitor.ids.emplace(SlotWithPayload<PackedVolumeIds>{
-          .slot_range = {0, 1},
-          .payload =
-              {
-                  .main_uuid = options.uuid.value_or(boost::uuids::random_generator{}()),
-                  .recycler_uuid = recycler->uuid(),
-                  .trimmer_uuid = boost::uuids::random_generator{}(),
-              },
-      });
-
-      StatusOr<SlotRange> ids_slot = slot_writer.append(grant, visitor.ids->payload);
-
-      BATT_UNTESTED_COND(!ids_slot.ok());
-      BATT_REQUIRE_OK(ids_slot);
-
-      Status flush_status =
-          slot_writer.sync(LogReadMode::kDurable, SlotUpperBoundAt{ids_slot->upper_bound});
-
-      BATT_UNTESTED_COND(!flush_status.ok());
-      BATT_REQUIRE_OK(flush_status);
-    }
-    LLFS_VLOG(1) << BATT_INSPECT(visitor.ids->payload);
-
-    // Attach the main uuid, recycler uuid, and trimmer uuid to each device in
-    // the cache storage pool.
-    //
-    {
-      // Loop through all combinations of uuid, device_id.
-      //
-      LLFS_VLOG(1) << "Recovered attachments: " << batt::dump_range(visitor.device_attachments);
-
-      for (const auto& uuid : {
-               visitor.ids->payload.main_uuid,
-               visitor.ids->payload.recycler_uuid,
-               visitor.ids->payload.trimmer_uuid,
-           }) {
-        for (const PageArena& arena : cache->all_arenas()) {
-          const slot_offset_type slot_offset = [&] {
-            // Find the lowest available slot offset for the log associated with `uuid`.
-            //
-            if (uuid == visitor.ids->payload.recycler_uuid) {
-              return recycler->slot_upper_bound(LogReadMode::kDurable);
-            } else {
-              // Both the volume (main) and trimmer share the same WAL (the main log).
-              //
-              return slot_writer.slot_offset();
-            }
-          }();
-
-          auto attach_event = PackedVolumeAttachEvent{{
-              .id =
-                  VolumeAttachmentId{
-                      .client = uuid,
-                      .device = arena.device().get_id(),
-                  },
-              .user_slot_offset = slot_offset,
-          }};
-
-          trimmer_grant_size += packed_sizeof_slot(attach_event);
-
-          if (visitor.device_attachments.count(attach_event.id)) {
-            continue;
-          }
-
-          LLFS_VLOG(1) << "[Volume::recover] attaching client " << uuid << " to device "
-                       << arena.device().get_id() << BATT_INSPECT(slot_offset);
-
-          StatusOr<slot_offset_type> sync_slot =
-              arena.allocator().attach_user(uuid, /*user_slot=*/slot_offset);
-
-          BATT_UNTESTED_COND(!sync_slot.ok());
-          BATT_REQUIRE_OK(sync_slot);
+  std::unique_ptr<PageRecycler> recycler;
+  usize trimmer_grant_size = 0;
 
-          Status sync_status = arena.allocator().sync(*sync_slot);
+  if (!in_background) {
+    BATT_ASSIGN_OK_RESULT(
+        recycler, PageRecycler::recover(scheduler, options.name + "_PageRecycler",
+                                        options.max_refs_per_page, *page_deleter,
+                                        *params.recycler_log_factory));
 
-          BATT_UNTESTED_COND(!sync_status.ok());
-          BATT_REQUIRE_OK(sync_status);
+    TypedSlotWriter<VolumeEventVariant> slot_writer{*root_log};
 
-          StatusOr<SlotRange> ids_slot = slot_writer.append(grant, attach_event);
+    BATT_ASSIGN_OK_RESULT(trimmer_grant_size,
+                          recover_volume_write_state(options, *cache, *recycler, visitor,
+                                                     slot_writer));
+  }
 
-          BATT_UNTESTED_COND(!ids_slot.ok());
-          BATT_REQUIRE_OK(ids_slot);
+  std::unique_ptr<Volume> volume{
+      new Volume{params.options, visitor.ids->payload.main_uuid, std::move(cache),
+                 std::move(params.trim_control), std::move(page_deleter), std::move(root_log),
+                 std::move(recycler), visitor.ids->payload.trimmer_uuid, *trimmer_visitor,
+                 params.max_async_append_tasks, params.max_idle_async_append_tasks}};
 
-          Status flush_status =
-              slot_writer.sync(LogReadMode::kDurable, SlotUpperBoundAt{ids_slot->upper_bound});
+  if (!in_background) {
+    BATT_REQUIRE_OK(volume->finish_recovery(trimmer_grant_size));
+    return volume;
+  }
 
-          BATT_UNTESTED_COND(!flush_status.ok());
-          BATT_REQUIRE_OK(flush_status);
+  // The Volume can be read from now on; the rest of recovery runs on a background task, and
+  // `reserve` (hence all writes) waits for it to finish.
+  //
+  volume->write_recovery_task_.emplace(
+      scheduler.schedule_task(),
+      [volume = volume.get(), state, &scheduler,
+       recycler_log_factory = params.recycler_log_factory,
+       recycler_log_factory_owner = std::move(params.recycler_log_factory_owner)] {
+        Status status = [&]() -> Status {
+          BATT_ASSIGN_OK_RESULT(
+              volume->recycler_,
+              PageRecycler::recover(scheduler, volume->options_.name + "_PageRecycler",
+                                    volume->options_.max_refs_per_page, *volume->page_deleter_,
+                                    *recycler_log_factory));
+
+          BATT_ASSIGN_OK_RESULT(const usize trimmer_grant_size,
+                                recover_volume_write_state(volume->options_, volume->cache(),
+                                                           *volume->recycler_, state->visitor,
+                                                           volume->slot_writer_));
+
+          return volume->finish_recovery(trimmer_grant_size);
+        }();
+
+        if (!status.ok()) {
+          LLFS_LOG_ERROR() << "Volume recovery failed: " << BATT_INSPECT(status);
+          volume->write_recovery_.set_value(status);
         }
-      }
-
-      LLFS_VLOG(1) << "Page devices attached";
-    }
+      },
+      "Volume::write_recovery_task");
 
-    // Resolve any jobs with a PrepareJob slot but no CommitJob or RollbackJob.
-    //
-    LLFS_VLOG(1) << "Resolving pending jobs...";
-    Status jobs_resolved = visitor.resolve_pending_jobs(
-        *cache, *recycler, /*volume_uuid=*/visitor.ids->payload.main_uuid, slot_writer, grant);
+  return volume;
+}
 
-    BATT_UNTESTED_COND(!jobs_resolved.ok());
-    BATT_REQUIRE_OK(jobs_resolved);
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status Volume::finish_recovery(usize trimmer_grant_size)
+{
+  {
+    batt::StatusOr<batt::Grant> trimmer_grant =
+        this->slot_writer_.reserve(trimmer_grant_size, batt::WaitForResource::kFalse);
+    BATT_REQUIRE_OK(trimmer_grant);
 
-    LLFS_VLOG(1) << "Pending jobs resolved";
+    this->trimmer_.push_grant(std::move(*trimmer_grant));
   }
 
-  std::unique_ptr<Volume> volume{
-      new Volume{params.options, visitor.ids->payload.main_uuid, std::move(cache),
-                 std::move(params.trim_control), std::move(page_deleter), std::move(root_log),
-                 std::move(recycler), visitor.ids->payload.trimmer_uuid, *trimmer_visitor}};
+  this->recovered_upper_bound_ = this->slot_writer_.slot_offset();
 
   {
-    batt::StatusOr<batt::Grant> trimmer_grant =
-        volume->slot_writer_.reserve(trimmer_grant_size, batt::WaitForResource::kFalse);
-    BATT_REQUIRE_OK(trimmer_grant);
-
-    volume->trimmer_.push_grant(std::move(*trimmer_grant));
+    std::unique_lock<std::mutex> lock{this->halt_mutex_};
+    if (this->halt_requested_) {
+      return Status{batt::StatusCode::kClosed};
+    }
+    this->start();
   }
+  this->write_recovery_.set_value(true);
 
-  volume->start();
+  return OkStatus();
+}
 
-  return volume;
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status Volume::await_write_recovery() const
+{
+  return this->write_recovery_.await().status();
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -275,7 +471,9 @@ u64 Volume::calculate_grant_size(const AppendableJob& appendable) const
                             std::unique_ptr<LogDevice>&& root_log,
                             std::unique_ptr<PageRecycler>&& recycler,
                             const boost::uuids::uuid& trimmer_uuid,
-                            const VolumeTrimmer::RecoveryVisitor& trimmer_recovery_visitor) noexcept
+                            const VolumeTrimmer::RecoveryVisitor& trimmer_recovery_visitor,
+                            usize max_async_append_tasks,
+                            usize max_idle_async_append_tasks) noexcept
     : options_{options}
     , volume_uuid_{volume_uuid}
     , cache_{std::move(page_cache)}
@@ -291,9 +489,22 @@ u64 Volume::calculate_grant_size(const AppendableJob& appendable) const
           *this->trim_control_,
           this->root_log_->new_reader(/*slot_lower_bound=*/None, LogReadMode::kDurable),
           this->slot_writer_,
-          VolumeTrimmer::make_default_drop_roots_fn(this->cache(), *this->recycler_, trimmer_uuid),
+          // `recycler_` may still be in recovery here; the trimmer is not started until it is done.
+          //
+          [this, trimmer_uuid](slot_offset_type slot_offset, Slice<const PageId> roots_to_trim) {
+            return VolumeTrimmer::make_default_drop_roots_fn(this->cache(), *this->recycler_,
+                                                             trimmer_uuid)(slot_offset,
+                                                                           roots_to_trim);
+          },
           trimmer_recovery_visitor}
+    , durable_upper_bound_{this->root_log_->slot_range(LogReadMode::kDurable).upper_bound}
+    , max_async_append_tasks_{std::max<usize>(1, max_async_append_tasks)}
+    , max_idle_async_append_tasks_{max_idle_async_append_tasks}
 {
+  auto locked_snapshots = this->snapshots_.lock();
+  for (VolumeSnapshot& snapshot : trimmer_recovery_visitor.get_snapshots()) {
+    locked_snapshots->emplace(snapshot.id, std::move(snapshot));
+  }
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -322,17 +533,36 @@ void Volume::start()
         },
         "Volume::trimmer_task_");
   }
+
+  if (!this->durable_task_) {
+    this->durable_task_.emplace(
+        /*executor=*/batt::Runtime::instance().schedule_task(),
+        [this] {
+          this->durable_task_main();
+        },
+        "Volume::durable_task_");
+  }
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 void Volume::halt()
 {
+  {
+    std::unique_lock<std::mutex> lock{this->halt_mutex_};
+    this->halt_requested_ = true;
+  }
+
   this->slot_writer_.halt();
   this->trim_control_->halt();
   this->trimmer_.halt();
   this->root_log_->close().IgnoreError();
-  if (this->recycler_) {
+  this->async_append_queue_.close();
+
+  // While `write_recovery_task_` is running, `recycler_` may be set at any time; `join()` halts the
+  // recycler once the task is done.
+  //
+  if (!this->write_recovery_task_ && this->recycler_) {
     this->recycler_->halt();
   }
 }
@@ -341,10 +571,39 @@ void Volume::halt()
 //
 void Volume::join()
 {
+  if (this->write_recovery_task_) {
+    this->write_recovery_task_->join();
+    this->write_recovery_task_ = None;
+    if (this->recycler_) {
+      this->recycler_->halt();
+    }
+  }
   if (this->trimmer_task_) {
     this->trimmer_task_->join();
     this->trimmer_task_ = None;
   }
+  if (this->durable_task_) {
+    this->durable_task_->join();
+    this->durable_task_ = None;
+  }
+  {
+    std::vector<std::unique_ptr<batt::Task>> tasks;
+    {
+      std::unique_lock<std::mutex> lock{this->async_append_tasks_mutex_};
+      this->async_append_tasks_joined_ = true;
+      std::swap(tasks, this->async_append_tasks_);
+    }
+    for (std::unique_ptr<batt::Task>& task : tasks) {
+      task->join();
+    }
+  }
+
+  // Fail any async appends that were queued after the tasks stopped.
+  //
+  while (Optional<AsyncAppendOp*> op = this->async_append_queue_.try_pop_next()) {
+    this->finish_async_append(*op, Status{batt::StatusCode::kClosed});
+  }
+
   if (this->recycler_) {
     this->recycler_->join();
   }
@@ -405,6 +664,10 @@ StatusOr<SlotReadLock> Volume::lock_slots(const SlotRange& slot_range, LogReadMo
 //
 StatusOr<batt::Grant> Volume::reserve(u64 size, batt::WaitForResource wait_for_log_space)
 {
+  // Every write starts with a grant, so this is the one place writes wait for recovery.
+  //
+  BATT_REQUIRE_OK(this->await_write_recovery());
+
   return this->slot_writer_.reserve(size, wait_for_log_space);
 }
 
@@ -412,7 +675,7 @@ StatusOr<batt::Grant> Volume::reserve(u64 size, batt::WaitForResource wait_for_l
 //
 StatusOr<SlotRange> Volume::append(const PackableRef& payload, batt::Grant& grant)
 {
-  return this->slot_writer_.append(grant, payload);
+  return this->slot_writer_.append(grant, payload, this->options_.slot_compression_min_size);
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -443,34 +706,194 @@ StatusOr<SlotRange> Volume::append(AppendableJob&& appendable, batt::Grant& gran
   // log.
   //
   if (sequencer) {
-    BATT_DEBUG_INFO("awaiting previous slot in sequence; "
-                    << BATT_INSPECT(sequencer->has_prev()) << BATT_INSPECT(sequencer->poll_prev())
-                    << BATT_INSPECT(sequencer->get_current()) << sequencer->debug_info());
+    BATT_REQUIRE_OK(this->await_prev_slot(*sequencer));
+  }
 
-    StatusOr<SlotRange> prev_slot = sequencer->await_prev();
-    if (!prev_slot.ok()) {
-      sequencer->set_error(prev_slot.status());
-    }
-    BATT_REQUIRE_OK(prev_slot);
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Phase 1: Write a prepare slot to the write-ahead log and flush it to
+  // durable storage.
+  //
+  StatusOr<SlotRange> prepare_slot = this->append_prepare_slot(appendable, grant, sequencer);
+  BATT_REQUIRE_OK(prepare_slot);
 
-    // We only need to do a speculative sync here, because flushing later slots
-    // in the log implies that all earlier ones are flushed, and we are going to
-    // do a durable sync (flush) for our prepare event below.
-    //
-    BATT_DEBUG_INFO("awaiting flush of previous slot: " << *prev_slot);
+  BATT_DEBUG_INFO("flushing PrepareJob slot to storage");
 
-    Status sync_prev = this->slot_writer_.sync(LogReadMode::kSpeculative,
-                                               SlotUpperBoundAt{prev_slot->upper_bound});
-    if (!sync_prev.ok()) {
-      sequencer->set_error(sync_prev);
+  Status sync_prepare = LLFS_COLLECT_LATENCY(
+      this->metrics_.prepare_slot_sync_latency,
+      this->slot_writer_.sync(LogReadMode::kDurable, SlotUpperBoundAt{prepare_slot->upper_bound}));
+
+  BATT_REQUIRE_OK(sync_prepare);
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Phase 2: Commit the job and write the commit slot.
+  //
+  return this->commit_prepared_job(appendable, grant, *prepare_slot);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<VolumeSnapshot> Volume::snapshot(const PackableRef& user_data, batt::Grant& grant)
+{
+  std::vector<PageId> root_page_ids = trace_refs(user_data) | seq::collect_vec();
+
+  // Adding a reference to a page that is free or pending recycle would not bring it back (and might
+  // pin a later generation of the same physical page instead), so only pages that are already
+  // reachable can be shared with a snapshot.
+  //
+  for (const PageId& page_id : root_page_ids) {
+    StatusOr<PageAllocator*> allocator = this->cache().arena_for_page_id(page_id).allocator();
+    BATT_REQUIRE_OK(allocator);
+
+    const PageRefCount prc = (*allocator)->get_ref_count_obj(page_id);
+
+    if (PageId{prc.page_id} != page_id || prc.ref_count < 2) {
+      LLFS_VLOG(1) << "Volume::snapshot: root is not live; " << BATT_INSPECT(page_id)
+                   << BATT_INSPECT(prc);
+      return ::llfs::make_status(StatusCode::kSnapshotRootNotLive);
     }
-    BATT_REQUIRE_OK(sync_prev);
   }
 
+  StatusOr<AppendableJob> appendable = make_appendable_job(this->new_job(), PackableRef{user_data});
+  BATT_REQUIRE_OK(appendable);
+
   //+++++++++++-+-+--+----- --- -- -  -  -   -
-  // Phase 1: Write a prepare slot to the write-ahead log and flush it to
-  // durable storage.
+  // Phase 1: Write the prepare slot and flush it, as for any other job.
   //
+  Optional<SlotSequencer> no_sequencer;
+
+  StatusOr<SlotRange> prepare_slot = this->append_prepare_slot(*appendable, grant, no_sequencer);
+  BATT_REQUIRE_OK(prepare_slot);
+
+  BATT_REQUIRE_OK(
+      this->slot_writer_.sync(LogReadMode::kDurable, SlotUpperBoundAt{prepare_slot->upper_bound}));
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Phase 2: Add the root references, but leave the job pending; its prepare slot is carried
+  // forward by the trimmer (and its references kept) until the job is committed by
+  // `release_snapshot`.  If we crash before the snapshot slot below is durable, recovery resolves
+  // the job like any other, so no references are leaked.
+  //
+  BATT_REQUIRE_OK(commit(std::move(appendable->job), this->commit_params(*prepare_slot),
+                         Caller::Unknown));
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+  // Phase 3: Durably record the snapshot in place of a commit slot.
+  //
+  VolumeSnapshot snapshot = make_volume_snapshot(prepare_slot->lower_bound, user_data);
+  {
+    BATT_ASSIGN_OK_RESULT(batt::Grant trim_refresh_grant,
+                          grant.spend(packed_sizeof_slot(snapshot)));
+    this->trimmer_.push_grant(std::move(trim_refresh_grant));
+  }
+
+  StatusOr<SlotRange> snapshot_slot = this->slot_writer_.append(grant, snapshot);
+  BATT_REQUIRE_OK(snapshot_slot);
+
+  BATT_REQUIRE_OK(
+      this->slot_writer_.sync(LogReadMode::kDurable, SlotUpperBoundAt{snapshot_slot->upper_bound}));
+
+  this->snapshots_.lock()->emplace(snapshot.id, snapshot);
+
+  return snapshot;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status Volume::release_snapshot(slot_offset_type snapshot_id, batt::Grant& grant)
+{
+  Optional<VolumeSnapshot> released;
+  {
+    auto locked = this->snapshots_.lock();
+    auto iter = locked->find(snapshot_id);
+    if (iter == locked->end()) {
+      return batt::StatusCode::kNotFound;
+    }
+    released.emplace(std::move(iter->second));
+    locked->erase(iter);
+  }
+
+  // Put the snapshot back if we fail to release it.
+  //
+  auto on_failure = batt::finally([&] {
+    if (released) {
+      this->snapshots_.lock()->emplace(snapshot_id, std::move(*released));
+    }
+  });
+
+  // The trimmer drops the snapshot's roots and releases the space of the commit slot from its own
+  // grant when the commit slot is trimmed.
+  //
+  const PackedCommitJob commit_job{
+      .reserved_ = {},
+      .prepare_slot = snapshot_id,
+  };
+  {
+    BATT_ASSIGN_OK_RESULT(batt::Grant trim_grant, grant.spend(packed_sizeof_slot(commit_job)));
+    this->trimmer_.push_grant(std::move(trim_grant));
+  }
+
+  StatusOr<SlotRange> commit_slot = this->slot_writer_.append(grant, commit_job);
+  BATT_REQUIRE_OK(commit_slot);
+
+  BATT_REQUIRE_OK(
+      this->slot_writer_.sync(LogReadMode::kDurable, SlotUpperBoundAt{commit_slot->upper_bound}));
+
+  released = None;
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::vector<VolumeSnapshot> Volume::snapshots() const
+{
+  auto locked = this->snapshots_.lock();
+
+  std::vector<VolumeSnapshot> result;
+  result.reserve(locked->size());
+
+  for (const auto& [snapshot_id, snapshot] : *locked) {
+    result.emplace_back(snapshot);
+  }
+
+  return result;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status Volume::await_prev_slot(SlotSequencer& sequencer)
+{
+  BATT_DEBUG_INFO("awaiting previous slot in sequence; "
+                  << BATT_INSPECT(sequencer.has_prev()) << BATT_INSPECT(sequencer.poll_prev())
+                  << BATT_INSPECT(sequencer.get_current()) << sequencer.debug_info());
+
+  StatusOr<SlotRange> prev_slot = sequencer.await_prev();
+  if (!prev_slot.ok()) {
+    sequencer.set_error(prev_slot.status());
+  }
+  BATT_REQUIRE_OK(prev_slot);
+
+  // We only need to do a speculative sync here, because flushing later slots
+  // in the log implies that all earlier ones are flushed, and we are going to
+  // do a durable sync (flush) for our prepare event below.
+  //
+  BATT_DEBUG_INFO("awaiting flush of previous slot: " << *prev_slot);
+
+  Status sync_prev = this->slot_writer_.sync(LogReadMode::kSpeculative,
+                                             SlotUpperBoundAt{prev_slot->upper_bound});
+  if (!sync_prev.ok()) {
+    sequencer.set_error(sync_prev);
+  }
+  BATT_REQUIRE_OK(sync_prev);
+
+  return OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<SlotRange> Volume::append_prepare_slot(AppendableJob& appendable, batt::Grant& grant,
+                                                Optional<SlotSequencer>& sequencer)
+{
   BATT_DEBUG_INFO("appending PrepareJob slot to the WAL");
 
   auto prepared_job = prepare(appendable);
@@ -482,7 +905,8 @@ StatusOr<SlotRange> Volume::append(AppendableJob&& appendable, batt::Grant& gran
 
   StatusOr<SlotRange> prepare_slot =
       LLFS_COLLECT_LATENCY(this->metrics_.prepare_slot_append_latency,
-                           this->slot_writer_.append(grant, std::move(prepared_job)));
+                           this->slot_writer_.append(grant, std::move(prepared_job),
+                                                     this->options_.slot_compression_min_size));
 
   if (sequencer) {
     if (!prepare_slot.ok()) {
@@ -495,29 +919,48 @@ StatusOr<SlotRange> Volume::append(AppendableJob&& appendable, batt::Grant& gran
   }
   BATT_REQUIRE_OK(prepare_slot);
 
-  BATT_DEBUG_INFO("flushing PrepareJob slot to storage");
+  // Now that the prepare slot offset is known, we can start writing the job's new pages; these
+  // writes proceed concurrently with the flush of the prepare slot.  This is safe because new pages
+  // are unreachable until their ref counts are updated, which `commit` only does after the prepare
+  // slot is durable, and because recovery appends a PackedVolumeRecovered slot before any new
+  // prepare, so the offset of a prepare lost in a crash is never reused (see
+  // `recover_volume_write_state`).
+  //
+  // Recovery skips that slot if the log already ends with one; so until a slot appended since
+  // recovery is durable, a crash could leave the log exactly as recovery found it, and the next
+  // prepare could land on this one's offset.  Until then, page writes wait for the prepare flush.
+  //
+  if (!slot_less_than(this->recovered_upper_bound_,
+                      this->root_log_->slot_range(LogReadMode::kDurable).upper_bound)) {
+    BATT_DEBUG_INFO("awaiting flush of the first prepare slot since recovery");
 
-  Status sync_prepare = LLFS_COLLECT_LATENCY(
-      this->metrics_.prepare_slot_sync_latency,
-      this->slot_writer_.sync(LogReadMode::kDurable, SlotUpperBoundAt{prepare_slot->upper_bound}));
+    Status flushed = this->slot_writer_.sync(LogReadMode::kDurable,
+                                             SlotUpperBoundAt{prepare_slot->upper_bound});
+    BATT_REQUIRE_OK(flushed);
+  }
 
-  BATT_REQUIRE_OK(sync_prepare);
+  BATT_DEBUG_INFO("starting new page writes");
+
+  Status start_writes =
+      appendable.job.start_writing_new_pages(this->commit_params(*prepare_slot), Caller::Unknown);
+  BATT_REQUIRE_OK(start_writes);
 
+  return prepare_slot;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<SlotRange> Volume::commit_prepared_job(AppendableJob& appendable, batt::Grant& grant,
+                                                const SlotRange& prepare_slot)
+{
   //+++++++++++-+-+--+----- --- -- -  -  -   -
-  // Phase 2a: Commit the job; this writes new pages, updates ref counts, and
-  // deletes dropped pages.
+  // Phase 2a: Commit the job; this waits for new page writes, updates ref
+  // counts, and deletes dropped pages.
   //
   BATT_DEBUG_INFO("committing PageCacheJob");
 
-  const JobCommitParams params{
-      .caller_uuid = &this->get_volume_uuid(),
-      .caller_slot = prepare_slot->lower_bound,
-      .recycler = as_ref(*this->recycler_),
-      .recycle_grant = nullptr,
-      .recycle_depth = -1,
-  };
-
-  Status commit_job_result = commit(std::move(appendable.job), params, Caller::Unknown);
+  Status commit_job_result =
+      commit(std::move(appendable.job), this->commit_params(prepare_slot), Caller::Unknown);
 
   // BATT_UNTESTED_COND(!commit_job_result.ok());
   BATT_REQUIRE_OK(commit_job_result);
@@ -530,17 +973,302 @@ StatusOr<SlotRange> Volume::append(AppendableJob&& appendable, batt::Grant& gran
   StatusOr<SlotRange> commit_slot =
       this->slot_writer_.append(grant, PackedCommitJob{
                                            .reserved_ = {},
-                                           .prepare_slot = prepare_slot->lower_bound,
+                                           .prepare_slot = prepare_slot.lower_bound,
                                        });
 
   BATT_REQUIRE_OK(commit_slot);
 
   return SlotRange{
-      .lower_bound = prepare_slot->lower_bound,
+      .lower_bound = prepare_slot.lower_bound,
       .upper_bound = commit_slot->upper_bound,
   };
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+JobCommitParams Volume::commit_params(const SlotRange& prepare_slot)
+{
+  return JobCommitParams{
+      .caller_uuid = &this->get_volume_uuid(),
+      .caller_slot = prepare_slot.lower_bound,
+      .recycler = as_ref(*this->recycler_),
+      .recycle_grant = nullptr,
+      .recycle_depth = -1,
+  };
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// Volume::async_append
+
+// The state of an in-flight async_append; owned by whichever step or callback is currently
+// advancing it.
+//
+struct Volume::AsyncAppendOp {
+  enum struct Step {
+    kPrepare,
+    kCommit,
+  };
+
+  AppendableJob appendable;
+  batt::Grant grant;
+  Optional<SlotSequencer> sequencer;
+  AppendHandler handler;
+
+  // What the next call to `async_append_task_main` should do with this op.
+  //
+  Step next_step = Step::kPrepare;
+
+  // Set by the kPrepare step.
+  //
+  SlotRange prepare_slot;
+};
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void Volume::async_append(AppendableJob&& appendable, batt::Grant&& grant,
+                          Optional<SlotSequencer>&& sequencer, AppendHandler&& handler)
+{
+  auto* op = new AsyncAppendOp{
+      .appendable = std::move(appendable),
+      .grant = std::move(grant),
+      .sequencer = std::move(sequencer),
+      .handler = std::move(handler),
+  };
+
+  if (!op->sequencer) {
+    this->schedule_async_append_step(op);
+    return;
+  }
+
+  // Phase 0: Wait for the previous slot in the sequence without blocking; `await_prev_slot` will
+  // then find it already resolved when the prepare step runs.
+  //
+  op->sequencer->async_await_prev([this, op](const StatusOr<SlotRange>& prev_slot) {
+    if (!prev_slot.ok()) {
+      op->sequencer->set_error(prev_slot.status());
+      this->finish_async_append(op, prev_slot.status());
+      return;
+    }
+    this->schedule_async_append_step(op);
+  });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+batt::SharedPtr<batt::Latch<SlotRange>> Volume::async_append(AppendableJob&& appendable,
+                                                             batt::Grant&& grant,
+                                                             Optional<SlotSequencer>&& sequencer)
+{
+  auto result = batt::make_shared<batt::Latch<SlotRange>>();
+
+  this->async_append(std::move(appendable), std::move(grant), std::move(sequencer),
+                     [result](StatusOr<SlotRange> appended) {
+                       result->set_value(std::move(appended));
+                     });
+
+  return result;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void Volume::schedule_async_append_step(AsyncAppendOp* op)
+{
+  if (!this->async_append_queue_.push(op)) {
+    this->finish_async_append(op, Status{batt::StatusCode::kClosed});
+    return;
+  }
+
+  // Claim an idle task to run this step.  If they are all busy (e.g., blocked in the commit step of
+  // other appends), add one; if there are already `max_async_append_tasks_`, the step stays in the
+  // queue for the next task to finish a step.
+  //
+  {
+    std::unique_lock<std::mutex> lock{this->async_append_tasks_mutex_};
+
+    if (this->async_append_idle_task_count_ > 0) {
+      this->async_append_idle_task_count_ -= 1;
+      return;
+    }
+    if (this->async_append_task_count_ >= this->max_async_append_tasks_) {
+      this->async_append_unclaimed_step_count_ += 1;
+      return;
+    }
+    this->async_append_task_count_ += 1;
+  }
+
+  this->add_async_append_task();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void Volume::add_async_append_task()
+{
+  // The new task may start running right away, and it locks `async_append_tasks_mutex_` after each
+  // step, so it must not be created with the mutex held.
+  //
+  auto task = std::make_unique<batt::Task>(
+      /*executor=*/batt::Runtime::instance().schedule_task(),
+      [this] {
+        this->async_append_task_main();
+      },
+      "Volume::async_append_task");
+
+  std::unique_lock<std::mutex> lock{this->async_append_tasks_mutex_};
+
+  // Once `join()` has started, the queue has been closed, so the task exits right away; any steps
+  // still queued are failed by `join()`.
+  //
+  if (this->async_append_tasks_joined_) {
+    lock.unlock();
+    task->join();
+    return;
+  }
+
+  // Reap tasks that have retired (see `async_append_task_main`).
+  //
+  this->async_append_tasks_.erase(
+      std::remove_if(this->async_append_tasks_.begin(), this->async_append_tasks_.end(),
+                     [](const std::unique_ptr<batt::Task>& task) {
+                       return task->try_join();
+                     }),
+      this->async_append_tasks_.end());
+
+  this->async_append_tasks_.emplace_back(std::move(task));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void Volume::async_await_prepare_durable(AsyncAppendOp* op)
+{
+  const slot_offset_type durable_upper_bound = this->durable_upper_bound_.get_value();
+
+  if (slot_less_than(durable_upper_bound, op->prepare_slot.upper_bound)) {
+    this->durable_upper_bound_.async_wait(
+        durable_upper_bound, [this, op](const StatusOr<slot_offset_type>& updated) {
+          if (!updated.ok()) {
+            this->finish_async_append(op, updated.status());
+            return;
+          }
+          this->async_await_prepare_durable(op);
+        });
+    return;
+  }
+
+  // The prepare slot is durable; also wait for the new page writes here, so that the commit step
+  // doesn't hold a task while they finish.
+  //
+  op->appendable.job.async_await_new_page_writes([this, op](Status status) {
+    if (!status.ok()) {
+      this->finish_async_append(op, status);
+      return;
+    }
+    this->schedule_async_append_step(op);
+  });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void Volume::finish_async_append(AsyncAppendOp* op, StatusOr<SlotRange>&& result)
+{
+  std::unique_ptr<AsyncAppendOp> owned_op{op};
+
+  if (op->sequencer && !op->sequencer->is_resolved()) {
+    BATT_CHECK(!result.ok()) << "The SlotSequencer must be resolved once the prepare slot is known";
+    op->sequencer->set_error(result.status());
+  }
+
+  // Release the job and the rest of the grant before notifying the caller.
+  //
+  AppendHandler handler = std::move(op->handler);
+  owned_op = nullptr;
+
+  handler(std::move(result));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void Volume::async_append_task_main()
+{
+  for (;;) {
+    StatusOr<AsyncAppendOp*> next = this->async_append_queue_.await_next();
+    if (!next.ok()) {
+      break;
+    }
+    AsyncAppendOp* const op = *next;
+
+    switch (op->next_step) {
+      case AsyncAppendOp::Step::kPrepare: {
+        if (op->sequencer) {
+          Status prev_status = this->await_prev_slot(*op->sequencer);
+          if (!prev_status.ok()) {
+            this->finish_async_append(op, prev_status);
+            break;
+          }
+        }
+
+        StatusOr<SlotRange> prepare_slot =
+            this->append_prepare_slot(op->appendable, op->grant, op->sequencer);
+        if (!prepare_slot.ok()) {
+          this->finish_async_append(op, prepare_slot.status());
+          break;
+        }
+
+        op->prepare_slot = *prepare_slot;
+        op->next_step = AsyncAppendOp::Step::kCommit;
+        this->async_await_prepare_durable(op);
+        break;
+      }
+
+      case AsyncAppendOp::Step::kCommit:
+        this->finish_async_append(
+            op, this->commit_prepared_job(op->appendable, op->grant, op->prepare_slot));
+        break;
+    }
+
+    // Take a step that was queued while all tasks were busy, if there is one; otherwise become
+    // idle, or retire if there are enough idle tasks already.
+    //
+    std::unique_lock<std::mutex> lock{this->async_append_tasks_mutex_};
+
+    if (this->async_append_unclaimed_step_count_ > 0) {
+      this->async_append_unclaimed_step_count_ -= 1;
+    } else if (this->async_append_idle_task_count_ < this->max_idle_async_append_tasks_) {
+      this->async_append_idle_task_count_ += 1;
+    } else {
+      this->async_append_task_count_ -= 1;
+      return;
+    }
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void Volume::durable_task_main()
+{
+  Status status = [this]() -> Status {
+    for (;;) {
+      // Wait for new data to be committed, then flush everything committed so far.
+      //
+      const slot_offset_type known_upper_bound = this->durable_upper_bound_.get_value();
+
+      BATT_REQUIRE_OK(this->root_log_->sync(LogReadMode::kSpeculative,
+                                            SlotUpperBoundAt{.offset = known_upper_bound + 1}));
+
+      const slot_offset_type target_upper_bound =
+          this->root_log_->slot_range(LogReadMode::kSpeculative).upper_bound;
+
+      BATT_REQUIRE_OK(this->root_log_->sync(LogReadMode::kDurable,
+                                            SlotUpperBoundAt{.offset = target_upper_bound}));
+
+      this->durable_upper_bound_.set_value(target_upper_bound);
+    }
+  }();
+
+  this->durable_upper_bound_.close();
+
+  LLFS_VLOG(1) << "Volume::durable_task_ exited with status=" << status;
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<VolumeReader> Volume::reader(const SlotRangeSpec& slot_range, LogReadMode mode)
@@ -578,7 +1306,9 @@ StatusOr<VolumeReader> Volume::reader(const SlotRangeSpec& slot_range, LogReadMo
 //
 std::unique_ptr<PageCacheJob> Volume::new_job() const
 {
-  return this->cache().new_job();
+  std::unique_ptr<PageCacheJob> job = this->cache().new_job();
+  job->set_cache_owner(cache_owner_for_uuid(this->volume_uuid_));
+  return job;
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -652,9 +1382,10 @@ SlotRange Volume::root_log_slot_range(LogReadMode mode) const
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-const PageRecycler::Metrics& Volume::page_recycler_metrics() const
+StatusOr<const PageRecycler::Metrics*> Volume::page_recycler_metrics() const
 {
-  return this->recycler_->metrics();
+  BATT_REQUIRE_OK(this->await_write_recovery());
+  return &this->recycler_->metrics();
 }
 
 }  // namespace llfs
@@ -23,14 +23,24 @@
 #include <llfs/volume_metrics.hpp>
 #include <llfs/volume_options.hpp>
 #include <llfs/volume_reader.hpp>
+#include <llfs/volume_snapshot.hpp>
 #include <llfs/volume_trimmer.hpp>
 
 #include <batteries/async/grant.hpp>
+#include <batteries/async/latch.hpp>
+#include <batteries/async/mutex.hpp>
+#include <batteries/async/queue.hpp>
+#include <batteries/async/task.hpp>
 #include <batteries/async/task_scheduler.hpp>
+#include <batteries/async/watch.hpp>
 #include <batteries/shared_ptr.hpp>
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <type_traits>
+#include <vector>
 
 namespace llfs {
 
@@ -38,9 +48,35 @@ struct VolumeRecoverParams {
   batt::TaskScheduler* scheduler;
   VolumeOptions options;
   batt::SharedPtr<PageCache> cache;
+
+  // May be a StripedLogDeviceFactory, to spread the root log over several devices so that
+  // independent appends are flushed in parallel.
+  //
   LogDeviceFactory* root_log_factory;
   LogDeviceFactory* recycler_log_factory;
   std::shared_ptr<SlotLockManager> trim_control;
+
+  // If true, `Volume::recover` returns as soon as the root log has been scanned, so the Volume can
+  // be read from right away.  Recovery of the PageRecycler, device attachments, and pending jobs
+  // then runs on a background task, and writes wait for it; see Volume::await_write_recovery.
+  //
+  bool background_write_recovery = false;
+
+  // (Optional) Keeps `recycler_log_factory` alive until it is no longer needed; only required
+  // when `background_write_recovery` is true and the caller does not outlive the Volume.
+  //
+  std::shared_ptr<LogDeviceFactory> recycler_log_factory_owner;
+
+  // The most tasks that may run `Volume::async_append` steps at once; once they are all busy,
+  // further steps wait in a queue for one of them to finish its current step.  (A step never waits
+  // for another one to run, so this can't deadlock.)
+  //
+  usize max_async_append_tasks = 16;
+
+  // Async append tasks that run out of steps exit, except for up to this many, which wait for the
+  // next steps.
+  //
+  usize max_idle_async_append_tasks = 2;
 };
 
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
@@ -53,7 +89,8 @@ class Volume
   //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 
   // Read the Volume state from the passed log devices and resolve any pending jobs by committing or
-  // rolling back so the Volume is in a clean state.
+  // rolling back so the Volume is in a clean state.  See
+  // VolumeRecoverParams::background_write_recovery to do the latter in the background.
   //
   static StatusOr<std::unique_ptr<Volume>> recover(
       VolumeRecoverParams&& params, const VolumeReader::SlotVisitorFn& slot_visitor_fn);
@@ -79,20 +116,30 @@ class Volume
   //
   const boost::uuids::uuid& get_volume_uuid() const;
 
-  // Returns the UUID for this volume's recycler log.
+  // Returns the UUID for this volume's recycler log.  Waits for `await_write_recovery()`, and
+  // returns its error if recovery failed.
   //
-  const boost::uuids::uuid& get_recycler_uuid() const;
+  StatusOr<boost::uuids::uuid> get_recycler_uuid() const;
 
   // Returns the UUID for this volume's trimmer task.
   //
   const boost::uuids::uuid& get_trimmer_uuid() const;
 
-  // Reserve `size` bytes in the log for future appends.
+  // Blocks until the Volume can be written to; returns an error if recovery failed.  Reading the
+  // Volume never needs to wait for this.
+  //
+  Status await_write_recovery() const;
+
+  // Reserve `size` bytes in the log for future appends.  Waits for `await_write_recovery()`.
   //
   StatusOr<batt::Grant> reserve(u64 size, batt::WaitForResource wait_for_log_space);
 
   // Returns the number of bytes needed to append `payload`.
   //
+  // If slot compression is enabled (VolumeOptions::slot_compression_min_size), the grant sizes
+  // returned by these functions are upper bounds: `append` spends only the size of each slot as
+  // written to the log, and the rest of the grant is left for future appends.
+  //
   u64 calculate_grant_size(const PackableRef& payload) const;
 
   // Returns the number of bytes needed to append `payload`.
@@ -126,6 +173,65 @@ class Volume
   struct PrepareJob_must_be_passed_to_Volume_append_by_move* append(
       const AppendableJob&, batt::Grant&, Optional<SlotSequencer>&& = None);
 
+  // Called with the result of `async_append`.  This runs on a Volume background task or an I/O
+  // completion context, so it must not block.
+  //
+  using AppendHandler = std::function<void(StatusOr<SlotRange>)>;
+
+  // Same as `append(AppendableJob&&, ...)`, except that it returns immediately and `handler` is
+  // called with the result once the commit slot has been appended.  The Volume owns `grant` until
+  // then; whatever is left of it is released before `handler` is called.  The object referred to
+  // by `appendable_job.user_data` must stay alive until `handler` is called.
+  //
+  // No task is tied up while the append waits on the previous slot in `prepare_slot_sequencer`,
+  // the flush of its prepare slot, or the writes of its new pages; only the prepare and commit
+  // steps themselves (which call blocking log and allocator APIs) run on a pool of Volume tasks.
+  // The pool grows whenever a step is ready and no task is idle, so a slow commit never holds up
+  // the steps of other appends.
+  //
+  // All handlers must have been called before the Volume is destroyed.
+  //
+  void async_append(AppendableJob&& appendable_job, batt::Grant&& grant,
+                    Optional<SlotSequencer>&& prepare_slot_sequencer, AppendHandler&& handler);
+
+  // Same as above, but returns a latch that receives the result instead of taking a handler.
+  //
+  batt::SharedPtr<batt::Latch<SlotRange>> async_append(
+      AppendableJob&& appendable_job, batt::Grant&& grant,
+      Optional<SlotSequencer>&& prepare_slot_sequencer = None);
+
+  // Returns the number of bytes needed to take a snapshot with `user_data`.
+  //
+  u64 calculate_snapshot_grant_size(const PackableRef& user_data) const;
+
+  // Returns the number of bytes needed to release a snapshot.
+  //
+  u64 calculate_release_snapshot_grant_size() const;
+
+  // Takes a copy-on-write snapshot of everything reachable from the pages referenced by
+  // `user_data` (i.e., `trace_refs(user_data)`), by preparing a job that adds one reference to each
+  // of those roots and durably recording the snapshot in the root log.  The cost is proportional
+  // to the number of roots, not to the amount of data reachable from them.  See VolumeSnapshot.
+  //
+  // The snapshot is kept (across trims and restarts) until it is passed to `release_snapshot`.
+  // `user_data` is not passed to slot visitors; it is stored with the snapshot instead, and can be
+  // read back via `snapshots()`.
+  //
+  // Every root must already be live (ref count of at least 2, same generation); otherwise this
+  // returns StatusCode::kSnapshotRootNotLive and nothing is appended.  The caller must not release
+  // its own references to the roots until this function returns.
+  //
+  StatusOr<VolumeSnapshot> snapshot(const PackableRef& user_data, batt::Grant& grant);
+
+  // Commits the job of the given snapshot, so that its root references are dropped once the commit
+  // slot is trimmed.  Returns batt::StatusCode::kNotFound if there is no such (live) snapshot.
+  //
+  Status release_snapshot(slot_offset_type snapshot_id, batt::Grant& grant);
+
+  // Returns all snapshots that have not been released, ordered by id.
+  //
+  std::vector<VolumeSnapshot> snapshots() const;
+
   // Returns a new VolumeReader for the given slot range and durability level.  This can be used to
   // read raw user-level slot data; if you want to read typed user slots, use `typed_reader`
   // instead.
@@ -193,9 +299,10 @@ class Volume
   //
   SlotRange root_log_slot_range(LogReadMode mode) const;
 
-  // Returns diagnostic metrics for this Volume's PageRecycler.
+  // Returns diagnostic metrics for this Volume's PageRecycler.  Waits for
+  // `await_write_recovery()`, and returns its error if recovery failed.
   //
-  const PageRecycler::Metrics& page_recycler_metrics() const;
+  StatusOr<const PageRecycler::Metrics*> page_recycler_metrics() const;
 
  private:
   explicit Volume(const VolumeOptions& options, const boost::uuids::uuid& volume_uuid,
@@ -204,12 +311,66 @@ class Volume
                   std::unique_ptr<PageCache::PageDeleterImpl>&& page_deleter,
                   std::unique_ptr<LogDevice>&& root_log, std::unique_ptr<PageRecycler>&& recycler,
                   const boost::uuids::uuid& trimmer_uuid,
-                  const VolumeTrimmer::RecoveryVisitor& trimmer_recovery_visitor) noexcept;
+                  const VolumeTrimmer::RecoveryVisitor& trimmer_recovery_visitor,
+                  usize max_async_append_tasks, usize max_idle_async_append_tasks) noexcept;
 
   // Launch background tasks associated with this Volume.
   //
   void start();
 
+  // Hands the trimmer its grant, starts the Volume, and makes it writable.
+  //
+  Status finish_recovery(usize trimmer_grant_size);
+
+  // Returns the number of bytes needed to append a job with the given PrepareJob slot.
+  //
+  u64 calculate_job_grant_size(const PrepareJob& prepare_job) const;
+
+  // Phase 0 of an append with a SlotSequencer: waits for the previous slot in the sequence to be
+  // appended, resolving `sequencer` with an error if this fails.
+  //
+  Status await_prev_slot(SlotSequencer& sequencer);
+
+  // Phase 1 of an append: writes the prepare slot (resolving `sequencer`, if present) and starts
+  // writing the job's new pages.  Does not wait for the prepare slot to be flushed.
+  //
+  StatusOr<SlotRange> append_prepare_slot(AppendableJob& appendable, batt::Grant& grant,
+                                          Optional<SlotSequencer>& sequencer);
+
+  // Phase 2 of an append: commits the job and writes the commit slot.  The prepare slot must be
+  // durable.
+  //
+  StatusOr<SlotRange> commit_prepared_job(AppendableJob& appendable, batt::Grant& grant,
+                                          const SlotRange& prepare_slot);
+
+  JobCommitParams commit_params(const SlotRange& prepare_slot);
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+  // async_append implementation.
+
+  struct AsyncAppendOp;
+
+  // Queues `op` to have its next step run by an idle async append task, starting a new task if
+  // there are none and there are fewer than `max_async_append_tasks_`.
+  //
+  void schedule_async_append_step(AsyncAppendOp* op);
+
+  // Starts another task running `async_append_task_main`, and reaps any that have retired.
+  //
+  void add_async_append_task();
+
+  // Re-schedules `op` once its prepare slot is durable and its new pages are written.
+  //
+  void async_await_prepare_durable(AsyncAppendOp* op);
+
+  // Deletes `op` and passes `result` to its handler.
+  //
+  void finish_async_append(AsyncAppendOp* op, StatusOr<SlotRange>&& result);
+
+  void async_append_task_main();
+
+  void durable_task_main();
+
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
   // Configuration options for this volume.
@@ -244,7 +405,8 @@ class Volume
   //
   batt::Mutex<SlotReadLock> trim_lock_;
 
-  // Recycles pages that are dereferenced by this volume.
+  // Recycles pages that are dereferenced by this volume.  Set by `write_recovery_task_` if the
+  // Volume is recovered in the background.
   //
   std::unique_ptr<PageRecycler> recycler_;
 
@@ -259,6 +421,74 @@ class Volume
   // Task that runs `trimmer_` continuously in the background.
   //
   Optional<batt::Task> trimmer_task_;
+
+  // The snapshots that have not been released, by id.
+  //
+  mutable batt::Mutex<std::map<slot_offset_type, VolumeSnapshot, SlotLess>> snapshots_;
+
+  // The highest known durable root log offset, kept up to date by `durable_task_` so that async
+  // appends can wait for their prepare slot to be flushed without blocking.
+  //
+  batt::Watch<slot_offset_type> durable_upper_bound_;
+
+  Optional<batt::Task> durable_task_;
+
+  // Async appends that are ready to run their next step.
+  //
+  batt::Queue<AsyncAppendOp*> async_append_queue_;
+
+  // See VolumeRecoverParams::max_async_append_tasks and max_idle_async_append_tasks.
+  //
+  const usize max_async_append_tasks_;
+  const usize max_idle_async_append_tasks_;
+
+  // Protects the async append task counts, `async_append_tasks_`, and `async_append_tasks_joined_`;
+  // steps are scheduled from I/O completion handlers as well as tasks.
+  //
+  std::mutex async_append_tasks_mutex_;
+
+  // The number of async append tasks that have not exited (or decided to).
+  //
+  usize async_append_task_count_ = 0;
+
+  // The number of async append tasks that are waiting for a step and have not yet been claimed by
+  // `schedule_async_append_step`.
+  //
+  usize async_append_idle_task_count_ = 0;
+
+  // The number of queued steps that no task has been claimed for, because all
+  // `max_async_append_tasks_` were busy; the next task to finish a step takes one of these.
+  //
+  usize async_append_unclaimed_step_count_ = 0;
+
+  // The tasks that run async append steps (including retired ones that have not been reaped yet).
+  //
+  std::vector<std::unique_ptr<batt::Task>> async_append_tasks_;
+
+  // Set by `join()`; no more tasks are added after this.
+  //
+  bool async_append_tasks_joined_ = false;
+
+  // Resolved once the Volume is fully recovered and can be written to.
+  //
+  mutable batt::Latch<bool> write_recovery_;
+
+  // The upper bound of the log when write recovery finished; see `append_prepare_slot`.
+  //
+  slot_offset_type recovered_upper_bound_ = 0;
+
+  // Finishes recovery in the background; see VolumeRecoverParams::background_write_recovery.
+  //
+  Optional<batt::Task> write_recovery_task_;
+
+  // Protects `halt_requested_`; held by `finish_recovery` while it starts the background tasks, so
+  // that a Volume halted during background recovery is never started.
+  //
+  std::mutex halt_mutex_;
+
+  // Set by `halt()`.
+  //
+  bool halt_requested_ = false;
 };
 
 }  // namespace llfs
@@ -18,6 +18,7 @@
 #include <llfs/memory_log_device.hpp>
 #include <llfs/memory_page_cache.hpp>
 #include <llfs/opaque_page_view.hpp>
+#include <llfs/status_code.hpp>
 
 #include <batteries/state_machine_model.hpp>
 
@@ -104,37 +105,59 @@ class VolumeTest : public ::testing::Test
   void save_uuids(const llfs::Volume& test_volume)
   {
     this->volume_uuid = test_volume.get_volume_uuid();
-    this->recycler_uuid = test_volume.get_recycler_uuid();
+
+    llfs::StatusOr<boost::uuids::uuid> recycler_uuid = test_volume.get_recycler_uuid();
+    ASSERT_TRUE(recycler_uuid.ok()) << BATT_INSPECT(recycler_uuid.status());
+    this->recycler_uuid = *recycler_uuid;
+
     this->trimmer_uuid = test_volume.get_trimmer_uuid();
   }
 
   void validate_uuids(const llfs::Volume& test_volume) const
   {
     EXPECT_EQ(this->volume_uuid, test_volume.get_volume_uuid());
-    EXPECT_EQ(this->recycler_uuid, test_volume.get_recycler_uuid());
+
+    llfs::StatusOr<boost::uuids::uuid> recycler_uuid = test_volume.get_recycler_uuid();
+    ASSERT_TRUE(recycler_uuid.ok()) << BATT_INSPECT(recycler_uuid.status());
+    EXPECT_EQ(this->recycler_uuid, *recycler_uuid);
+
     EXPECT_EQ(this->trimmer_uuid, test_volume.get_trimmer_uuid());
   }
 
   template <typename SlotVisitorFn>
   std::unique_ptr<llfs::Volume> open_volume_or_die(llfs::LogDeviceFactory& root_log,
                                                    llfs::LogDeviceFactory& recycler_log,
-                                                   SlotVisitorFn&& slot_visitor_fn)
+                                                   SlotVisitorFn&& slot_visitor_fn,
+                                                   bool background_write_recovery = false,
+                                                   llfs::Optional<usize> max_async_append_tasks =
+                                                       llfs::None,
+                                                   llfs::Optional<usize>
+                                                       max_idle_async_append_tasks = llfs::None)
   {
-    llfs::StatusOr<std::unique_ptr<llfs::Volume>> test_volume_recovered = llfs::Volume::recover(
-        llfs::VolumeRecoverParams{
-            &batt::Runtime::instance().default_scheduler(),
-            llfs::VolumeOptions{
-                .name = "test_volume",
-                .uuid = llfs::None,
-                .max_refs_per_page = max_refs_per_page,
-                .trim_lock_update_interval = llfs::TrimLockUpdateInterval{0u},
-            },
-            this->page_cache,
-            /*root_log=*/&root_log,
-            /*recycler_log=*/&recycler_log,
-            nullptr,
-        },  //
-        BATT_FORWARD(slot_visitor_fn));
+    llfs::VolumeRecoverParams params{
+        &batt::Runtime::instance().default_scheduler(),
+        llfs::VolumeOptions{
+            .name = "test_volume",
+            .uuid = llfs::None,
+            .max_refs_per_page = max_refs_per_page,
+            .trim_lock_update_interval = llfs::TrimLockUpdateInterval{0u},
+            .slot_compression_min_size = llfs::SlotCompressionMinSize{0},
+        },
+        this->page_cache,
+        /*root_log=*/&root_log,
+        /*recycler_log=*/&recycler_log,
+        nullptr,
+        background_write_recovery,
+    };
+    if (max_async_append_tasks) {
+      params.max_async_append_tasks = *max_async_append_tasks;
+    }
+    if (max_idle_async_append_tasks) {
+      params.max_idle_async_append_tasks = *max_idle_async_append_tasks;
+    }
+
+    llfs::StatusOr<std::unique_ptr<llfs::Volume>> test_volume_recovered =
+        llfs::Volume::recover(std::move(params), BATT_FORWARD(slot_visitor_fn));
 
     BATT_CHECK(test_volume_recovered.ok());
 
@@ -230,7 +253,11 @@ class VolumeTest : public ::testing::Test
 
     if (expected_ref_count) {
       const llfs::PageArena& arena = this->page_cache->arena_for_page_id(page_id);
-      const i32 ref_count = arena.allocator().get_ref_count(page_id).first;
+      llfs::StatusOr<llfs::PageAllocator*> allocator = arena.allocator();
+      if (!allocator.ok()) {
+        return false;
+      }
+      const i32 ref_count = (*allocator)->get_ref_count(page_id).first;
 
       LLFS_VLOG(1) << BATT_INSPECT(page_id) << BATT_INSPECT(ref_count);
 
@@ -570,7 +597,9 @@ TEST_F(VolumeTest, PageJobs)
             LLFS_VLOG(1) << "waiting for ref count; " << BATT_INSPECT(new_page_slot[i])
                          << BATT_INSPECT(i) << BATT_INSPECT(j) << BATT_INSPECT(id)
                          << BATT_INSPECT(target);
-            ASSERT_TRUE(arena.allocator().await_ref_count(id, target));
+            llfs::StatusOr<llfs::PageAllocator*> allocator = arena.allocator();
+            ASSERT_TRUE(allocator.ok());
+            ASSERT_TRUE((*allocator)->await_ref_count(id, target));
 
             if (target > 1) {
               ASSERT_TRUE(this->verify_opaque_page(id, /*expected_ref_count=*/target));
@@ -585,6 +614,527 @@ TEST_F(VolumeTest, PageJobs)
   LLFS_VLOG(1) << BATT_INSPECT(fake_recycler_log.state()->device_time);
 }
 
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+TEST_F(VolumeTest, BackgroundWriteRecovery)
+{
+  const auto append_upserts = [](llfs::Volume& test_volume, i32 first_key, i32 last_key) {
+    llfs::slot_offset_type slot_upper_bound = 0;
+    for (i32 key = first_key; key < last_key; key += 1) {
+      auto upsert_event = llfs::pack_as_variant<TestVolumeEvent>(UpsertEvent{key, key * 3 + 1});
+      auto packable_event = llfs::PackableRef{upsert_event};
+
+      llfs::StatusOr<batt::Grant> grant = test_volume.reserve(
+          test_volume.calculate_grant_size(packable_event), batt::WaitForResource::kFalse);
+      BATT_CHECK_OK(grant);
+
+      llfs::StatusOr<llfs::SlotRange> appended = test_volume.append(packable_event, *grant);
+      BATT_CHECK_OK(appended);
+
+      slot_upper_bound = appended->upper_bound;
+    }
+    BATT_CHECK_OK(
+        test_volume.sync(llfs::LogReadMode::kDurable, llfs::SlotUpperBoundAt{slot_upper_bound}));
+  };
+
+  // A new Volume is always recovered in the foreground.
+  {
+    auto fake_root_log = llfs::testing::make_fake_log_device_factory(*this->root_log);
+    auto fake_recycler_log = llfs::testing::make_fake_log_device_factory(*this->recycler_log);
+
+    std::unique_ptr<llfs::Volume> test_volume = this->open_volume_or_die(
+        fake_root_log, fake_recycler_log,
+        /*slot_visitor_fn=*/
+        [](const llfs::SlotParse&, const std::string_view&) {
+          return llfs::OkStatus();
+        },
+        /*background_write_recovery=*/true);
+
+    EXPECT_TRUE(test_volume->await_write_recovery().ok());
+    this->save_uuids(*test_volume);
+
+    append_upserts(*test_volume, 0, 5);
+  }
+
+  // Re-open in the background; the data is readable and the Volume becomes writable.
+  {
+    auto fake_root_log = llfs::testing::make_fake_log_device_factory(*this->root_log);
+    auto fake_recycler_log = llfs::testing::make_fake_log_device_factory(*this->recycler_log);
+
+    std::unique_ptr<llfs::Volume> test_volume = this->open_volume_or_die(
+        fake_root_log, fake_recycler_log,
+        /*slot_visitor_fn=*/
+        [](const llfs::SlotParse&, const std::string_view&) {
+          return llfs::OkStatus();
+        },
+        /*background_write_recovery=*/true);
+
+    EXPECT_THAT(this->read_volume(*test_volume),
+                ::testing::UnorderedElementsAre(std::make_pair(0, 1), std::make_pair(1, 4),
+                                                std::make_pair(2, 7), std::make_pair(3, 10),
+                                                std::make_pair(4, 13)));
+
+    // `reserve` waits for recovery to finish.
+    //
+    append_upserts(*test_volume, 5, 7);
+
+    EXPECT_TRUE(test_volume->await_write_recovery().ok());
+    this->validate_uuids(*test_volume);
+
+    EXPECT_THAT(this->read_volume(*test_volume),
+                ::testing::UnorderedElementsAre(std::make_pair(0, 1), std::make_pair(1, 4),
+                                                std::make_pair(2, 7), std::make_pair(3, 10),
+                                                std::make_pair(4, 13), std::make_pair(5, 16),
+                                                std::make_pair(6, 19)));
+  }
+
+  // Closing a Volume while it is still recovering is safe.
+  {
+    auto fake_root_log = llfs::testing::make_fake_log_device_factory(*this->root_log);
+    auto fake_recycler_log = llfs::testing::make_fake_log_device_factory(*this->recycler_log);
+
+    std::unique_ptr<llfs::Volume> test_volume = this->open_volume_or_die(
+        fake_root_log, fake_recycler_log,
+        /*slot_visitor_fn=*/
+        [](const llfs::SlotParse&, const std::string_view&) {
+          return llfs::OkStatus();
+        },
+        /*background_write_recovery=*/true);
+  }
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+TEST_F(VolumeTest, Snapshot)
+{
+  const auto open_volume = [&] {
+    auto fake_root_log = llfs::testing::make_fake_log_device_factory(*this->root_log);
+    auto fake_recycler_log = llfs::testing::make_fake_log_device_factory(*this->recycler_log);
+
+    return this->open_volume_or_die(
+        fake_root_log, fake_recycler_log,
+        /*slot_visitor_fn=*/[](const llfs::SlotParse&, const auto& /*payload*/) {
+          return llfs::OkStatus();
+        });
+  };
+
+  // Runs `fn` on a task and waits for it to finish.
+  //
+  const auto run_task = [](const char* name, auto&& fn) {
+    batt::Task task{batt::Runtime::instance().schedule_task(), BATT_FORWARD(fn), name};
+    task.join();
+  };
+
+  // Trims the whole log and waits for the trim to finish.
+  //
+  const auto trim_all = [](llfs::Volume& volume) {
+    const llfs::slot_offset_type log_end =
+        volume.root_log_slot_range(llfs::LogReadMode::kDurable).upper_bound;
+
+    ASSERT_TRUE(volume.trim(log_end).ok());
+    ASSERT_TRUE(volume.await_trim(log_end).ok());
+  };
+
+  std::unique_ptr<llfs::Volume> test_volume = open_volume();
+
+  // Writes a new page and appends a job that makes it the (only) live root.
+  //
+  const auto write_root = [&](llfs::PageId* page_id) -> llfs::StatusOr<llfs::SlotRange> {
+    std::unique_ptr<llfs::PageCacheJob> job = test_volume->new_job();
+
+    llfs::StatusOr<llfs::PinnedPage> pinned_page = this->make_opaque_page(*job);
+    BATT_REQUIRE_OK(pinned_page);
+
+    *page_id = get_page_id(*pinned_page);
+    const std::vector<llfs::PageId> roots{*page_id};
+
+    return this->append_job(*test_volume, std::move(job),
+                            llfs::as_seq(roots) | llfs::seq::decayed() | llfs::seq::boxed());
+  };
+
+  llfs::PageId old_root;
+  llfs::StatusOr<llfs::SlotRange> old_root_slot = write_root(&old_root);
+  ASSERT_TRUE(old_root_slot.ok()) << BATT_INSPECT(old_root_slot.status());
+  ASSERT_TRUE(this->verify_opaque_page(old_root, /*expected_ref_count=*/2));
+
+  // Snapshot the current root; this adds one reference to it.
+  //
+  const std::vector<llfs::PageId> snapshot_roots{old_root};
+  auto snapshot_event = llfs::pack_as_variant<TestVolumeEvent>(
+      llfs::as_seq(snapshot_roots) | llfs::seq::decayed() | llfs::seq::boxed());
+
+  const auto take_snapshot = [&]() -> llfs::StatusOr<llfs::VolumeSnapshot> {
+    const llfs::PackableRef user_data{snapshot_event};
+
+    llfs::StatusOr<batt::Grant> grant = test_volume->reserve(
+        test_volume->calculate_snapshot_grant_size(user_data), batt::WaitForResource::kFalse);
+    BATT_REQUIRE_OK(grant);
+
+    return test_volume->snapshot(user_data, *grant);
+  };
+
+  llfs::StatusOr<llfs::VolumeSnapshot> snapshot = take_snapshot();
+  ASSERT_TRUE(snapshot.ok()) << BATT_INSPECT(snapshot.status());
+
+  EXPECT_THAT(snapshot->root_page_ids, ::testing::ElementsAre(old_root));
+  EXPECT_FALSE(llfs::slot_less_than(snapshot->id, old_root_slot->upper_bound));
+  EXPECT_TRUE(this->verify_opaque_page(old_root, /*expected_ref_count=*/3));
+  {
+    // The snapshot's user data is the packed event passed to `snapshot`.
+    //
+    using PackedSnapshotEvent =
+        llfs::PackedVariantInstance<TestVolumeEvent, llfs::PackedArray<llfs::PackedPageId>>;
+
+    auto* event = (const PackedSnapshotEvent*)snapshot->user_data.data();
+
+    EXPECT_TRUE(event->verify_case());
+    ASSERT_EQ(event->tail.size(), 1u);
+    EXPECT_EQ(event->tail[0].as_page_id(), old_root);
+  }
+
+  // Replace the live root; the snapshot's page is not touched.
+  //
+  llfs::PageId new_root;
+  llfs::StatusOr<llfs::SlotRange> new_root_slot = write_root(&new_root);
+  ASSERT_TRUE(new_root_slot.ok()) << BATT_INSPECT(new_root_slot.status());
+
+  EXPECT_TRUE(this->verify_opaque_page(old_root, /*expected_ref_count=*/3));
+  EXPECT_TRUE(this->verify_opaque_page(new_root, /*expected_ref_count=*/2));
+
+  // The snapshot does not pin the log: trimming all of it drops the references held by the jobs,
+  // but not the one held by the snapshot.
+  //
+  run_task("VolumeTest_Snapshot_trim_task", [&] {
+    trim_all(*test_volume);
+
+    llfs::StatusOr<llfs::PageAllocator*> allocator =
+        this->page_cache->arena_for_page_id(new_root).allocator();
+    ASSERT_TRUE(allocator.ok());
+    ASSERT_TRUE((*allocator)->await_ref_count(new_root, 0));
+    EXPECT_TRUE(this->verify_opaque_page(old_root, /*expected_ref_count=*/2));
+  });
+
+  // The snapshot survives a restart, and further trims.
+  //
+  test_volume = nullptr;
+  test_volume = open_volume();
+
+  EXPECT_THAT(test_volume->snapshots(), ::testing::ElementsAre(::testing::AllOf(
+                                            ::testing::Field(&llfs::VolumeSnapshot::id,
+                                                             snapshot->id),
+                                            ::testing::Field(&llfs::VolumeSnapshot::root_page_ids,
+                                                             ::testing::ElementsAre(old_root)),
+                                            ::testing::Field(&llfs::VolumeSnapshot::user_data,
+                                                             snapshot->user_data))));
+
+  run_task("VolumeTest_Snapshot_trim_after_restart_task", [&] {
+    trim_all(*test_volume);
+    trim_all(*test_volume);
+
+    EXPECT_TRUE(this->verify_opaque_page(old_root, /*expected_ref_count=*/2));
+  });
+
+  // Once the snapshot is released and the release is trimmed, the old root is recycled.
+  //
+  {
+    llfs::StatusOr<batt::Grant> grant =
+        test_volume->reserve(test_volume->calculate_release_snapshot_grant_size() * 2,
+                             batt::WaitForResource::kFalse);
+    ASSERT_TRUE(grant.ok()) << BATT_INSPECT(grant.status());
+
+    EXPECT_TRUE(test_volume->release_snapshot(snapshot->id, *grant).ok());
+    EXPECT_EQ(test_volume->release_snapshot(snapshot->id, *grant), batt::StatusCode::kNotFound);
+    EXPECT_THAT(test_volume->snapshots(), ::testing::IsEmpty());
+  }
+
+  run_task("VolumeTest_Snapshot_release_task", [&] {
+    trim_all(*test_volume);
+
+    llfs::StatusOr<llfs::PageAllocator*> allocator =
+        this->page_cache->arena_for_page_id(old_root).allocator();
+    ASSERT_TRUE(allocator.ok());
+    ASSERT_TRUE((*allocator)->await_ref_count(old_root, 0));
+
+    // A page that is no longer live can't be snapshotted.
+    //
+    llfs::StatusOr<llfs::VolumeSnapshot> stale_snapshot = take_snapshot();
+    EXPECT_EQ(stale_snapshot.status(), llfs::StatusCode::kSnapshotRootNotLive);
+  });
+
+  test_volume = nullptr;
+  test_volume = open_volume();
+
+  EXPECT_THAT(test_volume->snapshots(), ::testing::IsEmpty());
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+TEST_F(VolumeTest, AsyncAppendJobs)
+{
+  // More jobs than a fixed-size pool of append tasks would have run at once.
+  //
+  constexpr usize kNumJobs = 16;
+
+  auto fake_root_log = llfs::testing::make_fake_log_device_factory(*this->root_log);
+  auto fake_recycler_log = llfs::testing::make_fake_log_device_factory(*this->recycler_log);
+
+  // Run the appends with the default task pool, and with pools too small to run them all at once
+  // (so that steps are queued, and idle tasks retire and are replaced).
+  //
+  for (const auto& [max_tasks, max_idle_tasks] :
+       std::vector<std::pair<usize, usize>>{{16, 2}, {1, 0}, {3, 1}}) {
+    std::unique_ptr<llfs::Volume> test_volume = this->open_volume_or_die(
+        fake_root_log, fake_recycler_log,
+        /*slot_visitor_fn=*/
+        [](const llfs::SlotParse&, const auto& /*payload*/) {
+          return llfs::OkStatus();
+        },
+        /*background_write_recovery=*/false, max_tasks, max_idle_tasks);
+
+    using Event = decltype(
+        llfs::pack_as_variant<TestVolumeEvent>(std::declval<llfs::BoxedSeq<llfs::PageId>>()));
+
+    // The event payloads are only referenced by the AppendableJobs, so they must outlive the
+    // appends.
+    //
+    std::vector<std::vector<llfs::PageId>> event_page_ids(kNumJobs);
+    std::vector<std::unique_ptr<Event>> events;
+
+    std::vector<llfs::PageId> page_ids;
+    std::vector<batt::SharedPtr<batt::Latch<llfs::SlotRange>>> results;
+
+    // Start all the appends before waiting on any of them, ordering their prepare slots with a
+    // chain of sequencers.
+    //
+    llfs::SlotSequencer sequencer;
+    for (usize i = 0; i < kNumJobs; ++i) {
+      std::unique_ptr<llfs::PageCacheJob> job = test_volume->new_job();
+
+      llfs::StatusOr<llfs::PinnedPage> pinned_page = this->make_opaque_page(*job);
+      ASSERT_TRUE(pinned_page.ok());
+
+      page_ids.emplace_back(get_page_id(*pinned_page));
+      event_page_ids[i].emplace_back(page_ids.back());
+
+      events.emplace_back(std::make_unique<Event>(llfs::pack_as_variant<TestVolumeEvent>(
+          llfs::as_seq(event_page_ids[i]) | llfs::seq::decayed() | llfs::seq::boxed())));
+
+      llfs::StatusOr<llfs::AppendableJob> appendable_job =
+          llfs::make_appendable_job(std::move(job), llfs::PackableRef{*events.back()});
+      ASSERT_TRUE(appendable_job.ok());
+
+      llfs::StatusOr<batt::Grant> grant = test_volume->reserve(
+          test_volume->calculate_grant_size(*appendable_job), batt::WaitForResource::kFalse);
+      ASSERT_TRUE(grant.ok());
+
+      llfs::SlotSequencer next_sequencer = sequencer.get_next();
+
+      results.emplace_back(test_volume->async_append(std::move(*appendable_job),
+                                                     std::move(*grant), std::move(sequencer)));
+
+      sequencer = std::move(next_sequencer);
+    }
+
+    for (usize i = 0; i < kNumJobs; ++i) {
+      llfs::StatusOr<llfs::SlotRange> appended = results[i]->await();
+      ASSERT_TRUE(appended.ok()) << BATT_INSPECT(appended.status()) << BATT_INSPECT(i)
+                                 << BATT_INSPECT(max_tasks) << BATT_INSPECT(max_idle_tasks);
+
+      // The sequencers order the prepare slots (but not the commit slots).
+      //
+      if (i > 0) {
+        llfs::StatusOr<llfs::SlotRange> prev_appended = results[i - 1]->await();
+        ASSERT_TRUE(prev_appended.ok());
+        EXPECT_TRUE(llfs::slot_less_than(prev_appended->lower_bound, appended->lower_bound))
+            << BATT_INSPECT(i) << BATT_INSPECT(*appended) << BATT_INSPECT(*prev_appended);
+      }
+
+      EXPECT_TRUE(this->verify_opaque_page(page_ids[i], /*expected_ref_count=*/2));
+    }
+  }
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// Volume::append starts writing new pages before the prepare slot is durable.  Simulate a crash
+// after such a write completes but before its prepare is flushed: the allocator forgets the page,
+// so the same PageId is handed out again after recovery.  The stale page image must not carry the
+// user slot of the job that reuses the id.
+//
+TEST_F(VolumeTest, ReusePageIdAfterCrash)
+{
+  const auto open_volume = [&] {
+    auto fake_root_log = llfs::testing::make_fake_log_device_factory(*this->root_log);
+    auto fake_recycler_log = llfs::testing::make_fake_log_device_factory(*this->recycler_log);
+
+    return this->open_volume_or_die(
+        fake_root_log, fake_recycler_log,
+        /*slot_visitor_fn=*/[](const llfs::SlotParse&, const auto& /*payload*/) {
+          return llfs::OkStatus();
+        });
+  };
+
+  llfs::PageId stale_page_id;
+  llfs::slot_offset_type stale_slot = 0;
+  {
+    std::unique_ptr<llfs::Volume> test_volume = open_volume();
+    this->save_uuids(*test_volume);
+
+    // Until a slot appended since recovery is durable, Volume::append waits for the prepare slot
+    // flush before writing pages, so commit one job first.
+    //
+    {
+      std::unique_ptr<llfs::PageCacheJob> first_job = test_volume->new_job();
+
+      llfs::StatusOr<llfs::PinnedPage> first_page = this->make_opaque_page(*first_job);
+      ASSERT_TRUE(first_page.ok());
+
+      const std::vector<llfs::PageId> first_roots{get_page_id(*first_page)};
+      llfs::StatusOr<llfs::SlotRange> first_appended =
+          this->append_job(*test_volume, std::move(first_job),
+                           llfs::as_seq(first_roots) | llfs::seq::decayed() | llfs::seq::boxed());
+      ASSERT_TRUE(first_appended.ok()) << BATT_INSPECT(first_appended.status());
+    }
+
+    std::unique_ptr<llfs::PageCacheJob> job = test_volume->new_job();
+    const u64 job_id = job->job_id;
+
+    {
+      llfs::StatusOr<llfs::PinnedPage> pinned_page = this->make_opaque_page(*job);
+      ASSERT_TRUE(pinned_page.ok());
+
+      stale_page_id = get_page_id(*pinned_page);
+    }
+    job->new_root(stale_page_id);
+
+    // This is the offset the prepare slot would have been appended at.
+    //
+    stale_slot = test_volume->root_log_slot_range(llfs::LogReadMode::kSpeculative).upper_bound;
+
+    // Writing pages doesn't touch the recycler, but JobCommitParams requires one.
+    //
+    llfs::MemoryLogDevice scratch_recycler_log{
+        llfs::PageRecycler::calculate_log_size(max_refs_per_page)};
+    auto fake_scratch_recycler_log =
+        llfs::testing::make_fake_log_device_factory(scratch_recycler_log);
+    llfs::PageCache::PageDeleterImpl page_deleter{*this->page_cache};
+
+    llfs::StatusOr<std::unique_ptr<llfs::PageRecycler>> scratch_recycler =
+        llfs::PageRecycler::recover(batt::Runtime::instance().default_scheduler(),
+                                    "scratch_recycler", max_refs_per_page, page_deleter,
+                                    fake_scratch_recycler_log);
+    ASSERT_TRUE(scratch_recycler.ok());
+
+    // "Crash": the page is written with the would-be prepare slot, but the job is dropped (which
+    // waits for the write to finish) without the prepare ever being appended, and the allocator
+    // forgets the allocation.
+    //
+    {
+      llfs::StatusOr<llfs::CommittablePageCacheJob> committable =
+          llfs::CommittablePageCacheJob::from(std::move(job), llfs::Caller::Unknown);
+      ASSERT_TRUE(committable.ok());
+
+      ASSERT_TRUE(committable
+                      ->start_writing_new_pages(
+                          llfs::JobCommitParams{
+                              .caller_uuid = &this->volume_uuid,
+                              .caller_slot = stale_slot,
+                              .recycler = llfs::as_ref(**scratch_recycler),
+                              .recycle_grant = nullptr,
+                              .recycle_depth = -1,
+                          },
+                          llfs::Caller::Unknown)
+                      .ok());
+    }
+    this->page_cache->deallocate_page(stale_page_id, llfs::Caller::Unknown, job_id);
+  }
+
+  std::unique_ptr<llfs::Volume> test_volume = open_volume();
+  this->validate_uuids(*test_volume);
+
+  std::unique_ptr<llfs::PageCacheJob> job = test_volume->new_job();
+
+  llfs::StatusOr<llfs::PinnedPage> pinned_page = this->make_opaque_page(*job);
+  ASSERT_TRUE(pinned_page.ok());
+  ASSERT_EQ(get_page_id(*pinned_page), stale_page_id);
+
+  const std::vector<llfs::PageId> roots{stale_page_id};
+  llfs::StatusOr<llfs::SlotRange> appended =
+      this->append_job(*test_volume, std::move(job),
+                       llfs::as_seq(roots) | llfs::seq::decayed() | llfs::seq::boxed());
+  ASSERT_TRUE(appended.ok()) << BATT_INSPECT(appended.status());
+
+  // Recovery moved the log past the stale prepare offset, so the new job can't be confused with the
+  // crashed one.
+  //
+  EXPECT_TRUE(llfs::slot_less_than(stale_slot, appended->lower_bound))
+      << BATT_INSPECT(stale_slot) << BATT_INSPECT(*appended);
+
+  llfs::StatusOr<llfs::PinnedPage> loaded =
+      this->page_cache->get(stale_page_id, llfs::OkIfNotFound{false});
+  ASSERT_TRUE(loaded.ok());
+
+  const llfs::PackedPageHeader& header = llfs::get_page_header(*loaded->get_page_buffer());
+  EXPECT_EQ(header.user_slot.user_id, this->volume_uuid);
+  EXPECT_EQ(header.user_slot.slot_offset, appended->lower_bound);
+
+  EXPECT_TRUE(this->verify_opaque_page(stale_page_id, /*expected_ref_count=*/2));
+}
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+// Reopening a Volume that nothing has been appended to since it was last recovered must not append
+// another PackedVolumeRecovered slot.
+//
+TEST_F(VolumeTest, ReopenIdleVolume)
+{
+  const auto open_volume = [&] {
+    auto fake_root_log = llfs::testing::make_fake_log_device_factory(*this->root_log);
+    auto fake_recycler_log = llfs::testing::make_fake_log_device_factory(*this->recycler_log);
+
+    return this->open_volume_or_die(
+        fake_root_log, fake_recycler_log,
+        /*slot_visitor_fn=*/[](const llfs::SlotParse&, const auto& /*payload*/) {
+          return llfs::OkStatus();
+        });
+  };
+
+  llfs::slot_offset_type recovered_upper_bound = 0;
+  {
+    std::unique_ptr<llfs::Volume> test_volume = open_volume();
+
+    recovered_upper_bound =
+        test_volume->root_log_slot_range(llfs::LogReadMode::kDurable).upper_bound;
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    std::unique_ptr<llfs::Volume> test_volume = open_volume();
+
+    EXPECT_EQ(test_volume->root_log_slot_range(llfs::LogReadMode::kDurable).upper_bound,
+              recovered_upper_bound)
+        << BATT_INSPECT(i);
+  }
+
+  // After an append, the next recovery appends a new slot.
+  //
+  {
+    std::unique_ptr<llfs::Volume> test_volume = open_volume();
+
+    llfs::StatusOr<batt::Grant> grant =
+        test_volume->reserve(test_volume->calculate_grant_size(std::string_view{"hello"}),
+                             batt::WaitForResource::kFalse);
+    ASSERT_TRUE(grant.ok());
+
+    llfs::StatusOr<llfs::SlotRange> appended =
+        test_volume->sync(test_volume->append(std::string_view{"hello"}, *grant));
+    ASSERT_TRUE(appended.ok());
+
+    recovered_upper_bound = appended->upper_bound;
+  }
+  {
+    std::unique_ptr<llfs::Volume> test_volume = open_volume();
+
+    EXPECT_TRUE(llfs::slot_less_than(
+        recovered_upper_bound,
+        test_volume->root_log_slot_range(llfs::LogReadMode::kDurable).upper_bound));
+  }
+}
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
 struct VolumeCrashTestState {
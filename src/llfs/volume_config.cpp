@@ -13,6 +13,8 @@
 #include <llfs/page_recycler.hpp>
 #include <llfs/uuid.hpp>
 
+#include <batteries/checked_cast.hpp>
+
 #include <boost/uuid/random_generator.hpp>
 
 namespace llfs {
@@ -37,10 +39,23 @@ Status configure_storage_object(StorageFileBuilder::Transaction& txn,
   BATT_CHECK(!options.root_log.uuid)
       << "Creating a Volume from a pre-existing root log is not supported";
 
-  StatusOr<FileOffsetPtr<const PackedLogDeviceConfig&>> p_root_log_config =
-      txn.add_object(options.root_log);
+  boost::uuids::uuid root_log_uuid;
+
+  if (options.striped_root_log) {
+    StatusOr<FileOffsetPtr<const PackedStripedLogConfig&>> p_root_log_config =
+        txn.add_object(*options.striped_root_log);
+
+    BATT_REQUIRE_OK(p_root_log_config);
+
+    root_log_uuid = (*p_root_log_config)->uuid;
+  } else {
+    StatusOr<FileOffsetPtr<const PackedLogDeviceConfig&>> p_root_log_config =
+        txn.add_object(options.root_log);
+
+    BATT_REQUIRE_OK(p_root_log_config);
 
-  BATT_REQUIRE_OK(p_root_log_config);
+    root_log_uuid = (*p_root_log_config)->uuid;
+  }
 
   const LogDeviceConfigOptions recycler_log_options{
       .uuid = random_uuid(),
@@ -58,13 +73,15 @@ Status configure_storage_object(StorageFileBuilder::Transaction& txn,
   p_config->slot_i = 0;
   p_config->n_slots = 2;
   p_config->max_refs_per_page = options.base.max_refs_per_page;
-  p_config->root_log_uuid = (*p_root_log_config)->uuid;
+  p_config->root_log_uuid = root_log_uuid;
   p_config->recycler_log_uuid = (*p_recycler_log_config)->uuid;
 
   p_config->slot_1.tag = PackedConfigSlotBase::Tag::kVolumeContinuation;
   p_config->slot_1.slot_i = 1;
   p_config->slot_1.n_slots = 2;
   p_config->trim_lock_update_interval_bytes = options.base.trim_lock_update_interval;
+  p_config->slot_compression_min_size =
+      BATT_CHECKED_CAST(u32, options.base.slot_compression_min_size.value());
 
   if (!txn.packer().pack_string_to(&p_config->name, options.base.name)) {
     return ::batt::StatusCode::kResourceExhausted;
@@ -73,6 +90,39 @@ Status configure_storage_object(StorageFileBuilder::Transaction& txn,
   return OkStatus();
 }
 
+namespace {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+VolumeOptions volume_options_from_config(const PackedVolumeConfig& config)
+{
+  return VolumeOptions{
+      .name = std::string{config.name.as_str()},
+      .uuid = config.uuid,
+      .max_refs_per_page = MaxRefsPerPage{config.max_refs_per_page},
+      .trim_lock_update_interval = TrimLockUpdateInterval{config.trim_lock_update_interval_bytes},
+      .slot_compression_min_size = SlotCompressionMinSize{config.slot_compression_min_size},
+  };
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::unique_ptr<LogDeviceFactory>> recover_root_log_factory(
+    const batt::SharedPtr<StorageContext>& storage_context, const boost::uuids::uuid& uuid,
+    const IoRingLogDriverOptions& options)
+{
+  batt::SharedPtr<StorageObjectInfo> info = storage_context->find_object_by_uuid(uuid);
+
+  if (info && info->p_config_slot->tag == PackedConfigSlot::Tag::kStripedLog) {
+    return storage_context->recover_object(batt::StaticType<PackedStripedLogConfig>{}, uuid,
+                                           options);
+  }
+
+  return storage_context->recover_object(batt::StaticType<PackedLogDeviceConfig>{}, uuid, options);
+}
+
+}  // namespace
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 StatusOr<std::unique_ptr<Volume>> recover_storage_object(
@@ -83,9 +133,8 @@ StatusOr<std::unique_ptr<Volume>> recover_storage_object(
   StatusOr<batt::SharedPtr<PageCache>> page_cache = storage_context->get_page_cache();
   BATT_REQUIRE_OK(page_cache);
 
-  StatusOr<std::unique_ptr<LogDeviceFactory>> root_log_factory = storage_context->recover_object(
-      batt::StaticType<PackedLogDeviceConfig>{}, p_volume_config->root_log_uuid,
-      volume_runtime_options.root_log_options);
+  StatusOr<std::unique_ptr<LogDeviceFactory>> root_log_factory = recover_root_log_factory(
+      storage_context, p_volume_config->root_log_uuid, volume_runtime_options.root_log_options);
   BATT_REQUIRE_OK(root_log_factory);
 
   StatusOr<std::unique_ptr<LogDeviceFactory>> recycler_log_factory =
@@ -94,23 +143,55 @@ StatusOr<std::unique_ptr<Volume>> recover_storage_object(
                                       volume_runtime_options.recycler_log_options);
   BATT_REQUIRE_OK(recycler_log_factory);
 
+  // The recycler log may still be needed after this function returns; see
+  // VolumeRecoverParams::background_write_recovery.
+  //
+  std::shared_ptr<LogDeviceFactory> shared_recycler_log_factory{std::move(*recycler_log_factory)};
+
   VolumeRecoverParams params{
       .scheduler = &storage_context->get_scheduler(),
-      .options =
-          VolumeOptions{
-              .name = std::string{p_volume_config->name.as_str()},
-              .uuid = p_volume_config->uuid,
-              .max_refs_per_page = MaxRefsPerPage{p_volume_config->max_refs_per_page},
-              .trim_lock_update_interval =
-                  TrimLockUpdateInterval{p_volume_config->trim_lock_update_interval_bytes},
-          },
+      .options = volume_options_from_config(*p_volume_config),
       .cache = *page_cache,
       .root_log_factory = root_log_factory->get(),
-      .recycler_log_factory = recycler_log_factory->get(),
+      .recycler_log_factory = shared_recycler_log_factory.get(),
       .trim_control = std::move(volume_runtime_options.trim_control),
+      .background_write_recovery = volume_runtime_options.background_write_recovery,
+      .recycler_log_factory_owner = shared_recycler_log_factory,
+      .max_async_append_tasks = volume_runtime_options.max_async_append_tasks,
+      .max_idle_async_append_tasks = volume_runtime_options.max_idle_async_append_tasks,
   };
 
   return Volume::recover(std::move(params), volume_runtime_options.slot_visitor_fn);
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<std::unique_ptr<VolumeFollower>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string /*file_name*/,
+    const FileOffsetPtr<const PackedVolumeConfig&>& p_volume_config,
+    VolumeFollowerRuntimeOptions&& follower_runtime_options)
+{
+  // Recovering the PageCache of a context that is not in follower mode would recover (and write
+  // to) the writer's PageAllocators.
+  //
+  if (!storage_context->is_follower()) {
+    return {batt::StatusCode::kFailedPrecondition};
+  }
+
+  StatusOr<batt::SharedPtr<PageCache>> page_cache = storage_context->get_page_cache();
+  BATT_REQUIRE_OK(page_cache);
+
+  StatusOr<std::unique_ptr<IoRingLogFollowerDevice>> root_log = storage_context->recover_object(
+      batt::StaticType<PackedLogDeviceConfig>{}, p_volume_config->root_log_uuid,
+      follower_runtime_options.root_log_options);
+  BATT_REQUIRE_OK(root_log);
+
+  return VolumeFollower::recover(VolumeFollowerRecoverParams{
+      .scheduler = &storage_context->get_scheduler(),
+      .options = volume_options_from_config(*p_volume_config),
+      .cache = *page_cache,
+      .root_log = std::move(*root_log),
+  });
+}
+
 }  // namespace llfs
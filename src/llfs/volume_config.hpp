@@ -18,7 +18,9 @@
 #include <llfs/packed_pointer.hpp>
 #include <llfs/page_size.hpp>
 #include <llfs/storage_file_builder.hpp>
+#include <llfs/striped_log_config.hpp>
 #include <llfs/volume.hpp>
+#include <llfs/volume_follower.hpp>
 #include <llfs/volume_options.hpp>
 #include <llfs/volume_runtime_options.hpp>
 
@@ -50,6 +52,15 @@ StatusOr<std::unique_ptr<Volume>> recover_storage_object(
     const FileOffsetPtr<const PackedVolumeConfig&>& p_volume_config,
     VolumeRuntimeOptions&& volume_runtime_options);
 
+// Recover a read-only VolumeFollower from the passed storage context, which must be in follower
+// mode (see StorageContext::enable_follower_mode).  Applications should not call this function
+// directly; instead use `StorageContext::recover_object`.
+//
+StatusOr<std::unique_ptr<VolumeFollower>> recover_storage_object(
+    const batt::SharedPtr<StorageContext>& storage_context, const std::string file_name,
+    const FileOffsetPtr<const PackedVolumeConfig&>& p_volume_config,
+    VolumeFollowerRuntimeOptions&& follower_runtime_options);
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
 struct VolumeConfigOptions {
@@ -66,6 +77,11 @@ struct VolumeConfigOptions {
   // Used to calculate the minimum recycler log size.
   //
   Optional<PageCount> recycler_max_buffered_page_count;
+
+  // If set, the root log is created as a StripedLogDevice with these options, and `root_log` is
+  // ignored.
+  //
+  Optional<StripedLogConfigOptions> striped_root_log;
 };
 
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
@@ -77,7 +93,7 @@ struct PackedVolumeConfig : PackedConfigSlotHeader {
   //
   little_u64 max_refs_per_page;
 
-  // The root log configuration.
+  // The root log configuration (a PackedLogDeviceConfig or a PackedStripedLogConfig).
   //
   boost::uuids::uuid root_log_uuid;
 
@@ -99,9 +115,14 @@ struct PackedVolumeConfig : PackedConfigSlotHeader {
   //
   PackedBytes name;
 
+  // See VolumeOptions::slot_compression_min_size; 0 (disabled) for volumes created before this
+  // field was added.
+  //
+  little_u32 slot_compression_min_size;
+
   // Reserved for future use.
   //
-  u8 pad1_[44];
+  u8 pad1_[40];
 };
 
 BATT_STATIC_ASSERT_EQ(sizeof(PackedVolumeConfig), PackedVolumeConfig::kSize);
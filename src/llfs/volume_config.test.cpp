@@ -127,6 +127,7 @@ TEST_F(VolumeConfigTest, ConfigRestore)
                         .uuid = llfs::None,
                         .max_refs_per_page = llfs::MaxRefsPerPage{1},
                         .trim_lock_update_interval = llfs::TrimLockUpdateInterval{4 * kKiB},
+                        .slot_compression_min_size = llfs::SlotCompressionMinSize{0},
                     },
                 .root_log =
                     llfs::LogDeviceConfigOptions{
@@ -54,6 +54,7 @@ class VolumeEventVisitor
   LLFS_VOLUME_EVENT_HANDLER_DECL(PackedVolumeRecovered, on_volume_recovered)
   LLFS_VOLUME_EVENT_HANDLER_DECL(PackedVolumeFormatUpgrade, on_volume_format_upgrade)
   LLFS_VOLUME_EVENT_HANDLER_DECL(VolumeTrimEvent, on_volume_trim)
+  LLFS_VOLUME_EVENT_HANDLER_DECL(VolumeSnapshot, on_volume_snapshot)
 
 #undef LLFS_VOLUME_EVENT_HANDLER_DECL
 
@@ -118,6 +119,11 @@ template <typename R>
     {
       return batt::make_default<R>();
     }
+
+    R on_volume_snapshot(const SlotParse&, const VolumeSnapshot&) override
+    {
+      return batt::make_default<R>();
+    }
   };
 
   // It's OK that this is non-const, since it has no state.
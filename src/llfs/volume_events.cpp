@@ -22,14 +22,27 @@ std::ostream& operator<<(std::ostream& out, const VolumeAttachmentId& id)
   return out << "{.client=" << id.client << ", .device=" << id.device.value() << ",}";
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PrepareJob make_prepare_job(const BoxedSeq<PageId>& new_page_ids,
+                            const BoxedSeq<PageId>& deleted_page_ids, const PackableRef& user_data)
+{
+  return PrepareJob{
+      .new_page_ids = sorted_page_ids(new_page_ids),
+      .deleted_page_ids = sorted_page_ids(deleted_page_ids),
+      .root_page_ids = sorted_page_ids(trace_refs(user_data)),
+      .user_data = user_data,
+  };
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 usize packed_sizeof(const PrepareJob& obj)
 {
-  return sizeof(PackedPrepareJob) +                                                               //
-         packed_array_size<PackedPageId>(batt::make_copy(obj.new_page_ids) | seq::count()) +      //
-         packed_array_size<PackedPageId>(batt::make_copy(obj.deleted_page_ids) | seq::count()) +  //
-         packed_array_size<PackedPageId>(trace_refs(obj.user_data) | seq::count()) +              //
+  return sizeof(PackedPrepareJob) +                                  //
+         packed_page_id_list_size(as_slice(obj.new_page_ids)) +      //
+         packed_page_id_list_size(as_slice(obj.deleted_page_ids)) +  //
+         packed_page_id_list_size(as_slice(obj.root_page_ids)) +     //
          packed_sizeof(obj.user_data);
 }
 
@@ -38,7 +51,7 @@ usize packed_sizeof(const PrepareJob& obj)
 PackedPrepareJob* pack_object_to(const PrepareJob& obj, PackedPrepareJob* packed, DataPacker* dst)
 {
   {
-    PackedArray<PackedPageId>* packed_new_page_ids = pack_object(obj.new_page_ids, dst);
+    PackedPageIdList* packed_new_page_ids = pack_page_id_list(as_slice(obj.new_page_ids), dst);
     if (!packed_new_page_ids) {
       return nullptr;
     }
@@ -46,7 +59,8 @@ PackedPrepareJob* pack_object_to(const PrepareJob& obj, PackedPrepareJob* packed
   }
   //----- --- -- -  -  -   -
   {
-    PackedArray<PackedPageId>* packed_deleted_page_ids = pack_object(obj.deleted_page_ids, dst);
+    PackedPageIdList* packed_deleted_page_ids =
+        pack_page_id_list(as_slice(obj.deleted_page_ids), dst);
     if (!packed_deleted_page_ids) {
       return nullptr;
     }
@@ -54,7 +68,7 @@ PackedPrepareJob* pack_object_to(const PrepareJob& obj, PackedPrepareJob* packed
   }
   //----- --- -- -  -  -   -
   {
-    PackedArray<PackedPageId>* packed_root_page_ids = pack_object(trace_refs(obj.user_data), dst);
+    PackedPageIdList* packed_root_page_ids = pack_page_id_list(as_slice(obj.root_page_ids), dst);
     if (!packed_root_page_ids) {
       return nullptr;
     }
@@ -80,6 +94,28 @@ StatusOr<Ref<const PackedPrepareJob>> unpack_object(const PackedPrepareJob& pack
   return as_cref(packed);
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status validate_packed_value(const PackedPrepareJob& packed, const void* buffer_data,
+                             usize buffer_size)
+{
+  BATT_REQUIRE_OK(validate_packed_struct(packed, buffer_data, buffer_size));
+  BATT_REQUIRE_OK(validate_packed_value(packed.new_page_ids, buffer_data, buffer_size));
+  BATT_REQUIRE_OK(validate_packed_value(packed.deleted_page_ids, buffer_data, buffer_size));
+  BATT_REQUIRE_OK(validate_packed_value(packed.root_page_ids, buffer_data, buffer_size));
+
+  // The user data runs to the end of the slot (and may be empty), so only its start is checked.
+  //
+  BATT_REQUIRE_OK(validate_packed_struct(packed.user_data, buffer_data, buffer_size));
+  if (packed.user_data == nullptr) {
+    return make_status(StatusCode::kUnpackCastNullptr);
+  }
+  BATT_REQUIRE_OK(validate_packed_byte_range(packed.user_data.get(), /*packed_size=*/0, buffer_data,
+                                             buffer_size));
+
+  return batt::OkStatus();
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 usize packed_sizeof(const PackedPrepareJob& obj)
@@ -95,15 +131,14 @@ usize packed_sizeof(const PackedPrepareJob& obj)
 //
 usize packed_sizeof(const TrimmedPrepareJob& object)
 {
-  return sizeof(PackedTrimmedPrepareJob) +
-         sizeof(PackedPageId) * (batt::make_copy(object.page_ids) | batt::seq::count());
+  return sizeof(PackedSlotOffset) + packed_page_id_list_size(object.page_ids);
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 usize packed_sizeof(const PackedTrimmedPrepareJob& packed)
 {
-  return sizeof(PackedTrimmedPrepareJob) + sizeof(PackedPageId) * packed.page_ids.size();
+  return sizeof(PackedSlotOffset) + packed_sizeof(packed.page_ids);
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -112,26 +147,12 @@ PackedTrimmedPrepareJob* pack_object_to(const TrimmedPrepareJob& object,
                                         PackedTrimmedPrepareJob* packed, DataPacker* dst)
 {
   packed->prepare_slot = object.prepare_slot;
-  packed->page_ids.initialize(0u);
-
-  bool error = false;
-  usize count = 0;
-  batt::make_copy(object.page_ids)  //
-      | batt::seq::for_each([&count, &error, dst](PageId page_id) {
-          if (pack_object(page_id, dst) == nullptr) {
-            error = true;
-            return batt::seq::LoopControl::kBreak;
-          }
-          ++count;
-          return batt::seq::LoopControl::kContinue;
-        });
-
-  if (error) {
+
+  const std::vector<PageId> page_ids = sorted_page_ids(object.page_ids);
+  if (pack_page_id_list_to(as_slice(page_ids), &packed->page_ids, dst) == nullptr) {
     return nullptr;
   }
 
-  packed->page_ids.item_count = count;
-
   return packed;
 }
 
@@ -142,11 +163,7 @@ StatusOr<TrimmedPrepareJob> unpack_object(const PackedTrimmedPrepareJob& packed,
   TrimmedPrepareJob object;
 
   object.prepare_slot = packed.prepare_slot;
-  object.page_ids = as_seq(packed.page_ids)  //
-                    | batt::seq::map([](const PackedPageId& page_id) {
-                        return page_id.as_page_id();
-                      })  //
-                    | batt::seq::boxed();
+  object.page_ids = as_seq(packed.page_ids) | batt::seq::boxed();
 
   return object;
 }
@@ -159,6 +176,7 @@ Status validate_packed_value(const PackedTrimmedPrepareJob& packed, const void*
   BATT_REQUIRE_OK(validate_packed_struct(packed, buffer_data, buffer_size));
   BATT_REQUIRE_OK(
       validate_packed_byte_range(&packed, packed_sizeof(packed), buffer_data, buffer_size));
+  BATT_REQUIRE_OK(validate_packed_value(packed.page_ids, buffer_data, buffer_size));
 
   return batt::OkStatus();
 }
@@ -11,11 +11,13 @@
 #define LLFS_VOLUME_EVENTS_HPP
 
 #include <llfs/appendable_job.hpp>
+#include <llfs/packed_page_id_list.hpp>
 #include <llfs/packed_pointer.hpp>
 #include <llfs/page_id_factory.hpp>
 #include <llfs/page_layout.hpp>
 #include <llfs/simple_packed_type.hpp>
 #include <llfs/volume_events_fwd.hpp>
+#include <llfs/volume_snapshot.hpp>
 
 #include <batteries/bounds.hpp>
 #include <batteries/static_assert.hpp>
@@ -26,6 +28,8 @@
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include <vector>
+
 namespace llfs {
 
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
@@ -125,7 +129,7 @@ inline std::ostream& operator<<(std::ostream& out, const PackedVolumeIds& t)
 //
 struct PackedTrimmedPrepareJob {
   PackedSlotOffset prepare_slot;
-  PackedArray<PackedPageId> page_ids;
+  PackedPageIdList page_ids;
 };
 
 BATT_STATIC_ASSERT_EQ(sizeof(PackedTrimmedPrepareJob), 16);
@@ -214,12 +218,23 @@ LLFS_SIMPLE_PACKED_TYPE(PackedVolumeFormatUpgrade);
 // The "prepare" phase slot written to a log when transactionally appending a PageCacheJob with user
 // data (T).
 //
+// The page id lists are held sorted, the order in which PackedPageIdList stores them; create with
+// `make_prepare_job`, so that each list is collected and sorted once, however many times the job is
+// sized and packed.
+//
 struct PrepareJob {
-  BoxedSeq<PageId> new_page_ids;
-  BoxedSeq<PageId> deleted_page_ids;
+  std::vector<PageId> new_page_ids;
+  std::vector<PageId> deleted_page_ids;
+  std::vector<PageId> root_page_ids;
   PackableRef user_data;
 };
 
+// Returns a PrepareJob for the given page ids (in any order) and user data; the root page ids are
+// traced from `user_data`.
+//
+PrepareJob make_prepare_job(const BoxedSeq<PageId>& new_page_ids,
+                            const BoxedSeq<PageId>& deleted_page_ids, const PackableRef& user_data);
+
 usize packed_sizeof(const PrepareJob& obj);
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -230,9 +245,13 @@ struct PackedPrepareJob {
   PackedPrepareJob& operator=(const PackedPrepareJob&) = delete;
 
   u8 reserved_[sizeof(PackedVolumeTrimEvent) + sizeof(PackedPointer<PackedTrimmedPrepareJob>)];
-  PackedPointer<PackedArray<PackedPageId>> new_page_ids;
-  PackedPointer<PackedArray<PackedPageId>> deleted_page_ids;
-  PackedPointer<PackedArray<PackedPageId>> root_page_ids;
+
+  // The page id lists are stored sorted and delta-encoded (see PackedPageIdList); slots written
+  // before this encoding existed hold plain PackedArray<PackedPageId>, which decode the same way.
+  //
+  PackedPointer<PackedPageIdList> new_page_ids;
+  PackedPointer<PackedPageIdList> deleted_page_ids;
+  PackedPointer<PackedPageIdList> root_page_ids;
   PackedPointer<PackedRawData> user_data;
 };
 
@@ -244,6 +263,9 @@ PackedPrepareJob* pack_object_to(const PrepareJob& obj, PackedPrepareJob* packed
 
 StatusOr<Ref<const PackedPrepareJob>> unpack_object(const PackedPrepareJob& packed, DataReader*);
 
+Status validate_packed_value(const PackedPrepareJob& packed, const void* buffer_data,
+                             usize buffer_size);
+
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
 struct PackedCommitJob {
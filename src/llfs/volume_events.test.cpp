@@ -209,9 +209,12 @@ TEST_F(VolumeEventsTest, TrimEventPackUnpack)
         EXPECT_EQ(job->prepare_slot, i);
         EXPECT_EQ(job->page_ids.size(), i);
 
+        const std::vector<llfs::PageId> job_page_ids =
+            llfs::as_seq(job->page_ids) | batt::seq::collect_vec();
+        ASSERT_EQ(job_page_ids.size(), i);
+
         for (usize j = 0; j < i; ++j) {
-          EXPECT_EQ(this->page_ids[j], job->page_ids[j].as_page_id())
-              << BATT_INSPECT(i) << BATT_INSPECT(j);
+          EXPECT_EQ(this->page_ids[j], job_page_ids[j]) << BATT_INSPECT(i) << BATT_INSPECT(j);
         }
       }
 
@@ -239,4 +242,46 @@ TEST_F(VolumeEventsTest, TrimEventPackUnpack)
   }
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+TEST_F(VolumeEventsTest, VolumeSnapshotPackUnpack)
+{
+  for (usize n_pages : {0, 1, 5}) {
+    for (const std::string& user_data : {std::string{}, std::string{"abc"},
+                                         std::string(100, 'x')}) {
+      llfs::VolumeSnapshot object{
+          .id = 8192 + n_pages,
+          .root_page_ids = batt::as_seq(this->page_ids) | batt::seq::take_n(n_pages) |
+                           batt::seq::decayed() | batt::seq::collect_vec(),
+          .user_data = user_data,
+      };
+
+      ASSERT_NE(this->pack_into_buffer(object), nullptr);
+
+      {
+        batt::StatusOr<const llfs::PackedVolumeSnapshot&> packed =
+            llfs::unpack_cast<llfs::PackedVolumeSnapshot>(this->const_buffer());
+
+        ASSERT_TRUE(packed.ok()) << BATT_INSPECT(packed.status());
+        EXPECT_EQ(packed->snapshot_id, object.id);
+        EXPECT_EQ(packed->root_page_ids.size(), n_pages);
+        EXPECT_EQ(packed->user_data.as_str(), user_data);
+
+        batt::StatusOr<llfs::VolumeSnapshot> unpacked = this->unpack_from_buffer(*packed);
+
+        ASSERT_TRUE(unpacked.ok()) << BATT_INSPECT(unpacked.status());
+        EXPECT_EQ(unpacked->id, object.id);
+        EXPECT_EQ(unpacked->root_page_ids, object.root_page_ids);
+        EXPECT_EQ(unpacked->user_data, object.user_data);
+      }
+      {
+        batt::StatusOr<const llfs::PackedVolumeSnapshot&> packed =
+            llfs::unpack_cast<llfs::PackedVolumeSnapshot>(this->const_buffer(1));
+
+        EXPECT_FALSE(packed.ok());
+      }
+    }
+  }
+}
+
 }  // namespace
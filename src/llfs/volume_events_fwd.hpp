@@ -23,6 +23,7 @@ struct PackedPrepareJob;
 struct PackedCommitJob;
 struct PackedRollbackJob;
 struct PackedVolumeTrimEvent;
+struct PackedVolumeSnapshot;
 
 //=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
 //
@@ -36,8 +37,9 @@ using VolumeEventVariant =
                   PackedRollbackJob,          // 6
                   PackedVolumeFormatUpgrade,  // 7
                   PackedRawData,              // 8
-                  PackedVolumeTrimEvent       // 9
-                                              // 10..255 : reserved for future use.
+                  PackedVolumeTrimEvent,      // 9
+                  PackedVolumeSnapshot        // 10
+                                              // 11..255 : reserved for future use.
                   >;
 
 }  // namespace llfs
@@ -0,0 +1,209 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/volume_follower.hpp>
+//
+
+#include <llfs/logging.hpp>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ StatusOr<std::unique_ptr<VolumeFollower>> VolumeFollower::recover(
+    VolumeFollowerRecoverParams&& params)
+{
+  BATT_CHECK_NOT_NULLPTR(params.scheduler);
+  BATT_CHECK_NOT_NULLPTR(params.cache);
+  BATT_CHECK_NOT_NULLPTR(params.root_log);
+
+  std::unique_ptr<VolumeFollower> follower{new VolumeFollower{
+      params.options, std::move(params.cache), std::move(params.root_log), *params.scheduler}};
+
+  follower->start();
+
+  return follower;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ VolumeFollower::VolumeFollower(const VolumeOptions& options,
+                                            batt::SharedPtr<PageCache>&& cache,
+                                            std::unique_ptr<LogDevice>&& root_log,
+                                            batt::TaskScheduler& scheduler) noexcept
+    : options_{options}
+    , cache_{std::move(cache)}
+    , root_log_{std::move(root_log)}
+    , scheduler_{scheduler}
+    , trim_control_{}
+    , trim_lock_{BATT_OK_RESULT_OR_PANIC(this->trim_control_.lock_slots(
+          this->root_log_->slot_range(LogReadMode::kDurable), "VolumeFollower::(ctor)"))}
+{
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+VolumeFollower::~VolumeFollower() noexcept
+{
+  this->halt();
+  this->join();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void VolumeFollower::start()
+{
+  BATT_CHECK(!this->trim_task_);
+
+  this->trim_task_.emplace(
+      this->scheduler_.schedule_task(),
+      [this] {
+        this->trim_task_main();
+      },
+      "VolumeFollower::trim_task");
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void VolumeFollower::halt()
+{
+  this->trim_control_.halt();
+  this->root_log_->close().IgnoreError();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void VolumeFollower::join()
+{
+  if (this->trim_task_) {
+    this->trim_task_->join();
+    this->trim_task_ = None;
+  }
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+const VolumeOptions& VolumeFollower::options() const
+{
+  return this->options_;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PageCache& VolumeFollower::cache() const
+{
+  return *this->cache_;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+SlotLockManager& VolumeFollower::trim_control()
+{
+  return this->trim_control_;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+SlotRange VolumeFollower::root_log_slot_range(LogReadMode mode) const
+{
+  return this->root_log_->slot_range(mode);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<SlotRange> VolumeFollower::sync(LogReadMode mode, SlotUpperBoundAt event)
+{
+  Status status = this->root_log_->sync(mode, event);
+  BATT_REQUIRE_OK(status);
+
+  return this->root_log_->slot_range(mode);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<VolumeReader> VolumeFollower::reader(const SlotRangeSpec& slot_range, LogReadMode mode)
+{
+  SlotRange base_range = this->root_log_->slot_range(mode);
+
+  // Clamp the effective slot range to the portion covered by the trim lock.
+  //
+  base_range.lower_bound = this->trim_lock_.with_lock([&](SlotReadLock& trim_lock) {
+    if (trim_lock) {
+      return slot_max(base_range.lower_bound, trim_lock.slot_range().lower_bound);
+    }
+    return base_range.lower_bound;
+  });
+
+  StatusOr<SlotReadLock> read_lock = this->trim_control_.lock_slots(
+      SlotRange{
+          .lower_bound = slot_range.lower_bound.value_or(base_range.lower_bound),
+          .upper_bound = slot_range.upper_bound.value_or(base_range.upper_bound),
+      },
+      "VolumeFollower::read");
+
+  BATT_REQUIRE_OK(read_lock);
+
+  return VolumeReader{*this, std::move(*read_lock), mode};
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status VolumeFollower::trim(slot_offset_type slot_lower_bound)
+{
+  return this->trim_lock_.with_lock([slot_lower_bound, this](SlotReadLock& trim_lock) -> Status {
+    SlotRange target_range = trim_lock.slot_range();
+    target_range.lower_bound = slot_max(target_range.lower_bound, slot_lower_bound);
+    target_range.upper_bound = slot_max(target_range.upper_bound, target_range.lower_bound);
+
+    BATT_ASSIGN_OK_RESULT(trim_lock,
+                          this->trim_control_.update_lock(std::move(trim_lock), target_range,
+                                                          "VolumeFollower::trim"));
+
+    return OkStatus();
+  });
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+slot_offset_type VolumeFollower::get_safe_trim_pos() const
+{
+  return this->trim_control_.get_lower_bound();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+void VolumeFollower::trim_task_main()
+{
+  slot_offset_type lower_bound = this->root_log_->slot_range(LogReadMode::kDurable).lower_bound;
+
+  for (;;) {
+    StatusOr<slot_offset_type> new_lower_bound =
+        this->trim_control_.await_lower_bound(lower_bound + 1);
+    if (!new_lower_bound.ok()) {
+      LLFS_VLOG(1) << "VolumeFollower::trim_task exiting; " << new_lower_bound.status();
+      break;
+    }
+    lower_bound = *new_lower_bound;
+
+    // The local copy of the log is never trimmed past the data that has actually been read from
+    // the writer.
+    //
+    const SlotRange log_range = this->root_log_->slot_range(LogReadMode::kDurable);
+    const slot_offset_type trim_pos = slot_min(lower_bound, log_range.upper_bound);
+
+    if (slot_less_than(log_range.lower_bound, trim_pos)) {
+      Status status = this->root_log_->trim(trim_pos);
+      if (!status.ok()) {
+        LLFS_VLOG(1) << "VolumeFollower::trim_task exiting; " << BATT_INSPECT(status);
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace llfs
@@ -0,0 +1,164 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_VOLUME_FOLLOWER_HPP
+#define LLFS_VOLUME_FOLLOWER_HPP
+
+#include <llfs/log_device.hpp>
+#include <llfs/page_cache.hpp>
+#include <llfs/slot.hpp>
+#include <llfs/slot_lock_manager.hpp>
+#include <llfs/volume_options.hpp>
+#include <llfs/volume_reader.hpp>
+
+#include <batteries/async/mutex.hpp>
+#include <batteries/async/task.hpp>
+#include <batteries/async/task_scheduler.hpp>
+#include <batteries/shared_ptr.hpp>
+
+#include <memory>
+
+namespace llfs {
+
+struct VolumeFollowerRecoverParams {
+  batt::TaskScheduler* scheduler;
+  VolumeOptions options;
+
+  // Must be a read-only PageCache; see StorageContext::enable_follower_mode.
+  //
+  batt::SharedPtr<PageCache> cache;
+
+  // A read-only LogDevice that follows the Volume's root log as it grows, such as an
+  // IoRingLogFollowerDevice.
+  //
+  std::unique_ptr<LogDevice> root_log;
+};
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief Read-only view of a Volume that is being written by another process.
+ *
+ * A VolumeFollower serves VolumeReaders (and the pages they reference) from the root log and page
+ * devices of a live Volume.  It never touches the Volume's PageAllocators, recycler, or trimmer;
+ * new commits become visible as the root log follower picks them up.
+ *
+ * The writer still decides when slots are trimmed and pages recycled.  To keep a follower's data
+ * valid, the writer must hold a trim lock on the follower's behalf, e.g.:
+ *
+ *   writer:   lock = volume.lock_slots(SlotRangeSpec{...}, LogReadMode::kDurable, "follower");
+ *   follower: reports `follower.get_safe_trim_pos()` to the writer (out of band);
+ *   writer:   lock = volume.trim_control().update_lock(std::move(lock), {reported_pos, ...}, ...);
+ *
+ * Since a page is only recycled once every slot that references it is trimmed, this one lock keeps
+ * both the slots and the pages the follower can still reach alive.  If the writer trims past the
+ * follower anyway, the follower's root log fails with StatusCode::kLogFollowerFellBehind.
+ */
+class VolumeFollower
+{
+ public:
+  friend class VolumeReader;
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  static StatusOr<std::unique_ptr<VolumeFollower>> recover(VolumeFollowerRecoverParams&& params);
+
+  //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  ~VolumeFollower() noexcept;
+
+  VolumeFollower(const VolumeFollower&) = delete;
+  VolumeFollower& operator=(const VolumeFollower&) = delete;
+
+  // Initiates an asynchronous shutdown of the follower and all associated background Tasks.
+  //
+  void halt();
+
+  // Waits for all activity to be stopped on this follower.  `halt()` must be called, or `join()`
+  // will never return.
+  //
+  void join();
+
+  // The VolumeOptions of the followed Volume.
+  //
+  const VolumeOptions& options() const;
+
+  // Returns the PageCache used to load pages.
+  //
+  PageCache& cache() const;
+
+  // Returns a reference to the (follower-local) root log lock manager.
+  //
+  SlotLockManager& trim_control();
+
+  // Returns the slot offset range of the root log that this follower currently holds.
+  //
+  SlotRange root_log_slot_range(LogReadMode mode) const;
+
+  // Blocks until the follower has caught up with the writer's root log at the given offset.
+  //
+  StatusOr<SlotRange> sync(LogReadMode mode, SlotUpperBoundAt event);
+
+  // Returns a new VolumeReader for the given slot range; see Volume::reader.
+  //
+  StatusOr<VolumeReader> reader(const SlotRangeSpec& slot_range, LogReadMode mode);
+
+  // Returns a new TypedVolumeReader for the given slot range; see Volume::typed_reader.
+  //
+  template <typename T>
+  StatusOr<TypedVolumeReader<T>> typed_reader(const SlotRangeSpec& slot_range, LogReadMode mode,
+                                              batt::StaticType<T> = {})
+  {
+    StatusOr<VolumeReader> reader = this->reader(slot_range, mode);
+    BATT_REQUIRE_OK(reader);
+
+    return TypedVolumeReader<T>{std::move(*reader)};
+  }
+
+  // Releases this follower's own hold on root log slots below `slot_lower_bound`; slots stay
+  // readable until all VolumeReaders have moved past them as well.  See Volume::trim.
+  //
+  Status trim(slot_offset_type slot_lower_bound);
+
+  // Returns the lowest root log slot offset that this follower (or any of its readers) may still
+  // read.  This is the position the writer's trim lock for this follower should be advanced to.
+  //
+  slot_offset_type get_safe_trim_pos() const;
+
+ private:
+  explicit VolumeFollower(const VolumeOptions& options, batt::SharedPtr<PageCache>&& cache,
+                          std::unique_ptr<LogDevice>&& root_log,
+                          batt::TaskScheduler& scheduler) noexcept;
+
+  void start();
+
+  // Trims the local copy of the root log as slot read locks are released.
+  //
+  void trim_task_main();
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  const VolumeOptions options_;
+
+  batt::SharedPtr<PageCache> cache_;
+
+  std::unique_ptr<LogDevice> root_log_;
+
+  batt::TaskScheduler& scheduler_;
+
+  SlotLockManager trim_control_;
+
+  // The follower's own lock on the root log.  VolumeFollower::trim() updates this object.
+  //
+  batt::Mutex<SlotReadLock> trim_lock_;
+
+  Optional<batt::Task> trim_task_;
+};
+
+}  // namespace llfs
+
+#endif  // LLFS_VOLUME_FOLLOWER_HPP
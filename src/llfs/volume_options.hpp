@@ -12,6 +12,7 @@
 
 #include <llfs/config.hpp>
 #include <llfs/optional.hpp>
+#include <llfs/slot_compression.hpp>
 
 #include <batteries/strong_typedef.hpp>
 
@@ -36,6 +37,11 @@ struct VolumeOptions {
   MaxRefsPerPage max_refs_per_page;
 
   TrimLockUpdateInterval trim_lock_update_interval;
+
+  // User payloads (raw data slots and PrepareJob slots) at least this large are compressed in the
+  // root log when that makes them smaller; 0 disables compression.
+  //
+  SlotCompressionMinSize slot_compression_min_size;
 };
 
 }  // namespace llfs
@@ -10,6 +10,7 @@
 //
 
 #include <llfs/volume.hpp>
+#include <llfs/volume_follower.hpp>
 #include <llfs/volume_slot_demuxer.hpp>
 
 namespace llfs {
@@ -20,17 +21,19 @@ namespace {
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-/*explicit*/ VolumeReader::Impl::Impl(Volume& volume, SlotReadLock&& read_lock,
-                                      LogReadMode mode) noexcept
-    : volume_{volume}
+/*explicit*/ VolumeReader::Impl::Impl(PageCache& cache, const VolumeOptions& options,
+                                      LogDevice& root_log, SlotLockManager& trim_control,
+                                      SlotReadLock&& read_lock, LogReadMode mode) noexcept
+    : options_{options}
+    , trim_control_{trim_control}
     , read_lock_{std::move(read_lock)}
-    , job_{this->volume_.cache().new_job()}
-    , log_reader_{this->volume_.root_log_->new_reader(read_lock.slot_range().lower_bound, mode)}
+    , job_{cache.new_job()}
+    , log_reader_{root_log.new_reader(read_lock.slot_range().lower_bound, mode)}
     , slot_reader_{*this->log_reader_}
     , paused_{true}
     , pending_jobs_{}
     , trim_lock_update_lower_bound_{this->log_reader_->slot_offset() +
-                                    this->volume_.options().trim_lock_update_interval}
+                                    this->options_.trim_lock_update_interval}
 {
   this->slot_reader_.set_pre_slot_fn([this](slot_offset_type) {
     if (this->paused_) {
@@ -54,16 +57,33 @@ void VolumeReader::ImplDeleter::operator()(Impl* ptr) const
 //
 const VolumeOptions& VolumeReader::volume_options() const
 {
-  return this->impl_->volume_.options();
+  return this->impl_->options_;
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 /*explicit*/ VolumeReader::VolumeReader(Volume& volume, SlotReadLock&& read_lock,
                                         LogReadMode mode) noexcept
-    : impl_{new Impl{volume, std::move(read_lock), mode}}
+    : impl_{new Impl{volume.cache(), volume.options(), *volume.root_log_, *volume.trim_control_,
+                     std::move(read_lock), mode}}
 {
   BATT_CHECK(this->impl_->read_lock_);
+
+  this->impl_->job_->set_cache_owner(cache_owner_for_uuid(volume.get_volume_uuid()));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*explicit*/ VolumeReader::VolumeReader(VolumeFollower& follower, SlotReadLock&& read_lock,
+                                        LogReadMode mode) noexcept
+    : impl_{new Impl{follower.cache(), follower.options(), *follower.root_log_,
+                     follower.trim_control(), std::move(read_lock), mode}}
+{
+  BATT_CHECK(this->impl_->read_lock_);
+
+  if (follower.options().uuid) {
+    this->impl_->job_->set_cache_owner(cache_owner_for_uuid(*follower.options().uuid));
+  }
 }
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -125,7 +145,7 @@ Status VolumeReader::trim(slot_offset_type trim_upper_bound)
 
   BATT_CHECK(this->impl_->read_lock_);
 
-  StatusOr<SlotReadLock> updated = this->impl_->volume_.trim_control_->update_lock(
+  StatusOr<SlotReadLock> updated = this->impl_->trim_control_.update_lock(
       std::move(this->impl_->read_lock_), new_slot_range, "VolumeReader::trim");
 
   BATT_UNTESTED_COND(!updated.ok());
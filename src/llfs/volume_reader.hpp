@@ -22,6 +22,7 @@
 namespace llfs {
 
 class Volume;
+class VolumeFollower;
 class VolumeReader;
 
 template <typename T>
@@ -41,6 +42,9 @@ class VolumeReader : public PageLoader
 
   explicit VolumeReader(Volume& volume, SlotReadLock&& read_lock, LogReadMode mode) noexcept;
 
+  explicit VolumeReader(VolumeFollower& follower, SlotReadLock&& read_lock,
+                        LogReadMode mode) noexcept;
+
   VolumeReader() = default;
 
   //+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -24,16 +24,19 @@ namespace llfs {
 class VolumeReader::Impl
 {
  public:
-  // Construct a VolumeReader::Impl for the given Volume with the specified slot range locked.
+  // Construct a VolumeReader::Impl for the given Volume (or VolumeFollower) root log with the
+  // specified slot range locked.
   //
-  explicit Impl(Volume& volume, SlotReadLock&& read_lock, LogReadMode mode) noexcept;
+  explicit Impl(PageCache& cache, const VolumeOptions& options, LogDevice& root_log,
+                SlotLockManager& trim_control, SlotReadLock&& read_lock, LogReadMode mode) noexcept;
 
   Impl(const Impl&) = delete;
   Impl& operator=(const Impl&) = delete;
 
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
-  Volume& volume_;
+  const VolumeOptions& options_;
+  SlotLockManager& trim_control_;
   SlotReadLock read_lock_;
   std::unique_ptr<PageCacheJob> job_;
   std::unique_ptr<LogDevice::Reader> log_reader_;
@@ -51,6 +51,16 @@ StatusOr<NoneType> VolumeRecoveryVisitor::on_volume_ids(const SlotParse& slot,
   return None;
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<NoneType> VolumeRecoveryVisitor::on_volume_recovered(
+    const SlotParse& slot, const PackedVolumeRecovered& recovered)
+{
+  this->recovered_slot = slot.offset;
+
+  return VolumeSlotDemuxer<NoneType>::on_volume_recovered(slot, recovered);
+}
+
 // TODO[tastolfi 2022-11-18] on_volume_trim;
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -79,8 +89,7 @@ Status VolumeRecoveryVisitor::resolve_pending_jobs(PageCache& cache, PageRecycle
     std::vector<PageId> found_pages;
     Status overall_status = OkStatus();
     as_seq(*pending_job.get().new_page_ids) |
-        seq::for_each([&](const PackedPageId& packed_page_id) {
-          auto page_id = packed_page_id.as_page_id();
+        seq::for_each([&](const PageId& page_id) {
           Status recover_status = job->recover_page(page_id, volume_uuid, prepare_slot);
           if (recover_status.ok()) {
             found_pages.emplace_back(page_id);
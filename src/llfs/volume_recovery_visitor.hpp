@@ -36,6 +36,8 @@ class VolumeRecoveryVisitor : public VolumeSlotDemuxer<NoneType>
 
   StatusOr<NoneType> on_volume_ids(const SlotParse&, const PackedVolumeIds&) override;
 
+  StatusOr<NoneType> on_volume_recovered(const SlotParse&, const PackedVolumeRecovered&) override;
+
   //+++++++++++-+-+--+----- --- -- -  -  -   -
   // public data
   //+++++++++++-+-+--+----- --- -- -  -  -   -
@@ -47,6 +49,10 @@ class VolumeRecoveryVisitor : public VolumeSlotDemuxer<NoneType>
   // The uuids for the volume.
   //
   Optional<SlotWithPayload<PackedVolumeIds>> ids;
+
+  // The most recent PackedVolumeRecovered slot, if any.
+  //
+  Optional<SlotRange> recovered_slot;
 };
 
 }  // namespace llfs
@@ -22,6 +22,18 @@ namespace llfs {
       .root_log_options = IoRingLogDriverOptions::with_default_values(),
       .recycler_log_options = IoRingLogDriverOptions::with_default_values(),
       .trim_control = nullptr,
+      .background_write_recovery = false,
+      .max_async_append_tasks = 16,
+      .max_idle_async_append_tasks = 2,
+  };
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+/*static*/ VolumeFollowerRuntimeOptions VolumeFollowerRuntimeOptions::with_default_values()
+{
+  return VolumeFollowerRuntimeOptions{
+      .root_log_options = IoRingLogFollowerOptions{},
   };
 }
 
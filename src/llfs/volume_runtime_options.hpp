@@ -11,6 +11,7 @@
 #define LLFS_VOLUME_RUNTIME_OPTIONS_HPP
 
 #include <llfs/ioring_log_driver_options.hpp>
+#include <llfs/ioring_log_follower_driver.hpp>
 #include <llfs/volume_reader.hpp>
 
 #include <batteries/async/task_scheduler.hpp>
@@ -41,6 +42,32 @@ struct VolumeRuntimeOptions {
   // `nullptr`, a new SlotLockManager will be created.
   //
   std::shared_ptr<SlotLockManager> trim_control;
+
+  // If true, the Volume can be read from as soon as its root log has been scanned; the rest of
+  // recovery runs in the background and writes wait for it.  See
+  // VolumeRecoverParams::background_write_recovery.
+  //
+  bool background_write_recovery = false;
+
+  // See VolumeRecoverParams::max_async_append_tasks.
+  //
+  usize max_async_append_tasks = 16;
+
+  // See VolumeRecoverParams::max_idle_async_append_tasks.
+  //
+  usize max_idle_async_append_tasks = 2;
+};
+
+// Options used to recover a VolumeFollower from a StorageContext in follower mode.
+//
+struct VolumeFollowerRuntimeOptions {
+  static VolumeFollowerRuntimeOptions with_default_values();
+
+  //+++++++++++-+-+--+----- --- -- -  -  -   -
+
+  // Runtime options for the read-only root log follower.
+  //
+  IoRingLogFollowerOptions root_log_options;
 };
 
 }  // namespace llfs
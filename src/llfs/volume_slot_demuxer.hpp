@@ -79,6 +79,8 @@ class VolumeSlotDemuxer : public VolumeEventVisitor<StatusOr<R>>
 
   StatusOr<R> on_volume_trim(const SlotParse&, const VolumeTrimEvent&) override;
 
+  StatusOr<R> on_volume_snapshot(const SlotParse&, const VolumeSnapshot&) override;
+
  private:
   // Updates internal state to reflect having visited the given slot.
   //
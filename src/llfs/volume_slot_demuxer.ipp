@@ -231,6 +231,27 @@ StatusOr<R> VolumeSlotDemuxer<R, Fn>::on_volume_trim(const SlotParse& slot,
   return this->base_.on_volume_trim(slot, trim);
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+template <typename R, typename Fn>
+StatusOr<R> VolumeSlotDemuxer<R, Fn>::on_volume_snapshot(
+    const SlotParse& slot, const VolumeSnapshot& snapshot) /*override*/
+{
+  auto on_scope_exit = batt::finally([&] {
+    this->mark_slot_visited(slot);
+  });
+
+  LLFS_VLOG(1) << "on_volume_snapshot(" << BATT_INSPECT(slot) << ")";
+
+  // A snapshot's job stays pending until the snapshot is released, but it is not waiting to be
+  // resolved; stop tracking it so that it neither holds back the safe trim pos nor gets committed
+  // during recovery.  Snapshots are not passed to the user-level slot visitor.
+  //
+  this->pending_jobs_.erase(snapshot.id);
+
+  return this->base_.on_volume_snapshot(slot, snapshot);
+}
+
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 template <typename R, typename Fn>
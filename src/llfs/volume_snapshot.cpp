@@ -0,0 +1,92 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#include <llfs/volume_snapshot.hpp>
+//
+
+#include <llfs/data_layout.hpp>
+
+#include <batteries/stream_util.hpp>
+
+#include <algorithm>
+
+namespace llfs {
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::ostream& operator<<(std::ostream& out, const VolumeSnapshot& t)
+{
+  return out << "VolumeSnapshot{.id=" << t.id
+             << ", .root_page_ids=" << batt::dump_range(t.root_page_ids)
+             << ", .user_data.size()=" << t.user_data.size() << ",}";
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize packed_sizeof(const VolumeSnapshot& object)
+{
+  return sizeof(PackedSlotOffset) + packed_sizeof(object.user_data) +
+         packed_page_id_list_size(as_slice(object.root_page_ids));
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+usize packed_sizeof(const PackedVolumeSnapshot& packed)
+{
+  return sizeof(PackedSlotOffset) + packed_sizeof(packed.user_data) +
+         packed_sizeof(packed.root_page_ids);
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+PackedVolumeSnapshot* pack_object_to(const VolumeSnapshot& object, PackedVolumeSnapshot* packed,
+                                     DataPacker* dst)
+{
+  BATT_ASSERT(std::is_sorted(object.root_page_ids.begin(), object.root_page_ids.end()));
+
+  packed->snapshot_id = object.id;
+
+  // The page id list must be packed first, so that its items immediately follow `packed`; the
+  // user data is allocated from the back of the buffer.
+  //
+  if (pack_page_id_list_to(as_slice(object.root_page_ids), &packed->root_page_ids, dst) ==
+      nullptr) {
+    return nullptr;
+  }
+
+  if (!dst->pack_string_to(&packed->user_data, object.user_data)) {
+    return nullptr;
+  }
+
+  return packed;
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+StatusOr<VolumeSnapshot> unpack_object(const PackedVolumeSnapshot& packed, DataReader* /*src*/)
+{
+  return VolumeSnapshot{
+      .id = packed.snapshot_id,
+      .root_page_ids = as_seq(packed.root_page_ids) | seq::collect_vec(),
+      .user_data = std::string{packed.user_data.as_str()},
+  };
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status validate_packed_value(const PackedVolumeSnapshot& packed, const void* buffer_data,
+                             usize buffer_size)
+{
+  BATT_REQUIRE_OK(validate_packed_struct(packed, buffer_data, buffer_size));
+  BATT_REQUIRE_OK(validate_packed_value(packed.user_data, buffer_data, buffer_size));
+  BATT_REQUIRE_OK(validate_packed_value(packed.root_page_ids, buffer_data, buffer_size));
+
+  return batt::OkStatus();
+}
+
+}  // namespace llfs
@@ -0,0 +1,97 @@
+//#=##=##=#==#=#==#===#+==#+==========+==+=+=+=+=+=++=+++=+++++=-++++=-+++++++++++
+//
+// Part of the LLFS Project, under Apache License v2.0.
+// See https://www.apache.org/licenses/LICENSE-2.0 for license information.
+// SPDX short identifier: Apache-2.0
+//
+//+++++++++++-+-+--+----- --- -- -  -  -   -
+
+#pragma once
+#ifndef LLFS_VOLUME_SNAPSHOT_HPP
+#define LLFS_VOLUME_SNAPSHOT_HPP
+
+#include <llfs/data_packer.hpp>
+#include <llfs/data_reader.hpp>
+#include <llfs/define_packed_type.hpp>
+#include <llfs/int_types.hpp>
+#include <llfs/packed_bytes.hpp>
+#include <llfs/packed_page_id_list.hpp>
+#include <llfs/page_id.hpp>
+#include <llfs/slot.hpp>
+#include <llfs/status.hpp>
+
+#include <batteries/static_assert.hpp>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace llfs {
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief A point-in-time, copy-on-write view of the pages reachable from a set of root pages;
+ * created by Volume::snapshot.
+ *
+ * A snapshot is a job whose PrepareJob slot refers to the root pages, but which is never committed;
+ * a PackedVolumeSnapshot slot is written in place of the CommitJob.  The job holds one reference to
+ * each root for as long as it is pending, so the snapshot's pages stay readable no matter how the
+ * live roots change afterward; since pages are immutable, later jobs simply stop sharing pages with
+ * the snapshot as they are rewritten.
+ *
+ * The snapshot does not hold a lock on the log.  The VolumeTrimmer carries the pending job forward
+ * in its trim events and re-appends the PackedVolumeSnapshot slot before trimming it, so snapshots
+ * survive both trimming and restarts (see Volume::snapshots).  Volume::release_snapshot commits the
+ * job, after which the root references are dropped when the commit slot is trimmed.
+ */
+struct VolumeSnapshot {
+  // Identifies the snapshot within its Volume; this is the offset of its PrepareJob slot.
+  //
+  slot_offset_type id;
+
+  // The pages this snapshot holds a reference to, sorted by PageId.
+  //
+  std::vector<PageId> root_page_ids;
+
+  // The packed user data passed to Volume::snapshot; this can be read back with `unpack_cast`.
+  //
+  std::string user_data;
+};
+
+std::ostream& operator<<(std::ostream& out, const VolumeSnapshot& t);
+
+//=#=#==#==#===============+=+=+=+=++=++++++++++++++-++-+--+-+----+---------------
+/** \brief The Volume WAL record of a live VolumeSnapshot.
+ */
+struct PackedVolumeSnapshot {
+  // The offset of the snapshot's PrepareJob slot.
+  //
+  PackedSlotOffset snapshot_id;
+
+  // See VolumeSnapshot::user_data.
+  //
+  PackedBytes user_data;
+
+  // Must be last; the list items follow this struct.
+  //
+  PackedPageIdList root_page_ids;
+};
+
+BATT_STATIC_ASSERT_EQ(sizeof(PackedVolumeSnapshot), 24);
+
+LLFS_DEFINE_PACKED_TYPE_FOR(VolumeSnapshot, PackedVolumeSnapshot);
+
+usize packed_sizeof(const VolumeSnapshot& object);
+
+usize packed_sizeof(const PackedVolumeSnapshot& packed);
+
+PackedVolumeSnapshot* pack_object_to(const VolumeSnapshot& object, PackedVolumeSnapshot* packed,
+                                     DataPacker* dst);
+
+StatusOr<VolumeSnapshot> unpack_object(const PackedVolumeSnapshot& packed, DataReader* src);
+
+Status validate_packed_value(const PackedVolumeSnapshot& packed, const void* buffer_data,
+                             usize buffer_size);
+
+}  // namespace llfs
+
+#endif  // LLFS_VOLUME_SNAPSHOT_HPP
@@ -216,10 +216,26 @@ StatusOr<VolumeTrimmedRegionInfo> read_trimmed_region(
   result->slot_range.lower_bound = slot_reader.next_slot_offset();
   result->slot_range.upper_bound = result->slot_range.lower_bound;
 
+  // The slot size of each snapshot that is released in this region; the trimmer grant holds enough
+  // to refresh each live snapshot once, which is no longer needed.
+  //
+  std::unordered_map<slot_offset_type /*snapshot_id*/, usize> released_snapshot_sizes;
+
+  // Called when a job is committed or rolled back; if the job is a snapshot found earlier in this
+  // region, it no longer needs to be refreshed.
+  //
+  const auto release_snapshot = [&result, &released_snapshot_sizes](slot_offset_type prepare_slot) {
+    auto iter = result->snapshots_to_refresh.find(prepare_slot);
+    if (iter != result->snapshots_to_refresh.end()) {
+      released_snapshot_sizes[prepare_slot] = packed_sizeof_slot(iter->second);
+      result->snapshots_to_refresh.erase(iter);
+    }
+  };
+
   StatusOr<usize> read_status = slot_reader.run(
       batt::WaitForResource::kTrue,
-      [trim_upper_bound, &result, &prior_pending_jobs](const SlotParse& slot,
-                                                       const auto& payload) -> Status {
+      [trim_upper_bound, &result, &prior_pending_jobs, &released_snapshot_sizes,
+       &release_snapshot](const SlotParse& slot, const auto& payload) -> Status {
         const SlotRange& slot_range = slot.offset;
 
         LLFS_VLOG(2) << "read slot: " << BATT_INSPECT(slot_range)
@@ -241,11 +257,7 @@ StatusOr<VolumeTrimmedRegionInfo> read_trimmed_region(
             //
             [&](const SlotParse& slot, const Ref<const PackedPrepareJob>& prepare) {
               std::vector<PageId> root_page_ids =
-                  as_seq(*prepare.get().root_page_ids) |
-                  seq::map([](const PackedPageId& packed) -> PageId {
-                    return packed.as_page_id();
-                  }) |
-                  seq::collect_vec();
+                  as_seq(*prepare.get().root_page_ids) | seq::collect_vec();
 
               LLFS_VLOG(1) << "visit_slot(" << BATT_INSPECT(slot.offset)
                            << ", PrepareJob) root_page_ids=" << batt::dump_range(root_page_ids);
@@ -286,6 +298,8 @@ StatusOr<VolumeTrimmedRegionInfo> read_trimmed_region(
 
               result->grant_size_to_release += packed_sizeof_slot(commit);
 
+              release_snapshot(commit.prepare_slot);
+
               // Check the pending PrepareJob slots from before this trim.
               //
               if (extract_pending_job(prior_pending_jobs)) {
@@ -319,6 +333,7 @@ StatusOr<VolumeTrimmedRegionInfo> read_trimmed_region(
               // The job has been resolved (rolled back); remove it from the maps.
               //
               LLFS_VLOG(1) << "Rolling back pending job;" << BATT_INSPECT(rollback.prepare_slot);
+              release_snapshot(rollback.prepare_slot);
               if (prior_pending_jobs.erase(rollback.prepare_slot) == 1u) {
                 result->resolved_jobs.emplace_back(rollback.prepare_slot);
               }
@@ -353,6 +368,13 @@ StatusOr<VolumeTrimmedRegionInfo> read_trimmed_region(
               return batt::OkStatus();
             },
 
+            //+++++++++++-+-+--+----- --- -- -  -  -   -
+            //
+            [&](const SlotParse&, const PackedVolumeRecovered& recovered) {
+              result->grant_size_to_release += packed_sizeof_slot(recovered);
+              return batt::OkStatus();
+            },
+
             //+++++++++++-+-+--+----- --- -- -  -  -   -
             //
             [&](const SlotParse&, const VolumeTrimEvent& trim_event) {
@@ -373,6 +395,25 @@ StatusOr<VolumeTrimmedRegionInfo> read_trimmed_region(
               return batt::OkStatus();
             },
 
+            //+++++++++++-+-+--+----- --- -- -  -  -   -
+            //
+            [&](const SlotParse& slot, const VolumeSnapshot& snapshot) {
+              // A snapshot is live for as long as its job is pending.
+              //
+              const bool is_live = result->pending_jobs.count(snapshot.id) != 0 ||
+                                   prior_pending_jobs.count(snapshot.id) != 0;
+
+              LLFS_VLOG(1) << "visit_slot(" << BATT_INSPECT(slot.offset) << ", VolumeSnapshot)"
+                           << BATT_INSPECT(snapshot.id) << BATT_INSPECT(is_live);
+
+              if (is_live) {
+                result->snapshots_to_refresh[snapshot.id] = snapshot;
+              } else {
+                released_snapshot_sizes[snapshot.id] = packed_sizeof_slot(snapshot);
+              }
+              return batt::OkStatus();
+            },
+
             //+++++++++++-+-+--+----- --- -- -  -  -   -
             //
             [](const SlotParse&, const auto& /*payload*/) {
@@ -389,6 +430,11 @@ StatusOr<VolumeTrimmedRegionInfo> read_trimmed_region(
     BATT_REQUIRE_OK(read_status);
   }
 
+  for (const auto& [snapshot_id, slot_size] : released_snapshot_sizes) {
+    result->grant_size_to_release += slot_size;
+    result->released_snapshots.emplace_back(snapshot_id);
+  }
+
   return result;
 }
 
@@ -455,6 +501,39 @@ Status refresh_volume_metadata(TypedSlotWriter<VolumeEventVariant>& slot_writer,
     LLFS_VLOG(1) << " -- " << BATT_INSPECT(sync_point);
   }
 
+  // Refresh any snapshots that will be lost in this trim; the snapshot slot must stay in the log
+  // until its job is resolved.
+  //
+  for (const auto& [snapshot_id, snapshot] : trimmed_region.snapshots_to_refresh) {
+    trimmed_region.grant_size_to_reserve += packed_sizeof_slot(snapshot);
+
+    // Skip this snapshot if we know it has been refreshed at a higher slot.
+    //
+    {
+      auto iter = refresh_info.most_recent_snapshot_slot.find(snapshot_id);
+      if (iter != refresh_info.most_recent_snapshot_slot.end()) {
+        if (!slot_less_than(iter->second, trimmed_region.slot_range.upper_bound)) {
+          continue;
+        }
+      }
+    }
+
+    LLFS_VLOG(1) << "Refreshing snapshot " << snapshot;
+
+    StatusOr<SlotRange> slot_range = slot_writer.append(grant, snapshot);
+    BATT_REQUIRE_OK(slot_range);
+
+    refresh_info.most_recent_snapshot_slot[snapshot_id] = slot_range->lower_bound;
+
+    clamp_min_slot(&sync_point, slot_range->upper_bound);
+
+    LLFS_VLOG(1) << " -- " << BATT_INSPECT(sync_point);
+  }
+
+  for (slot_offset_type snapshot_id : trimmed_region.released_snapshots) {
+    refresh_info.most_recent_snapshot_slot.erase(snapshot_id);
+  }
+
   // Make sure all refreshed slots are flushed before returning.
   //
   if (sync_point) {
@@ -601,6 +680,8 @@ Status VolumeTrimmer::RecoveryVisitor::on_raw_data(const SlotParse&,
 Status VolumeTrimmer::RecoveryVisitor::on_prepare_job(
     const SlotParse& slot, const Ref<const PackedPrepareJob>& prepare) /*override*/
 {
+  this->prepared_jobs_.emplace(slot.offset.lower_bound);
+
   const usize slot_size = packed_sizeof_slot(prepare.get());
 
   this->trimmer_grant_size_ += slot_size;
@@ -616,6 +697,8 @@ Status VolumeTrimmer::RecoveryVisitor::on_prepare_job(
 Status VolumeTrimmer::RecoveryVisitor::on_commit_job(const SlotParse& slot,
                                                      const PackedCommitJob& commit) /*override*/
 {
+  this->resolved_jobs_.emplace(commit.prepare_slot);
+
   const usize slot_size = packed_sizeof_slot(commit);
 
   this->trimmer_grant_size_ += slot_size;
@@ -628,9 +711,11 @@ Status VolumeTrimmer::RecoveryVisitor::on_commit_job(const SlotParse& slot,
 
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
-Status VolumeTrimmer::RecoveryVisitor::on_rollback_job(const SlotParse&,
-                                                       const PackedRollbackJob&) /*override*/
+Status VolumeTrimmer::RecoveryVisitor::on_rollback_job(
+    const SlotParse&, const PackedRollbackJob& rollback) /*override*/
 {
+  this->resolved_jobs_.emplace(rollback.prepare_slot);
+
   // TODO [tastolfi 2022-11-23] Figure out whether we need to do anything here to avoid leaking log
   // grant...
   //
@@ -672,8 +757,16 @@ Status VolumeTrimmer::RecoveryVisitor::on_volume_ids(const SlotParse& slot,
 //==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
 //
 Status VolumeTrimmer::RecoveryVisitor::on_volume_recovered(
-    const SlotParse&, const PackedVolumeRecovered&) /*override*/
+    const SlotParse& slot, const PackedVolumeRecovered& recovered) /*override*/
 {
+  const usize slot_size = packed_sizeof_slot(recovered);
+
+  this->trimmer_grant_size_ += slot_size;
+
+  LLFS_VLOG(1) << "RecoveryVisitor::on_volume_recovered(slot=" << slot.offset
+               << "); trimmer_grant_size " << (this->trimmer_grant_size_ - slot_size) << " -> "
+               << this->trimmer_grant_size_;
+
   return batt::OkStatus();
 }
 
@@ -736,4 +829,48 @@ Status VolumeTrimmer::RecoveryVisitor::on_volume_trim(
   return batt::OkStatus();
 }
 
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+Status VolumeTrimmer::RecoveryVisitor::on_volume_snapshot(
+    const SlotParse& slot, const VolumeSnapshot& snapshot) /*override*/
+{
+  const usize slot_size = packed_sizeof_slot(snapshot);
+
+  // Each snapshot slot in the log will either be refreshed or released when it is trimmed.
+  //
+  this->trimmer_grant_size_ += slot_size;
+
+  LLFS_VLOG(1) << "RecoveryVisitor::on_volume_snapshot(slot=" << slot.offset
+               << "); trimmer_grant_size " << (this->trimmer_grant_size_ - slot_size) << " -> "
+               << this->trimmer_grant_size_;
+
+  this->refresh_info_.most_recent_snapshot_slot[snapshot.id] = slot.offset.lower_bound;
+  this->snapshots_[snapshot.id] = snapshot;
+
+  return batt::OkStatus();
+}
+
+//==#==========+==+=+=++=+++++++++++-+-+--+----- --- -- -  -  -   -
+//
+std::vector<VolumeSnapshot> VolumeTrimmer::RecoveryVisitor::get_snapshots() const noexcept
+{
+  std::vector<VolumeSnapshot> live_snapshots;
+
+  for (const auto& [snapshot_id, snapshot] : this->snapshots_) {
+    // A snapshot is live until its job is resolved.  If the job was resolved in a region that has
+    // since been trimmed, a refreshed snapshot slot may still be in the log; in that case the job
+    // is neither in the untrimmed part of the log nor among the pending jobs carried forward by
+    // trim events.
+    //
+    const bool is_pending = this->prepared_jobs_.count(snapshot_id) != 0 ||
+                            this->pending_jobs_.count(snapshot_id) != 0;
+
+    if (is_pending && this->resolved_jobs_.count(snapshot_id) == 0) {
+      live_snapshots.emplace_back(snapshot);
+    }
+  }
+
+  return live_snapshots;
+}
+
 }  // namespace llfs
@@ -17,8 +17,10 @@
 #include <llfs/status.hpp>
 #include <llfs/volume_event_visitor.hpp>
 #include <llfs/volume_events.hpp>
+#include <llfs/volume_snapshot.hpp>
 
 #include <atomic>
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -35,6 +37,8 @@ struct VolumeTrimmedRegionInfo {
   Optional<PackedVolumeIds> ids_to_refresh;
   std::unordered_map<VolumeAttachmentId, PackedVolumeAttachEvent, VolumeAttachmentId::Hash>
       attachments_to_refresh;
+  std::unordered_map<slot_offset_type /*snapshot_id*/, VolumeSnapshot> snapshots_to_refresh;
+  std::vector<slot_offset_type> released_snapshots;
   usize grant_size_to_release = 0;
   usize grant_size_to_reserve = 0;
 
@@ -65,14 +69,18 @@ struct VolumeMetadataRefreshInfo {
   using AttachSlotMap =
       std::unordered_map<VolumeAttachmentId, slot_offset_type, VolumeAttachmentId::Hash>;
 
+  using SnapshotSlotMap = std::unordered_map<slot_offset_type /*snapshot_id*/, slot_offset_type>;
+
   Optional<slot_offset_type> most_recent_ids_slot;
   AttachSlotMap most_recent_attach_slot;
+  SnapshotSlotMap most_recent_snapshot_slot;
 };
 
 inline bool operator==(const VolumeMetadataRefreshInfo& l, const VolumeMetadataRefreshInfo& r)
 {
   return l.most_recent_ids_slot == r.most_recent_ids_slot  //
-         && l.most_recent_attach_slot == r.most_recent_attach_slot;
+         && l.most_recent_attach_slot == r.most_recent_attach_slot  //
+         && l.most_recent_snapshot_slot == r.most_recent_snapshot_slot;
 }
 
 inline bool operator!=(const VolumeMetadataRefreshInfo& l, const VolumeMetadataRefreshInfo& r)
@@ -84,6 +92,7 @@ inline std::ostream& operator<<(std::ostream& out, const VolumeMetadataRefreshIn
 {
   return out << "{.most_recent_ids_slot=" << t.most_recent_ids_slot
              << ",  .most_recent_attach_slot=" << batt::dump_range(t.most_recent_attach_slot)
+             << ",  .most_recent_snapshot_slot=" << batt::dump_range(t.most_recent_snapshot_slot)
              << ",}";
 }
 
@@ -247,6 +256,8 @@ class VolumeTrimmer::RecoveryVisitor : public VolumeEventVisitor<Status>
   Status on_volume_format_upgrade(const SlotParse&, const PackedVolumeFormatUpgrade&) override;
 
   Status on_volume_trim(const SlotParse&, const VolumeTrimEvent&) override;
+
+  Status on_volume_snapshot(const SlotParse&, const VolumeSnapshot&) override;
   //
   //+++++++++++-+-+--+----- --- -- -  -  -   -
 
@@ -279,12 +290,26 @@ class VolumeTrimmer::RecoveryVisitor : public VolumeEventVisitor<Status>
     return this->trimmer_grant_size_;
   }
 
+  /** \brief Returns the snapshots that have not been released, ordered by id.
+   */
+  std::vector<VolumeSnapshot> get_snapshots() const noexcept;
+
  private:
   slot_offset_type log_trim_pos_;
   VolumeMetadataRefreshInfo refresh_info_;
   Optional<VolumeTrimEventInfo> trim_event_info_;
   VolumePendingJobsUMap pending_jobs_;
   usize trimmer_grant_size_ = 0;
+
+  // The prepare slots of all jobs in the untrimmed part of the log, and of those jobs that are
+  // resolved there; used to tell which of `snapshots_` are still pending.
+  //
+  std::unordered_set<slot_offset_type> prepared_jobs_;
+  std::unordered_set<slot_offset_type> resolved_jobs_;
+
+  // The most recent PackedVolumeSnapshot slot for each snapshot id.
+  //
+  std::map<slot_offset_type, VolumeSnapshot, SlotLess> snapshots_;
 };
 
 }  // namespace llfs
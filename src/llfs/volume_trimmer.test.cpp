@@ -432,11 +432,10 @@ class VolumeTrimmerTest : public ::testing::Test
     batt::BoxedSeq<llfs::PageId> page_ids_seq =
         batt::as_seq(page_ids) | batt::seq::decayed() | batt::seq::boxed();
 
-    llfs::PrepareJob prepare{
-        .new_page_ids = batt::seq::Empty<llfs::PageId>{} | batt::seq::boxed(),
-        .deleted_page_ids = batt::seq::Empty<llfs::PageId>{} | batt::seq::boxed(),
-        .user_data = llfs::PackableRef{page_ids_seq},
-    };
+    llfs::PrepareJob prepare = llfs::make_prepare_job(
+        /*new_page_ids=*/batt::seq::Empty<llfs::PageId>{} | batt::seq::boxed(),
+        /*deleted_page_ids=*/batt::seq::Empty<llfs::PageId>{} | batt::seq::boxed(),
+        llfs::PackableRef{page_ids_seq});
 
     const usize n_to_reserve = (packed_sizeof_slot(prepare) +
                                 packed_sizeof_slot(batt::StaticType<llfs::PackedCommitJob>{})) *